@@ -0,0 +1,57 @@
+#pragma once
+
+#include "defines.hpp"
+
+// Every benchmark prints one csv line:
+//   group,name,iterations,ns_per_op,ops_per_sec
+// so two runs can be diffed or pasted into a spreadsheet. Keep names stable between changes. Lines starting with '#'
+// are notes/checks, not results. Groups can be picked on the command line, see bench_main.cpp.
+
+void bench_print_header();
+void bench_report(const char *group, const char *name, u64 iterations, f64 elapsed_seconds);
+
+// resident set size of the bench process, 0 if the platform doesnt tell us.
+u64 bench_get_rss_bytes();
+// high water mark of the resident set since the last bench_reset_peak_rss, 0 if the platform doesnt tell us.
+void bench_reset_peak_rss();
+u64  bench_get_peak_rss_bytes();
+
+// keeps the optimizer from throwing away the work we are measuring.
+template <typename T> inline void bench_do_not_optimize(T const &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// INFO: deterministic xorshift for the bench inputs. dmath's drandom is seeded from the clock and shares rand()'s state
+// between threads, so two runs wouldnt time the same data. Every bench seeds it first, threads seed their own stream.
+void bench_random_seed(u64 seed);
+u64  bench_random_u64();
+// uniform in [min, max).
+f32  bench_random_f32(f32 min, f32 max);
+
+void bench_allocators_run();
+void bench_arenas_run();
+void bench_slab_run();
+void bench_dmemory_run();
+void bench_snapshot_run();
+void bench_darray_run();
+void bench_hashtable_run();
+void bench_dstring_run();
+// spawns its own reader/writer threads.
+void bench_concurrent_hashtable_run();
+// spawns its own producer/consumer threads.
+void bench_ring_buffer_run();
+// reads the obj files in assets/meshes, run it from bin/.
+void bench_text_scan_run();
+// reads the obj files in assets/meshes, run it from bin/.
+void bench_number_run();
+// checks the simd math against the scalar versions before timing it.
+void bench_math_run();
+// same, for the vertex batch kernels, on a generated grid mesh.
+void bench_vertex_batch_run();
+// checks the simd culling against the scalar one and a few known boxes before timing it.
+void bench_frustum_run();
+// reads assets/meshes/sponza.obj if it is there (run it from bin/), a generated scene otherwise.
+void bench_bvh_run();
+// creates its own arena pools, call it after the main pool is gone.
+void bench_huge_pages_run();
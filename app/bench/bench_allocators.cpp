@@ -0,0 +1,285 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "memory/arenas.hpp"
+#include "memory/linear_allocator.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+// INFO: every allocation pattern is run against every allocator so a change to one of them can be judged against the
+// others. "free" means whatever the allocator offers: nothing for the arena and the linear allocator (they are reset in
+// bulk at the end of a frame/round), dfree for dallocate and free for malloc.
+enum bench_allocator_kind
+{
+    BENCH_ALLOCATOR_ARENA,
+    BENCH_ALLOCATOR_LINEAR,
+    BENCH_ALLOCATOR_DALLOCATE,
+    BENCH_ALLOCATOR_MALLOC,
+    BENCH_ALLOCATOR_COUNT,
+};
+
+static const char *bench_allocator_names[BENCH_ALLOCATOR_COUNT] = {"arena_allocate_block", "linear_allocator",
+                                                                   "dallocate", "malloc"};
+
+struct bench_allocator
+{
+    bench_allocator_kind kind;
+    memory_tags          tag;
+    arena               *backing;
+    linear_allocator     linear;
+};
+
+static void bench_allocator_create(bench_allocator *allocator, bench_allocator_kind kind, memory_tags tag,
+                                   u64 linear_capacity)
+{
+    allocator->kind    = kind;
+    allocator->tag     = tag;
+    allocator->backing = arena_get_arena();
+    allocator->linear  = {};
+    if (kind == BENCH_ALLOCATOR_LINEAR)
+    {
+        linear_allocator_create(allocator->backing, &allocator->linear, linear_capacity);
+    }
+    else if (kind == BENCH_ALLOCATOR_DALLOCATE)
+    {
+        memory_system_enable_slab(allocator->backing);
+    }
+}
+
+static void bench_allocator_destroy(bench_allocator *allocator)
+{
+    if (allocator->kind == BENCH_ALLOCATOR_LINEAR)
+    {
+        linear_allocator_destroy(&allocator->linear);
+    }
+    arena_free_arena(allocator->backing);
+}
+
+static inline void *bench_allocator_allocate(bench_allocator *allocator, u64 size)
+{
+    switch (allocator->kind)
+    {
+    case BENCH_ALLOCATOR_ARENA:
+        return arena_allocate_block(allocator->backing, size);
+    case BENCH_ALLOCATOR_LINEAR:
+        return linear_allocator_allocate(&allocator->linear, size);
+    case BENCH_ALLOCATOR_DALLOCATE:
+        return dallocate(allocator->backing, size, allocator->tag);
+    case BENCH_ALLOCATOR_MALLOC:
+        return malloc(size);
+    default:
+        return nullptr;
+    }
+}
+
+static inline void bench_allocator_free(bench_allocator *allocator, void *block, u64 size)
+{
+    switch (allocator->kind)
+    {
+    case BENCH_ALLOCATOR_DALLOCATE:
+        dfree(block, size, allocator->tag);
+        break;
+    case BENCH_ALLOCATOR_MALLOC:
+        free(block);
+        break;
+    default:
+        break;
+    }
+}
+
+// end of a frame/round, everything handed out since the last call is dead.
+static inline void bench_allocator_free_all(bench_allocator *allocator)
+{
+    switch (allocator->kind)
+    {
+    case BENCH_ALLOCATOR_ARENA:
+        arena_reset_arena(allocator->backing, false);
+        break;
+    case BENCH_ALLOCATOR_LINEAR:
+        linear_allocator_free_all(&allocator->linear);
+        break;
+    default:
+        break;
+    }
+}
+
+static void bench_allocators_report(const char *group, bench_allocator_kind kind, u64 operations, u64 bytes,
+                                    f64 elapsed, u64 rss_before)
+{
+    bench_report(group, bench_allocator_names[kind], operations, elapsed);
+    u64 peak_rss = bench_get_peak_rss_bytes();
+    u64 peak     = peak_rss > rss_before ? peak_rss - rss_before : 0;
+    printf("# %s,%s: %.1f MiB/s requested, peak rss +%.1f MiB\n", group, bench_allocator_names[kind],
+           (static_cast<f64>(bytes) / MB(1)) / elapsed, static_cast<f64>(peak) / MB(1));
+}
+
+// the containers: 256 darrays start at 10 u64's and double 8 times (up to 20 KiB), copying over and freeing the old
+// block on every growth. Repeated for a number of rounds, everything is freed at the end of a round.
+#define BENCH_ALLOCATORS_CONTAINERS 256
+#define BENCH_ALLOCATORS_GROWTH_ROUNDS 32
+
+static void bench_allocators_darray_growth(bench_allocator_kind kind)
+{
+    // one round allocates a bit under 2x the final sizes, the linear allocator cant reuse anything inside a round.
+    u64             linear_capacity = BENCH_ALLOCATORS_CONTAINERS * 10 * sizeof(u64) * 512;
+    bench_allocator allocator;
+    bench_allocator_create(&allocator, kind, MEM_TAG_DARRAY, linear_capacity);
+
+    void *blocks[BENCH_ALLOCATORS_CONTAINERS];
+    u64   sizes[BENCH_ALLOCATORS_CONTAINERS];
+    u64   operations = 0;
+    u64   bytes      = 0;
+
+    bench_reset_peak_rss();
+    u64 rss_before = bench_get_rss_bytes();
+    f64 start      = platform_get_absolute_time();
+    for (u32 round = 0; round < BENCH_ALLOCATORS_GROWTH_ROUNDS; round++)
+    {
+        for (u32 i = 0; i < BENCH_ALLOCATORS_CONTAINERS; i++)
+        {
+            sizes[i]   = 10 * sizeof(u64);
+            blocks[i]  = bench_allocator_allocate(&allocator, sizes[i]);
+            bytes     += sizes[i];
+            operations++;
+        }
+        for (u32 growth = 0; growth < 8; growth++)
+        {
+            for (u32 i = 0; i < BENCH_ALLOCATORS_CONTAINERS; i++)
+            {
+                void *grown = bench_allocator_allocate(&allocator, sizes[i] * 2);
+                dcopy_memory(grown, blocks[i], sizes[i]);
+                bench_allocator_free(&allocator, blocks[i], sizes[i]);
+                blocks[i]   = grown;
+                bytes      += sizes[i] * 2;
+                sizes[i]   *= 2;
+                operations += 2;
+            }
+        }
+        for (u32 i = 0; i < BENCH_ALLOCATORS_CONTAINERS; i++)
+        {
+            bench_allocator_free(&allocator, blocks[i], sizes[i]);
+            operations++;
+        }
+        bench_allocator_free_all(&allocator);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_allocators_report("alloc_darray_growth", kind, operations, bytes, elapsed, rss_before);
+    bench_allocator_destroy(&allocator);
+}
+
+// mesh loading: vertex/index buffers between 256 KiB and 8 MiB, filled completely, freed at the end of a round (one
+// round ~ one model).
+#define BENCH_ALLOCATORS_MESH_BUFFERS 48
+#define BENCH_ALLOCATORS_MESH_ROUNDS 8
+
+static void bench_allocators_mesh_buffers(bench_allocator_kind kind)
+{
+    u64 mesh_sizes[BENCH_ALLOCATORS_MESH_BUFFERS];
+    u64 round_size = 0;
+    // the same sizes for every allocator.
+    bench_random_seed(1234);
+    for (u32 i = 0; i < BENCH_ALLOCATORS_MESH_BUFFERS; i++)
+    {
+        mesh_sizes[i]  = KI(256) + (bench_random_u64() % (MB(8) - KI(256)));
+        mesh_sizes[i] &= ~static_cast<u64>(15);
+        round_size    += mesh_sizes[i];
+    }
+
+    bench_allocator allocator;
+    bench_allocator_create(&allocator, kind, MEM_TAG_GEOMETRY, round_size);
+
+    void *blocks[BENCH_ALLOCATORS_MESH_BUFFERS];
+    u64   operations = 0;
+    u64   bytes      = 0;
+
+    bench_reset_peak_rss();
+    u64 rss_before = bench_get_rss_bytes();
+    f64 start      = platform_get_absolute_time();
+    for (u32 round = 0; round < BENCH_ALLOCATORS_MESH_ROUNDS; round++)
+    {
+        for (u32 i = 0; i < BENCH_ALLOCATORS_MESH_BUFFERS; i++)
+        {
+            blocks[i] = bench_allocator_allocate(&allocator, mesh_sizes[i]);
+            dset_memory_value(blocks[i], round, mesh_sizes[i]);
+            bytes += mesh_sizes[i];
+            operations++;
+        }
+        for (u32 i = 0; i < BENCH_ALLOCATORS_MESH_BUFFERS; i++)
+        {
+            bench_allocator_free(&allocator, blocks[i], mesh_sizes[i]);
+            operations++;
+        }
+        bench_allocator_free_all(&allocator);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_allocators_report("alloc_mesh_buffers", kind, operations, bytes, elapsed, rss_before);
+    bench_allocator_destroy(&allocator);
+}
+
+// per frame churn: a couple thousand short lived 16 B - 4 KiB blocks (text quads, command lists, temp strings), the
+// first bytes get written, all of them die at the end of the frame.
+#define BENCH_ALLOCATORS_FRAME_ALLOCATIONS 2048
+#define BENCH_ALLOCATORS_FRAMES 512
+
+static void bench_allocators_frame_churn(bench_allocator_kind kind)
+{
+    u64 sizes[BENCH_ALLOCATORS_FRAME_ALLOCATIONS];
+    u64 frame_size = 0;
+    bench_random_seed(42);
+    for (u32 i = 0; i < BENCH_ALLOCATORS_FRAME_ALLOCATIONS; i++)
+    {
+        sizes[i]    = (16 + (bench_random_u64() % 4080)) & ~static_cast<u64>(7);
+        frame_size += sizes[i];
+    }
+
+    bench_allocator allocator;
+    bench_allocator_create(&allocator, kind, MEM_TAG_RENDERER, frame_size);
+
+    void *blocks[BENCH_ALLOCATORS_FRAME_ALLOCATIONS];
+    u64   operations = 0;
+    u64   bytes      = 0;
+
+    bench_reset_peak_rss();
+    u64 rss_before = bench_get_rss_bytes();
+    f64 start      = platform_get_absolute_time();
+    for (u32 frame = 0; frame < BENCH_ALLOCATORS_FRAMES; frame++)
+    {
+        for (u32 i = 0; i < BENCH_ALLOCATORS_FRAME_ALLOCATIONS; i++)
+        {
+            blocks[i]                       = bench_allocator_allocate(&allocator, sizes[i]);
+            static_cast<u64 *>(blocks[i])[0] = frame;
+            bytes                          += sizes[i];
+            operations++;
+        }
+        for (u32 i = 0; i < BENCH_ALLOCATORS_FRAME_ALLOCATIONS; i++)
+        {
+            bench_allocator_free(&allocator, blocks[i], sizes[i]);
+            operations++;
+        }
+        bench_allocator_free_all(&allocator);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_allocators_report("alloc_frame_churn", kind, operations, bytes, elapsed, rss_before);
+    bench_allocator_destroy(&allocator);
+}
+
+void bench_allocators_run()
+{
+    for (u32 kind = 0; kind < BENCH_ALLOCATOR_COUNT; kind++)
+    {
+        bench_allocators_darray_growth(static_cast<bench_allocator_kind>(kind));
+    }
+    for (u32 kind = 0; kind < BENCH_ALLOCATOR_COUNT; kind++)
+    {
+        bench_allocators_mesh_buffers(static_cast<bench_allocator_kind>(kind));
+    }
+    for (u32 kind = 0; kind < BENCH_ALLOCATOR_COUNT; kind++)
+    {
+        bench_allocators_frame_churn(static_cast<bench_allocator_kind>(kind));
+    }
+}
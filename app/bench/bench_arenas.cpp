@@ -0,0 +1,244 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "memory/arenas.hpp"
+#include "memory/frame_arena.hpp"
+#include "platform/platform.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#define BENCH_ARENA_ITERATIONS_PER_THREAD 2000
+
+// N threads hammering the pool's free list: acquire an arena, touch one page, give it back.
+static void bench_arena_acquire_release(u32 thread_count)
+{
+    std::atomic<u32> ready{0};
+    std::atomic<bool> go{false};
+
+    auto worker = [&]() {
+        ready.fetch_add(1);
+        while (!go.load())
+        {
+        }
+        for (u32 i = 0; i < BENCH_ARENA_ITERATIONS_PER_THREAD; i++)
+        {
+            arena *a     = arena_get_arena(ARENA_SIZE_SMALL);
+            u64   *block = static_cast<u64 *>(arena_allocate_block(a, sizeof(u64)));
+            *block       = i;
+            bench_do_not_optimize(*block);
+            arena_free_arena(a);
+        }
+    };
+
+    std::thread threads[64];
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i] = std::thread(worker);
+    }
+    while (ready.load() != thread_count)
+    {
+    }
+
+    f64 start = platform_get_absolute_time();
+    go.store(true);
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i].join();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    char name[64];
+    snprintf(name, sizeof(name), "acquire_release_%u_threads", thread_count);
+    bench_report("arena_pool", name, static_cast<u64>(thread_count) * BENCH_ARENA_ITERATIONS_PER_THREAD, elapsed);
+}
+
+// every thread grabs its own arena once through the thread-local api and only bump allocates afterwards.
+static void bench_arena_thread_local_alloc(u32 thread_count)
+{
+    const u64 allocations_per_thread = 1000000;
+
+    auto worker = [&]() {
+        arena_thread_acquire_arena();
+        for (u64 i = 0; i < allocations_per_thread; i++)
+        {
+            void *block = arena_allocate_block(arena_get_thread_arena(), 32);
+            bench_do_not_optimize(block);
+        }
+        arena_thread_release_arena();
+    };
+
+    std::thread threads[64];
+    f64         start = platform_get_absolute_time();
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i] = std::thread(worker);
+    }
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i].join();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    char name[64];
+    snprintf(name, sizeof(name), "thread_local_alloc_32b_%u_threads", thread_count);
+    bench_report("arena_pool", name, thread_count * allocations_per_thread, elapsed);
+}
+
+// grow an arena to 256 MiB in 64 KiB blocks and reset it. Measures the commit-on-demand path and the page discard on
+// reset, reports the resident size at the peak and after the reset.
+static void bench_arena_grow_reset()
+{
+    const u64 block_size = 64 * 1024;
+    const u64 grow_size  = MB(256);
+    const u32 rounds     = 8;
+
+    arena *a     = arena_get_arena();
+    f64    start = platform_get_absolute_time();
+    u64    peak_committed = 0;
+    u64    peak_rss       = 0;
+    for (u32 r = 0; r < rounds; r++)
+    {
+        for (u64 i = 0; i < grow_size / block_size; i++)
+        {
+            u8 *block = static_cast<u8 *>(arena_allocate_block(a, block_size));
+            // touch every page so the commit actually costs something
+            for (u64 j = 0; j < block_size; j += 4096)
+            {
+                block[j] = 1;
+            }
+        }
+        peak_committed = a->committed;
+        peak_rss       = bench_get_rss_bytes();
+        arena_reset_arena(a);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_report("arena_pool", "grow_256mib_and_reset", rounds, elapsed);
+    printf("# arena reserved %llu MiB, committed %llu MiB, rss at peak %llu MiB, rss after reset %llu MiB\n",
+           static_cast<unsigned long long>(a->total_size / MB(1)),
+           static_cast<unsigned long long>(peak_committed / MB(1)),
+           static_cast<unsigned long long>(peak_rss / MB(1)),
+           static_cast<unsigned long long>(bench_get_rss_bytes() / MB(1)));
+    arena_free_arena(a);
+}
+
+// many short lived scratch arenas at the same time, more than the small class has, so the last ones spill over into
+// the medium class.
+static void bench_arena_size_classes()
+{
+    const u32 held_count = 96;
+    arena    *held[held_count];
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < held_count; i++)
+    {
+        held[i] = arena_get_arena(ARENA_SIZE_SMALL);
+        bench_do_not_optimize(arena_allocate_block(held[i], 64));
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    u32 per_class[ARENA_SIZE_CLASS_COUNT] = {0};
+    for (u32 i = 0; i < held_count; i++)
+    {
+        per_class[held[i]->size_class]++;
+        arena_free_arena(held[i]);
+    }
+    bench_report("arena_pool", "hold_96_small_arenas", held_count, elapsed);
+    printf("# held %u small arena requests: %u small, %u medium, %u large\n", held_count, per_class[ARENA_SIZE_SMALL],
+           per_class[ARENA_SIZE_MEDIUM], per_class[ARENA_SIZE_LARGE]);
+}
+
+// temp allocations the way the import paths used to do them (grab a whole arena, free it) vs a scoped scratch marker.
+static void bench_arena_scratch_scope()
+{
+    const u32 iterations = 20000;
+    const u64 temp_size  = 16 * 1024;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        arena *temp  = arena_get_arena();
+        u8    *block = static_cast<u8 *>(arena_allocate_block(temp, temp_size));
+        block[0]     = 1;
+        bench_do_not_optimize(block);
+        arena_free_arena(temp);
+    }
+    bench_report("arena_pool", "temp_16kib_get_free_arena", iterations, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        arena_scope scratch(scratch_arena_get());
+        u8         *block = static_cast<u8 *>(arena_allocate_block(scratch.owner, temp_size));
+        block[0]          = 1;
+        bench_do_not_optimize(block);
+    }
+    bench_report("arena_pool", "temp_16kib_scratch_scope", iterations, platform_get_absolute_time() - start);
+    scratch_arena_release();
+}
+
+// reset cost of an arena that only used 1 MiB. legacy is what reset used to do: zero the whole arena (128 MiB back
+// then), used_prefix is the current reset and no_clear skips the zeroing like the frame arenas do.
+static void bench_arena_reset_cost()
+{
+    const u64 used_size   = MB(1);
+    const u64 legacy_size = MB(128);
+
+    arena *a = arena_get_arena();
+    // commit the legacy range once so that the legacy reset doesnt pay for page faults.
+    arena_allocate_block(a, legacy_size);
+    dzero_memory(a->start_ptr, legacy_size);
+    a->free_ptr  = a->start_ptr;
+    a->allocated = 0;
+
+    const u32 legacy_iterations = 20;
+    f64       start             = platform_get_absolute_time();
+    for (u32 i = 0; i < legacy_iterations; i++)
+    {
+        bench_do_not_optimize(arena_allocate_block(a, used_size));
+        a->free_ptr  = a->start_ptr;
+        a->allocated = 0;
+        dzero_memory(a->start_ptr, legacy_size);
+    }
+    bench_report("arena_reset", "legacy_zero_128mib_used_1mib", legacy_iterations,
+                 platform_get_absolute_time() - start);
+
+    const u32 iterations = 2000;
+    start                = platform_get_absolute_time();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        bench_do_not_optimize(arena_allocate_block(a, used_size));
+        arena_reset_arena(a);
+    }
+    bench_report("arena_reset", "used_prefix_used_1mib", iterations, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        bench_do_not_optimize(arena_allocate_block(a, used_size));
+        arena_reset_arena(a, false);
+    }
+    bench_report("arena_reset", "no_clear_used_1mib", iterations, platform_get_absolute_time() - start);
+
+    arena_free_arena(a);
+}
+
+void bench_arenas_run()
+{
+    // acquire/release uses small arenas, thread local alloc the medium per thread arenas. Both have more than 16.
+    u32 thread_counts[] = {1, 2, 4, 8, 16};
+    for (u32 count : thread_counts)
+    {
+        bench_arena_acquire_release(count);
+    }
+    for (u32 count : thread_counts)
+    {
+        bench_arena_thread_local_alloc(count);
+    }
+    bench_arena_grow_reset();
+    bench_arena_reset_cost();
+    bench_arena_scratch_scope();
+    bench_arena_size_classes();
+}
@@ -0,0 +1,406 @@
+#include "bench.hpp"
+
+#include "core/dfile_system.hpp"
+#include "core/dmemory.hpp"
+#include "math/dbvh.hpp"
+#include "math/dfrustum.hpp"
+#include "math/dmath.hpp"
+#include "math/dvertex_batch.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+#include "resources/obj_parser.hpp"
+
+#include <cstdio>
+
+// INFO: the scene bvh on the sponza objects: build, refit, frustum queries against the flat frustum_cull pass, and
+// ray casts and nearest object queries against a loop over every box. The brute force answers are checked before
+// anything is timed. Sponza is read from assets/meshes/sponza.obj (run from bin/) with the engine's obj parser, one box
+// per object it splits the file into. Without the file a generated scene of the same size stands in for it. A big
+// generated scene shows how it scales.
+#define BENCH_BVH_SPONZA_OBJECTS 393
+#define BENCH_BVH_LARGE_OBJECTS  65533
+#define BENCH_BVH_QUERIES        4096
+#define BENCH_BVH_CAMERAS        64
+#define BENCH_BVH_WORK           (1 << 22)
+
+struct bench_bvh_scene
+{
+    bounds_3D *boxes;
+    u32        count;
+    vec3       min;
+    vec3       max;
+};
+
+static vec3 bench_bvh_random_point(const bench_bvh_scene *scene)
+{
+    return vec3(bench_random_f32(scene->min.x, scene->max.x), bench_random_f32(scene->min.y, scene->max.y),
+                bench_random_f32(scene->min.z, scene->max.z));
+}
+
+static void bench_bvh_finish_scene(bench_bvh_scene *scene)
+{
+    scene->min = vec3(D_INFINITY, D_INFINITY, D_INFINITY);
+    scene->max = vec3(-D_INFINITY, -D_INFINITY, -D_INFINITY);
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        bounds_3D *b = scene->boxes + i;
+        b->center    = (vec3(b->min) + b->max) * 0.5f;
+        b->radius    = (vec3(b->max) - b->min).magnitude() * 0.5f;
+        for (u32 j = 0; j < 3; j++)
+        {
+            scene->min.elements[j] = fminf(scene->min.elements[j], b->min.elements[j]);
+            scene->max.elements[j] = fmaxf(scene->max.elements[j], b->max.elements[j]);
+        }
+    }
+}
+
+// the boxes of every object the engine's obj parser splits the file into, false if the file isnt there.
+static bool bench_bvh_load_obj(arena *a, const char *path, bench_bvh_scene *scene)
+{
+    u64 size = 0;
+    if (!file_get_size(path, &size))
+    {
+        return false;
+    }
+    u32              count   = 0;
+    geometry_config *configs = nullptr;
+    obj_parse_file(a, path, nullptr, &count, &configs);
+    if (count == 0)
+    {
+        return false;
+    }
+
+    scene->boxes = static_cast<bounds_3D *>(arena_allocate_block(a, sizeof(bounds_3D) * count));
+    scene->count = count;
+    for (u32 i = 0; i < count; i++)
+    {
+        const vertex_3D *vertices = static_cast<const vertex_3D *>(configs[i].vertices);
+        scene->boxes[i]           = vertex_batch_bounds_3D(vertices, configs[i].vertex_count);
+    }
+    bench_bvh_finish_scene(scene);
+    return true;
+}
+
+// an atrium the size of sponza: floor and walls, two storeys of columns around the court, and props and drapes
+// scattered in between.
+static void bench_bvh_generate_scene(arena *a, u32 count, bench_bvh_scene *scene)
+{
+    scene->boxes = static_cast<bounds_3D *>(arena_allocate_block(a, sizeof(bounds_3D) * count));
+    scene->count = count;
+
+    f32 extent_x = count > BENCH_BVH_SPONZA_OBJECTS ? 400.0f : 19.0f;
+    f32 extent_z = count > BENCH_BVH_SPONZA_OBJECTS ? 400.0f : 11.0f;
+    u32 i        = 0;
+    auto add     = [&](vec3 min, vec3 max) {
+        if (i < count)
+        {
+            scene->boxes[i].min   = min;
+            scene->boxes[i++].max = max;
+        }
+    };
+    add(vec3(-extent_x, -0.2f, -extent_z), vec3(extent_x, 0, extent_z));
+    add(vec3(-extent_x, 0, -extent_z), vec3(extent_x, 15, -extent_z + 0.5f));
+    add(vec3(-extent_x, 0, extent_z - 0.5f), vec3(extent_x, 15, extent_z));
+    add(vec3(-extent_x, 0, -extent_z), vec3(-extent_x + 0.5f, 15, extent_z));
+    add(vec3(extent_x - 0.5f, 0, -extent_z), vec3(extent_x, 15, extent_z));
+    for (f32 x = -extent_x + 2; x < extent_x - 2 && i < count / 3; x += 2.5f)
+    {
+        for (f32 storey = 0; storey < 2; storey++)
+        {
+            for (f32 side = -1; side <= 1; side += 2)
+            {
+                vec3 base(x, storey * 6, side * (extent_z - 4));
+                add(base - vec3(0.4f, 0, 0.4f), base + vec3(0.4f, 5.5f, 0.4f));
+            }
+        }
+    }
+    while (i < count)
+    {
+        vec3 center(bench_random_f32(-extent_x, extent_x), bench_random_f32(0, 14),
+                    bench_random_f32(-extent_z, extent_z));
+        vec3 half(bench_random_f32(0.05f, 1.5f), bench_random_f32(0.05f, 2.0f), bench_random_f32(0.05f, 1.5f));
+        add(center - half, center + half);
+    }
+    bench_bvh_finish_scene(scene);
+}
+
+static frustum bench_bvh_camera(const bench_bvh_scene *scene, u32 index)
+{
+    vec3 size      = vec3(scene->max) - scene->min;
+    f32  angle     = 6.2831853f * index / BENCH_BVH_CAMERAS;
+    vec3 position  = (vec3(scene->min) + scene->max) * 0.5f + vec3(size.x * 0.3f * cosf(angle), 0, 0);
+    position.y     = scene->min.y + size.y * 0.2f;
+    mat4 camera    = mat4_mul(mat4_euler_xyz(-0.1f, angle, 0), mat4_translation(position));
+    mat4 projection = mat4_perspective(45 * D_DEG2RAD_MULTIPLIER, 16.0f / 9.0f, 0.01f, 1000.0f);
+    return frustum_from_matrix(mat4_mul(mat4_inverse(camera), projection));
+}
+
+static bool bench_bvh_brute_raycast(const bench_bvh_scene *scene, vec3 origin, vec3 direction, bvh_hit *out_hit)
+{
+    *out_hit = bvh_hit{};
+    f32 best = D_INFINITY;
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        const bounds_3D *b     = scene->boxes + i;
+        f32              enter = -D_INFINITY;
+        f32              exit  = D_INFINITY;
+        for (u32 j = 0; j < 3; j++)
+        {
+            f32 inverse = 1.0f / direction.elements[j];
+            f32 t0      = (b->min.elements[j] - origin.elements[j]) * inverse;
+            f32 t1      = (b->max.elements[j] - origin.elements[j]) * inverse;
+            enter       = fmaxf(enter, fminf(t0, t1));
+            exit        = fminf(exit, fmaxf(t0, t1));
+        }
+        if (exit >= enter && exit >= 0 && enter > 0 && enter < best)
+        {
+            best          = enter;
+            out_hit->item = i;
+        }
+    }
+    out_hit->distance = best;
+    return out_hit->item != INVALID_ID;
+}
+
+static bool bench_bvh_brute_nearest(const bench_bvh_scene *scene, vec3 point, bvh_hit *out_hit)
+{
+    *out_hit = bvh_hit{};
+    f32 best = D_INFINITY;
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        const bounds_3D *b = scene->boxes + i;
+        f32              d = 0;
+        for (u32 j = 0; j < 3; j++)
+        {
+            f32 below   = b->min.elements[j] - point.elements[j];
+            f32 outside = fmaxf(fmaxf(below, 0), point.elements[j] - b->max.elements[j]);
+            d          += outside * outside;
+        }
+        if (d < best)
+        {
+            best          = d;
+            out_hit->item = i;
+        }
+    }
+    out_hit->distance = sqrtf(best);
+    return out_hit->item != INVALID_ID;
+}
+
+// the tree and the loops do the same float math, but the compiler is free to fuse it differently.
+static bool bench_bvh_same(f32 a, f32 b)
+{
+    return fabsf(a - b) <= 1e-5f * fmaxf(1.0f, fabsf(b));
+}
+
+struct bench_bvh_queries
+{
+    vec3 *origins;
+    vec3 *directions;
+};
+
+static void bench_bvh_check(arena *a, bvh *tree, const bench_bvh_scene *scene, const bench_bvh_queries *queries,
+                            const char *when)
+{
+    u32 *bvh_items  = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * scene->count));
+    u32 *flat_items = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * scene->count));
+    u8  *seen       = static_cast<u8 *>(arena_allocate_block(a, scene->count));
+
+    frustum_cull_list list;
+    frustum_cull_list_create(a, scene->count, &list);
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        frustum_cull_list_push_world(&list, scene->boxes + i);
+    }
+
+    u32 frustum_mismatches = 0;
+    u32 visible            = 0;
+    for (u32 c = 0; c < BENCH_BVH_CAMERAS; c++)
+    {
+        frustum f          = bench_bvh_camera(scene, c);
+        u32     bvh_count  = bvh_query_frustum(tree, &f, bvh_items);
+        u32     flat_count = frustum_cull(&f, &list, flat_items);
+        dzero_memory(seen, scene->count);
+        for (u32 i = 0; i < bvh_count; i++)
+        {
+            seen[bvh_items[i]] = 1;
+        }
+        u32 found = 0;
+        for (u32 i = 0; i < flat_count; i++)
+        {
+            found += seen[flat_items[i]];
+        }
+        frustum_mismatches += (bvh_count - found) + (flat_count - found);
+        visible            += bvh_count;
+    }
+
+    u32 ray_mismatches     = 0;
+    u32 nearest_mismatches = 0;
+    u32 ray_hits           = 0;
+    for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+    {
+        bvh_hit expected, hit;
+        bool    expected_hit = bench_bvh_brute_raycast(scene, queries->origins[q], queries->directions[q], &expected);
+        bool    got_hit = bvh_raycast(tree, queries->origins[q], queries->directions[q], D_INFINITY, &hit);
+        // the same distance is enough, two boxes can start at the exact same spot.
+        ray_mismatches += expected_hit != got_hit || (got_hit && !bench_bvh_same(hit.distance, expected.distance));
+        ray_hits       += got_hit;
+
+        bench_bvh_brute_nearest(scene, queries->origins[q], &expected);
+        bvh_nearest(tree, queries->origins[q], &hit);
+        nearest_mismatches += !bench_bvh_same(hit.distance, expected.distance);
+    }
+    printf("# bvh check %s: %u nodes, frustum %u visible over %u cameras %u mismatches, rays %u/%u hit %u "
+           "mismatches, nearest %u mismatches\n",
+           when, tree->node_count, visible, BENCH_BVH_CAMERAS, frustum_mismatches, ray_hits, BENCH_BVH_QUERIES,
+           ray_mismatches, nearest_mismatches);
+}
+
+template <typename F> static f64 bench_bvh_time(const char *name, u64 ops_per_pass, u32 passes, F op)
+{
+    f64 start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < passes; pass++)
+    {
+        op(pass);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_report("bvh", name, ops_per_pass * passes, elapsed);
+    return elapsed;
+}
+
+static void bench_bvh_run_scene(arena *a, bench_bvh_scene *scene, const char *suffix)
+{
+    bench_bvh_queries queries;
+    queries.origins    = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * BENCH_BVH_QUERIES));
+    queries.directions = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * BENCH_BVH_QUERIES));
+    for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+    {
+        queries.origins[q] = bench_bvh_random_point(scene);
+        queries.directions[q] =
+            vec3_normalized(vec3(bench_random_f32(-1, 1), bench_random_f32(-0.5f, 0.5f), bench_random_f32(-1, 1)));
+    }
+
+    arena *tree_arena = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bvh    tree;
+    bvh_build(tree_arena, scene->boxes, scene->count, &tree);
+    bench_bvh_check(a, &tree, scene, &queries, suffix);
+
+    char name[64];
+    u32  builds = BENCH_BVH_WORK / scene->count / 8 + 1;
+    snprintf(name, sizeof(name), "build_%s", suffix);
+    f64 build = bench_bvh_time(name, scene->count, builds, [&](u32) {
+        arena_reset_arena(tree_arena, false);
+        bvh_build(tree_arena, scene->boxes, scene->count, &tree);
+        bench_do_not_optimize(tree.nodes);
+    });
+
+    snprintf(name, sizeof(name), "refit_%s", suffix);
+    u32 refits = BENCH_BVH_WORK / scene->count + 1;
+    bench_bvh_time(name, scene->count, refits, [&](u32) {
+        bvh_refit(&tree, scene->boxes);
+        bench_do_not_optimize(tree.nodes);
+    });
+
+    // everything moves a bit, the refit tree has to give the same answers.
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        vec3 offset(bench_random_f32(-0.5f, 0.5f), bench_random_f32(-0.5f, 0.5f), bench_random_f32(-0.5f, 0.5f));
+        scene->boxes[i].min    += offset;
+        scene->boxes[i].max    += offset;
+        scene->boxes[i].center += offset;
+    }
+    bvh_refit(&tree, scene->boxes);
+    char when[64];
+    snprintf(when, sizeof(when), "%s after refit", suffix);
+    bench_bvh_check(a, &tree, scene, &queries, when);
+
+    u32              *items = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * scene->count));
+    frustum_cull_list list;
+    frustum_cull_list_create(a, scene->count, &list);
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        frustum_cull_list_push_world(&list, scene->boxes + i);
+    }
+    frustum cameras[BENCH_BVH_CAMERAS];
+    for (u32 c = 0; c < BENCH_BVH_CAMERAS; c++)
+    {
+        cameras[c] = bench_bvh_camera(scene, c);
+    }
+    u32 frames = BENCH_BVH_WORK / scene->count + BENCH_BVH_CAMERAS;
+    snprintf(name, sizeof(name), "frustum_flat_%s", suffix);
+    f64 flat = bench_bvh_time(name, 1, frames, [&](u32 pass) {
+        bench_do_not_optimize(frustum_cull(&cameras[pass % BENCH_BVH_CAMERAS], &list, items));
+    });
+    snprintf(name, sizeof(name), "frustum_%s", suffix);
+    f64 query = bench_bvh_time(name, 1, frames, [&](u32 pass) {
+        bench_do_not_optimize(bvh_query_frustum(&tree, &cameras[pass % BENCH_BVH_CAMERAS], items));
+    });
+
+    u32 passes = BENCH_BVH_WORK / (scene->count * 16) + 1;
+    snprintf(name, sizeof(name), "raycast_brute_%s", suffix);
+    f64 brute_rays = bench_bvh_time(name, BENCH_BVH_QUERIES, passes, [&](u32) {
+        for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+        {
+            bvh_hit hit;
+            bench_bvh_brute_raycast(scene, queries.origins[q], queries.directions[q], &hit);
+            bench_do_not_optimize(hit);
+        }
+    });
+    snprintf(name, sizeof(name), "raycast_%s", suffix);
+    f64 rays = bench_bvh_time(name, BENCH_BVH_QUERIES, passes, [&](u32) {
+        for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+        {
+            bvh_hit hit;
+            bvh_raycast(&tree, queries.origins[q], queries.directions[q], D_INFINITY, &hit);
+            bench_do_not_optimize(hit);
+        }
+    });
+    snprintf(name, sizeof(name), "nearest_brute_%s", suffix);
+    f64 brute_nearest = bench_bvh_time(name, BENCH_BVH_QUERIES, passes, [&](u32) {
+        for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+        {
+            bvh_hit hit;
+            bench_bvh_brute_nearest(scene, queries.origins[q], &hit);
+            bench_do_not_optimize(hit);
+        }
+    });
+    snprintf(name, sizeof(name), "nearest_%s", suffix);
+    f64 nearest = bench_bvh_time(name, BENCH_BVH_QUERIES, passes, [&](u32) {
+        for (u32 q = 0; q < BENCH_BVH_QUERIES; q++)
+        {
+            bvh_hit hit;
+            bvh_nearest(&tree, queries.origins[q], &hit);
+            bench_do_not_optimize(hit);
+        }
+    });
+
+    f64 queries_run = static_cast<f64>(BENCH_BVH_QUERIES) * passes;
+    printf("# bvh %s: %u objects, build %.1f us, frustum %.2f us (flat %.2f us), %.2f M rays/s (%.1fx brute force), "
+           "%.2f M nearest/s (%.1fx brute force)\n",
+           suffix, scene->count, build / builds * 1000000.0, query / frames * 1000000.0, flat / frames * 1000000.0,
+           queries_run / rays / 1000000.0, brute_rays / rays, queries_run / nearest / 1000000.0,
+           brute_nearest / nearest);
+
+    arena_free_arena(tree_arena);
+}
+
+void bench_bvh_run()
+{
+    bench_random_seed(0x9e3779b97f4a7c15ull);
+    arena          *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_bvh_scene scene;
+    if (bench_bvh_load_obj(a, "../assets/meshes/sponza.obj", &scene))
+    {
+        printf("# bvh: sponza.obj, %u objects\n", scene.count);
+    }
+    else
+    {
+        printf("# bvh: no assets/meshes/sponza.obj, using a generated scene of %u objects\n",
+               BENCH_BVH_SPONZA_OBJECTS);
+        bench_bvh_generate_scene(a, BENCH_BVH_SPONZA_OBJECTS, &scene);
+    }
+    bench_bvh_run_scene(a, &scene, "sponza");
+
+    bench_bvh_generate_scene(a, BENCH_BVH_LARGE_OBJECTS, &scene);
+    bench_bvh_run_scene(a, &scene, "large");
+    arena_free_arena(a);
+}
@@ -0,0 +1,356 @@
+#include "bench.hpp"
+
+#include "containers/dconcurrent_hashtable.hpp"
+#include "containers/dhashtable.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// INFO: two parts. The stress run has loader style writers inserting/updating/erasing while readers look things up
+// non stop, and every value carries a checksum of its key + version so a reader that sees a half written or reused
+// entry notices. The throughput part measures lookups with and without a writer running, against a dhashtable behind a
+// mutex, which is what the resource systems would need without the concurrent table.
+#define BENCH_CHT_WRITERS 2
+#define BENCH_CHT_READERS 3
+#define BENCH_CHT_KEYS_PER_WRITER 4096
+// the first keys of every writer range are inserted up front and only ever updated, a reader must always find them.
+#define BENCH_CHT_PINNED_KEYS 256
+#define BENCH_CHT_STRESS_SECONDS 0.5
+#define BENCH_CHT_LOOKUPS 2000000
+#define BENCH_CHT_READ_BATCH 64
+
+struct bench_cht_value
+{
+    u64 key;
+    u64 version;
+    u64 check;
+    u64 pad;
+};
+
+static inline u64 bench_cht_check(u64 key, u64 version)
+{
+    u64 x = (key ^ (version * 0x9e3779b97f4a7c15)) * 0xbf58476d1ce4e5b9;
+    return x ^ (x >> 31);
+}
+
+static inline bench_cht_value bench_cht_make_value(u64 key, u64 version)
+{
+    return {key, version, bench_cht_check(key, version), 0};
+}
+
+// keys never start at 0 so a zeroed entry cant pass the check.
+static inline u64 bench_cht_key(u32 writer, u64 index)
+{
+    return (static_cast<u64>(writer + 1) << 32) | index;
+}
+
+struct bench_cht_writer_model
+{
+    bool present[BENCH_CHT_KEYS_PER_WRITER];
+    u64  version[BENCH_CHT_KEYS_PER_WRITER];
+};
+
+static void bench_cht_stress_writer(dconcurrent_hashtable<bench_cht_value> *table, u32 writer,
+                                    bench_cht_writer_model *model, std::atomic<bool> *stop, u64 *out_ops)
+{
+    bench_random_seed(0x1234567ull * (writer + 1));
+    u64 ops = 0;
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        u64 index = bench_random_u64() % BENCH_CHT_KEYS_PER_WRITER;
+        u64 key   = bench_cht_key(writer, index);
+        u32 op    = static_cast<u32>(bench_random_u64() % 4);
+        if (index < BENCH_CHT_PINNED_KEYS || op < 2)
+        {
+            model->version[index]++;
+            table->insert(key, bench_cht_make_value(key, model->version[index]));
+            model->present[index] = true;
+        }
+        else if (op == 2 && model->present[index])
+        {
+            model->version[index]++;
+            table->update(key, bench_cht_make_value(key, model->version[index]));
+        }
+        else
+        {
+            bool erased = table->erase(key);
+            if (erased != model->present[index])
+            {
+                printf("# concurrent_hashtable stress: erase of %llx returned %d, expected %d\n",
+                       static_cast<unsigned long long>(key), erased, model->present[index]);
+            }
+            model->present[index] = false;
+        }
+        ops++;
+    }
+    *out_ops = ops;
+}
+
+static void bench_cht_stress_reader(dconcurrent_hashtable<bench_cht_value> *table, u32 seed, std::atomic<bool> *stop,
+                                    u64 *out_lookups, u64 *out_failures)
+{
+    bench_random_seed(0x9876543ull * (seed + 1));
+    u32 reader   = table->register_reader();
+    u64 lookups  = 0;
+    u64 failures = 0;
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        table->read_begin(reader);
+        for (u32 i = 0; i < BENCH_CHT_READ_BATCH; i++)
+        {
+            u32                    writer = static_cast<u32>(bench_random_u64() % BENCH_CHT_WRITERS);
+            u64                    index  = bench_random_u64() % BENCH_CHT_KEYS_PER_WRITER;
+            u64                    key    = bench_cht_key(writer, index);
+            const bench_cht_value *value  = table->find(key);
+            if (!value)
+            {
+                failures += index < BENCH_CHT_PINNED_KEYS;
+                continue;
+            }
+            failures += value->key != key || value->check != bench_cht_check(key, value->version);
+        }
+        table->read_end(reader);
+        lookups += BENCH_CHT_READ_BATCH;
+    }
+    table->unregister_reader(reader);
+    *out_lookups  = lookups;
+    *out_failures = failures;
+}
+
+static void bench_cht_stress()
+{
+    dconcurrent_hashtable<bench_cht_value> table;
+    table.init(BENCH_CHT_WRITERS * BENCH_CHT_KEYS_PER_WRITER * 2);
+
+    static bench_cht_writer_model models[BENCH_CHT_WRITERS];
+    for (u32 w = 0; w < BENCH_CHT_WRITERS; w++)
+    {
+        models[w] = {};
+        for (u64 i = 0; i < BENCH_CHT_PINNED_KEYS; i++)
+        {
+            u64 key              = bench_cht_key(w, i);
+            models[w].version[i] = 1;
+            models[w].present[i] = true;
+            table.insert(key, bench_cht_make_value(key, 1));
+        }
+    }
+
+    std::atomic<bool> stop{false};
+    u64               writer_ops[BENCH_CHT_WRITERS];
+    u64               lookups[BENCH_CHT_READERS];
+    u64               failures[BENCH_CHT_READERS];
+    std::thread       writers[BENCH_CHT_WRITERS];
+    std::thread       readers[BENCH_CHT_READERS];
+    for (u32 r = 0; r < BENCH_CHT_READERS; r++)
+    {
+        readers[r] = std::thread(bench_cht_stress_reader, &table, r, &stop, &lookups[r], &failures[r]);
+    }
+    for (u32 w = 0; w < BENCH_CHT_WRITERS; w++)
+    {
+        writers[w] = std::thread(bench_cht_stress_writer, &table, w, &models[w], &stop, &writer_ops[w]);
+    }
+
+    f64 start = platform_get_absolute_time();
+    while (platform_get_absolute_time() - start < BENCH_CHT_STRESS_SECONDS)
+    {
+        std::this_thread::yield();
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (u32 w = 0; w < BENCH_CHT_WRITERS; w++)
+    {
+        writers[w].join();
+    }
+    for (u32 r = 0; r < BENCH_CHT_READERS; r++)
+    {
+        readers[r].join();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    // everything the writers think is in there has to be in there with the last version they wrote, nothing else.
+    u64 mismatches    = 0;
+    u64 expected_size = 0;
+    u32 reader        = table.register_reader();
+    table.read_begin(reader);
+    for (u32 w = 0; w < BENCH_CHT_WRITERS; w++)
+    {
+        for (u64 i = 0; i < BENCH_CHT_KEYS_PER_WRITER; i++)
+        {
+            const bench_cht_value *value = table.find(bench_cht_key(w, i));
+            if (models[w].present[i])
+            {
+                expected_size++;
+                mismatches += !value || value->version != models[w].version[i];
+            }
+            else
+            {
+                mismatches += value != nullptr;
+            }
+        }
+    }
+    table.read_end(reader);
+    table.unregister_reader(reader);
+    mismatches += table.num_elements() != expected_size;
+
+    u64 total_writes   = 0;
+    u64 total_lookups  = 0;
+    u64 total_failures = 0;
+    for (u32 w = 0; w < BENCH_CHT_WRITERS; w++)
+    {
+        total_writes += writer_ops[w];
+    }
+    for (u32 r = 0; r < BENCH_CHT_READERS; r++)
+    {
+        total_lookups  += lookups[r];
+        total_failures += failures[r];
+    }
+    bench_report("concurrent_hashtable", "stress_writes", total_writes, elapsed);
+    bench_report("concurrent_hashtable", "stress_lookups", total_lookups, elapsed);
+    printf("# concurrent_hashtable stress: %d writers, %d readers, %llu bad reads, %llu mismatches at the end -> %s\n",
+           BENCH_CHT_WRITERS, BENCH_CHT_READERS, static_cast<unsigned long long>(total_failures),
+           static_cast<unsigned long long>(mismatches), (total_failures || mismatches) ? "FAILED" : "ok");
+    table.destroy();
+}
+
+struct bench_cht_locked_table
+{
+    dhashtable<bench_cht_value> table;
+    std::mutex                  lock;
+
+    bench_cht_locked_table(arena *a, u64 size) : table(a, size)
+    {
+    }
+};
+
+// readers look up the pinned keys, one writer (if any) keeps updating them.
+template <bool locked>
+static void bench_cht_throughput_reader(dconcurrent_hashtable<bench_cht_value> *table,
+                                        bench_cht_locked_table *locked_table, u32 seed, u64 lookups, u64 *out_sum)
+{
+    bench_random_seed(0x5555ull * (seed + 1));
+    u64 sum    = 0;
+    u32 reader = locked ? 0 : table->register_reader();
+    for (u64 done = 0; done < lookups; done += BENCH_CHT_READ_BATCH)
+    {
+        if constexpr (locked)
+        {
+            for (u32 i = 0; i < BENCH_CHT_READ_BATCH; i++)
+            {
+                u64 key = bench_cht_key(0, bench_random_u64() % BENCH_CHT_PINNED_KEYS);
+                std::lock_guard<std::mutex> guard(locked_table->lock);
+                bench_cht_value            *value  = locked_table->table.try_find(key);
+                sum                               += value ? value->version : 0;
+            }
+        }
+        else
+        {
+            table->read_begin(reader);
+            for (u32 i = 0; i < BENCH_CHT_READ_BATCH; i++)
+            {
+                u64 key = bench_cht_key(0, bench_random_u64() % BENCH_CHT_PINNED_KEYS);
+                const bench_cht_value *value  = table->find(key);
+                sum                          += value ? value->version : 0;
+            }
+            table->read_end(reader);
+        }
+    }
+    if (!locked)
+    {
+        table->unregister_reader(reader);
+    }
+    *out_sum = sum;
+}
+
+template <bool locked>
+static void bench_cht_throughput_writer(dconcurrent_hashtable<bench_cht_value> *table,
+                                        bench_cht_locked_table *locked_table, std::atomic<bool> *stop)
+{
+    u64 version = 2;
+    while (!stop->load(std::memory_order_relaxed))
+    {
+        u64 key = bench_cht_key(0, version % BENCH_CHT_PINNED_KEYS);
+        if constexpr (locked)
+        {
+            std::lock_guard<std::mutex> guard(locked_table->lock);
+            locked_table->table.update(key, bench_cht_make_value(key, version));
+        }
+        else
+        {
+            table->update(key, bench_cht_make_value(key, version));
+        }
+        version++;
+        // a loader doesnt write non stop, it decodes a file between inserts.
+        std::this_thread::yield();
+    }
+}
+
+template <bool locked>
+static void bench_cht_throughput(dconcurrent_hashtable<bench_cht_value> *table, bench_cht_locked_table *locked_table,
+                                 u32 reader_count, bool with_writer)
+{
+    std::atomic<bool> stop{false};
+    std::thread       writer;
+    if (with_writer)
+    {
+        writer = std::thread(bench_cht_throughput_writer<locked>, table, locked_table, &stop);
+    }
+
+    u64         per_reader = BENCH_CHT_LOOKUPS / reader_count;
+    u64         sums[4];
+    std::thread readers[4];
+    f64         start = platform_get_absolute_time();
+    for (u32 r = 0; r < reader_count; r++)
+    {
+        readers[r] = std::thread(bench_cht_throughput_reader<locked>, table, locked_table, r, per_reader, &sums[r]);
+    }
+    for (u32 r = 0; r < reader_count; r++)
+    {
+        readers[r].join();
+        bench_do_not_optimize(sums[r]);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    stop.store(true, std::memory_order_relaxed);
+    if (with_writer)
+    {
+        writer.join();
+    }
+
+    char name[96];
+    snprintf(name, sizeof(name), "%s_find_%u_readers%s", locked ? "mutex_dhashtable" : "concurrent", reader_count,
+             with_writer ? "_1_writer" : "");
+    bench_report("concurrent_hashtable", name, per_reader * reader_count, elapsed);
+}
+
+void bench_concurrent_hashtable_run()
+{
+    bench_cht_stress();
+
+    dconcurrent_hashtable<bench_cht_value> table;
+    table.init(BENCH_CHT_PINNED_KEYS * 4);
+    arena                  *a            = arena_get_arena();
+    bench_cht_locked_table *locked_table = new bench_cht_locked_table(a, BENCH_CHT_PINNED_KEYS * 2);
+    for (u64 i = 0; i < BENCH_CHT_PINNED_KEYS; i++)
+    {
+        u64 key = bench_cht_key(0, i);
+        table.insert(key, bench_cht_make_value(key, 1));
+        locked_table->table.insert(key, bench_cht_make_value(key, 1));
+    }
+
+    u32 reader_counts[] = {1, 2, 4};
+    for (u32 with_writer = 0; with_writer < 2; with_writer++)
+    {
+        for (u32 reader_count : reader_counts)
+        {
+            bench_cht_throughput<false>(&table, locked_table, reader_count, with_writer);
+            bench_cht_throughput<true>(&table, locked_table, reader_count, with_writer);
+        }
+    }
+    printf("# concurrent_hashtable: %u hardware threads\n", std::thread::hardware_concurrency());
+
+    delete locked_table;
+    arena_free_arena(a);
+    table.destroy();
+}
@@ -0,0 +1,319 @@
+#include "bench.hpp"
+
+#include "containers/darray.hpp"
+#include "containers/dstable_array.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+// INFO: the old darray paths, kept here as the baseline: push_back takes the element by value and copies it in, the
+// const operator[] returns a copy, growth copies the whole capacity and pop_at allocates a new array. The DWARN that
+// used to fire on every growth is left out, it only measures the terminal.
+template <typename T> struct bench_darray_legacy
+{
+    u64    capacity;
+    u64    element_size;
+    u64    length;
+    arena *arena;
+    T     *data;
+
+    void init(struct arena *in_arena)
+    {
+        element_size = sizeof(T);
+        capacity     = DEFAULT_DARRAY_SIZE * element_size;
+        length       = 0;
+        arena        = in_arena;
+        data         = static_cast<T *>(dallocate(arena, capacity, MEM_TAG_DARRAY));
+    }
+
+    T get(u64 index) const
+    {
+        T *elem = &data[index];
+        return *elem;
+    }
+
+    void push_back(T element)
+    {
+        if (length + 1 >= (capacity / element_size))
+        {
+            void *buffer = dallocate(arena, DEFAULT_DARRAY_RESIZE_FACTOR * capacity, MEM_TAG_DARRAY);
+            dcopy_memory(buffer, data, capacity);
+            dfree(data, capacity, MEM_TAG_DARRAY);
+            capacity = capacity * DEFAULT_DARRAY_RESIZE_FACTOR;
+            data     = static_cast<T *>(buffer);
+        }
+        dcopy_memory(&data[length], &element, element_size);
+        length++;
+    }
+
+    T pop_at(u32 index)
+    {
+        T  copy      = data[index];
+        T *new_array = static_cast<T *>(dallocate(arena, capacity, MEM_TAG_DARRAY));
+        dcopy_memory(new_array, data, index * element_size);
+        dcopy_memory(&new_array[index], &data[index + 1], (length - index) * element_size);
+        dfree(data, capacity, MEM_TAG_DARRAY);
+        data = new_array;
+        length--;
+        return copy;
+    }
+};
+
+#define BENCH_DARRAY_STRINGS 4096
+#define BENCH_DARRAY_STRING_ROUNDS 32
+#define BENCH_DARRAY_U64S (1 << 20)
+#define BENCH_DARRAY_POP_ELEMENTS 8192
+#define BENCH_DARRAY_POPS 2048
+
+static const char *bench_darray_names[] = {"../assets/textures/cobblestone.png", "default", "sponza_floor_diffuse",
+                                           "battle_damaged_helmet", "skybox_front"};
+
+static u64 bench_darray_sum_lengths_legacy(const bench_darray_legacy<dstring> &array)
+{
+    u64 sum = 0;
+    for (u64 i = 0; i < array.length; i++)
+    {
+        sum += array.get(i).str_len;
+    }
+    return sum;
+}
+
+static u64 bench_darray_sum_lengths(const darray<dstring> &array)
+{
+    u64 sum = 0;
+    for (u64 i = 0; i < array.length; i++)
+    {
+        sum += array[i].str_len;
+    }
+    return sum;
+}
+
+// what the resource systems do with their loaded_* tables: push a name per resource, scan them all for lookups.
+static void bench_darray_dstring(bool legacy)
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    memory_system_enable_slab(a);
+
+    u64 checksum = 0;
+    f64 start    = platform_get_absolute_time();
+    for (u32 round = 0; round < BENCH_DARRAY_STRING_ROUNDS; round++)
+    {
+        if (legacy)
+        {
+            bench_darray_legacy<dstring> array;
+            array.init(a);
+            for (u32 i = 0; i < BENCH_DARRAY_STRINGS; i++)
+            {
+                array.push_back(dstring(bench_darray_names[i % 5]));
+            }
+            checksum += bench_darray_sum_lengths_legacy(array);
+            dfree(array.data, array.capacity, MEM_TAG_DARRAY);
+        }
+        else
+        {
+            darray<dstring> array;
+            array.c_init(a);
+            for (u32 i = 0; i < BENCH_DARRAY_STRINGS; i++)
+            {
+                array.emplace_back(bench_darray_names[i % 5]);
+            }
+            checksum += bench_darray_sum_lengths(array);
+            dfree(array.data, array.capacity, MEM_TAG_DARRAY);
+        }
+        arena_reset_arena(a, false);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_do_not_optimize(checksum);
+
+    bench_report("darray", legacy ? "dstring_push_and_scan_by_value" : "dstring_emplace_and_scan_by_ref",
+                 static_cast<u64>(BENCH_DARRAY_STRINGS) * BENCH_DARRAY_STRING_ROUNDS * 2, elapsed);
+    arena_free_arena(a);
+}
+
+static void bench_darray_u64_growth(bool legacy)
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+
+    f64 start = platform_get_absolute_time();
+    if (legacy)
+    {
+        bench_darray_legacy<u64> array;
+        array.init(a);
+        for (u64 i = 0; i < BENCH_DARRAY_U64S; i++)
+        {
+            array.push_back(i);
+        }
+        bench_do_not_optimize(array.data[BENCH_DARRAY_U64S - 1]);
+    }
+    else
+    {
+        darray<u64> array;
+        array.c_init(a);
+        for (u64 i = 0; i < BENCH_DARRAY_U64S; i++)
+        {
+            array.push_back(i);
+        }
+        bench_do_not_optimize(array.data[BENCH_DARRAY_U64S - 1]);
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_report("darray", legacy ? "u64_push_back_legacy" : "u64_push_back", BENCH_DARRAY_U64S, elapsed);
+    arena_free_arena(a);
+}
+
+// draining from the back and a plain read pass, the two things the frame loops do with a filled array.
+static void bench_darray_pop_back_and_iterate()
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+
+    darray<u64> array;
+    array.c_init(a);
+    for (u64 i = 0; i < BENCH_DARRAY_U64S; i++)
+    {
+        array.push_back(i);
+    }
+
+    u64 sum   = 0;
+    f64 start = platform_get_absolute_time();
+    for (u64 i = 0; i < array.size(); i++)
+    {
+        sum += array[i];
+    }
+    bench_report("darray", "u64_iterate", BENCH_DARRAY_U64S, platform_get_absolute_time() - start);
+    bench_do_not_optimize(sum);
+
+    u64 popped = 0;
+    start      = platform_get_absolute_time();
+    while (array.size())
+    {
+        popped += array.pop_back();
+    }
+    bench_report("darray", "u64_pop_back", BENCH_DARRAY_U64S, platform_get_absolute_time() - start);
+
+    if (sum != popped || sum != (static_cast<u64>(BENCH_DARRAY_U64S) * (BENCH_DARRAY_U64S - 1)) / 2)
+    {
+        printf("# darray u64: iterate and pop_back saw different elements\n");
+    }
+    arena_free_arena(a);
+}
+
+// removing from the middle, e.g. dropping a released resource out of a table.
+static void bench_darray_pop_at(bool legacy)
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+
+    u64 checksum = 0;
+    f64 start    = platform_get_absolute_time();
+    if (legacy)
+    {
+        bench_darray_legacy<u32> array;
+        array.init(a);
+        for (u32 i = 0; i < BENCH_DARRAY_POP_ELEMENTS; i++)
+        {
+            array.push_back(i);
+        }
+        for (u32 i = 0; i < BENCH_DARRAY_POPS; i++)
+        {
+            checksum += array.pop_at(static_cast<u32>(array.length / 2));
+        }
+    }
+    else
+    {
+        darray<u32> array;
+        array.c_init(a);
+        for (u32 i = 0; i < BENCH_DARRAY_POP_ELEMENTS; i++)
+        {
+            array.push_back(i);
+        }
+        for (u32 i = 0; i < BENCH_DARRAY_POPS; i++)
+        {
+            checksum += array.pop_at(static_cast<u32>(array.length / 2));
+        }
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_do_not_optimize(checksum);
+
+    bench_report("darray", legacy ? "u32_pop_at_middle_realloc" : "u32_pop_at_middle_memmove", BENCH_DARRAY_POPS,
+                 elapsed);
+    printf("# darray pop_at %s: arena used %llu KiB\n", legacy ? "legacy" : "memmove",
+           static_cast<unsigned long long>(a->allocated / 1024));
+    arena_free_arena(a);
+}
+
+// appending to the stable array vs darray growth, plus a check that a pointer taken at the start is still good at the
+// end and that clear() hands the pages back.
+static void bench_darray_stable_array()
+{
+    dstable_array<u64> array;
+    array.init(BENCH_DARRAY_U64S);
+
+    u64 *first = nullptr;
+    f64  start = platform_get_absolute_time();
+    for (u64 i = 0; i < BENCH_DARRAY_U64S; i++)
+    {
+        u64 &elem = array.push_back(i);
+        if (i == 0)
+        {
+            first = &elem;
+        }
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_do_not_optimize(array.data[BENCH_DARRAY_U64S - 1]);
+    bench_report("darray", "u64_push_back_stable_array", BENCH_DARRAY_U64S, elapsed);
+
+    u64 rss_full = bench_get_rss_bytes();
+    array.clear();
+    u64 rss_cleared = bench_get_rss_bytes();
+    printf("# stable_array: first element %s after %d appends, %llu KiB committed, clear gave back %.1f MiB\n",
+           first == &array.data[0] ? "did not move" : "MOVED", BENCH_DARRAY_U64S,
+           static_cast<unsigned long long>(array.committed / 1024),
+           rss_full > rss_cleared ? static_cast<f64>(rss_full - rss_cleared) / MB(1) : 0.0);
+    array.destroy();
+}
+
+// pushing an element of the array itself back while it is full, the argument lives in the block that growing frees.
+// With the slab on the freed block gets a free list link written over its first bytes.
+static void bench_darray_self_push()
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    memory_system_enable_slab(a);
+    dstr_set_arena(a);
+
+    darray<u64>  numbers;
+    darray<dstr> names;
+    numbers.c_init(a);
+    names.c_init(a);
+    numbers.push_back(0x1234567890abcdefull);
+    names.push_back(dstr("a name that is too long for the small string buffer"));
+    u32 mismatches = 0;
+    for (u32 i = 0; i < 1000; i++)
+    {
+        numbers.push_back(numbers[0]);
+        names.push_back(names[0]);
+        mismatches += numbers.back() != numbers[0];
+        mismatches += !string_compare(names.back().c_str(), names[0].c_str());
+    }
+    if (mismatches)
+    {
+        printf("# darray: %u elements pushed from the array itself came out wrong\n", mismatches);
+    }
+    names.clear();
+    dstr_set_arena(nullptr);
+    arena_free_arena(a);
+}
+
+void bench_darray_run()
+{
+    bench_darray_self_push();
+    bench_darray_dstring(true);
+    bench_darray_dstring(false);
+    bench_darray_u64_growth(true);
+    bench_darray_u64_growth(false);
+    bench_darray_stable_array();
+    bench_darray_pop_back_and_iterate();
+    bench_darray_pop_at(true);
+    bench_darray_pop_at(false);
+}
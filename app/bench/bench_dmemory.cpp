@@ -0,0 +1,84 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+#include <thread>
+
+#define BENCH_DMEMORY_ALLOCATIONS 1000000
+
+// cost of the telemetry on the allocation path: plain dallocate vs the call site macro.
+static void bench_dmemory_tracked_allocations()
+{
+    arena *a = arena_get_arena();
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DMEMORY_ALLOCATIONS; i++)
+    {
+        void *block = dallocate(a, 32, MEM_TAG_GEOMETRY);
+        bench_do_not_optimize(block);
+    }
+    bench_report("dmemory", "dallocate_32b", BENCH_DMEMORY_ALLOCATIONS, platform_get_absolute_time() - start);
+    arena_reset_arena(a);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DMEMORY_ALLOCATIONS; i++)
+    {
+        void *block = DALLOCATE(a, 32, MEM_TAG_GEOMETRY);
+        bench_do_not_optimize(block);
+    }
+    bench_report("dmemory", "DALLOCATE_32b_callsite", BENCH_DMEMORY_ALLOCATIONS, platform_get_absolute_time() - start);
+    memory_system_timeline_sample("bench_single_thread");
+
+    arena_free_arena(a);
+}
+
+// every thread bumps the same tag counters, so this is the worst case for the atomics.
+static void bench_dmemory_contended_allocations(u32 thread_count)
+{
+    auto worker = [&]() {
+        arena *a = arena_thread_acquire_arena();
+        for (u32 i = 0; i < BENCH_DMEMORY_ALLOCATIONS; i++)
+        {
+            void *block = DALLOCATE(a, 32, MEM_TAG_GEOMETRY);
+            bench_do_not_optimize(block);
+        }
+        arena_thread_release_arena();
+    };
+
+    std::thread threads[64];
+    f64         start = platform_get_absolute_time();
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i] = std::thread(worker);
+    }
+    for (u32 i = 0; i < thread_count; i++)
+    {
+        threads[i].join();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    char name[64];
+    snprintf(name, sizeof(name), "DALLOCATE_32b_%u_threads", thread_count);
+    bench_report("dmemory", name, static_cast<u64>(thread_count) * BENCH_DMEMORY_ALLOCATIONS, elapsed);
+    memory_system_timeline_sample("bench_contended");
+}
+
+void bench_dmemory_run()
+{
+    bench_dmemory_tracked_allocations();
+    bench_dmemory_contended_allocations(4);
+    bench_dmemory_contended_allocations(8);
+
+    u64  buffer_size = 0;
+    char buffer[8000];
+    get_memory_usg_str(&buffer_size, buffer);
+    printf("# %s", buffer);
+    get_memory_callsite_usg_str(&buffer_size, buffer);
+    printf("# %s", buffer);
+
+    memory_system_export_timeline("bench_memory_timeline.json");
+    printf("# timeline written to bench_memory_timeline.json\n");
+}
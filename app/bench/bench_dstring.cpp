@@ -0,0 +1,281 @@
+#include "bench.hpp"
+
+#include "containers/darray.hpp"
+#include "core/dfile_system.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+#include "resources/resource_types.hpp"
+
+#include <cstdio>
+
+// INFO: the dstring operations the parsers and the resource systems lean on, at a few string lengths. A dstring is
+// always 512 bytes + the length no matter how long the text is, so the short cases show what that costs.
+#define BENCH_DSTRING_ITERATIONS 1000000
+#define BENCH_DSTRING_SPLIT_ITERATIONS 100000
+
+static const u32 bench_dstring_lengths[] = {8, 32, 128, 500};
+
+// "aaaaaaa,bbbbbbb,..." so split has a field every 8 characters and the text ends in a character we can search for.
+static void bench_dstring_make_text(char *out, u32 length)
+{
+    for (u32 i = 0; i < length; i++)
+    {
+        out[i] = (i % 8 == 7) ? ',' : static_cast<char>('a' + (i / 8) % 26);
+    }
+    out[length - 1] = 'Z';
+    out[length]     = '\0';
+}
+
+static void bench_dstring_run_length(u32 length)
+{
+    char text[MAX_STRING_LENGTH];
+    char other[MAX_STRING_LENGTH];
+    bench_dstring_make_text(text, length);
+    bench_dstring_make_text(other, length);
+
+    char name[64];
+    u64  checksum = 0;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        dstring str(text);
+        checksum += str.str_len;
+        bench_do_not_optimize(str);
+    }
+    snprintf(name, sizeof(name), "construct_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    dstring str;
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        // assigning over a non empty dstring warns, callers clear first.
+        str.clear();
+        str       = text;
+        checksum += str.str_len;
+        bench_do_not_optimize(str);
+    }
+    snprintf(name, sizeof(name), "clear_and_assign_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    dstring copy;
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        copy      = str;
+        checksum += copy.str_len;
+        bench_do_not_optimize(copy);
+    }
+    snprintf(name, sizeof(name), "copy_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        bench_do_not_optimize(text);
+        checksum += string_length(text);
+    }
+    snprintf(name, sizeof(name), "length_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    // equal strings, the worst case: every character gets looked at.
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        bench_do_not_optimize(other);
+        checksum += string_compare(text, other);
+    }
+    snprintf(name, sizeof(name), "compare_equal_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        bench_do_not_optimize(text);
+        checksum += string_first_string_occurence(text, "Z") != nullptr;
+    }
+    snprintf(name, sizeof(name), "find_at_end_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    arena          *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    darray<dstring> fields;
+    fields.c_init(a);
+    u64 expected_fields = 0;
+    start               = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_SPLIT_ITERATIONS; i++)
+    {
+        fields.clear();
+        string_split(&str, ',', &fields);
+        expected_fields  = expected_fields ? expected_fields : fields.size();
+        checksum        += fields.size() != expected_fields;
+    }
+    snprintf(name, sizeof(name), "split_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_SPLIT_ITERATIONS, platform_get_absolute_time() - start);
+    u64 commas = string_num_of_substring_occurence(text, ",");
+    if (expected_fields != commas + 1)
+    {
+        printf("# dstring split_%u: %llu fields, expected %llu\n", length,
+               static_cast<unsigned long long>(expected_fields), static_cast<unsigned long long>(commas + 1));
+    }
+    arena_free_arena(a);
+
+    bench_do_not_optimize(checksum);
+}
+
+// dstring vs dstr for short names and for ones that have to go to the string arena.
+static void bench_dstr_run_length(u32 length)
+{
+    char text[MAX_STRING_LENGTH];
+    bench_dstring_make_text(text, length);
+
+    char name[64];
+    u64  checksum = 0;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        dstr str(text);
+        checksum += str.size();
+        bench_do_not_optimize(str);
+    }
+    snprintf(name, sizeof(name), "dstr_construct_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    dstr str(text);
+    dstr copy;
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        copy      = str;
+        checksum += copy.size();
+        bench_do_not_optimize(copy);
+    }
+    snprintf(name, sizeof(name), "dstr_copy_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    dstring_view expected(text);
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_DSTRING_ITERATIONS; i++)
+    {
+        bench_do_not_optimize(expected);
+        checksum += copy.view() == expected;
+    }
+    snprintf(name, sizeof(name), "dstr_view_compare_%u", length);
+    bench_report("dstring", name, BENCH_DSTRING_ITERATIONS, platform_get_absolute_time() - start);
+
+    if (copy.view() != expected || string_length(copy.c_str()) != length)
+    {
+        printf("# dstring dstr_%u: copy doesnt match the source\n", length);
+    }
+    bench_do_not_optimize(checksum);
+}
+
+// what the names of the sponza materials and their textures cost as dstring vs dstr, plus how big the records that
+// hold them are now.
+static void bench_dstr_resource_report(arena *a)
+{
+    const char *path      = "../assets/materials/sponza.mtl";
+    u64         file_size = 0;
+    if (!file_open_and_read(path, &file_size, 0, 0))
+    {
+        printf("# dstr: couldnt open %s, no name report\n", path);
+        return;
+    }
+    char *file = static_cast<char *>(arena_allocate_block(a, file_size + 1));
+    file_open_and_read(path, &file_size, file, 0);
+    file[file_size] = '\0';
+
+    u64          names       = 0;
+    u64          inline_kept = 0;
+    u64          heap_bytes  = 0;
+    dstring_view rest(file, file_size);
+    while (rest.length)
+    {
+        s64          end  = rest.find('\n');
+        dstring_view line = rest.substr(0, end < 0 ? rest.length : static_cast<u64>(end)).trim();
+        rest              = rest.substr(end < 0 ? rest.length : static_cast<u64>(end) + 1, rest.length);
+
+        s64 space = line.find(' ');
+        if (space < 0)
+        {
+            continue;
+        }
+        dstring_view key = line.substr(0, space);
+        if (key != "newmtl" && key != "map_Kd" && key != "map_d" && key != "map_bump")
+        {
+            continue;
+        }
+        dstr name = line.substr(space + 1, line.length).trim();
+        names++;
+        inline_kept += name.is_inline();
+        heap_bytes  += name.heap_bytes();
+    }
+
+    u64 as_dstring = names * sizeof(dstring);
+    u64 as_dstr    = names * sizeof(dstr) + heap_bytes;
+    printf("# dstr: %llu names in sponza.mtl, %llu inline, %llu bytes as dstring, %llu bytes as dstr (%llu in the "
+           "string arena)\n",
+           static_cast<unsigned long long>(names), static_cast<unsigned long long>(inline_kept),
+           static_cast<unsigned long long>(as_dstring), static_cast<unsigned long long>(as_dstr),
+           static_cast<unsigned long long>(heap_bytes));
+
+    // every string field used to be a dstring, the difference per field is exact because both are 8 byte aligned.
+    u64 saved = sizeof(dstring) - sizeof(dstr);
+    printf("# dstr: sizeof dstring %llu, dstr %llu, dstring_view %llu\n",
+           static_cast<unsigned long long>(sizeof(dstring)), static_cast<unsigned long long>(sizeof(dstr)),
+           static_cast<unsigned long long>(sizeof(dstring_view)));
+    printf("# dstr: texture %llu bytes (-%llu), material %llu (-%llu), geometry %llu (-%llu), material_config %llu "
+           "(-%llu), shader_uniform_config %llu (-%llu)\n",
+           static_cast<unsigned long long>(sizeof(texture)), static_cast<unsigned long long>(saved),
+           static_cast<unsigned long long>(sizeof(material)), static_cast<unsigned long long>(saved),
+           static_cast<unsigned long long>(sizeof(geometry)), static_cast<unsigned long long>(saved),
+           static_cast<unsigned long long>(sizeof(material_config)), static_cast<unsigned long long>(saved * 5),
+           static_cast<unsigned long long>(sizeof(shader_uniform_config)), static_cast<unsigned long long>(saved));
+}
+
+// the usage reports append line after line into a buffer sized up front, more lines than fit must not run past it.
+static void bench_dstring_append_format_check()
+{
+    char buffer[32];
+    dset_memory_value(buffer, 0x7F, sizeof(buffer));
+    const u64 size   = 16;
+    u64       offset = 0;
+    for (u32 i = 0; i < 8; i++)
+    {
+        offset = string_append_format(buffer, size, offset, "line %u\n", i);
+    }
+    bool canary_intact = true;
+    for (u64 i = size; i < sizeof(buffer); i++)
+    {
+        canary_intact = canary_intact && buffer[i] == 0x7F;
+    }
+    if (offset != size - 1 || buffer[size - 1] != '\0' || !canary_intact)
+    {
+        printf("# string_append_format: offset %llu of %llu, wrote past the buffer: %s\n",
+               static_cast<unsigned long long>(offset), static_cast<unsigned long long>(size),
+               canary_intact ? "no" : "yes");
+    }
+}
+
+void bench_dstring_run()
+{
+    bench_dstring_append_format_check();
+    for (u32 length : bench_dstring_lengths)
+    {
+        bench_dstring_run_length(length);
+    }
+
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    memory_system_enable_slab(a);
+    dstr_set_arena(a);
+    for (u32 length : bench_dstring_lengths)
+    {
+        bench_dstr_run_length(length);
+    }
+    bench_dstr_resource_report(a);
+    dstr_set_arena(nullptr);
+    arena_free_arena(a);
+}
@@ -0,0 +1,211 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "math/dfrustum.hpp"
+#include "math/dmath.hpp"
+#include "math/dvertex_batch.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+// INFO: frustum culling of random boxes scattered around a camera, the way the renderer does it every frame: build
+// the world space cull list from object bounds and model matrices, then cull it. ops_per_sec is objects per second.
+// The counts are sponza sized (a few hundred objects) and a big scene, neither a multiple of 8 so the short last
+// group is in there too.
+#define BENCH_FRUSTUM_SMALL_COUNT 393
+#define BENCH_FRUSTUM_LARGE_COUNT 65533
+#define BENCH_FRUSTUM_OBJECTS     (1 << 23)
+#define BENCH_FRUSTUM_VERTICES    65537
+
+struct bench_frustum_scene
+{
+    bounds_3D *bounds;
+    mat4      *models;
+    u32        count;
+};
+
+static void bench_frustum_build_scene(arena *a, u32 count, bench_frustum_scene *scene)
+{
+    scene->count  = count;
+    scene->bounds = static_cast<bounds_3D *>(arena_allocate_block(a, sizeof(bounds_3D) * count));
+    scene->models = static_cast<mat4 *>(arena_allocate_block(a, sizeof(mat4) * count));
+    for (u32 i = 0; i < count; i++)
+    {
+        bounds_3D *b = scene->bounds + i;
+        vec3       half(bench_random_f32(0.1f, 4), bench_random_f32(0.1f, 4), bench_random_f32(0.1f, 4));
+        b->center    = vec3(bench_random_f32(-1, 1), bench_random_f32(-1, 1), bench_random_f32(-1, 1));
+        b->min       = b->center - half;
+        b->max       = b->center + half;
+        b->radius    = half.magnitude();
+
+        mat4 rotation    = mat4_euler_xyz(bench_random_f32(-3, 3), bench_random_f32(-3, 3), bench_random_f32(-3, 3));
+        scene->models[i] = mat4_mul(rotation, mat4_translation(vec3(bench_random_f32(-150, 150),
+                                                                    bench_random_f32(-20, 40),
+                                                                    bench_random_f32(-150, 150))));
+    }
+}
+
+// the camera from main.cpp, a bit above the ground looking down one axis.
+static frustum bench_frustum_camera()
+{
+    mat4 camera     = mat4_mul(mat4_euler_xyz(-0.2f, 0.7f, 0), mat4_translation(vec3(0, 6, 6)));
+    mat4 view       = mat4_inverse(camera);
+    mat4 projection = mat4_perspective(45 * D_DEG2RAD_MULTIPLIER, 16.0f / 9.0f, 0.01f, 1000.0f);
+    return frustum_from_matrix(mat4_mul(view, projection));
+}
+
+static void bench_frustum_fill(frustum_cull_list *list, const bench_frustum_scene *scene)
+{
+    list->count = 0;
+    for (u32 i = 0; i < scene->count; i++)
+    {
+        frustum_cull_list_push(list, scene->bounds + i, scene->models[i]);
+    }
+}
+
+// a camera at the origin looking down -z, a box in front of it has to stay and boxes behind it, off to the side and
+// past the far plane have to go.
+static bool bench_frustum_check_planes(arena *a)
+{
+    mat4    projection = mat4_perspective(45 * D_DEG2RAD_MULTIPLIER, 1.0f, 0.1f, 100.0f);
+    frustum f          = frustum_from_matrix(mat4_mul(mat4(), projection));
+
+    // the last one sticks out of the right plane a little.
+    vec3 centers[]  = {vec3(0, 0, -10),   vec3(0, 0, 10),    vec3(50, 0, -10),
+                       vec3(0, -50, -10), vec3(0, 0, -200), vec3(4.5f, 0, -10)};
+    bool expected[] = {true, false, false, false, false, true};
+    u32  count      = sizeof(expected) / sizeof(expected[0]);
+
+    frustum_cull_list list;
+    frustum_cull_list_create(a, count, &list);
+    for (u32 i = 0; i < count; i++)
+    {
+        bounds_3D b;
+        b.min    = vec3(-1, -1, -1);
+        b.max    = vec3(1, 1, 1);
+        b.radius = 1.7320508f;
+        frustum_cull_list_push(&list, &b, mat4_translation(centers[i]));
+    }
+    u32 visible[8];
+    u32 visible_count = frustum_cull(&f, &list, visible);
+
+    bool ok = true;
+    u32  v  = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        bool is_visible = v < visible_count && visible[v] == i;
+        v              += is_visible;
+        ok              = ok && is_visible == expected[i];
+    }
+    return ok;
+}
+
+static void bench_frustum_check(arena *a, bench_frustum_scene *scene)
+{
+    printf("# frustum_cull check planes: %s\n", bench_frustum_check_planes(a) ? "ok" : "WRONG");
+
+    frustum           f = bench_frustum_camera();
+    frustum_cull_list list;
+    frustum_cull_list_create(a, scene->count, &list);
+    bench_frustum_fill(&list, scene);
+
+    u32 *simd_visible   = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * scene->count));
+    u32 *scalar_visible = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * scene->count));
+    u32  simd_count     = frustum_cull(&f, &list, simd_visible);
+    u32  scalar_count   = frustum_cull_scalar(&f, &list, scalar_visible);
+
+    u32 mismatches = simd_count > scalar_count ? simd_count - scalar_count : scalar_count - simd_count;
+    for (u32 i = 0; i < simd_count && i < scalar_count; i++)
+    {
+        mismatches += simd_visible[i] != scalar_visible[i];
+    }
+    printf("# frustum_cull check cull against scalar: %u objects, %u visible, %u culled, %u mismatches\n",
+           scene->count, simd_count, scene->count - simd_count, mismatches);
+
+    // the bounds that geometry creation writes, on a random cloud with a count that isnt a multiple of 4.
+    vertex_3D *vertices =
+        static_cast<vertex_3D *>(arena_allocate_block(a, sizeof(vertex_3D) * BENCH_FRUSTUM_VERTICES));
+    for (u32 i = 0; i < BENCH_FRUSTUM_VERTICES; i++)
+    {
+        vertices[i]          = vertex_3D{};
+        vertices[i].position = vec3(bench_random_f32(-3, 5), bench_random_f32(-1, 7), bench_random_f32(-9, 0));
+        // rides along in the 4th lane of the position loads, it must not end up in the box.
+        vertices[i].normal   = vec3(bench_random_f32(-100, 100), 0, 0);
+    }
+    bounds_3D batch      = vertex_batch_bounds_3D(vertices, BENCH_FRUSTUM_VERTICES);
+    bounds_3D reference  = vertex_batch_bounds_3D_scalar(vertices, BENCH_FRUSTUM_VERTICES);
+    f32       difference = fabsf(batch.radius - reference.radius);
+    for (u32 i = 0; i < 3; i++)
+    {
+        difference = fmaxf(difference, fabsf(batch.min.elements[i] - reference.min.elements[i]));
+        difference = fmaxf(difference, fabsf(batch.max.elements[i] - reference.max.elements[i]));
+        difference = fmaxf(difference, fabsf(batch.center.elements[i] - reference.center.elements[i]));
+    }
+    printf("# frustum_cull check bounds_3D: max difference %.3g\n", difference);
+}
+
+template <typename F> static f64 bench_frustum_time(const char *name, u32 objects, F op)
+{
+    u32 passes = BENCH_FRUSTUM_OBJECTS / objects;
+    f64 start  = platform_get_absolute_time();
+    for (u32 pass = 0; pass < passes; pass++)
+    {
+        op();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_report("frustum_cull", name, static_cast<u64>(objects) * passes, elapsed);
+    return elapsed;
+}
+
+static void bench_frustum_run_scene(arena *a, u32 count, const char *suffix)
+{
+    bench_frustum_scene scene;
+    bench_frustum_build_scene(a, count, &scene);
+    if (count == BENCH_FRUSTUM_SMALL_COUNT)
+    {
+        bench_frustum_check(a, &scene);
+    }
+
+    frustum           f = bench_frustum_camera();
+    frustum_cull_list list;
+    frustum_cull_list_create(a, count, &list);
+    u32 *visible = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * count));
+
+    char name[64];
+    snprintf(name, sizeof(name), "build_list_%s", suffix);
+    bench_frustum_time(name, count, [&]() {
+        bench_frustum_fill(&list, &scene);
+        bench_do_not_optimize(list.center_x);
+    });
+
+    u32 visible_count = 0;
+    snprintf(name, sizeof(name), "cull_scalar_%s", suffix);
+    f64 scalar = bench_frustum_time(name, count, [&]() {
+        visible_count = frustum_cull_scalar(&f, &list, visible);
+        bench_do_not_optimize(visible_count);
+    });
+    snprintf(name, sizeof(name), "cull_%s", suffix);
+    f64 batch = bench_frustum_time(name, count, [&]() {
+        visible_count = frustum_cull(&f, &list, visible);
+        bench_do_not_optimize(visible_count);
+    });
+
+    f64 objects = static_cast<f64>(BENCH_FRUSTUM_OBJECTS / count) * count;
+    printf("# frustum_cull %s: %u objects, %u visible, %.1f M objects/s, %.1f M objects/s scalar, %.2fx\n", suffix,
+           count, visible_count, objects / batch / 1000000.0, objects / scalar / 1000000.0, scalar / batch);
+}
+
+void bench_frustum_run()
+{
+    bench_random_seed(0x2545f4914f6cdd1dull);
+#if DSIMD_AVX
+    printf("# frustum_cull: simd backend %s, 8 boxes per op\n", DSIMD_BACKEND_NAME);
+#else
+    printf("# frustum_cull: simd backend %s, 4 boxes per op\n", DSIMD_BACKEND_NAME);
+#endif
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_frustum_run_scene(a, BENCH_FRUSTUM_SMALL_COUNT, "sponza");
+    bench_frustum_run_scene(a, BENCH_FRUSTUM_LARGE_COUNT, "large");
+    arena_free_arena(a);
+}
@@ -0,0 +1,438 @@
+#include "bench.hpp"
+
+#include "containers/dhashtable.hpp"
+#include "containers/dslot_map.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+// INFO: the old dhashtable string paths, kept as the baseline: inline key + value + prev/next in every entry, djb2,
+// collisions chained through whatever empty slot a linear scan from the home slot finds first.
+template <typename T> struct bench_legacy_hashtable
+{
+    struct entry
+    {
+        bool   is_initialized;
+        entry *next;
+        entry *prev;
+        u32    unique_identifier;
+        char   key[MAX_KEY_LENGTH];
+        T      type;
+    };
+    entry *table;
+    u64    max_length;
+
+    void init(arena *a, u64 table_size)
+    {
+        max_length = table_size;
+        // fresh arena memory reads back as zero, same as what dallocate gave the old table.
+        table      = static_cast<entry *>(arena_allocate_block(a, sizeof(entry) * table_size));
+    }
+
+    u64 hash_func(const char *key)
+    {
+        u64 hash = 5381;
+        u32 c;
+        while ((c = *key++))
+        {
+            hash = ((hash << 5) + hash) + c;
+        }
+        return hash;
+    }
+
+    u64 find_empty_spot(u64 hash_code)
+    {
+        u64 i = (hash_code + 1) % max_length;
+        while (i != hash_code)
+        {
+            if (!table[i].is_initialized)
+            {
+                return i;
+            }
+            i = (i + 1) % max_length;
+        }
+        return INVALID_ID_64;
+    }
+
+    void insert(const char *key, T type)
+    {
+        u64    hash_code = hash_func(key) % max_length;
+        entry *entry_ptr = &table[hash_code];
+        if (entry_ptr->is_initialized)
+        {
+            while (entry_ptr->next)
+            {
+                entry_ptr = entry_ptr->next;
+            }
+            entry_ptr->next = &table[find_empty_spot(hash_code)];
+            entry_ptr       = entry_ptr->next;
+        }
+        dcopy_memory(entry_ptr->key, key, strlen(key));
+        entry_ptr->type           = type;
+        entry_ptr->next           = nullptr;
+        entry_ptr->is_initialized = true;
+    }
+
+    T *find(const char *key)
+    {
+        entry *entry_ptr = &table[hash_func(key) % max_length];
+        while (entry_ptr)
+        {
+            if (string_compare(key, entry_ptr->key))
+            {
+                return &entry_ptr->type;
+            }
+            entry_ptr = entry_ptr->next;
+        }
+        return nullptr;
+    }
+};
+
+// resource sized values, roughly what a texture/material record is.
+struct bench_hashtable_value
+{
+    u64 id;
+    u32 data[30];
+};
+
+#define BENCH_HASHTABLE_LOOKUPS 1000000
+
+static void bench_hashtable_make_keys(char (*keys)[MAX_KEY_LENGTH], u32 count)
+{
+    for (u32 i = 0; i < count; i++)
+    {
+        snprintf(keys[i], MAX_KEY_LENGTH, "../assets/textures/material_%u_albedo.png", i);
+    }
+}
+
+// load_percent is how full the tables end up, the resource systems run anywhere between nearly empty and nearly full.
+static void bench_hashtable_run_size(u32 count, u32 load_percent)
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+
+    char (*keys)[MAX_KEY_LENGTH] =
+        static_cast<char (*)[MAX_KEY_LENGTH]>(arena_allocate_block(a, static_cast<u64>(count) * MAX_KEY_LENGTH));
+    bench_hashtable_make_keys(keys, count);
+    u64 table_size = (static_cast<u64>(count) * 100) / load_percent;
+
+    bench_hashtable_value value = {};
+    char                  name[64];
+    u64                   checksum = 0;
+
+    // old table
+    {
+        bench_legacy_hashtable<bench_hashtable_value> table;
+        table.init(a, table_size);
+
+        f64 start = platform_get_absolute_time();
+        for (u32 i = 0; i < count; i++)
+        {
+            value.id = i;
+            table.insert(keys[i], value);
+        }
+        f64 elapsed = platform_get_absolute_time() - start;
+        snprintf(name, sizeof(name), "insert_%u_load%u_legacy", count, load_percent);
+        bench_report("hashtable", name, count, elapsed);
+
+        start = platform_get_absolute_time();
+        for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+        {
+            checksum += table.find(keys[(i * 7919u) % count])->id;
+        }
+        elapsed = platform_get_absolute_time() - start;
+        snprintf(name, sizeof(name), "find_hit_%u_load%u_legacy", count, load_percent);
+        bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, elapsed);
+    }
+
+    // new table
+    {
+        dhashtable<bench_hashtable_value> table(a, table_size);
+        table.is_non_resizable = true;
+
+        f64 start = platform_get_absolute_time();
+        for (u32 i = 0; i < count; i++)
+        {
+            value.id = i;
+            table.insert(keys[i], value);
+        }
+        f64 elapsed = platform_get_absolute_time() - start;
+        snprintf(name, sizeof(name), "insert_%u_load%u_swiss", count, load_percent);
+        bench_report("hashtable", name, count, elapsed);
+
+        start = platform_get_absolute_time();
+        for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+        {
+            checksum += table.find(keys[(i * 7919u) % count])->id;
+        }
+        elapsed = platform_get_absolute_time() - start;
+        snprintf(name, sizeof(name), "find_hit_%u_load%u_swiss", count, load_percent);
+        bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, elapsed);
+
+        // erase/insert churn, every key goes out and comes back in. Checks that erase leaves the table consistent.
+        start = platform_get_absolute_time();
+        for (u32 i = 0; i < count; i++)
+        {
+            table.erase(keys[i]);
+            value.id = i;
+            table.insert(keys[i], value);
+        }
+        elapsed = platform_get_absolute_time() - start;
+        snprintf(name, sizeof(name), "erase_insert_%u_load%u_swiss", count, load_percent);
+        bench_report("hashtable", name, static_cast<u64>(count) * 2, elapsed);
+
+        u32 missing = 0;
+        for (u32 i = 0; i < count; i++)
+        {
+            bench_hashtable_value *found = table.find(keys[i]);
+            missing                     += !found || found->id != i;
+        }
+        if (missing || table.num_elements() != count)
+        {
+            printf("# hashtable %u: %u keys missing after churn, %llu elements\n", count, missing,
+                   static_cast<unsigned long long>(table.num_elements()));
+        }
+    }
+    bench_do_not_optimize(checksum);
+    arena_free_arena(a);
+}
+
+// u64 keys (string ids, geometry ids): insert, hits, misses and erase everything again.
+static void bench_hashtable_u64_keys(u32 count)
+{
+    arena *a    = arena_get_arena(ARENA_SIZE_MEDIUM);
+    u64   *keys = static_cast<u64 *>(arena_allocate_block(a, sizeof(u64) * count));
+    for (u32 i = 0; i < count; i++)
+    {
+        // spread out like hashed ids, never INVALID_ID_64.
+        keys[i] = (static_cast<u64>(i) + 1) * 0x9E3779B97F4A7C15ull >> 1;
+    }
+
+    dhashtable<bench_hashtable_value> table(a, (static_cast<u64>(count) * 100) / 85);
+    table.is_non_resizable = true;
+
+    bench_hashtable_value value = {};
+    char                  name[64];
+    u64                   checksum = 0;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < count; i++)
+    {
+        value.id = i;
+        table.insert(keys[i], value);
+    }
+    snprintf(name, sizeof(name), "insert_u64_%u", count);
+    bench_report("hashtable", name, count, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+    {
+        checksum += table.find(keys[(i * 7919u) % count])->id;
+    }
+    snprintf(name, sizeof(name), "find_hit_u64_%u", count);
+    bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, platform_get_absolute_time() - start);
+
+    u32 false_hits = 0;
+    start          = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+    {
+        false_hits += table.try_find(keys[(i * 7919u) % count] ^ 0x8000000000000000ull) != nullptr;
+    }
+    snprintf(name, sizeof(name), "find_miss_u64_%u", count);
+    bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, platform_get_absolute_time() - start);
+
+    u32 not_erased = 0;
+    start          = platform_get_absolute_time();
+    for (u32 i = 0; i < count; i++)
+    {
+        not_erased += !table.erase(keys[i]);
+    }
+    snprintf(name, sizeof(name), "erase_u64_%u", count);
+    bench_report("hashtable", name, count, platform_get_absolute_time() - start);
+
+    if (false_hits || not_erased || table.num_elements())
+    {
+        printf("# hashtable u64 %u: %u misses found something, %u keys not erased, %llu left\n", count, false_hits,
+               not_erased, static_cast<unsigned long long>(table.num_elements()));
+    }
+    bench_do_not_optimize(checksum);
+    arena_free_arena(a);
+}
+
+// what the resource systems do with an id they got back from create: u64 keyed dhashtable find vs a slot map handle.
+// The records are about the size of a geometry/material.
+struct bench_slot_map_record
+{
+    u64 id;
+    u8  payload[248];
+};
+
+static void bench_hashtable_slot_map(u32 count)
+{
+    arena *a       = arena_get_arena(ARENA_SIZE_MEDIUM);
+    u64   *ids     = static_cast<u64 *>(arena_allocate_block(a, sizeof(u64) * count));
+    u64   *handles = static_cast<u64 *>(arena_allocate_block(a, sizeof(u64) * count));
+    char   name[64];
+    u64    checksum = 0;
+
+    bench_slot_map_record record = {};
+    {
+        dhashtable<bench_slot_map_record> table(a, count);
+        table.is_non_resizable = true;
+        for (u32 i = 0; i < count; i++)
+        {
+            record.id = i;
+            ids[i]    = table.insert(INVALID_ID_64, record);
+        }
+        f64 start = platform_get_absolute_time();
+        for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+        {
+            checksum += table.find(ids[(i * 7919u) % count])->id;
+        }
+        snprintf(name, sizeof(name), "find_u64_id_%u_dhashtable", count);
+        bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, platform_get_absolute_time() - start);
+    }
+
+    dslot_map<bench_slot_map_record> slot_map;
+    slot_map.init(count);
+    for (u32 i = 0; i < count; i++)
+    {
+        record.id  = i;
+        handles[i] = slot_map.insert(record);
+    }
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_HASHTABLE_LOOKUPS; i++)
+    {
+        checksum += slot_map.get(handles[(i * 7919u) % count])->id;
+    }
+    snprintf(name, sizeof(name), "get_handle_%u_slot_map", count);
+    bench_report("hashtable", name, BENCH_HASHTABLE_LOOKUPS, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u64 i = 0; i < slot_map.size(); i++)
+    {
+        checksum += slot_map.at(i)->id;
+    }
+    snprintf(name, sizeof(name), "iterate_%u_slot_map", count);
+    bench_report("hashtable", name, count, platform_get_absolute_time() - start);
+
+    // free every other record and fill the slots again, the old handles must not see the new records and the records
+    // that stayed must not have moved.
+    bench_slot_map_record *kept = slot_map.get(handles[1]);
+    for (u32 i = 0; i < count; i += 2)
+    {
+        slot_map.erase(handles[i]);
+    }
+    for (u32 i = 0; i < count; i += 2)
+    {
+        record.id = count + i;
+        slot_map.insert(record);
+    }
+    u32 stale_hits = 0;
+    u32 misses     = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        bench_slot_map_record *found  = slot_map.get(handles[i]);
+        stale_hits                   += (i % 2 == 0) && found;
+        misses                       += (i % 2 == 1) && (!found || found->id != i);
+    }
+    u32 moved = slot_map.get(handles[1]) != kept;
+    if (stale_hits || misses || moved || slot_map.size() != count)
+    {
+        printf("# slot map %u: %u stale handles resolved, %u live handles lost, kept record moved: %u\n", count,
+               stale_hits, misses, moved);
+    }
+
+    slot_map.destroy();
+    bench_do_not_optimize(checksum);
+    arena_free_arena(a);
+}
+
+// values that own memory (shader_config has dstr and darray members): they have to survive the table growing and get
+// destroyed on erase and clear. The value counts how many of it are alive.
+struct bench_hashtable_owning_value
+{
+    static s64 alive;
+    dstr       name;
+
+    bench_hashtable_owning_value(const char *in_name) : name(in_name)
+    {
+        alive++;
+    }
+    bench_hashtable_owning_value(const bench_hashtable_owning_value &other) : name(other.name)
+    {
+        alive++;
+    }
+    bench_hashtable_owning_value(bench_hashtable_owning_value &&other) : name(std::move(other.name))
+    {
+        alive++;
+    }
+    bench_hashtable_owning_value &operator=(const bench_hashtable_owning_value &other) = default;
+    ~bench_hashtable_owning_value()
+    {
+        alive--;
+    }
+};
+s64 bench_hashtable_owning_value::alive = 0;
+
+static void bench_hashtable_non_trivial()
+{
+    arena *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    dstr_set_arena(a);
+
+    const u32 count      = 256;
+    u32       mismatches = 0;
+    s64       alive_after_erase;
+    s64       alive_after_clear;
+    char      key[MAX_KEY_LENGTH];
+    char      value[128];
+    {
+        dhashtable<bench_hashtable_owning_value> table(a, 16);
+        for (u32 i = 0; i < count; i++)
+        {
+            snprintf(key, sizeof(key), "shader_%u", i);
+            snprintf(value, sizeof(value), "a value long enough to live on the heap, number %u", i);
+            table.insert(key, bench_hashtable_owning_value(value));
+        }
+        for (u32 i = 0; i < count; i++)
+        {
+            snprintf(key, sizeof(key), "shader_%u", i);
+            snprintf(value, sizeof(value), "a value long enough to live on the heap, number %u", i);
+            bench_hashtable_owning_value *found  = table.find(key);
+            mismatches                         += !found || !string_compare(found->name.c_str(), value);
+        }
+        for (u32 i = 0; i < count; i += 2)
+        {
+            snprintf(key, sizeof(key), "shader_%u", i);
+            table.erase(key);
+        }
+        alive_after_erase = bench_hashtable_owning_value::alive;
+        table.clear();
+        alive_after_clear = bench_hashtable_owning_value::alive;
+    }
+    if (mismatches || alive_after_erase != count / 2 || alive_after_clear)
+    {
+        printf("# hashtable owning values: %u wrong after growing, %lld alive after erasing half of %u, %lld after "
+               "clear\n",
+               mismatches, static_cast<long long>(alive_after_erase), count, static_cast<long long>(alive_after_clear));
+    }
+    dstr_set_arena(nullptr);
+    arena_free_arena(a);
+}
+
+void bench_hashtable_run()
+{
+    bench_hashtable_non_trivial();
+    bench_hashtable_run_size(1000, 50);
+    bench_hashtable_run_size(1000, 85);
+    bench_hashtable_run_size(100000, 50);
+    bench_hashtable_run_size(100000, 85);
+    bench_hashtable_u64_keys(1000);
+    bench_hashtable_u64_keys(100000);
+    bench_hashtable_slot_map(1000);
+    bench_hashtable_slot_map(100000);
+}
@@ -0,0 +1,253 @@
+#include "bench.hpp"
+
+#include "core/dfile_system.hpp"
+#include "core/dmemory.hpp"
+#include "math/dmath_types.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// INFO: OBJ parse + vertex processing with the arena pool on normal pages vs 2 MiB pages. The helmet mesh is
+// replicated BENCH_HUGE_PAGES_COPIES times and the faces of every copy point at the vertices of another copy, so the
+// de-indexing gathers from all over a big working set the way a sponza sized model does. Every mode gets its own pool,
+// so this has to run while no other pool is alive.
+#define BENCH_HUGE_PAGES_MESH "../assets/meshes/battle_damaged_helmet.obj"
+#define BENCH_HUGE_PAGES_COPIES 24
+#define BENCH_HUGE_PAGES_PARSE_ITERATIONS 3
+#define BENCH_HUGE_PAGES_VERTEX_ITERATIONS 20
+
+struct bench_obj_mesh
+{
+    vec3 *positions;
+    vec3 *normals;
+    vec2 *uvs;
+    // position/uv/normal triplets, 3 per triangle, 0 based.
+    u32  *indices;
+    u32   position_count;
+    u32   normal_count;
+    u32   uv_count;
+    u32   index_count;
+};
+
+struct bench_vertex
+{
+    vec3 position;
+    vec3 normal;
+    vec2 uv;
+};
+
+static char *bench_huge_pages_build_text(u64 *out_size)
+{
+    u64 file_size = 0;
+    if (!file_get_size(BENCH_HUGE_PAGES_MESH, &file_size))
+    {
+        return nullptr;
+    }
+    char *source = static_cast<char *>(malloc(file_size + 1));
+    file_open_and_read(BENCH_HUGE_PAGES_MESH, &file_size, source, 0);
+    source[file_size] = '\0';
+
+    u32 positions = 0;
+    u32 normals   = 0;
+    u32 uvs       = 0;
+    for (const char *line = source; line && *line; line = strchr(line, '\n'), line = line ? line + 1 : nullptr)
+    {
+        positions += line[0] == 'v' && line[1] == ' ';
+        normals   += line[0] == 'v' && line[1] == 'n';
+        uvs       += line[0] == 'v' && line[1] == 't';
+    }
+
+    // faces get longer once the indices are offset, leave some room.
+    u64   capacity = (file_size * 2) * BENCH_HUGE_PAGES_COPIES;
+    char *text     = static_cast<char *>(malloc(capacity));
+    u64   size     = 0;
+    for (u32 copy = 0; copy < BENCH_HUGE_PAGES_COPIES; copy++)
+    {
+        u32 target = (copy * 7) % BENCH_HUGE_PAGES_COPIES;
+        for (const char *line = source; line && *line;)
+        {
+            const char *end      = strchr(line, '\n');
+            u64         line_len = end ? static_cast<u64>(end - line) + 1 : strlen(line);
+            if (line[0] == 'f' && line[1] == ' ')
+            {
+                u32 v[9];
+                if (sscanf(line, "f %u/%u/%u %u/%u/%u %u/%u/%u", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6],
+                           &v[7], &v[8]) == 9)
+                {
+                    size += snprintf(text + size, capacity - size, "f %u/%u/%u %u/%u/%u %u/%u/%u\n",
+                                     v[0] + target * positions, v[1] + target * uvs, v[2] + target * normals,
+                                     v[3] + target * positions, v[4] + target * uvs, v[5] + target * normals,
+                                     v[6] + target * positions, v[7] + target * uvs, v[8] + target * normals);
+                }
+            }
+            else
+            {
+                memcpy(text + size, line, line_len);
+                size += line_len;
+            }
+            line = end ? end + 1 : nullptr;
+        }
+    }
+    text[size] = '\0';
+    free(source);
+    *out_size = size;
+    return text;
+}
+
+static void bench_huge_pages_parse(arena *a, const char *text, bench_obj_mesh *mesh)
+{
+    *mesh = {};
+    for (const char *line = text; line && *line; line = strchr(line, '\n'), line = line ? line + 1 : nullptr)
+    {
+        mesh->position_count += line[0] == 'v' && line[1] == ' ';
+        mesh->normal_count   += line[0] == 'v' && line[1] == 'n';
+        mesh->uv_count       += line[0] == 'v' && line[1] == 't';
+        mesh->index_count    += (line[0] == 'f' && line[1] == ' ') ? 9 : 0;
+    }
+    mesh->positions = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * mesh->position_count));
+    mesh->normals   = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * mesh->normal_count));
+    mesh->uvs       = static_cast<vec2 *>(arena_allocate_block(a, sizeof(vec2) * mesh->uv_count));
+    mesh->indices   = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * mesh->index_count));
+
+    u32 p = 0, n = 0, t = 0, f = 0;
+    for (const char *line = text; line && *line; line = strchr(line, '\n'), line = line ? line + 1 : nullptr)
+    {
+        char *next = nullptr;
+        if (line[0] == 'v' && line[1] == ' ')
+        {
+            mesh->positions[p].x   = strtof(line + 2, &next);
+            mesh->positions[p].y   = strtof(next, &next);
+            mesh->positions[p++].z = strtof(next, nullptr);
+        }
+        else if (line[0] == 'v' && line[1] == 'n')
+        {
+            mesh->normals[n].x   = strtof(line + 2, &next);
+            mesh->normals[n].y   = strtof(next, &next);
+            mesh->normals[n++].z = strtof(next, nullptr);
+        }
+        else if (line[0] == 'v' && line[1] == 't')
+        {
+            mesh->uvs[t].x   = strtof(line + 2, &next);
+            mesh->uvs[t++].y = strtof(next, nullptr);
+        }
+        else if (line[0] == 'f' && line[1] == ' ')
+        {
+            const char *c = line + 2;
+            for (u32 i = 0; i < 9; i++)
+            {
+                mesh->indices[f++] = static_cast<u32>(strtoul(c, &next, 10)) - 1;
+                c                  = next + 1;
+            }
+        }
+    }
+}
+
+// de-index into an interleaved vertex buffer, scale + offset the positions and renormalize the normals.
+static void bench_huge_pages_process(const bench_obj_mesh *mesh, bench_vertex *out_vertices)
+{
+    u32 vertex_count = mesh->index_count / 3;
+    for (u32 i = 0; i < vertex_count; i++)
+    {
+        const vec3 &position = mesh->positions[mesh->indices[i * 3 + 0]];
+        const vec2 &uv       = mesh->uvs[mesh->indices[i * 3 + 1]];
+        const vec3 &normal   = mesh->normals[mesh->indices[i * 3 + 2]];
+
+        bench_vertex *v = &out_vertices[i];
+        v->position.x   = position.x * 2.0f + 1.0f;
+        v->position.y   = position.y * 2.0f;
+        v->position.z   = position.z * 2.0f - 1.0f;
+
+        f32 length  = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        f32 inverse = length > 0.0f ? 1.0f / length : 0.0f;
+        v->normal.x = normal.x * inverse;
+        v->normal.y = normal.y * inverse;
+        v->normal.z = normal.z * inverse;
+        v->uv       = uv;
+    }
+}
+
+static u64 bench_huge_pages_anon_huge_bytes()
+{
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f)
+    {
+        return 0;
+    }
+    char               line[256];
+    unsigned long long kib = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "AnonHugePages: %llu kB", &kib) == 1)
+        {
+            break;
+        }
+    }
+    fclose(f);
+    return kib * 1024;
+}
+
+static void bench_huge_pages_mode(arena_huge_page_mode mode, const char *mode_name, const char *source_text,
+                                  u64 text_size)
+{
+    arena_allocate_arena_pool(GB(8), mode);
+    arena *a = arena_get_arena();
+
+    // the text lives in the arena too, the parse reads it once front to back.
+    char *text = static_cast<char *>(arena_allocate_block(a, text_size + 1));
+    memcpy(text, source_text, text_size + 1);
+
+    bench_obj_mesh mesh;
+    arena_marker   before_mesh = arena_get_marker(a);
+    f64            start       = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_HUGE_PAGES_PARSE_ITERATIONS; i++)
+    {
+        arena_pop_to_marker(before_mesh);
+        bench_huge_pages_parse(a, text, &mesh);
+    }
+    f64 parse_elapsed = platform_get_absolute_time() - start;
+
+    bench_vertex *vertices =
+        static_cast<bench_vertex *>(arena_allocate_block(a, sizeof(bench_vertex) * (mesh.index_count / 3)));
+    start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_HUGE_PAGES_VERTEX_ITERATIONS; i++)
+    {
+        bench_huge_pages_process(&mesh, vertices);
+        bench_do_not_optimize(vertices[i % (mesh.index_count / 3)].position.x);
+    }
+    f64 vertex_elapsed = platform_get_absolute_time() - start;
+    u64 huge_bytes     = bench_huge_pages_anon_huge_bytes();
+
+    char name[64];
+    snprintf(name, sizeof(name), "obj_parse_%s", mode_name);
+    bench_report("huge_pages", name, BENCH_HUGE_PAGES_PARSE_ITERATIONS, parse_elapsed);
+    snprintf(name, sizeof(name), "vertex_process_%s", mode_name);
+    bench_report("huge_pages", name, static_cast<u64>(BENCH_HUGE_PAGES_VERTEX_ITERATIONS) * (mesh.index_count / 3),
+                 vertex_elapsed);
+    const char *mode_names[] = {"off", "transparent", "explicit"};
+    printf("# huge_pages %s: parse %.1f MiB/s, %u vertices, pool ended up %s, anon huge pages %.1f MiB\n", mode_name,
+           (static_cast<f64>(text_size) * BENCH_HUGE_PAGES_PARSE_ITERATIONS / MB(1)) / parse_elapsed,
+           mesh.index_count / 3, mode_names[arena_get_huge_page_mode()], static_cast<f64>(huge_bytes) / MB(1));
+
+    arena_free_arena(a);
+    arena_free_arena_pool();
+}
+
+void bench_huge_pages_run()
+{
+    u64   text_size = 0;
+    char *text      = bench_huge_pages_build_text(&text_size);
+    if (!text)
+    {
+        printf("# huge_pages: skipped, run the bench from bin/ so that ../assets resolves\n");
+        return;
+    }
+
+    bench_huge_pages_mode(ARENA_HUGE_PAGES_OFF, "4k_pages", text, text_size);
+    bench_huge_pages_mode(ARENA_HUGE_PAGES_TRANSPARENT, "transparent_huge", text, text_size);
+    bench_huge_pages_mode(ARENA_HUGE_PAGES_EXPLICIT, "explicit_huge", text, text_size);
+    free(text);
+}
@@ -0,0 +1,160 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+void bench_print_header()
+{
+    printf("group,name,iterations,ns_per_op,ops_per_sec\n");
+}
+
+void bench_report(const char *group, const char *name, u64 iterations, f64 elapsed_seconds)
+{
+    f64 ns_per_op   = (elapsed_seconds * 1000000000.0) / static_cast<f64>(iterations);
+    f64 ops_per_sec = static_cast<f64>(iterations) / elapsed_seconds;
+    printf("%s,%s,%llu,%.2f,%.0f\n", group, name, static_cast<unsigned long long>(iterations), ns_per_op, ops_per_sec);
+    fflush(stdout);
+}
+
+static thread_local u64 bench_random_state = 0x9e3779b97f4a7c15ull;
+
+void bench_random_seed(u64 seed)
+{
+    // xorshift never leaves 0.
+    bench_random_state = seed ? seed : 0x9e3779b97f4a7c15ull;
+}
+
+u64 bench_random_u64()
+{
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 7;
+    bench_random_state ^= bench_random_state << 17;
+    return bench_random_state;
+}
+
+f32 bench_random_f32(f32 min, f32 max)
+{
+    f32 t = static_cast<f32>(bench_random_u64() >> 40) / static_cast<f32>(1 << 24);
+    return min + (max - min) * t;
+}
+
+u64 bench_get_rss_bytes()
+{
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+    {
+        return 0;
+    }
+    unsigned long long size     = 0;
+    unsigned long long resident = 0;
+    s32                read     = fscanf(f, "%llu %llu", &size, &resident);
+    fclose(f);
+    return read == 2 ? resident * platform_get_info().page_size : 0;
+}
+
+void bench_reset_peak_rss()
+{
+    // writing 5 to clear_refs resets VmHWM to the current rss (linux 4.0+).
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f)
+    {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+u64 bench_get_peak_rss_bytes()
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+    {
+        return 0;
+    }
+    char               line[256];
+    unsigned long long peak_kib = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "VmHWM: %llu kB", &peak_kib) == 1)
+        {
+            break;
+        }
+    }
+    fclose(f);
+    return peak_kib * 1024;
+}
+
+struct bench_group
+{
+    const char *name;
+    void (*run)();
+};
+
+// same order as the output, huge_pages is last because it needs the main arena pool to be gone.
+static const bench_group bench_groups[] = {
+    {"allocators", bench_allocators_run},
+    {"arenas", bench_arenas_run},
+    {"slab", bench_slab_run},
+    {"dmemory", bench_dmemory_run},
+    {"snapshot", bench_snapshot_run},
+    {"darray", bench_darray_run},
+    {"hashtable", bench_hashtable_run},
+    {"dstring", bench_dstring_run},
+    {"concurrent_hashtable", bench_concurrent_hashtable_run},
+    {"ring_buffer", bench_ring_buffer_run},
+    {"text_scan", bench_text_scan_run},
+    {"number_parse", bench_number_run},
+    {"math", bench_math_run},
+    {"vertex_batch", bench_vertex_batch_run},
+    {"frustum_cull", bench_frustum_run},
+    {"bvh", bench_bvh_run},
+};
+
+// no arguments runs everything, otherwise only the groups named on the command line:
+//   ./learningVulkan_bench darray hashtable dstring
+static bool bench_group_selected(int argc, char **argv, const char *group)
+{
+    if (argc < 2)
+    {
+        return true;
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        if (string_compare(argv[i], group))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    u64 arena_pool_size = GB(64);
+    arena_allocate_arena_pool(arena_pool_size);
+
+    arena *system_arena = arena_get_arena();
+    memory_system_startup(system_arena);
+
+    bench_print_header();
+    for (const bench_group &group : bench_groups)
+    {
+        if (bench_group_selected(argc, argv, group.name))
+        {
+            group.run();
+        }
+    }
+
+    memory_system_shutdown();
+    arena_free_arena(system_arena);
+    arena_free_arena_pool();
+
+    if (bench_group_selected(argc, argv, "huge_pages"))
+    {
+        bench_huge_pages_run();
+    }
+    return 0;
+}
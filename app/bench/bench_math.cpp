@@ -0,0 +1,278 @@
+#include "bench.hpp"
+
+#include "math/dmath.hpp"
+#include "math/dsimd.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+// INFO: the simd math functions against the *_scalar reference versions in dmath.hpp. First a correctness pass over a
+// few thousand random inputs (affine transforms like the ones the engine builds plus general matrices), then every op
+// timed both ways over arrays of inputs so nothing gets folded away. Which backend got compiled in is printed first,
+// build with make bench simd_flags=-mavx2 to get the avx one.
+#define BENCH_MATH_COUNT 1024
+#define BENCH_MATH_PASSES 2000
+#define BENCH_MATH_CHECK_ROUNDS 16
+
+struct bench_math_data
+{
+    mat4 *a;
+    mat4 *b;
+    mat4 *out_matrices;
+    vec4 *vectors;
+    vec4 *out_vectors;
+    vec3 *points;
+    vec3 *out_points;
+};
+
+// rotation * scale * translation, what model and view matrices look like.
+static mat4 bench_math_random_affine()
+{
+    mat4 rotation = mat4_euler_xyz(bench_random_f32(-D_PI, D_PI), bench_random_f32(-D_PI, D_PI),
+                                   bench_random_f32(-D_PI, D_PI));
+    mat4 scale    = mat4_scale(vec3(bench_random_f32(0.25f, 4.0f), bench_random_f32(0.25f, 4.0f),
+                                    bench_random_f32(0.25f, 4.0f)));
+    mat4 translation =
+        mat4_translation(vec3(bench_random_f32(-100, 100), bench_random_f32(-100, 100), bench_random_f32(-100, 100)));
+    return mat4_mul_scalar(mat4_mul_scalar(rotation, scale), translation);
+}
+
+// every entry random, with a heavier diagonal so it stays well away from singular.
+static mat4 bench_math_random_general()
+{
+    mat4 out_matrix;
+    for (u32 i = 0; i < 16; i++)
+    {
+        out_matrix.data[i] = bench_random_f32(-1.0f, 1.0f);
+    }
+    for (u32 i = 0; i < 4; i++)
+    {
+        out_matrix.data[i * 5] += bench_random_f32(2.0f, 4.0f);
+    }
+    return out_matrix;
+}
+
+// biggest difference relative to the biggest magnitude of the reference, what matters for a transform.
+static f32 bench_math_error(const f32 *simd, const f32 *scalar, u32 count)
+{
+    f32 scale = 1.0f;
+    f32 error = 0.0f;
+    for (u32 i = 0; i < count; i++)
+    {
+        scale = fabsf(scalar[i]) > scale ? fabsf(scalar[i]) : scale;
+    }
+    for (u32 i = 0; i < count; i++)
+    {
+        f32 difference = fabsf(simd[i] - scalar[i]);
+        error          = difference > error ? difference : error;
+    }
+    return error / scale;
+}
+
+struct bench_math_check
+{
+    const char *name;
+    f32         tolerance;
+    f32         max_error;
+    u64         failures;
+};
+
+static void bench_math_check_error(bench_math_check *check, f32 error)
+{
+    // a nan anywhere counts as a failure too.
+    if (!(error <= check->tolerance))
+    {
+        check->failures++;
+    }
+    check->max_error = error > check->max_error ? error : check->max_error;
+}
+
+static void bench_math_correctness()
+{
+    bench_math_check checks[] = {
+        {"mat4_mul", 1e-6f, 0, 0},         {"mat4_transposed", 0.0f, 0, 0},     {"mat4_inverse", 1e-5f, 0, 0},
+        {"mat4_inverse_identity", 1e-4f, 0, 0}, {"mat4_mul_vec4", 1e-6f, 0, 0}, {"mat4_transform_point", 1e-6f, 0, 0},
+        {"mat4_transform_vector", 1e-6f, 0, 0}, {"vec3_normalized", 1e-6f, 0, 0}, {"vec4_normalized", 1e-6f, 0, 0},
+        {"quat_mul", 1e-6f, 0, 0},         {"quat_normalize", 1e-6f, 0, 0},     {"mat4_operator_mul", 1e-6f, 0, 0},
+    };
+    u64 cases = 0;
+
+    for (u32 round = 0; round < BENCH_MATH_CHECK_ROUNDS * BENCH_MATH_COUNT; round++)
+    {
+        bool general = round & 1;
+        mat4 a       = general ? bench_math_random_general() : bench_math_random_affine();
+        mat4 b       = general ? bench_math_random_general() : bench_math_random_affine();
+        vec4 v(bench_random_f32(-10, 10), bench_random_f32(-10, 10), bench_random_f32(-10, 10),
+               bench_random_f32(-10, 10));
+        vec3 p(v.x, v.y, v.z);
+        cases++;
+
+        mat4 simd   = mat4_mul(a, b);
+        mat4 scalar = mat4_mul_scalar(a, b);
+        bench_math_check_error(&checks[0], bench_math_error(simd.data, scalar.data, 16));
+
+        simd   = mat4_transposed(a);
+        scalar = mat4_transposed_scalar(a);
+        bench_math_check_error(&checks[1], bench_math_error(simd.data, scalar.data, 16));
+
+        simd   = mat4_inverse(a);
+        scalar = mat4_inverse_scalar(a);
+        bench_math_check_error(&checks[2], bench_math_error(simd.data, scalar.data, 16));
+        // and the simd inverse has to actually invert. The translations are up to 100 and the inverse scales up to 4, so
+        // a few 1e-5 off identity is plain float rounding, the scalar inverse lands there too.
+        mat4 identity;
+        mat4 product = mat4_mul_scalar(a, simd);
+        bench_math_check_error(&checks[3], bench_math_error(product.data, identity.data, 16));
+
+        vec4 simd_vector   = mat4_mul_vec4(a, v);
+        vec4 scalar_vector = mat4_mul_vec4_scalar(a, v);
+        bench_math_check_error(&checks[4], bench_math_error(simd_vector.elements, scalar_vector.elements, 4));
+
+        vec3 simd_point   = mat4_transform_point(a, p);
+        vec3 scalar_point = mat4_transform_point_scalar(a, p);
+        bench_math_check_error(&checks[5], bench_math_error(simd_point.elements, scalar_point.elements, 3));
+
+        simd_point   = mat4_transform_vector(a, p);
+        scalar_point = mat4_transform_vector_scalar(a, p);
+        bench_math_check_error(&checks[6], bench_math_error(simd_point.elements, scalar_point.elements, 3));
+
+        simd_point   = vec3_normalized(p);
+        scalar_point = vec3_normalized_scalar(p);
+        bench_math_check_error(&checks[7], bench_math_error(simd_point.elements, scalar_point.elements, 3));
+
+        simd_vector   = vec4_normalized(v);
+        scalar_vector = vec4_normalized_scalar(v);
+        bench_math_check_error(&checks[8], bench_math_error(simd_vector.elements, scalar_vector.elements, 4));
+
+        quat q_0      = quat_normalize_scalar(v);
+        quat q_1      = quat_from_axis_angle(vec3_normalized_scalar(p), bench_random_f32(-D_PI, D_PI), true);
+        simd_vector   = quat_mul(q_0, q_1);
+        scalar_vector = quat_mul_scalar(q_0, q_1);
+        bench_math_check_error(&checks[9], bench_math_error(simd_vector.elements, scalar_vector.elements, 4));
+
+        simd_vector   = quat_normalize(v);
+        scalar_vector = quat_normalize_scalar(v);
+        bench_math_check_error(&checks[10], bench_math_error(simd_vector.elements, scalar_vector.elements, 4));
+
+        simd   = a * b;
+        scalar = mat4_mul_scalar(a, b);
+        bench_math_check_error(&checks[11], bench_math_error(simd.data, scalar.data, 16));
+    }
+
+    u64 failures = 0;
+    for (const bench_math_check &check : checks)
+    {
+        printf("# math check %s: max relative error %.3g (tolerance %.3g), %llu of %llu over\n", check.name,
+               check.max_error, check.tolerance, static_cast<unsigned long long>(check.failures),
+               static_cast<unsigned long long>(cases));
+        failures += check.failures;
+    }
+    printf("# math: %llu checks failed\n", static_cast<unsigned long long>(failures));
+}
+
+template <typename F> static f64 bench_math_time(const char *name, F op)
+{
+    f64 start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_MATH_PASSES; pass++)
+    {
+        for (u32 i = 0; i < BENCH_MATH_COUNT; i++)
+        {
+            op(i);
+        }
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_report("math", name, static_cast<u64>(BENCH_MATH_COUNT) * BENCH_MATH_PASSES, elapsed);
+    return elapsed;
+}
+
+static void bench_math_speedup(const char *name, f64 scalar_seconds, f64 simd_seconds)
+{
+    printf("# math %s: %.2fx faster than scalar\n", name, scalar_seconds / simd_seconds);
+}
+
+static void bench_math_timings(bench_math_data *d)
+{
+    f64 scalar = bench_math_time("mat4_mul_scalar",
+                                 [d](u32 i) { d->out_matrices[i] = mat4_mul_scalar(d->a[i], d->b[i]); });
+    f64 simd   = bench_math_time("mat4_mul", [d](u32 i) { d->out_matrices[i] = mat4_mul(d->a[i], d->b[i]); });
+    bench_math_speedup("mat4_mul", scalar, simd);
+
+    scalar = bench_math_time("mat4_inverse_scalar", [d](u32 i) { d->out_matrices[i] = mat4_inverse_scalar(d->a[i]); });
+    simd   = bench_math_time("mat4_inverse", [d](u32 i) { d->out_matrices[i] = mat4_inverse(d->a[i]); });
+    bench_math_speedup("mat4_inverse", scalar, simd);
+
+    scalar = bench_math_time("mat4_transposed_scalar",
+                             [d](u32 i) { d->out_matrices[i] = mat4_transposed_scalar(d->a[i]); });
+    simd   = bench_math_time("mat4_transposed", [d](u32 i) { d->out_matrices[i] = mat4_transposed(d->a[i]); });
+    bench_math_speedup("mat4_transposed", scalar, simd);
+
+    scalar = bench_math_time("mat4_mul_vec4_scalar",
+                             [d](u32 i) { d->out_vectors[i] = mat4_mul_vec4_scalar(d->a[i], d->vectors[i]); });
+    simd   = bench_math_time("mat4_mul_vec4", [d](u32 i) { d->out_vectors[i] = mat4_mul_vec4(d->a[i], d->vectors[i]); });
+    bench_math_speedup("mat4_mul_vec4", scalar, simd);
+
+    scalar = bench_math_time("mat4_transform_point_scalar",
+                             [d](u32 i) { d->out_points[i] = mat4_transform_point_scalar(d->a[i], d->points[i]); });
+    simd   = bench_math_time("mat4_transform_point",
+                             [d](u32 i) { d->out_points[i] = mat4_transform_point(d->a[i], d->points[i]); });
+    bench_math_speedup("mat4_transform_point", scalar, simd);
+
+    scalar = bench_math_time("mat4_transform_vector_scalar",
+                             [d](u32 i) { d->out_points[i] = mat4_transform_vector_scalar(d->a[i], d->points[i]); });
+    simd   = bench_math_time("mat4_transform_vector",
+                             [d](u32 i) { d->out_points[i] = mat4_transform_vector(d->a[i], d->points[i]); });
+    bench_math_speedup("mat4_transform_vector", scalar, simd);
+
+    scalar = bench_math_time("vec3_normalized_scalar",
+                             [d](u32 i) { d->out_points[i] = vec3_normalized_scalar(d->points[i]); });
+    simd   = bench_math_time("vec3_normalized", [d](u32 i) { d->out_points[i] = vec3_normalized(d->points[i]); });
+    bench_math_speedup("vec3_normalized", scalar, simd);
+
+    scalar = bench_math_time("vec4_normalized_scalar",
+                             [d](u32 i) { d->out_vectors[i] = vec4_normalized_scalar(d->vectors[i]); });
+    simd   = bench_math_time("vec4_normalized", [d](u32 i) { d->out_vectors[i] = vec4_normalized(d->vectors[i]); });
+    bench_math_speedup("vec4_normalized", scalar, simd);
+
+    // the vectors double as quaternions, only the timing matters here.
+    scalar = bench_math_time("quat_mul_scalar", [d](u32 i) {
+        d->out_vectors[i] = quat_mul_scalar(d->vectors[i], d->vectors[(i + 1) % BENCH_MATH_COUNT]);
+    });
+    simd   = bench_math_time("quat_mul", [d](u32 i) {
+        d->out_vectors[i] = quat_mul(d->vectors[i], d->vectors[(i + 1) % BENCH_MATH_COUNT]);
+    });
+    bench_math_speedup("quat_mul", scalar, simd);
+
+    bench_do_not_optimize(d->out_matrices);
+    bench_do_not_optimize(d->out_vectors);
+    bench_do_not_optimize(d->out_points);
+}
+
+void bench_math_run()
+{
+    bench_random_seed(0x2545f4914f6cdd1dull);
+    printf("# math: simd backend %s\n", DSIMD_BACKEND_NAME);
+    bench_math_correctness();
+
+    arena          *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_math_data data;
+    data.a            = static_cast<mat4 *>(arena_allocate_block(a, sizeof(mat4) * BENCH_MATH_COUNT));
+    data.b            = static_cast<mat4 *>(arena_allocate_block(a, sizeof(mat4) * BENCH_MATH_COUNT));
+    data.out_matrices = static_cast<mat4 *>(arena_allocate_block(a, sizeof(mat4) * BENCH_MATH_COUNT));
+    data.vectors      = static_cast<vec4 *>(arena_allocate_block(a, sizeof(vec4) * BENCH_MATH_COUNT));
+    data.out_vectors  = static_cast<vec4 *>(arena_allocate_block(a, sizeof(vec4) * BENCH_MATH_COUNT));
+    data.points       = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * BENCH_MATH_COUNT));
+    data.out_points   = static_cast<vec3 *>(arena_allocate_block(a, sizeof(vec3) * BENCH_MATH_COUNT));
+    for (u32 i = 0; i < BENCH_MATH_COUNT; i++)
+    {
+        data.a[i]       = bench_math_random_affine();
+        data.b[i]       = bench_math_random_affine();
+        data.vectors[i] = vec4(bench_random_f32(-10, 10), bench_random_f32(-10, 10), bench_random_f32(-10, 10),
+                               bench_random_f32(-10, 10));
+        data.points[i]  = vec3(data.vectors[i].x, data.vectors[i].y, data.vectors[i].z);
+    }
+
+    bench_math_timings(&data);
+
+    arena_free_arena(a);
+}
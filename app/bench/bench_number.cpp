@@ -0,0 +1,322 @@
+#include "bench.hpp"
+
+#include "core/dfile_system.hpp"
+#include "core/dnumber.hpp"
+#include "core/dstring.hpp"
+#include "core/dtext_scan.hpp"
+#include "containers/darray.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// INFO: number_parse_* against strtof/strtol on every number in the obj files of assets/meshes, plus a check that the
+// floats come out bit for bit the same as strtof for the asset numbers and for a pile of generated hard cases
+// (round trip digits, exact halfway points between floats, subnormals, very long digit strings).
+#define BENCH_NUMBER_PASSES 20
+#define BENCH_NUMBER_RANDOM_CASES 200000
+
+static const char *bench_number_files[] = {
+    "../assets/meshes/cube.obj",   "../assets/meshes/cone.obj",      "../assets/meshes/cylinder.obj",
+    "../assets/meshes/arrow.obj",  "../assets/meshes/torus.obj",     "../assets/meshes/sphere.obj",
+    "../assets/meshes/battle_damaged_helmet.obj", "../assets/materials/sponza.mtl",
+};
+
+struct bench_number_tokens
+{
+    // the float fields of v/vn/vt lines (and mtl colors), the vertex lines themselves and the corners of f lines.
+    darray<dstring_view> floats;
+    darray<dstring_view> vertex_lines;
+    darray<dstring_view> corners;
+    u64                  float_bytes;
+    u64                  corner_bytes;
+};
+
+static bool bench_number_same_bits(f32 a, f32 b)
+{
+    if (a != a && b != b)
+    {
+        return true;
+    }
+    return memcmp(&a, &b, sizeof(f32)) == 0;
+}
+
+// text has to be '\0' terminated for strtof.
+static bool bench_number_check(const char *text)
+{
+    f32 expected = strtof(text, nullptr);
+    f32 parsed   = -1.0f;
+    u64 used     = number_parse_f32(dstring_view(text), &parsed);
+    return used && bench_number_same_bits(expected, parsed);
+}
+
+static void bench_number_collect(char *file, u64 length, bench_number_tokens *tokens)
+{
+    text_line_reader lines(file, length);
+    dstring_view     line;
+    while (lines.next(&line))
+    {
+        dstring_view rest    = line;
+        dstring_view keyword = text_next_token(&rest);
+        bool         vertex  = keyword == "v" || keyword == "vn" || keyword == "vt";
+        if (vertex || keyword == "Kd" || keyword == "Ka" || keyword == "Ks" || keyword == "Ns")
+        {
+            if (vertex)
+            {
+                tokens->vertex_lines.push_back(rest);
+            }
+            dstring_view token;
+            while ((token = text_next_token(&rest)).length)
+            {
+                tokens->floats.push_back(token);
+                tokens->float_bytes += token.length;
+            }
+        }
+        else if (keyword == "f")
+        {
+            dstring_view token;
+            while ((token = text_next_token(&rest)).length)
+            {
+                tokens->corners.push_back(token);
+                tokens->corner_bytes += token.length;
+            }
+        }
+    }
+}
+
+static void bench_number_report(const char *name, u64 count, u64 bytes, f64 elapsed_seconds)
+{
+    bench_report("number_parse", name, count * BENCH_NUMBER_PASSES, elapsed_seconds);
+    printf("# number_parse %s: %.0f MB/s\n", name,
+           static_cast<f64>(bytes) * BENCH_NUMBER_PASSES / 1000000.0 / elapsed_seconds);
+}
+
+static void bench_number_throughput(bench_number_tokens *tokens)
+{
+    u64 count = tokens->floats.size();
+    f64 sum   = 0;
+
+    // the tokens point into the '\0' terminated file buffers and end in a space or a line end, strtof stops there.
+    f64 start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < count; i++)
+        {
+            sum += strtof(tokens->floats[i].data, nullptr);
+        }
+    }
+    bench_number_report("f32_strtof", count, tokens->float_bytes, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < count; i++)
+        {
+            f32 value = 0;
+            number_parse_f32(tokens->floats[i], &value);
+            sum += value;
+        }
+    }
+    bench_number_report("f32_number_parse", count, tokens->float_bytes, platform_get_absolute_time() - start);
+
+    // whole "x y z" vertex lines, the way the obj parser reads them.
+    u64 lines      = tokens->vertex_lines.size();
+    u64 line_bytes = 0;
+    for (u64 i = 0; i < lines; i++)
+    {
+        line_bytes += tokens->vertex_lines[i].length;
+    }
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < lines; i++)
+        {
+            char *end = const_cast<char *>(tokens->vertex_lines[i].data);
+            f32   x   = strtof(end, &end);
+            f32   y   = strtof(end, &end);
+            f32   z   = strtof(end, &end);
+            sum      += x + y + z;
+        }
+    }
+    bench_number_report("vertex_line_strtof", lines, line_bytes, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < lines; i++)
+        {
+            dstring_view line      = tokens->vertex_lines[i];
+            f32          values[3] = {};
+            number_parse_f32s(&line, values, 3);
+            sum += values[0] + values[1] + values[2];
+        }
+    }
+    bench_number_report("vertex_line_number_parse", lines, line_bytes, platform_get_absolute_time() - start);
+
+    // the first index of every face corner, strtol stops at the '/'.
+    u64 corners = tokens->corners.size();
+    s64 indices = 0;
+    start       = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < corners; i++)
+        {
+            indices += strtol(tokens->corners[i].data, nullptr, 10);
+        }
+    }
+    bench_number_report("index_strtol", corners, tokens->corner_bytes, platform_get_absolute_time() - start);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_NUMBER_PASSES; pass++)
+    {
+        for (u64 i = 0; i < corners; i++)
+        {
+            s64 value = 0;
+            number_parse_s64(tokens->corners[i], &value);
+            indices += value;
+        }
+    }
+    bench_number_report("index_number_parse", corners, tokens->corner_bytes, platform_get_absolute_time() - start);
+
+    bench_do_not_optimize(sum);
+    bench_do_not_optimize(indices);
+}
+
+// the generated cases, returns how many didnt match strtof.
+static u64 bench_number_check_generated(u64 *out_cases)
+{
+    char text[256];
+    u64  wrong = 0;
+    u64  cases = 0;
+    auto check = [&](const char *string) {
+        cases++;
+        if (!bench_number_check(string))
+        {
+            if (wrong < 5)
+            {
+                f32 parsed = 0;
+                number_parse_f32(dstring_view(string), &parsed);
+                printf("# number_parse: %s -> %.9g, strtof %.9g\n", string, parsed, strtof(string, nullptr));
+            }
+            wrong++;
+        }
+    };
+
+    const char *fixed[] = {"0",        "-0",        "1",         "-1.5",      "3.4028235e38", "3.4028236e38",
+                           "1e39",     "1e-46",     "1e-45",     "1.4e-45",   "7.006492e-46", "7.006493e-46",
+                           "1.17549435e-38", "123456789012345678901234567890", "0.000000000000000000000000000001",
+                           "inf",      "-Infinity", "nan",       "1.e5",      ".5",           "5.",
+                           "16777217", "16777216.5", "33554435", "1e", "1e+", "2.5E-3"};
+    for (const char *string : fixed)
+    {
+        check(string);
+    }
+
+    for (u32 i = 0; i < BENCH_NUMBER_RANDOM_CASES; i++)
+    {
+        u32 bits = static_cast<u32>(bench_random_u64());
+        if ((bits & 0x7F800000) == 0x7F800000)
+        {
+            continue;
+        }
+        f32 value;
+        memcpy(&value, &bits, sizeof(value));
+
+        // round trip digits, fewer digits and the double with all of its digits.
+        snprintf(text, sizeof(text), "%.9g", value);
+        check(text);
+        snprintf(text, sizeof(text), "%.6g", value);
+        check(text);
+        snprintf(text, sizeof(text), "%.17g", static_cast<f64>(value));
+        check(text);
+
+        // exactly halfway to the next float (a double can hold that), then a hair above and below it.
+        u32 next_bits = bits + 1;
+        if ((next_bits & 0x7F800000) == 0x7F800000)
+        {
+            continue;
+        }
+        f32 next;
+        memcpy(&next, &next_bits, sizeof(next));
+        f64 halfway = (static_cast<f64>(value) + static_cast<f64>(next)) / 2.0;
+        snprintf(text, sizeof(text), "%.150e", halfway);
+        check(text);
+        snprintf(text, sizeof(text), "%.25e", halfway);
+        check(text);
+        snprintf(text, sizeof(text), "%.17g", nextafter(halfway, 0.0));
+        check(text);
+        snprintf(text, sizeof(text), "%.17g", nextafter(halfway, halfway * 2.0));
+        check(text);
+    }
+
+    // a short simple number buried in a lot of digits.
+    for (u32 i = 0; i < 1000; i++)
+    {
+        u32 digits = 20 + static_cast<u32>(bench_random_u64() % 200);
+        u32 length = 0;
+        text[length++] = static_cast<char>('1' + bench_random_u64() % 9);
+        text[length++] = '.';
+        for (u32 d = 0; d < digits && length < sizeof(text) - 8; d++)
+        {
+            text[length++] = static_cast<char>('0' + bench_random_u64() % 10);
+        }
+        length += snprintf(text + length, sizeof(text) - length, "e%d", static_cast<s32>(bench_random_u64() % 90) - 50);
+        check(text);
+    }
+
+    *out_cases = cases;
+    return wrong;
+}
+
+void bench_number_run()
+{
+    bench_random_seed(0x9e3779b97f4a7c15ull);
+    arena              *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_number_tokens tokens;
+    tokens.floats.c_init(a);
+    tokens.vertex_lines.c_init(a);
+    tokens.corners.c_init(a);
+    tokens.float_bytes  = 0;
+    tokens.corner_bytes = 0;
+
+    for (const char *path : bench_number_files)
+    {
+        u64 size = 0;
+        if (!file_get_size(path, &size))
+        {
+            printf("# number_parse: couldnt open %s, skipping it\n", path);
+            continue;
+        }
+        char *file = static_cast<char *>(arena_allocate_block(a, size + 1));
+        file_open_and_read(path, &size, file, 1);
+        file[size] = '\0';
+        bench_number_collect(file, size, &tokens);
+    }
+    printf("# number_parse: %llu floats, %llu vertex lines, %llu face corners from the assets\n",
+           static_cast<unsigned long long>(tokens.floats.size()),
+           static_cast<unsigned long long>(tokens.vertex_lines.size()),
+           static_cast<unsigned long long>(tokens.corners.size()));
+
+    if (tokens.floats.size())
+    {
+        bench_number_throughput(&tokens);
+    }
+
+    // every asset number has to come out bit for bit like strtof.
+    u64 asset_wrong = 0;
+    for (u64 i = 0; i < tokens.floats.size(); i++)
+    {
+        f32 parsed = 0;
+        number_parse_f32(tokens.floats[i], &parsed);
+        asset_wrong += !bench_number_same_bits(parsed, strtof(tokens.floats[i].data, nullptr));
+    }
+    u64 generated       = 0;
+    u64 generated_wrong = bench_number_check_generated(&generated);
+    printf("# number_parse: %llu of %llu asset floats and %llu of %llu generated cases differ from strtof\n",
+           static_cast<unsigned long long>(asset_wrong), static_cast<unsigned long long>(tokens.floats.size()),
+           static_cast<unsigned long long>(generated_wrong), static_cast<unsigned long long>(generated));
+
+    arena_free_arena(a);
+}
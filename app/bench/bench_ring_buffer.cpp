@@ -0,0 +1,223 @@
+#include "bench.hpp"
+
+#include "containers/dring_buffer.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+// INFO: the rings against a mutex guarded ring, which is what a queue between threads would be without them. Every run
+// checks that what came out is exactly what went in (order too, for the spsc ring). A side that finds the ring
+// full/empty yields, on a machine with less cores than threads that is what moves things forward.
+#define BENCH_RING_CAPACITY 1024
+#define BENCH_RING_ITEMS 2000000
+#define BENCH_RING_ROUND_TRIPS 20000
+#define BENCH_RING_MPMC_THREADS 2
+
+struct bench_locked_ring
+{
+    std::mutex lock;
+    u64       *buffer;
+    u64        mask;
+    u64        head;
+    u64        tail;
+
+    void init(arena *a, u64 capacity)
+    {
+        buffer = static_cast<u64 *>(arena_allocate_block(a, sizeof(u64) * capacity));
+        mask   = capacity - 1;
+        head   = 0;
+        tail   = 0;
+    }
+    bool try_push(const u64 &element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (tail - head > mask)
+        {
+            return false;
+        }
+        buffer[tail++ & mask] = element;
+        return true;
+    }
+    bool try_pop(u64 *out_element)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (head == tail)
+        {
+            return false;
+        }
+        *out_element = buffer[head++ & mask];
+        return true;
+    }
+};
+
+template <typename ring> static inline void bench_ring_push(ring *r, u64 value)
+{
+    while (!r->try_push(value))
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename ring> static inline u64 bench_ring_pop(ring *r)
+{
+    u64 value = 0;
+    while (!r->try_pop(&value))
+    {
+        std::this_thread::yield();
+    }
+    return value;
+}
+
+template <typename ring> static void bench_ring_producer(ring *r, u64 first, u64 count)
+{
+    for (u64 i = 0; i < count; i++)
+    {
+        bench_ring_push(r, first + i);
+    }
+}
+
+// one producer thread, the calling thread consumes.
+template <typename ring> static void bench_ring_one_to_one(ring *r, const char *name)
+{
+    f64         start    = platform_get_absolute_time();
+    std::thread producer = std::thread(bench_ring_producer<ring>, r, 0, BENCH_RING_ITEMS);
+    u64         out_of_order = 0;
+    for (u64 i = 0; i < BENCH_RING_ITEMS; i++)
+    {
+        out_of_order += bench_ring_pop(r) != i;
+    }
+    producer.join();
+    bench_report("ring_buffer", name, BENCH_RING_ITEMS, platform_get_absolute_time() - start);
+    if (out_of_order)
+    {
+        printf("# ring_buffer %s: %llu items out of order\n", name, static_cast<unsigned long long>(out_of_order));
+    }
+}
+
+template <typename ring> static void bench_ring_consumer(ring *r, u64 count, u64 *out_sum)
+{
+    u64 sum = 0;
+    for (u64 i = 0; i < count; i++)
+    {
+        sum += bench_ring_pop(r);
+    }
+    *out_sum = sum;
+}
+
+template <typename ring> static void bench_ring_many_to_many(ring *r, const char *name)
+{
+    u64         per_thread = BENCH_RING_ITEMS / BENCH_RING_MPMC_THREADS;
+    u64         sums[BENCH_RING_MPMC_THREADS];
+    std::thread producers[BENCH_RING_MPMC_THREADS];
+    std::thread consumers[BENCH_RING_MPMC_THREADS];
+
+    f64 start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_RING_MPMC_THREADS; i++)
+    {
+        consumers[i] = std::thread(bench_ring_consumer<ring>, r, per_thread, &sums[i]);
+        producers[i] = std::thread(bench_ring_producer<ring>, r, i * per_thread, per_thread);
+    }
+    u64 sum = 0;
+    for (u32 i = 0; i < BENCH_RING_MPMC_THREADS; i++)
+    {
+        producers[i].join();
+        consumers[i].join();
+        sum += sums[i];
+    }
+    bench_report("ring_buffer", name, per_thread * BENCH_RING_MPMC_THREADS, platform_get_absolute_time() - start);
+
+    // every value 0..n-1 went in exactly once.
+    u64 n = per_thread * BENCH_RING_MPMC_THREADS;
+    if (sum != (n * (n - 1)) / 2)
+    {
+        printf("# ring_buffer %s: items lost or duplicated\n", name);
+    }
+}
+
+template <typename ring> static void bench_ring_echo(ring *in, ring *out)
+{
+    for (u64 i = 0; i < BENCH_RING_ROUND_TRIPS; i++)
+    {
+        bench_ring_push(out, bench_ring_pop(in) + 1);
+    }
+}
+
+// latency: one item goes to the other thread and comes back, nothing else is in flight.
+template <typename ring> static void bench_ring_round_trip(ring *to_echo, ring *from_echo, const char *name)
+{
+    std::thread echo  = std::thread(bench_ring_echo<ring>, to_echo, from_echo);
+    f64         start = platform_get_absolute_time();
+    u64         wrong = 0;
+    for (u64 i = 0; i < BENCH_RING_ROUND_TRIPS; i++)
+    {
+        bench_ring_push(to_echo, i);
+        wrong += bench_ring_pop(from_echo) != i + 1;
+    }
+    bench_report("ring_buffer", name, BENCH_RING_ROUND_TRIPS, platform_get_absolute_time() - start);
+    echo.join();
+    if (wrong)
+    {
+        printf("# ring_buffer %s: %llu wrong replies\n", name, static_cast<unsigned long long>(wrong));
+    }
+}
+
+// push + pop on one thread, the cost of the ring itself without any cache line moving between cores.
+template <typename ring> static void bench_ring_uncontended(ring *r, const char *name)
+{
+    u64 sum   = 0;
+    f64 start = platform_get_absolute_time();
+    for (u64 i = 0; i < BENCH_RING_ITEMS; i++)
+    {
+        r->try_push(i);
+        u64 value = 0;
+        r->try_pop(&value);
+        sum += value;
+    }
+    bench_report("ring_buffer", name, BENCH_RING_ITEMS, platform_get_absolute_time() - start);
+    bench_do_not_optimize(sum);
+}
+
+void bench_ring_buffer_run()
+{
+    arena *a = arena_get_arena();
+
+    dspsc_ring<u64> spsc;
+    dspsc_ring<u64> spsc_back;
+    spsc.init(a, BENCH_RING_CAPACITY);
+    spsc_back.init(a, BENCH_RING_CAPACITY);
+    dmpmc_ring<u64> mpmc;
+    dmpmc_ring<u64> mpmc_back;
+    mpmc.init(a, BENCH_RING_CAPACITY);
+    mpmc_back.init(a, BENCH_RING_CAPACITY);
+    bench_locked_ring *locked      = new bench_locked_ring();
+    bench_locked_ring *locked_back = new bench_locked_ring();
+    locked->init(a, BENCH_RING_CAPACITY);
+    locked_back->init(a, BENCH_RING_CAPACITY);
+
+    bench_ring_uncontended(&spsc, "push_pop_1_thread_spsc");
+    bench_ring_uncontended(&mpmc, "push_pop_1_thread_mpmc");
+    bench_ring_uncontended(locked, "push_pop_1_thread_mutex");
+
+    bench_ring_one_to_one(&spsc, "1_producer_1_consumer_spsc");
+    bench_ring_one_to_one(&mpmc, "1_producer_1_consumer_mpmc");
+    bench_ring_one_to_one(locked, "1_producer_1_consumer_mutex");
+
+    bench_ring_many_to_many(&mpmc, "2_producers_2_consumers_mpmc");
+    bench_ring_many_to_many(locked, "2_producers_2_consumers_mutex");
+
+    bench_ring_round_trip(&spsc, &spsc_back, "round_trip_spsc");
+    bench_ring_round_trip(&mpmc, &mpmc_back, "round_trip_mpmc");
+    bench_ring_round_trip(locked, locked_back, "round_trip_mutex");
+
+    delete locked;
+    delete locked_back;
+    spsc.destroy();
+    spsc_back.destroy();
+    mpmc.destroy();
+    mpmc_back.destroy();
+    arena_free_arena(a);
+}
@@ -0,0 +1,70 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "memory/arenas.hpp"
+#include "memory/slab_allocator.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+#define BENCH_SLAB_CONTAINERS 256
+#define BENCH_SLAB_ROUNDS 64
+
+// what the containers do: start at 10 elements and double on every growth, copy over and dfree the old block. Every
+// round builds BENCH_SLAB_CONTAINERS arrays up to 2560 u64's (20 KiB) and then frees all of them.
+static void bench_slab_container_workload(bool slab_backed)
+{
+    arena *a       = arena_get_arena();
+    a->slab_backed = slab_backed;
+
+    void *blocks[BENCH_SLAB_CONTAINERS];
+    u64   sizes[BENCH_SLAB_CONTAINERS];
+    u64   operations = 0;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 round = 0; round < BENCH_SLAB_ROUNDS; round++)
+    {
+        for (u32 i = 0; i < BENCH_SLAB_CONTAINERS; i++)
+        {
+            sizes[i]  = 10 * sizeof(u64);
+            blocks[i] = dallocate(a, sizes[i], MEM_TAG_DARRAY);
+            operations++;
+        }
+        for (u32 growth = 0; growth < 8; growth++)
+        {
+            for (u32 i = 0; i < BENCH_SLAB_CONTAINERS; i++)
+            {
+                void *grown = dallocate(a, sizes[i] * 2, MEM_TAG_DARRAY);
+                dcopy_memory(grown, blocks[i], sizes[i]);
+                dfree(blocks[i], sizes[i], MEM_TAG_DARRAY);
+                blocks[i]  = grown;
+                sizes[i]  *= 2;
+                operations += 2;
+            }
+        }
+        for (u32 i = 0; i < BENCH_SLAB_CONTAINERS; i++)
+        {
+            dfree(blocks[i], sizes[i], MEM_TAG_DARRAY);
+            operations++;
+        }
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+
+    bench_report("slab", slab_backed ? "container_growth_slab" : "container_growth_arena_only", operations, elapsed);
+    // with the slab the arena itself stays empty, all the blocks live in the slab's spans.
+    printf("# %s: arena used %llu KiB after %d rounds\n", slab_backed ? "slab" : "arena only",
+           static_cast<unsigned long long>(a->allocated / 1024), BENCH_SLAB_ROUNDS);
+    arena_free_arena(a);
+}
+
+void bench_slab_run()
+{
+    bench_slab_container_workload(false);
+    bench_slab_container_workload(true);
+
+    u64  buffer_size = 0;
+    char buffer[4096];
+    get_memory_slab_usg_str(&buffer_size, static_cast<char *>(0));
+    get_memory_slab_usg_str(&buffer_size, buffer);
+    printf("# %s", buffer);
+}
@@ -0,0 +1,124 @@
+#include "bench.hpp"
+
+#include "core/dfile_system.hpp"
+#include "memory/arena_snapshot.hpp"
+#include "platform/platform.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "vendor/stb_image.h"
+
+#include <cstdio>
+
+// INFO: same set of textures the app decodes during application_initialize (the default skybox) plus a couple of
+// material textures. The cold run is what startup costs without a snapshot (stbi decode + recording), the warm run is
+// what it costs with one (map the file + look up every texture + touch every page like the staging upload would).
+static const char *bench_snapshot_textures[] = {
+    "../assets/textures/front.jpg",       "../assets/textures/left.jpg",   "../assets/textures/right.jpg",
+    "../assets/textures/top.jpg",         "../assets/textures/back.jpg",   "../assets/textures/bottom.jpg",
+    "../assets/textures/cobblestone.png", "../assets/textures/default.png"};
+
+#define BENCH_SNAPSHOT_PATH "bench_resource_snapshot.bin"
+
+static u32 bench_snapshot_num_textures()
+{
+    return sizeof(bench_snapshot_textures) / sizeof(bench_snapshot_textures[0]);
+}
+
+static bool bench_snapshot_cold_load()
+{
+    arena_snapshot_open(BENCH_SNAPSHOT_PATH);
+    for (u32 i = 0; i < bench_snapshot_num_textures(); i++)
+    {
+        const char           *path   = bench_snapshot_textures[i];
+        arena_snapshot_source source = arena_snapshot_source_of(path);
+
+        s32      width    = 0;
+        s32      height   = 0;
+        s32      channels = 0;
+        stbi_uc *pixels   = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            printf("# snapshot: couldnt decode %s: %s\n", path, stbi_failure_reason());
+            arena_snapshot_close();
+            return false;
+        }
+        u32 params[4] = {static_cast<u32>(width), static_cast<u32>(height), static_cast<u32>(channels), 0};
+        arena_snapshot_add(SNAPSHOT_ENTRY_TEXTURE_PIXELS, path, source, params, pixels,
+                           static_cast<u64>(width) * height * 4);
+        bench_do_not_optimize(pixels[0]);
+        stbi_image_free(pixels);
+    }
+    arena_snapshot_close();
+    return true;
+}
+
+static bool bench_snapshot_warm_load()
+{
+    if (!arena_snapshot_open(BENCH_SNAPSHOT_PATH))
+    {
+        arena_snapshot_close();
+        return false;
+    }
+    u64 page_size = platform_get_info().page_size;
+    u64 checksum  = 0;
+    for (u32 i = 0; i < bench_snapshot_num_textures(); i++)
+    {
+        const char           *path   = bench_snapshot_textures[i];
+        arena_snapshot_source source = arena_snapshot_source_of(path);
+
+        u32       params[4] = {0};
+        u64       size      = 0;
+        const u8 *pixels    = static_cast<const u8 *>(
+            arena_snapshot_find(SNAPSHOT_ENTRY_TEXTURE_PIXELS, path, source, params, &size));
+        if (!pixels)
+        {
+            arena_snapshot_close();
+            return false;
+        }
+        for (u64 offset = 0; offset < size; offset += page_size)
+        {
+            checksum += pixels[offset];
+        }
+    }
+    bench_do_not_optimize(checksum);
+    arena_snapshot_close();
+    return true;
+}
+
+void bench_snapshot_run()
+{
+    file_delete(BENCH_SNAPSHOT_PATH);
+
+    const u64 cold_iterations = 3;
+    f64       start           = platform_get_absolute_time();
+    for (u64 i = 0; i < cold_iterations; i++)
+    {
+        file_delete(BENCH_SNAPSHOT_PATH);
+        if (!bench_snapshot_cold_load())
+        {
+            printf("# snapshot: skipped, run the bench from bin/ so that ../assets resolves\n");
+            return;
+        }
+    }
+    bench_report("snapshot", "texture_set_stbi_decode_and_record", cold_iterations,
+                 platform_get_absolute_time() - start);
+
+    const u64 warm_iterations = 50;
+    start                     = platform_get_absolute_time();
+    for (u64 i = 0; i < warm_iterations; i++)
+    {
+        if (!bench_snapshot_warm_load())
+        {
+            printf("# snapshot: warm load missed\n");
+            return;
+        }
+    }
+    bench_report("snapshot", "texture_set_snapshot_map_and_lookup", warm_iterations,
+                 platform_get_absolute_time() - start);
+
+    u64 snapshot_size = 0;
+    file_get_size(BENCH_SNAPSHOT_PATH, &snapshot_size);
+    printf("# snapshot: %u textures, %llu bytes on disk\n", bench_snapshot_num_textures(),
+           static_cast<unsigned long long>(snapshot_size));
+    file_delete(BENCH_SNAPSHOT_PATH);
+}
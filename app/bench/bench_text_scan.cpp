@@ -0,0 +1,340 @@
+#include "bench.hpp"
+
+#include "core/dfile_system.hpp"
+#include "core/dstring.hpp"
+#include "core/dtext_scan.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+// INFO: the text scanner over every obj in assets/meshes, once per level the cpu supports, against what the parsers
+// did before it (strstr/strchr walks over a '\0' terminated buffer). Every case also prints its throughput in MB/s of
+// obj text, and the counts of every level are checked against the scalar one.
+#define BENCH_TEXT_SCAN_PASSES 50
+#define BENCH_TEXT_SCAN_MAX_FILES 16
+
+static const char *bench_text_scan_meshes[] = {"cube.obj",  "cone.obj",  "cylinder.obj",
+                                               "arrow.obj", "torus.obj", "sphere.obj",
+                                               "battle_damaged_helmet.obj"};
+
+struct bench_text_file
+{
+    char *data;
+    u64   length;
+};
+
+struct bench_text_files
+{
+    bench_text_file files[BENCH_TEXT_SCAN_MAX_FILES];
+    u32             count;
+    u64             total_bytes;
+};
+
+// what a pass over all the files counted, every way of getting there has to end up with the same numbers.
+struct bench_obj_counts
+{
+    u64 lines;
+    u64 positions;
+    u64 normals;
+    u64 tex_coords;
+    u64 faces;
+    u64 objects;
+    u64 usemtls;
+
+    bool operator==(const bench_obj_counts &other) const
+    {
+        return memcmp(this, &other, sizeof(bench_obj_counts)) == 0;
+    }
+};
+
+static void bench_text_scan_report(const char *name, f64 elapsed_seconds, const bench_text_files *files)
+{
+    bench_report("text_scan", name, BENCH_TEXT_SCAN_PASSES, elapsed_seconds);
+    f64 megabytes = static_cast<f64>(files->total_bytes) * BENCH_TEXT_SCAN_PASSES / 1000000.0;
+    printf("# text_scan %s: %.0f MB/s\n", name, megabytes / elapsed_seconds);
+}
+
+// newlines with strchr, how the old line walks found the end of a line.
+static u64 bench_count_newlines_strchr(const bench_text_file *file)
+{
+    u64         count = 0;
+    const char *ptr   = file->data;
+    while ((ptr = strchr(ptr, '\n')) != nullptr)
+    {
+        count++;
+        ptr++;
+    }
+    return count;
+}
+
+// the six whole buffer substring counts geometry_system_parse_obj did before it went line based. They count
+// "v " inside "usemtl" lines and such, so only the time is compared, not the numbers.
+static u64 bench_obj_substring_counts(const bench_text_file *file)
+{
+    const char *keys[] = {"o ", "usemtl", "v ", "vn", "vt", "f "};
+    u64         sum    = 0;
+    for (const char *key : keys)
+    {
+        sum += string_num_of_substring_occurence(file->data, key);
+    }
+    return sum;
+}
+
+// what the parser does now: one pass over the lines, classified by their first token.
+static void bench_obj_classify_lines(const bench_text_file *file, bench_obj_counts *counts)
+{
+    text_line_reader lines(file->data, file->length);
+    dstring_view     line;
+    while (lines.next(&line))
+    {
+        counts->lines++;
+        dstring_view keyword  = text_next_token(&line);
+        counts->positions    += keyword == "v";
+        counts->normals      += keyword == "vn";
+        counts->tex_coords   += keyword == "vt";
+        counts->faces        += keyword == "f";
+        counts->objects      += keyword == "o";
+        counts->usemtls      += keyword == "usemtl";
+    }
+}
+
+static void bench_obj_count_keywords(const bench_text_file *file, bench_obj_counts *counts)
+{
+    // a file that doesnt end in a '\n' still has a last line.
+    counts->lines      += text_count_char(file->data, file->length, '\n') +
+                     (file->length && file->data[file->length - 1] != '\n');
+    counts->positions  += text_count_keyword(file->data, file->length, "v");
+    counts->normals    += text_count_keyword(file->data, file->length, "vn");
+    counts->tex_coords += text_count_keyword(file->data, file->length, "vt");
+    counts->faces      += text_count_keyword(file->data, file->length, "f");
+    counts->objects    += text_count_keyword(file->data, file->length, "o");
+    counts->usemtls    += text_count_keyword(file->data, file->length, "usemtl");
+}
+
+static void bench_text_scan_level(const bench_text_files *files, text_scan_level level, bench_obj_counts *out_counts)
+{
+    const char *level_name = text_scan_level_name(level);
+    char        name[64];
+    u64         checksum = 0;
+
+    f64 start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files->count; i++)
+        {
+            checksum += text_count_char(files->files[i].data, files->files[i].length, '\n');
+        }
+    }
+    snprintf(name, sizeof(name), "count_newlines_%s", level_name);
+    bench_text_scan_report(name, platform_get_absolute_time() - start, files);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files->count; i++)
+        {
+            text_line_reader lines(files->files[i].data, files->files[i].length);
+            dstring_view     line;
+            while (lines.next(&line))
+            {
+                checksum += line.length;
+            }
+        }
+    }
+    snprintf(name, sizeof(name), "iterate_lines_%s", level_name);
+    bench_text_scan_report(name, platform_get_absolute_time() - start, files);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files->count; i++)
+        {
+            checksum += text_count(files->files[i].data, files->files[i].length, "usemtl");
+        }
+    }
+    snprintf(name, sizeof(name), "count_usemtl_%s", level_name);
+    bench_text_scan_report(name, platform_get_absolute_time() - start, files);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        bench_obj_counts counts = {};
+        for (u32 i = 0; i < files->count; i++)
+        {
+            bench_obj_classify_lines(&files->files[i], &counts);
+        }
+        *out_counts = counts;
+    }
+    snprintf(name, sizeof(name), "obj_classify_lines_%s", level_name);
+    bench_text_scan_report(name, platform_get_absolute_time() - start, files);
+
+    start = platform_get_absolute_time();
+    bench_obj_counts keyword_counts;
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        keyword_counts = {};
+        for (u32 i = 0; i < files->count; i++)
+        {
+            bench_obj_count_keywords(&files->files[i], &keyword_counts);
+        }
+    }
+    snprintf(name, sizeof(name), "obj_count_keywords_%s", level_name);
+    bench_text_scan_report(name, platform_get_absolute_time() - start, files);
+
+    if (!(keyword_counts == *out_counts))
+    {
+        printf("# text_scan %s: keyword counts dont match the line pass\n", level_name);
+    }
+    bench_do_not_optimize(checksum);
+}
+
+// the vector paths against the scalar one at every start offset and length around the register sizes, so the
+// unaligned heads and the tails that dont fill a register are covered too.
+static u64 bench_text_scan_check_edges(const bench_text_file *file, text_scan_level level)
+{
+    const char *needles[] = {"vn", "usemtl", "f 1", "0.000000"};
+    u64         mismatches = 0;
+    u64         window     = file->length < 200 ? file->length : 200;
+    for (u64 offset = 0; offset < 40 && offset < window; offset++)
+    {
+        for (u64 length = 0; offset + length <= window; length++)
+        {
+            const char *data = file->data + offset;
+
+            text_scan_set_level(TEXT_SCAN_SCALAR);
+            const char *scalar_char  = text_find_char(data, length, '\n');
+            u64         scalar_count = text_count_char(data, length, ' ');
+            const char *scalar_found[4];
+            for (u32 n = 0; n < 4; n++)
+            {
+                scalar_found[n] = text_find(data, length, needles[n]);
+            }
+
+            text_scan_set_level(level);
+            mismatches += text_find_char(data, length, '\n') != scalar_char;
+            mismatches += text_count_char(data, length, ' ') != scalar_count;
+            for (u32 n = 0; n < 4; n++)
+            {
+                mismatches += text_find(data, length, needles[n]) != scalar_found[n];
+            }
+        }
+    }
+    return mismatches;
+}
+
+void bench_text_scan_run()
+{
+    arena           *a     = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_text_files files = {};
+    for (const char *mesh : bench_text_scan_meshes)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "../assets/meshes/%s", mesh);
+        u64 size = 0;
+        if (!file_get_size(path, &size))
+        {
+            printf("# text_scan: couldnt open %s, skipping it\n", path);
+            continue;
+        }
+        bench_text_file *file = &files.files[files.count++];
+        file->data            = static_cast<char *>(arena_allocate_block(a, size + 1));
+        file->length          = size;
+        file_open_and_read(path, &size, file->data, 1);
+        file->data[size]   = '\0';
+        files.total_bytes += size;
+    }
+    if (!files.count)
+    {
+        printf("# text_scan: no meshes, run the bench from bin/\n");
+        arena_free_arena(a);
+        return;
+    }
+    printf("# text_scan: %u obj files, %llu bytes, best level %s\n", files.count,
+           static_cast<unsigned long long>(files.total_bytes), text_scan_level_name(text_scan_get_level()));
+
+    // the old way first.
+    u64 checksum = 0;
+    f64 start    = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files.count; i++)
+        {
+            checksum += bench_count_newlines_strchr(&files.files[i]);
+        }
+    }
+    bench_text_scan_report("count_newlines_strchr", platform_get_absolute_time() - start, &files);
+    u64 strchr_newlines = checksum / BENCH_TEXT_SCAN_PASSES;
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files.count; i++)
+        {
+            checksum += string_num_of_substring_occurence(files.files[i].data, "usemtl");
+        }
+    }
+    bench_text_scan_report("count_usemtl_strstr", platform_get_absolute_time() - start, &files);
+
+    start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_TEXT_SCAN_PASSES; pass++)
+    {
+        for (u32 i = 0; i < files.count; i++)
+        {
+            checksum += bench_obj_substring_counts(&files.files[i]);
+        }
+    }
+    bench_text_scan_report("obj_substring_counts_strstr", platform_get_absolute_time() - start, &files);
+    bench_do_not_optimize(checksum);
+
+    text_scan_level  best = text_scan_get_level();
+    bench_obj_counts scalar_counts;
+    for (u32 level = TEXT_SCAN_SCALAR; level <= best; level++)
+    {
+        text_scan_set_level(static_cast<text_scan_level>(level));
+        bench_obj_counts counts;
+        bench_text_scan_level(&files, static_cast<text_scan_level>(level), &counts);
+        if (level == TEXT_SCAN_SCALAR)
+        {
+            scalar_counts = counts;
+            continue;
+        }
+        if (!(counts == scalar_counts))
+        {
+            printf("# text_scan %s: counts dont match the scalar pass\n",
+                   text_scan_level_name(static_cast<text_scan_level>(level)));
+        }
+    }
+
+    u64 newlines = 0;
+    for (u32 i = 0; i < files.count; i++)
+    {
+        newlines += text_count_char(files.files[i].data, files.files[i].length, '\n');
+    }
+    if (newlines != strchr_newlines)
+    {
+        printf("# text_scan: %llu newlines, strchr found %llu\n", static_cast<unsigned long long>(newlines),
+               static_cast<unsigned long long>(strchr_newlines));
+    }
+    printf("# text_scan: %llu lines, %llu v, %llu vn, %llu vt, %llu f, %llu o, %llu usemtl\n",
+           static_cast<unsigned long long>(scalar_counts.lines),
+           static_cast<unsigned long long>(scalar_counts.positions),
+           static_cast<unsigned long long>(scalar_counts.normals),
+           static_cast<unsigned long long>(scalar_counts.tex_coords),
+           static_cast<unsigned long long>(scalar_counts.faces), static_cast<unsigned long long>(scalar_counts.objects),
+           static_cast<unsigned long long>(scalar_counts.usemtls));
+
+    for (u32 level = TEXT_SCAN_SSE2; level <= best; level++)
+    {
+        u64 mismatches = bench_text_scan_check_edges(&files.files[files.count - 1], static_cast<text_scan_level>(level));
+        if (mismatches)
+        {
+            printf("# text_scan %s: %llu results differ from scalar at unaligned starts/tails\n",
+                   text_scan_level_name(static_cast<text_scan_level>(level)),
+                   static_cast<unsigned long long>(mismatches));
+        }
+    }
+    text_scan_set_level(best);
+    arena_free_arena(a);
+}
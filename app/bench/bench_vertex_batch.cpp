@@ -0,0 +1,203 @@
+#include "bench.hpp"
+
+#include "core/dmemory.hpp"
+#include "math/dmath.hpp"
+#include "math/dvertex_batch.hpp"
+#include "memory/arenas.hpp"
+#include "platform/platform.hpp"
+
+#include <cstdio>
+
+// INFO: the vertex batch kernels against their one vertex at a time versions on a grid mesh (shared vertices, like an
+// imported one). Every case reports one op per vertex of the mesh, so ops_per_sec is vertices per second. The grid is
+// 255 x 257 vertices and the checks drop the last triangle, so neither count is a multiple of 4 and the short last
+// group gets exercised too.
+#define BENCH_VERTEX_GRID_X 255
+#define BENCH_VERTEX_GRID_Y 257
+#define BENCH_VERTEX_PASSES 40
+
+struct bench_vertex_mesh
+{
+    vertex_3D *vertices;
+    vertex_3D *scratch;
+    u32        vertex_count;
+    u32       *indices;
+    u32        index_count;
+};
+
+static void bench_vertex_build_mesh(arena *a, bench_vertex_mesh *mesh)
+{
+    mesh->vertex_count = BENCH_VERTEX_GRID_X * BENCH_VERTEX_GRID_Y;
+    mesh->index_count  = (BENCH_VERTEX_GRID_X - 1) * (BENCH_VERTEX_GRID_Y - 1) * 6;
+    mesh->vertices     = static_cast<vertex_3D *>(arena_allocate_block(a, sizeof(vertex_3D) * mesh->vertex_count));
+    mesh->scratch      = static_cast<vertex_3D *>(arena_allocate_block(a, sizeof(vertex_3D) * mesh->vertex_count));
+    mesh->indices      = static_cast<u32 *>(arena_allocate_block(a, sizeof(u32) * mesh->index_count));
+
+    for (u32 y = 0; y < BENCH_VERTEX_GRID_Y; y++)
+    {
+        for (u32 x = 0; x < BENCH_VERTEX_GRID_X; x++)
+        {
+            vertex_3D *v = mesh->vertices + y * BENCH_VERTEX_GRID_X + x;
+            v->position  = vec3(static_cast<f32>(x) + bench_random_f32(-0.3f, 0.3f), bench_random_f32(-2, 2),
+                                static_cast<f32>(y) + bench_random_f32(-0.3f, 0.3f));
+            v->normal    = vec3_normalized_scalar(
+                vec3(bench_random_f32(-0.2f, 0.2f), 1.0f, bench_random_f32(-0.2f, 0.2f)));
+            v->tex_coord = vec2(static_cast<f32>(x) / BENCH_VERTEX_GRID_X + bench_random_f32(-0.001f, 0.001f),
+                                static_cast<f32>(y) / BENCH_VERTEX_GRID_Y + bench_random_f32(-0.001f, 0.001f));
+            v->tangent   = vec4(1, 0, 0, bench_random_f32(-1, 1) < 0 ? -1.0f : 1.0f);
+        }
+    }
+    // every so often a vertex without a normal, like obj files that leave them out.
+    for (u32 i = 0; i < mesh->vertex_count; i += 97)
+    {
+        mesh->vertices[i].normal = vec3();
+    }
+
+    u32 *index = mesh->indices;
+    for (u32 y = 0; y + 1 < BENCH_VERTEX_GRID_Y; y++)
+    {
+        for (u32 x = 0; x + 1 < BENCH_VERTEX_GRID_X; x++)
+        {
+            u32 i0   = y * BENCH_VERTEX_GRID_X + x;
+            u32 i1   = i0 + 1;
+            u32 i2   = i0 + BENCH_VERTEX_GRID_X;
+            u32 i3   = i2 + 1;
+            index[0] = i0;
+            index[1] = i2;
+            index[2] = i1;
+            index[3] = i1;
+            index[4] = i2;
+            index[5] = i3;
+            index   += 6;
+        }
+    }
+}
+
+static f32 bench_vertex_difference(const f32 *a, const f32 *b, u32 count)
+{
+    f32 out = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        f32 difference = fabsf(a[i] - b[i]) / (fabsf(b[i]) > 1.0f ? fabsf(b[i]) : 1.0f);
+        // nan compares false, count it as a full miss.
+        out = difference <= out ? out : (difference == difference ? difference : 1.0f);
+    }
+    return out;
+}
+
+// biggest relative difference over every float of every vertex.
+static f32 bench_vertex_compare(const vertex_3D *a, const vertex_3D *b, u32 count)
+{
+    f32 out = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        f32 d = bench_vertex_difference(a[i].position.elements, b[i].position.elements, 3);
+        d     = fmaxf(d, bench_vertex_difference(a[i].normal.elements, b[i].normal.elements, 3));
+        d     = fmaxf(d, bench_vertex_difference(a[i].tex_coord.elements, b[i].tex_coord.elements, 2));
+        d     = fmaxf(d, bench_vertex_difference(a[i].tangent.elements, b[i].tangent.elements, 4));
+        out   = fmaxf(out, d);
+    }
+    return out;
+}
+
+static mat4 bench_vertex_matrix(bool mirror)
+{
+    mat4 out_matrix = mat4_mul_scalar(mat4_euler_xyz(0.3f, -1.1f, 2.0f), mat4_translation(vec3(0.001f, 0, -0.002f)));
+    if (mirror)
+    {
+        out_matrix = mat4_mul_scalar(mat4_scale(vec3(-1.0f, 2.0f, 0.5f)), out_matrix);
+    }
+    return out_matrix;
+}
+
+static void bench_vertex_check(bench_vertex_mesh *mesh)
+{
+    u64        bytes     = sizeof(vertex_3D) * mesh->vertex_count;
+    u32        count     = mesh->vertex_count;
+    u32        indices   = mesh->index_count - 3;
+    arena     *a         = arena_get_arena(ARENA_SIZE_MEDIUM);
+    vertex_3D *reference = static_cast<vertex_3D *>(arena_allocate_block(a, bytes));
+
+    dcopy_memory(reference, mesh->vertices, bytes);
+    dcopy_memory(mesh->scratch, mesh->vertices, bytes);
+    vertex_batch_scale_translate_3D_scalar(reference, count, vec3(0.5f, 2.0f, -1.0f), vec3(3, -4, 5));
+    vertex_batch_scale_translate_3D(mesh->scratch, count, vec3(0.5f, 2.0f, -1.0f), vec3(3, -4, 5));
+    printf("# vertex_batch check scale_translate_3D: max relative difference %.3g\n",
+           bench_vertex_compare(mesh->scratch, reference, count));
+
+    for (u32 mirror = 0; mirror < 2; mirror++)
+    {
+        dcopy_memory(reference, mesh->vertices, bytes);
+        dcopy_memory(mesh->scratch, mesh->vertices, bytes);
+        vertex_batch_transform_3D_scalar(reference, count, bench_vertex_matrix(mirror));
+        vertex_batch_transform_3D(mesh->scratch, count, bench_vertex_matrix(mirror));
+        printf("# vertex_batch check transform_3D%s: max relative difference %.3g\n", mirror ? " (mirrored)" : "",
+               bench_vertex_compare(mesh->scratch, reference, count));
+    }
+
+    dcopy_memory(reference, mesh->vertices, bytes);
+    dcopy_memory(mesh->scratch, mesh->vertices, bytes);
+    vertex_batch_calculate_tangents_scalar(reference, mesh->indices, indices);
+    vertex_batch_calculate_tangents(mesh->scratch, mesh->indices, indices);
+    printf("# vertex_batch check calculate_tangents: max relative difference %.3g\n",
+           bench_vertex_compare(mesh->scratch, reference, count));
+
+    arena_free_arena(a);
+}
+
+template <typename F> static f64 bench_vertex_time(const char *name, bench_vertex_mesh *mesh, F op)
+{
+    dcopy_memory(mesh->scratch, mesh->vertices, sizeof(vertex_3D) * mesh->vertex_count);
+    f64 start = platform_get_absolute_time();
+    for (u32 pass = 0; pass < BENCH_VERTEX_PASSES; pass++)
+    {
+        op();
+    }
+    f64 elapsed = platform_get_absolute_time() - start;
+    bench_do_not_optimize(mesh->scratch);
+    bench_report("vertex_batch", name, static_cast<u64>(mesh->vertex_count) * BENCH_VERTEX_PASSES, elapsed);
+    return elapsed;
+}
+
+static void bench_vertex_speedup(const char *name, bench_vertex_mesh *mesh, f64 scalar_seconds, f64 batch_seconds)
+{
+    f64 vertices = static_cast<f64>(mesh->vertex_count) * BENCH_VERTEX_PASSES;
+    printf("# vertex_batch %s: %.1f M vertices/s, %.1f M vertices/s scalar, %.2fx\n", name,
+           vertices / batch_seconds / 1000000.0, vertices / scalar_seconds / 1000000.0, scalar_seconds / batch_seconds);
+}
+
+void bench_vertex_batch_run()
+{
+    bench_random_seed(0x853c49e6748fea9bull);
+    printf("# vertex_batch: simd backend %s\n", DSIMD_BACKEND_NAME);
+    arena            *a = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bench_vertex_mesh mesh;
+    bench_vertex_build_mesh(a, &mesh);
+    bench_vertex_check(&mesh);
+
+    vertex_3D *v     = mesh.scratch;
+    u32        count = mesh.vertex_count;
+
+    f64 scalar = bench_vertex_time("scale_translate_3D_scalar", &mesh, [&]() {
+        vertex_batch_scale_translate_3D_scalar(v, count, vec3(1.0001f, 0.9999f, 1.0f), vec3(0.001f, 0, 0));
+    });
+    f64 batch  = bench_vertex_time("scale_translate_3D", &mesh, [&]() {
+        vertex_batch_scale_translate_3D(v, count, vec3(1.0001f, 0.9999f, 1.0f), vec3(0.001f, 0, 0));
+    });
+    bench_vertex_speedup("scale_translate_3D", &mesh, scalar, batch);
+
+    mat4 matrix = bench_vertex_matrix(false);
+    scalar      = bench_vertex_time("transform_3D_scalar", &mesh,
+                                    [&]() { vertex_batch_transform_3D_scalar(v, count, matrix); });
+    batch       = bench_vertex_time("transform_3D", &mesh, [&]() { vertex_batch_transform_3D(v, count, matrix); });
+    bench_vertex_speedup("transform_3D", &mesh, scalar, batch);
+
+    scalar = bench_vertex_time("calculate_tangents_scalar", &mesh, [&]() {
+        vertex_batch_calculate_tangents_scalar(v, mesh.indices, mesh.index_count);
+    });
+    batch  = bench_vertex_time("calculate_tangents", &mesh,
+                               [&]() { vertex_batch_calculate_tangents(v, mesh.indices, mesh.index_count); });
+    bench_vertex_speedup("calculate_tangents", &mesh, scalar, batch);
+
+    arena_free_arena(a);
+}
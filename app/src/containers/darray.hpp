@@ -1,4 +1,3 @@
-
 #pragma once
 #include "core/dasserts.hpp"
 #include "core/dmemory.hpp"
@@ -7,9 +6,17 @@
 
 #include "defines.hpp"
 
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #define DEFAULT_DARRAY_SIZE 10
 #define DEFAULT_DARRAY_RESIZE_FACTOR 2
 
+// INFO: elements of trivially copyable types (u32, vulkan structs, dstring...) are moved around with plain memcpy and
+// never constructed/destroyed. Everything else gets placement new on the way in and is moved element by element when
+// the array grows. Destructors run on pop_back/pop_at/clear and when resize shrinks the array, NOT in ~darray: the block
+// belongs to the arena and copies of a darray share it, so call clear() before dropping an array of non-trivial types.
 template <typename T> class darray
 {
   public:
@@ -23,9 +30,8 @@ template <typename T> class darray
     darray();
     ~darray();
 
-    // returns a copy of the value
-    T    operator[](u64 index) const;
-    void operator=(const darray<T> &in_darray);
+    const T &operator[](u64 index) const;
+    void     operator=(const darray<T> &in_darray);
 
     T &operator[](u64 index);
 
@@ -41,11 +47,27 @@ template <typename T> class darray
 
     void resize(u64 size);
 
-    void push_back(T a);
+    void push_back(const T &element);
+    void push_back(T &&element);
+    // constructs the element in place, returns a reference to it.
+    template <typename... Args> T &emplace_back(Args &&...args);
+
+    T   &back();
     T    pop_back();
     T    pop_at(u32 index);
     u64  size();
     void clear();
+
+  private:
+    static constexpr bool is_trivial = std::is_trivially_copyable<T>::value;
+
+    // moves the elements into a new block of new_capacity bytes and frees the old one. Split in two so emplace_back can
+    // build the new element in between, its arguments may point into the old block.
+    void relocate(u64 new_capacity);
+    T   *relocate_allocate(u64 new_capacity);
+    void relocate_move(T *buffer, u64 new_capacity);
+    void construct_range(u64 first, u64 last);
+    void destroy_range(u64 first, u64 last);
 };
 
 template <typename T> darray<T>::darray()
@@ -67,6 +89,63 @@ template <typename T> darray<T>::~darray()
     DTRACE("This doesnt do anything, this should not be called by anyone except the compiler.");
 }
 
+template <typename T> void darray<T>::construct_range(u64 first, u64 last)
+{
+    if constexpr (!is_trivial)
+    {
+        for (u64 i = first; i < last; i++)
+        {
+            new (&data[i]) T();
+        }
+    }
+}
+
+template <typename T> void darray<T>::destroy_range(u64 first, u64 last)
+{
+    if constexpr (!is_trivial)
+    {
+        for (u64 i = first; i < last; i++)
+        {
+            data[i].~T();
+        }
+    }
+}
+
+template <typename T> void darray<T>::relocate(u64 new_capacity)
+{
+    relocate_move(relocate_allocate(new_capacity), new_capacity);
+}
+
+template <typename T> T *darray<T>::relocate_allocate(u64 new_capacity)
+{
+    T *buffer = static_cast<T *>(dallocate(arena, new_capacity, MEM_TAG_DARRAY));
+    if (!buffer)
+    {
+        DFATAL("Darray coulnd't allocate block for ::relocate()");
+    }
+    return buffer;
+}
+
+template <typename T> void darray<T>::relocate_move(T *buffer, u64 new_capacity)
+{
+    u64 count = length * element_size < new_capacity ? length : new_capacity / element_size;
+    if constexpr (is_trivial)
+    {
+        dcopy_memory(buffer, data, count * element_size);
+    }
+    else
+    {
+        for (u64 i = 0; i < count; i++)
+        {
+            new (&buffer[i]) T(std::move(data[i]));
+        }
+        destroy_range(0, length);
+    }
+    dfree(data, capacity, MEM_TAG_DARRAY);
+    data     = buffer;
+    capacity = new_capacity;
+}
+
 template <typename T> void darray<T>::c_init(struct arena *in_arena)
 {
     if (data)
@@ -95,6 +174,7 @@ template <typename T> void darray<T>::reserve(struct arena *in_arena, u64 size)
     length = size;
     arena  = in_arena;
     data   = static_cast<T *>(dallocate(arena, capacity, MEM_TAG_DARRAY));
+    construct_range(0, length);
 }
 
 template <typename T> void darray<T>::reserve(struct arena *in_arena)
@@ -112,6 +192,7 @@ template <typename T> void darray<T>::reserve(struct arena *in_arena)
     length = DEFAULT_DARRAY_SIZE;
     arena  = in_arena;
     data   = static_cast<T *>(dallocate(arena, capacity, MEM_TAG_DARRAY));
+    construct_range(0, length);
 }
 
 template <typename T> void darray<T>::c_init(struct arena *in_arena, u64 size)
@@ -135,25 +216,34 @@ template <typename T> void darray<T>::operator=(const darray<T> &in_darray)
     if (data)
     {
         dfree(data, capacity, MEM_TAG_DARRAY);
-        capacity = in_darray.capacity;
     }
-    arena        = in_darray.arena;
+    arena    = in_darray.arena;
+    capacity = in_darray.capacity;
 
     data = static_cast<T *>(dallocate(arena, in_darray.capacity, MEM_TAG_DARRAY));
 
-    dcopy_memory(data, in_darray.data, in_darray.capacity);
+    if constexpr (is_trivial)
+    {
+        dcopy_memory(data, in_darray.data, in_darray.length * in_darray.element_size);
+    }
+    else
+    {
+        for (u64 i = 0; i < in_darray.length; i++)
+        {
+            new (&data[i]) T(in_darray.data[i]);
+        }
+    }
     length       = in_darray.length;
     element_size = in_darray.element_size;
     return;
 }
-template <typename T> T darray<T>::operator[](u64 index) const
+template <typename T> const T &darray<T>::operator[](u64 index) const
 {
     if ((index != 0 && index >= length) || index >= capacity)
     {
-        DASSERT_MSG(index >= length, "Index is out of bounds....");
+        DASSERT_MSG(index < length, "Index is out of bounds....");
     }
-    T *elem = &data[index];
-    return *elem;
+    return data[index];
 }
 
 template <typename T> T &darray<T>::operator[](u64 index)
@@ -162,52 +252,37 @@ template <typename T> T &darray<T>::operator[](u64 index)
     {
         DASSERT_MSG(index < length, "Index is out of bounds....");
     }
-
-    T *elem = &data[index];
-    return *elem;
+    return data[index];
 }
 
 template <typename T> void darray<T>::resize(u64 out_size)
 {
-    if (out_size < DEFAULT_DARRAY_SIZE)
+    if (!data)
     {
-        length = out_size;
-        DASSERT_MSG(data, "array hasnt been initalized yet.");
+        DERROR("Array hasn't been initialized properly. Call c_init, reserve or plain old constructor with arenas to initalize it.");
+        debugBreak();
         return;
     }
     u64 new_capacity = (out_size * element_size);
-    if (data)
+    if (new_capacity > capacity)
     {
-        if (capacity > new_capacity)
-        {
-            if (data && length > 0)
-            {
-                DASSERT_MSG(new_capacity > capacity, "Old capacity is bigger than the new capcity");
-            }
-            DERROR("Resizing array from %ldbytes to smaller %ldBytes", capacity, out_size);
-        }
-        void *buffer = dallocate(arena, element_size * out_size, MEM_TAG_DARRAY);
-        if (!buffer)
-        {
-            DFATAL("Darray coulnd't allocate block for ::resize()");
-        }
-        dcopy_memory(buffer, data, new_capacity);
-        dfree(data, capacity, MEM_TAG_DARRAY);
-        data     = static_cast<T *>(buffer);
-        capacity = new_capacity;
-        length   = out_size;
+        relocate(new_capacity);
     }
-    else
+    else if (out_size < length)
     {
-        DERROR("Array hasn't been initialized properly. Call c_init, reserve or plain old constructor with arenas to initalize it.");
-        debugBreak();
+        destroy_range(out_size, length);
+        length = out_size;
+        return;
     }
+    construct_range(length, out_size);
+    length = out_size;
 }
 
 template <typename T> void darray<T>::clear()
 {
     if (data)
     {
+        destroy_range(0, length);
         dzero_memory(data, capacity);
     }
     length = 0;
@@ -218,38 +293,43 @@ template <typename T> u64 darray<T>::size()
     return length;
 }
 
-template <typename T> void darray<T>::push_back(T element)
+template <typename T> void darray<T>::push_back(const T &element)
 {
-    if(data)
-    {
-        if (length + 1 >= (capacity / element_size))
-        {
-            DWARN("Array size is not large enough to accomadate another element. Resizing....");
-            void *buffer = dallocate(arena, DEFAULT_DARRAY_RESIZE_FACTOR * capacity, MEM_TAG_DARRAY);
-            if (!buffer)
-            {
-                DFATAL("Darray coulnd't allocate block for ::push_back()");
-            }
-
-            dcopy_memory(buffer, data, capacity);
-            dfree(data, capacity, MEM_TAG_DARRAY);
-
-            capacity = capacity * DEFAULT_DARRAY_RESIZE_FACTOR;
-            data     = static_cast<T *>(buffer);
-            buffer   = 0;
-        }
-    }
-    else
+    emplace_back(element);
+}
+
+template <typename T> void darray<T>::push_back(T &&element)
+{
+    emplace_back(std::move(element));
+}
+
+template <typename T> template <typename... Args> T &darray<T>::emplace_back(Args &&...args)
+{
+    DASSERT_MSG(data, "Array hasn't been initialized properly. Call c_init, reserve or plain old constructor with "
+                      "arenas to initalize it.");
+    if (length < (capacity / element_size))
     {
-        DERROR("Array hasn't been initialized properly. Call c_init, reserve or plain old constructor with arenas to initalize it.");
-        return;
+        T *elem = new (&data[length]) T(std::forward<Args>(args)...);
+        length++;
+        return *elem;
     }
 
-    T *last_index = &data[length];
-    dcopy_memory(last_index, &element, element_size);
+    // full. args can be a reference into data (arr.push_back(arr[i])) and freeing the old block scribbles over it, so
+    // the new element is built in the new block before the old one goes away.
+    u64 new_capacity = DEFAULT_DARRAY_RESIZE_FACTOR * capacity;
+    T  *buffer       = relocate_allocate(new_capacity);
+    T  *elem         = new (&buffer[length]) T(std::forward<Args>(args)...);
+    relocate_move(buffer, new_capacity);
     length++;
-    last_index = 0;
+    return *elem;
 }
+
+template <typename T> T &darray<T>::back()
+{
+    DASSERT_MSG(length != 0, "No elements in darray.");
+    return data[length - 1];
+}
+
 template <typename T> T darray<T>::pop_back()
 {
     if (length == 0)
@@ -257,45 +337,34 @@ template <typename T> T darray<T>::pop_back()
         DASSERT_MSG(length != 0, "No elements in darray to pop back.");
     }
 
-    T *return_element = &data[length - 1];
     length--;
-    return *return_element;
+    T return_element = std::move(data[length]);
+    destroy_range(length, length + 1);
+    return return_element;
 }
 
 template <typename T> T darray<T>::pop_at(u32 index)
 {
-    if (index >= length || index >= capacity)
+    if (index >= length)
     {
-        DASSERT_MSG(index > length, "Index is out of bounds....");
-    }
-    T *return_element      = &data[index];
-    T  return_element_copy = *return_element;
-    if (index == length - 1)
-    {
-        length--;
-        return return_element_copy;
+        DASSERT_MSG(index < length, "Index is out of bounds....");
     }
-    if (index == 0)
+    T return_element = std::move(data[index]);
+
+    // INFO: shift the tail down by one in place.
+    if constexpr (is_trivial)
     {
-        dcopy_memory(data, &return_element[1], (length - 1) * element_size);
-        length--;
-        return return_element_copy;
+        dmove_memory(&data[index], &data[index + 1], (length - index - 1) * element_size);
     }
-
-    T *next_element = &data[index + 1];
-
-    T *new_array = static_cast<T *>(dallocate(arena, capacity, MEM_TAG_DARRAY));
-    if (!new_array)
+    else
     {
-        DFATAL("Darray coulnd't allocate block for ::pop_at()");
+        for (u64 i = index; i + 1 < length; i++)
+        {
+            data[i] = std::move(data[i + 1]);
+        }
+        destroy_range(length - 1, length);
     }
-    dcopy_memory(new_array, data, index * element_size);
-    dcopy_memory(&new_array[index], next_element, (length - index) * element_size);
-
-    dfree(data, capacity, MEM_TAG_RENDERER);
-    data = static_cast<T *>(new_array);
-
     length--;
 
-    return return_element_copy;
+    return return_element;
 }
@@ -0,0 +1,510 @@
+#pragma once
+// INFO: hashtable for lookups that happen while other threads are loading. Readers never take a lock and never wait,
+// a lookup is a couple of atomic loads and an array read. Writers (insert/update/erase) take a spin lock between
+// themselves, so loader threads can insert at the same time, and publish their changes with a single atomic store.
+//
+// Keys are u64, use string_id_hash()/string_id_intern() for names. Slots hold (high 32 bits of the hash, dense index)
+// and the entries live in a dstable_array, so an entry never moves. Nothing a reader might be looking at is written
+// over in place: update() writes a new entry and swaps the slot, erase() turns the slot into a tombstone and growing
+// builds a new slot table and swaps the pointer. The old entries/tables are retired and only reused/freed once every
+// reader that could have seen them is done (epoch based reclamation, read_begin/read_end below).
+//
+// Every reader thread registers once and wraps its lookups in read_begin/read_end. Pointers returned by find are valid
+// until read_end. Keep read sections short (a frame at most), writers that run out of entries wait for them.
+
+#include "containers/dstable_array.hpp"
+#include "core/dasserts.hpp"
+#include "core/logger.hpp"
+#include "defines.hpp"
+#include "platform/platform.hpp"
+
+#include <atomic>
+#include <new>
+#include <thread>
+
+#define DCONCURRENT_HASHTABLE_MAX_READERS 64
+#define DCONCURRENT_HASHTABLE_MIN_SLOTS 16
+// max load (live + tombstones) is 7/8 of the slots, there is always an empty slot to stop a probe.
+#define DCONCURRENT_HASHTABLE_MAX_LOAD_NUMERATOR 7
+#define DCONCURRENT_HASHTABLE_MAX_LOAD_DENOMINATOR 8
+
+#define DCONCURRENT_HASHTABLE_SLOT_EMPTY 0xFFFFFFFFFFFFFFFFull
+#define DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE 0xFFFFFFFFFFFFFFFEull
+#define DCONCURRENT_HASHTABLE_NO_INDEX 0xFFFFFFFFu
+#define DCONCURRENT_HASHTABLE_READER_IDLE 0xFFFFFFFFFFFFFFFFull
+
+template <typename T> class dconcurrent_hashtable
+{
+  private:
+    struct entry
+    {
+        u64 key;
+        // epoch the entry was unlinked in, and the next index on the retired/free list.
+        u64 retire_epoch;
+        u32 next;
+        T   value;
+    };
+
+    struct slot_table
+    {
+        u64               slot_count;
+        u64               slot_mask;
+        u64               retire_epoch;
+        slot_table       *next_retired;
+        std::atomic<u64> *slots;
+    };
+
+    struct alignas(64) reader_slot
+    {
+        std::atomic<u64>  epoch;
+        std::atomic<bool> taken;
+    };
+
+    dstable_array<entry>      entries;
+    std::atomic<slot_table *> table;
+    std::atomic<u64>          global_epoch;
+    std::atomic<u64>          num_elements_in_table;
+    std::atomic_flag          write_lock = ATOMIC_FLAG_INIT;
+
+    // writer side, only touched with write_lock held.
+    u64         num_tombstones;
+    u32         free_head;
+    u32         retired_head;
+    u32         retired_tail;
+    slot_table *retired_tables;
+
+    reader_slot readers[DCONCURRENT_HASHTABLE_MAX_READERS];
+
+    static u64 hash_func(u64 key);
+    static u64 slots_for(u64 elements);
+
+    slot_table *_create_table(u64 slot_count);
+    void        _free_table(slot_table *old_table);
+    u64         _probe(const slot_table *in_table, u64 hash, u64 key, u64 *out_value);
+    void        _place(slot_table *in_table, u64 hash, u32 index);
+    void        _grow_if_needed();
+    u32         _allocate_entry();
+    void        _retire_entry(u32 index);
+    void        _insert_locked(u64 key, const T &value);
+    u64         _oldest_active_epoch();
+    void        _reclaim();
+    void        _lock();
+    void        _unlock();
+
+  public:
+    void init(u64 max_elements);
+    void destroy();
+
+    // a reader thread calls register once and passes the returned id to read_begin/read_end.
+    u32  register_reader();
+    void unregister_reader(u32 reader);
+    void read_begin(u32 reader);
+    void read_end(u32 reader);
+
+    // call between read_begin and read_end, the pointer is valid until read_end.
+    const T *find(u64 key);
+
+    // insert or overwrite.
+    void insert(u64 key, const T &value);
+    bool update(u64 key, const T &value);
+    bool erase(u64 key);
+
+    // hands retired entries and tables back once the readers are past them. Writers do this on their own, call it
+    // after a burst of erases if memory matters.
+    void reclaim();
+
+    u64 num_elements();
+};
+
+template <typename T> u64 dconcurrent_hashtable<T>::hash_func(u64 key)
+{
+    // SplitMix64, same as dhashtable.
+    u64 x  = key;
+    x     += 0x9e3779b97f4a7c15;
+    x      = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x      = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+template <typename T> u64 dconcurrent_hashtable<T>::slots_for(u64 elements)
+{
+    u64 wanted = (elements * DCONCURRENT_HASHTABLE_MAX_LOAD_DENOMINATOR) / DCONCURRENT_HASHTABLE_MAX_LOAD_NUMERATOR + 1;
+    u64 slots  = DCONCURRENT_HASHTABLE_MIN_SLOTS;
+    while (slots < wanted)
+    {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::init(u64 max_elements)
+{
+    DASSERT(max_elements && max_elements < DCONCURRENT_HASHTABLE_NO_INDEX - 1);
+
+    entries.init(max_elements);
+    table.store(_create_table(DCONCURRENT_HASHTABLE_MIN_SLOTS), std::memory_order_relaxed);
+    global_epoch.store(1, std::memory_order_relaxed);
+    num_elements_in_table.store(0, std::memory_order_relaxed);
+    num_tombstones = 0;
+    free_head      = DCONCURRENT_HASHTABLE_NO_INDEX;
+    retired_head   = DCONCURRENT_HASHTABLE_NO_INDEX;
+    retired_tail   = DCONCURRENT_HASHTABLE_NO_INDEX;
+    retired_tables = nullptr;
+    for (u32 i = 0; i < DCONCURRENT_HASHTABLE_MAX_READERS; i++)
+    {
+        readers[i].epoch.store(DCONCURRENT_HASHTABLE_READER_IDLE, std::memory_order_relaxed);
+        readers[i].taken.store(false, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+// WARN: no reader or writer may be using the table anymore.
+template <typename T> void dconcurrent_hashtable<T>::destroy()
+{
+    while (retired_tables)
+    {
+        slot_table *next = retired_tables->next_retired;
+        _free_table(retired_tables);
+        retired_tables = next;
+    }
+    slot_table *current = table.load(std::memory_order_acquire);
+    if (current)
+    {
+        _free_table(current);
+        table.store(nullptr, std::memory_order_relaxed);
+    }
+    entries.destroy();
+}
+
+template <typename T>
+typename dconcurrent_hashtable<T>::slot_table *dconcurrent_hashtable<T>::_create_table(u64 slot_count)
+{
+    // header and slots in one block. malloc and not an arena, loader threads grow the table too.
+    u64 header_size = (sizeof(slot_table) + 15) & ~static_cast<u64>(15);
+    u8 *block       = static_cast<u8 *>(platform_allocate(header_size + slot_count * sizeof(u64), true));
+    DASSERT(block);
+
+    slot_table *new_table   = reinterpret_cast<slot_table *>(block);
+    new_table->slot_count   = slot_count;
+    new_table->slot_mask    = slot_count - 1;
+    new_table->retire_epoch = 0;
+    new_table->next_retired = nullptr;
+    new_table->slots        = reinterpret_cast<std::atomic<u64> *>(block + header_size);
+    for (u64 i = 0; i < slot_count; i++)
+    {
+        new (&new_table->slots[i]) std::atomic<u64>(DCONCURRENT_HASHTABLE_SLOT_EMPTY);
+    }
+    return new_table;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_free_table(slot_table *old_table)
+{
+    platform_free(old_table, true);
+}
+
+template <typename T> u32 dconcurrent_hashtable<T>::register_reader()
+{
+    for (u32 i = 0; i < DCONCURRENT_HASHTABLE_MAX_READERS; i++)
+    {
+        bool expected = false;
+        if (!readers[i].taken.load(std::memory_order_relaxed) &&
+            readers[i].taken.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            return i;
+        }
+    }
+    DFATAL("More than %d readers registered on a concurrent hashtable.", DCONCURRENT_HASHTABLE_MAX_READERS);
+    return DCONCURRENT_HASHTABLE_NO_INDEX;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::unregister_reader(u32 reader)
+{
+    DASSERT(reader < DCONCURRENT_HASHTABLE_MAX_READERS);
+    readers[reader].epoch.store(DCONCURRENT_HASHTABLE_READER_IDLE, std::memory_order_release);
+    readers[reader].taken.store(false, std::memory_order_release);
+}
+
+template <typename T> void dconcurrent_hashtable<T>::read_begin(u32 reader)
+{
+    DASSERT(reader < DCONCURRENT_HASHTABLE_MAX_READERS);
+    readers[reader].epoch.store(global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    // the announced epoch has to be visible before any slot is read, otherwise a writer could reclaim something this
+    // reader is about to look at.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+template <typename T> void dconcurrent_hashtable<T>::read_end(u32 reader)
+{
+    readers[reader].epoch.store(DCONCURRENT_HASHTABLE_READER_IDLE, std::memory_order_release);
+}
+
+// returns the slot and what was in it, the slot itself can change right after.
+template <typename T>
+u64 dconcurrent_hashtable<T>::_probe(const slot_table *in_table, u64 hash, u64 key, u64 *out_value)
+{
+    u64 tag = hash >> 32;
+    u64 pos = hash & in_table->slot_mask;
+    for (u64 i = 0; i < in_table->slot_count; i++)
+    {
+        u64 value = in_table->slots[pos].load(std::memory_order_acquire);
+        if (value == DCONCURRENT_HASHTABLE_SLOT_EMPTY)
+        {
+            return INVALID_ID_64;
+        }
+        if (value != DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE && (value >> 32) == tag &&
+            entries.data[static_cast<u32>(value)].key == key)
+        {
+            *out_value = value;
+            return pos;
+        }
+        pos = (pos + 1) & in_table->slot_mask;
+    }
+    return INVALID_ID_64;
+}
+
+template <typename T> const T *dconcurrent_hashtable<T>::find(u64 key)
+{
+    const slot_table *current = table.load(std::memory_order_acquire);
+    u64               value   = 0;
+    if (_probe(current, hash_func(key), key, &value) == INVALID_ID_64)
+    {
+        return nullptr;
+    }
+    // even if the slot was updated or erased since, this entry wont be reused before read_end.
+    return &entries.data[static_cast<u32>(value)].value;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_lock()
+{
+    while (write_lock.test_and_set(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_unlock()
+{
+    write_lock.clear(std::memory_order_release);
+}
+
+// writer only, first empty or tombstone slot in the probe sequence.
+template <typename T> void dconcurrent_hashtable<T>::_place(slot_table *in_table, u64 hash, u32 index)
+{
+    u64 pos = hash & in_table->slot_mask;
+    while (true)
+    {
+        u64 value = in_table->slots[pos].load(std::memory_order_relaxed);
+        if (value == DCONCURRENT_HASHTABLE_SLOT_EMPTY || value == DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE)
+        {
+            if (value == DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE)
+            {
+                num_tombstones--;
+            }
+            in_table->slots[pos].store(((hash >> 32) << 32) | index, std::memory_order_release);
+            return;
+        }
+        pos = (pos + 1) & in_table->slot_mask;
+    }
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_grow_if_needed()
+{
+    slot_table *current = table.load(std::memory_order_relaxed);
+    u64         live    = num_elements_in_table.load(std::memory_order_relaxed);
+    u64         limit   = (current->slot_count * DCONCURRENT_HASHTABLE_MAX_LOAD_NUMERATOR) /
+                  DCONCURRENT_HASHTABLE_MAX_LOAD_DENOMINATOR;
+    if (live + num_tombstones + 1 <= limit)
+    {
+        return;
+    }
+
+    // INFO: rebuilt from scratch, this also drops the tombstones. Readers that are still probing the old table find
+    // everything they would have found before, it is retired and not freed.
+    slot_table *new_table = _create_table(slots_for((live + 1) * 2));
+    for (u64 i = 0; i < current->slot_count; i++)
+    {
+        u64 value = current->slots[i].load(std::memory_order_relaxed);
+        if (value == DCONCURRENT_HASHTABLE_SLOT_EMPTY || value == DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE)
+        {
+            continue;
+        }
+        u32 index = static_cast<u32>(value);
+        _place(new_table, hash_func(entries.data[index].key), index);
+    }
+    num_tombstones = 0;
+    table.store(new_table, std::memory_order_release);
+
+    current->retire_epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    current->next_retired = retired_tables;
+    retired_tables        = current;
+}
+
+template <typename T> u64 dconcurrent_hashtable<T>::_oldest_active_epoch()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    u64 oldest = DCONCURRENT_HASHTABLE_READER_IDLE;
+    for (u32 i = 0; i < DCONCURRENT_HASHTABLE_MAX_READERS; i++)
+    {
+        u64 epoch = readers[i].epoch.load(std::memory_order_acquire);
+        oldest    = epoch < oldest ? epoch : oldest;
+    }
+    return oldest;
+}
+
+// anything retired in epoch e can go once every active reader has announced an epoch after e.
+template <typename T> void dconcurrent_hashtable<T>::_reclaim()
+{
+    if (retired_head == DCONCURRENT_HASHTABLE_NO_INDEX && !retired_tables)
+    {
+        return;
+    }
+    u64 oldest = _oldest_active_epoch();
+
+    // entries are retired in epoch order, so stop at the first one that is still visible.
+    while (retired_head != DCONCURRENT_HASHTABLE_NO_INDEX && entries.data[retired_head].retire_epoch < oldest)
+    {
+        u32 index                = retired_head;
+        retired_head             = entries.data[index].next;
+        entries.data[index].next = free_head;
+        free_head                = index;
+    }
+    if (retired_head == DCONCURRENT_HASHTABLE_NO_INDEX)
+    {
+        retired_tail = DCONCURRENT_HASHTABLE_NO_INDEX;
+    }
+
+    slot_table **link = &retired_tables;
+    while (*link)
+    {
+        slot_table *old_table = *link;
+        if (old_table->retire_epoch < oldest)
+        {
+            *link = old_table->next_retired;
+            _free_table(old_table);
+            continue;
+        }
+        link = &old_table->next_retired;
+    }
+}
+
+template <typename T> u32 dconcurrent_hashtable<T>::_allocate_entry()
+{
+    if (free_head == DCONCURRENT_HASHTABLE_NO_INDEX && entries.length < entries.capacity)
+    {
+        entries.emplace_back();
+        return static_cast<u32>(entries.length - 1);
+    }
+    // out of fresh entries, wait for the readers to let go of the retired ones.
+    while (free_head == DCONCURRENT_HASHTABLE_NO_INDEX)
+    {
+        if (retired_head == DCONCURRENT_HASHTABLE_NO_INDEX)
+        {
+            DFATAL("Concurrent hashtable is full (%llu elements), raise its max_elements.", entries.capacity);
+        }
+        _reclaim();
+        if (free_head == DCONCURRENT_HASHTABLE_NO_INDEX)
+        {
+            std::this_thread::yield();
+        }
+    }
+    u32 index = free_head;
+    free_head = entries.data[index].next;
+    return index;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_retire_entry(u32 index)
+{
+    // the entry is unlinked already, everyone who reads global_epoch from now on cant see it.
+    entries.data[index].retire_epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    entries.data[index].next         = DCONCURRENT_HASHTABLE_NO_INDEX;
+    if (retired_tail == DCONCURRENT_HASHTABLE_NO_INDEX)
+    {
+        retired_head = index;
+    }
+    else
+    {
+        entries.data[retired_tail].next = index;
+    }
+    retired_tail = index;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::_insert_locked(u64 key, const T &value)
+{
+    u64    hash      = hash_func(key);
+    u32    index     = _allocate_entry();
+    entry *new_entry = &entries.data[index];
+    new_entry->key   = key;
+    new_entry->value = value;
+
+    slot_table *current   = table.load(std::memory_order_relaxed);
+    u64         old_value = 0;
+    u64         slot      = _probe(current, hash, key, &old_value);
+    if (slot != INVALID_ID_64)
+    {
+        // copy on write, readers see either the old or the new value, never half of each.
+        current->slots[slot].store(((hash >> 32) << 32) | index, std::memory_order_release);
+        _retire_entry(static_cast<u32>(old_value));
+    }
+    else
+    {
+        _grow_if_needed();
+        _place(table.load(std::memory_order_relaxed), hash, index);
+        num_elements_in_table.fetch_add(1, std::memory_order_relaxed);
+    }
+    _reclaim();
+}
+
+template <typename T> void dconcurrent_hashtable<T>::insert(u64 key, const T &value)
+{
+    _lock();
+    _insert_locked(key, value);
+    _unlock();
+}
+
+template <typename T> bool dconcurrent_hashtable<T>::update(u64 key, const T &value)
+{
+    _lock();
+    u64 old_value = 0;
+    if (_probe(table.load(std::memory_order_relaxed), hash_func(key), key, &old_value) == INVALID_ID_64)
+    {
+        _unlock();
+        DERROR("Couldnt associate a entry with key %llu.", key);
+        return false;
+    }
+    _insert_locked(key, value);
+    _unlock();
+    return true;
+}
+
+template <typename T> bool dconcurrent_hashtable<T>::erase(u64 key)
+{
+    _lock();
+    slot_table *current = table.load(std::memory_order_relaxed);
+    u64         value   = 0;
+    u64         slot    = _probe(current, hash_func(key), key, &value);
+    if (slot == INVALID_ID_64)
+    {
+        _unlock();
+        return false;
+    }
+    u32 index = static_cast<u32>(value);
+    current->slots[slot].store(DCONCURRENT_HASHTABLE_SLOT_TOMBSTONE, std::memory_order_release);
+    num_tombstones++;
+    num_elements_in_table.fetch_sub(1, std::memory_order_relaxed);
+    _retire_entry(index);
+    _reclaim();
+    _unlock();
+    return true;
+}
+
+template <typename T> void dconcurrent_hashtable<T>::reclaim()
+{
+    _lock();
+    _reclaim();
+    _unlock();
+}
+
+template <typename T> u64 dconcurrent_hashtable<T>::num_elements()
+{
+    return num_elements_in_table.load(std::memory_order_relaxed);
+}
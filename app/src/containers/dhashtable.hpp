@@ -1,8 +1,20 @@
 #pragma once
-// INFO:found this on sum random gogle search
-// this algorithm (k=33) was first reported by dan bernstein many years ago in comp.lang.c. another version of this
-// algorithm (now favored by bernstein) uses xor: hash(i) = hash(i - 1) * 33 ^ str[i]; the magic of number 33 (why it
-// works better than many other constants, prime or not) has never been adequately explained.
+// INFO: open addressing table in the style of google's SwissTable. Every slot has one control byte, either
+// DHASHTABLE_CTRL_EMPTY or the low 7 bits of the hash of the key that lives there, and the control bytes are kept in
+// their own array so that a lookup checks 16 slots with a couple of SSE2 instructions and only looks at a key when those
+// 7 bits match. The full 64 bit hash is stored next to the key, so a string compare only happens for real matches.
+//
+// Slots only hold an index into the dense entry array (key + value, filled front to back). The entries never move when
+// other entries are inserted or erased, pointers returned by find stay valid until that entry is erased or the table
+// grows.
+//
+// Probing is linear, 16 slots at a time starting at the home slot (the control bytes are mirrored past the end so the
+// last window doesnt need to wrap). Linear probing means erase can shift the following entries back instead of leaving
+// tombstones, so a table that sees a lot of insert/erase churn never degrades.
+//
+// Values of trivially copyable types are copied and cleared with plain memory ops. Everything else (shader_config with
+// its dstr and darray members) is copy constructed in on insert, move constructed into the new block when the table
+// grows and gets its destructor called on erase, clear and destruction, like darray does.
 
 #include "core/dasserts.hpp"
 #include "core/dmemory.hpp"
@@ -12,44 +24,86 @@
 
 #include "math/dmath.hpp"
 
+#include <new>
 #include <string.h>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DHASHTABLE_SSE2 1
+#endif
 
 #define MAX_KEY_LENGTH 64
 #define DEFAULT_HASH_TABLE_SIZE 20
 #define DEFAULT_HASH_TABLE_RESIZE_FACTOR 2
 
+#define DHASHTABLE_GROUP_WIDTH 16
+#define DHASHTABLE_CTRL_EMPTY 0x80
+// max load is 7/8 of the slots, there is always an empty slot to stop a probe.
+#define DHASHTABLE_MAX_LOAD_NUMERATOR 7
+#define DHASHTABLE_MAX_LOAD_DENOMINATOR 8
+
 template <typename T> class dhashtable
 {
   private:
+    enum key_kind : u32
+    {
+        KEY_KIND_FREE   = 0,
+        KEY_KIND_STRING = 1,
+        KEY_KIND_U64    = 2,
+    };
     struct entry
     {
-        bool   is_initialized    = false;
-        entry *next              = nullptr;
-        entry *prev              = nullptr;
-        u32    unique_identifier = INVALID_ID;
+        u64      hash;
+        // the u64 key, or the next free dense index while the entry is on the free list.
+        u64      int_key;
+        key_kind kind;
+        char     key[MAX_KEY_LENGTH];
+        T        type;
+    };
 
-        char key[MAX_KEY_LENGTH];
+    // slot_count + DHASHTABLE_GROUP_WIDTH control bytes, the tail mirrors the first DHASHTABLE_GROUP_WIDTH.
+    u8        *ctrl;
+    // dense index of the entry in every slot.
+    u32       *slots;
+    entry     *entries;
 
-        T type;
-    };
-    entry *table;
+    T *default_entry = nullptr;
 
-    entry *default_entry = nullptr;
+    static constexpr bool is_trivial = std::is_trivially_copyable<T>::value;
 
     u64 hash_func(const char *key);
     u64 hash_func(const u64 key);
 
-    u64 _find_empty_spot(u64 hash_code);
-
+    u64  _probe(u64 hash, key_kind kind, const char *str_key, u64 int_key);
+    u64  _find_empty_spot(u64 hash);
+    u32  _allocate_dense_index();
+    void _set_ctrl(u64 slot, u8 value);
+    void _erase_slot(u64 slot);
+    void _destroy_entries();
+    T   *_insert(u64 hash, key_kind kind, const char *str_key, u64 int_key, const T &type);
+
+    u64  _size_for_slots(u64 slots);
+    void _layout(void *block, u64 slot_count);
+    void _init_empty();
     void _im_paranoid();
     void _print_hashtable();
 
     void _resize_and_rehash();
 
-    u64    capacity;
-    u64    element_size;
+    u64    slot_count;
+    u64    slot_mask;
+    // max entries before the table has to grow.
     u64    max_length;
+    // dense indices handed out so far, erased ones go on the free list.
+    u64    dense_count;
+    u64    free_head;
+    // bytes of the block that holds everything.
+    u64    capacity;
     u64    num_elements_in_table;
+    void  *block;
+    bool   owns_block;
     arena *arena = nullptr;
 
   public:
@@ -79,11 +133,10 @@ template <typename T> class dhashtable
 
     T *find(const u64 key);
     T *find(const char *key);
+    // same as find but a miss is not an error, returns nullptr and doesnt log.
+    T *try_find(const u64 key);
 
-    /* INFO: this will return the index of the table where the value will be inserted, this is kind of a bad idea
-     * because when the hashtable resizes the previous returned values would not be valid. So this will only work for
-     * fixed size hashtables. "DONE: Maybe I should add a flag indicating that its a fixed size hashtable??" Call this
-     * only for fixed size hashtables */
+    // returns the key the value can be found with. Pass INVALID_ID_64 to have the table make up a unique key.
     u64  insert(const u64 key, T type);
     void insert(const char *key, T type);
 
@@ -93,74 +146,80 @@ template <typename T> class dhashtable
     void set_default_value(T default_val);
 };
 
-template <typename T> u64 dhashtable<T>::_find_empty_spot(u64 hash_code)
+static inline u64 dhashtable_slots_for(u64 table_size)
 {
-    u64 i  = hash_code + 1;
-    i     %= max_length;
-
-    while (i != hash_code)
+    u64 wanted = (table_size * DHASHTABLE_MAX_LOAD_DENOMINATOR) / DHASHTABLE_MAX_LOAD_NUMERATOR + 1;
+    u64 slots  = DHASHTABLE_GROUP_WIDTH;
+    while (slots < wanted)
     {
-        if (!table[i].is_initialized)
-        {
-            return i;
-        }
-        i++;
-        i %= max_length;
+        slots <<= 1;
     }
-    DERROR("Couldn't find empty spot");
-    return INVALID_ID_64;
+    return slots;
 }
 
-template <typename T> void dhashtable<T>::_resize_and_rehash()
+static inline u64 dhashtable_align_16(u64 size)
 {
-    DWARN("Hashtable does not have enough capacity to insert element. Resizing and rehashing");
+    return (size + 15) & ~static_cast<u64>(15);
+}
 
-    // get the pointer to the old table
-    entry *old_table      = table;
-    u64    old_capacity   = capacity;
-    u64    old_max_length = max_length;
-
-    entry *new_table =
-        static_cast<entry *>(dallocate(arena, capacity * DEFAULT_HASH_TABLE_RESIZE_FACTOR, MEM_TAG_DHASHTABLE));
-    table       = new_table;
-    capacity   *= DEFAULT_HASH_TABLE_RESIZE_FACTOR;
-    max_length  = capacity / element_size;
-    DTRACE("Num_elements_in_table before resize and rehash %d", num_elements_in_table);
-    num_elements_in_table = 0;
+template <typename T> u64 dhashtable<T>::_size_for_slots(u64 slots)
+{
+    u64 elements = (slots * DHASHTABLE_MAX_LOAD_NUMERATOR) / DHASHTABLE_MAX_LOAD_DENOMINATOR;
+    return dhashtable_align_16(slots + DHASHTABLE_GROUP_WIDTH) + dhashtable_align_16(slots * sizeof(u32)) +
+           elements * sizeof(entry);
+}
 
-    for (u64 i = 0; i < old_max_length; i++)
-    {
-        if (old_table[i].is_initialized)
-        {
-            old_table[i].next           = nullptr;
-            old_table[i].prev           = nullptr;
-            old_table[i].is_initialized = false;
-            insert(old_table[i].key, old_table[i].type);
-        }
-    }
-    dfree(old_table, old_capacity, MEM_TAG_DHASHTABLE);
+template <typename T> u64 dhashtable<T>::get_size_requirements(u64 table_size)
+{
+    return _size_for_slots(dhashtable_slots_for(table_size));
 }
-template <typename T> void dhashtable<T>::_im_paranoid()
+
+template <typename T> void dhashtable<T>::_layout(void *in_block, u64 in_slot_count)
 {
-    for (u64 i = 0; i < max_length; i++)
-    {
-        dzero_memory(&table[i], sizeof(entry));
-    }
+    slot_count = in_slot_count;
+    slot_mask  = in_slot_count - 1;
+    max_length = (in_slot_count * DHASHTABLE_MAX_LOAD_NUMERATOR) / DHASHTABLE_MAX_LOAD_DENOMINATOR;
+
+    u8 *ptr  = static_cast<u8 *>(in_block);
+    ctrl     = ptr;
+    ptr     += dhashtable_align_16(slot_count + DHASHTABLE_GROUP_WIDTH);
+    slots    = reinterpret_cast<u32 *>(ptr);
+    ptr     += dhashtable_align_16(slot_count * sizeof(u32));
+    entries  = reinterpret_cast<entry *>(ptr);
+    block    = in_block;
 }
-template <typename T> void dhashtable<T>::_print_hashtable()
+
+template <typename T> void dhashtable<T>::_init_empty()
+{
+    dset_memory_value(ctrl, DHASHTABLE_CTRL_EMPTY, slot_count + DHASHTABLE_GROUP_WIDTH);
+    num_elements_in_table = 0;
+    dense_count           = 0;
+    free_head             = INVALID_ID_64;
+}
+
+template <typename T> void dhashtable<T>::_set_ctrl(u64 slot, u8 value)
 {
-    for (u64 i = 0; i < max_length; i++)
+    ctrl[slot] = value;
+    if (slot < DHASHTABLE_GROUP_WIDTH)
     {
-        if (table[i].is_initialized)
-        {
-            DTRACE("%s", table[i].key);
-        }
+        ctrl[slot_count + slot] = value;
     }
 }
 
-template <typename T> u64 dhashtable<T>::get_size_requirements(u64 table_size)
+// bit i set if ctrl[pos + i] == value
+static inline u32 dhashtable_match_group(const u8 *group, u8 value)
 {
-    return sizeof(entry) * table_size;
+#if DHASHTABLE_SSE2
+    __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_bytes, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < DHASHTABLE_GROUP_WIDTH; i++)
+    {
+        mask |= static_cast<u32>(group[i] == value) << i;
+    }
+    return mask;
+#endif
 }
 
 template <typename T> u64 dhashtable<T>::hash_func(const u64 key)
@@ -176,71 +235,293 @@ template <typename T> u64 dhashtable<T>::hash_func(const u64 key)
 
 template <typename T> u64 dhashtable<T>::hash_func(const char *key)
 {
-    u64 hash = 5381;
-    u32 c;
+    // INFO: 8 bytes per step, multiply-xorshift on every word and the splitmix finalizer at the end. djb2 did one byte
+    // per step and left the top bits (the probe start) and the bottom 7 bits (the control byte) badly mixed for short
+    // similar keys like "texture_01", "texture_02".
+    u64 length = strlen(key);
+    u64 hash   = 0x9e3779b97f4a7c15 ^ (length * 0xff51afd7ed558ccd);
+    while (length >= 8)
+    {
+        u64 word;
+        memcpy(&word, key, 8);
+        hash    = (hash ^ word) * 0xbf58476d1ce4e5b9;
+        hash   ^= hash >> 29;
+        key    += 8;
+        length -= 8;
+    }
+    if (length)
+    {
+        u64 word = 0;
+        memcpy(&word, key, length);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9;
+    }
+    return hash_func(hash);
+}
 
-    while ((c = *key++))
+template <typename T> u64 dhashtable<T>::_probe(u64 hash, key_kind kind, const char *str_key, u64 int_key)
+{
+    u8  h2  = static_cast<u8>(hash & 0x7F);
+    u64 pos = (hash >> 7) & slot_mask;
+    // the slot indices only depend on the hash, fetch them while the control bytes are being compared.
+    __builtin_prefetch(&slots[pos]);
+
+    while (true)
     {
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+        const u8 *group   = &ctrl[pos];
+        u32       matches = dhashtable_match_group(group, h2);
+        while (matches)
+        {
+            u32        bit   = __builtin_ctz(matches);
+            u64        slot  = (pos + bit) & slot_mask;
+            entry *entry_ptr = &entries[slots[slot]];
+            if (entry_ptr->hash == hash && entry_ptr->kind == kind &&
+                (kind == KEY_KIND_U64 ? entry_ptr->int_key == int_key : string_compare(entry_ptr->key, str_key)))
+            {
+                return slot;
+            }
+            matches &= matches - 1;
+        }
+        if (dhashtable_match_group(group, DHASHTABLE_CTRL_EMPTY))
+        {
+            return INVALID_ID_64;
+        }
+        pos = (pos + DHASHTABLE_GROUP_WIDTH) & slot_mask;
     }
-    return hash;
+}
 
-    return hash;
+template <typename T> u64 dhashtable<T>::_find_empty_spot(u64 hash)
+{
+    u64 pos = (hash >> 7) & slot_mask;
+    while (true)
+    {
+        u32 empties = dhashtable_match_group(&ctrl[pos], DHASHTABLE_CTRL_EMPTY);
+        if (empties)
+        {
+            return (pos + __builtin_ctz(empties)) & slot_mask;
+        }
+        pos = (pos + DHASHTABLE_GROUP_WIDTH) & slot_mask;
+    }
+}
+
+template <typename T> u32 dhashtable<T>::_allocate_dense_index()
+{
+    if (free_head != INVALID_ID_64)
+    {
+        u32 index = static_cast<u32>(free_head);
+        free_head = entries[index].int_key;
+        return index;
+    }
+    DASSERT(dense_count < max_length);
+    return static_cast<u32>(dense_count++);
+}
+
+template <typename T> T *dhashtable<T>::_insert(u64 hash, key_kind kind, const char *str_key, u64 int_key, const T &type)
+{
+    if (num_elements_in_table + 1 > max_length)
+    {
+        if (is_non_resizable)
+        {
+            DASSERT_MSG(
+                1 == 0,
+                "Hashtable is signaled as non-resizable. Max entries reached. Increase the capacity of the table!!!");
+        }
+        DTRACE("Max capacity reached. Resizing and rehashing hahstable entries");
+        _resize_and_rehash();
+    }
+
+    u64 slot  = _find_empty_spot(hash);
+    u32 index = _allocate_dense_index();
+
+    entry *entry_ptr   = &entries[index];
+    entry_ptr->hash    = hash;
+    entry_ptr->int_key = int_key;
+    entry_ptr->kind    = kind;
+    entry_ptr->key[0]  = '\0';
+    if (kind == KEY_KIND_STRING)
+    {
+        u32 key_length = string_length(str_key);
+        if (key_length >= MAX_KEY_LENGTH)
+        {
+            DERROR("Hashtable key %s is longer than %d characters, it will be truncated.", str_key, MAX_KEY_LENGTH - 1);
+            key_length = MAX_KEY_LENGTH - 1;
+        }
+        dcopy_memory(entry_ptr->key, str_key, key_length);
+        entry_ptr->key[key_length] = '\0';
+    }
+    new (&entry_ptr->type) T(type);
+
+    slots[slot] = index;
+    _set_ctrl(slot, static_cast<u8>(hash & 0x7F));
+    num_elements_in_table++;
+    return &entry_ptr->type;
+}
+
+// INFO: backward shift deletion. Every entry after the hole that could live in the hole (its home slot is not between
+// the hole and where it sits now) moves back into it, until we hit an empty slot.
+template <typename T> void dhashtable<T>::_erase_slot(u64 slot)
+{
+    u32 index               = slots[slot];
+    entries[index].kind     = KEY_KIND_FREE;
+    entries[index].int_key  = free_head;
+    free_head               = index;
+    if constexpr (is_trivial)
+    {
+        dzero_memory(&entries[index].type, sizeof(T));
+    }
+    else
+    {
+        entries[index].type.~T();
+    }
+
+    u64 hole = slot;
+    u64 next = (slot + 1) & slot_mask;
+    while (ctrl[next] != DHASHTABLE_CTRL_EMPTY)
+    {
+        u64 home = (entries[slots[next]].hash >> 7) & slot_mask;
+        if (((next - home) & slot_mask) >= ((next - hole) & slot_mask))
+        {
+            slots[hole] = slots[next];
+            _set_ctrl(hole, ctrl[next]);
+            hole = next;
+        }
+        next = (next + 1) & slot_mask;
+    }
+    _set_ctrl(hole, DHASHTABLE_CTRL_EMPTY);
+    num_elements_in_table--;
+}
+
+template <typename T> void dhashtable<T>::_resize_and_rehash()
+{
+    DWARN("Hashtable does not have enough capacity to insert element. Resizing and rehashing");
+    DASSERT_MSG(arena, "Hashtable was initialized from a user block, it cannot grow.");
+
+    void      *old_block      = block;
+    u64        old_capacity   = capacity;
+    entry     *old_entries    = entries;
+    u64        old_dense      = dense_count;
+    u64        old_free_head  = free_head;
+    u64        old_elements   = num_elements_in_table;
+    u64        new_slot_count = slot_count * DEFAULT_HASH_TABLE_RESIZE_FACTOR;
+
+    capacity        = _size_for_slots(new_slot_count);
+    void *new_block = dallocate(arena, capacity, MEM_TAG_DHASHTABLE);
+    _layout(new_block, new_slot_count);
+    _init_empty();
+
+    // the dense indices stay the same, only the slots are rebuilt.
+    if constexpr (is_trivial)
+    {
+        dcopy_memory(entries, old_entries, old_dense * sizeof(entry));
+    }
+    else
+    {
+        for (u64 i = 0; i < old_dense; i++)
+        {
+            entries[i].hash    = old_entries[i].hash;
+            entries[i].int_key = old_entries[i].int_key;
+            entries[i].kind    = old_entries[i].kind;
+            dcopy_memory(entries[i].key, old_entries[i].key, MAX_KEY_LENGTH);
+            if (old_entries[i].kind != KEY_KIND_FREE)
+            {
+                new (&entries[i].type) T(std::move(old_entries[i].type));
+                old_entries[i].type.~T();
+            }
+        }
+    }
+    dense_count = old_dense;
+    free_head   = old_free_head;
+    for (u64 i = 0; i < old_dense; i++)
+    {
+        if (entries[i].kind == KEY_KIND_FREE)
+        {
+            continue;
+        }
+        u64 slot    = _find_empty_spot(entries[i].hash);
+        slots[slot] = static_cast<u32>(i);
+        _set_ctrl(slot, static_cast<u8>(entries[i].hash & 0x7F));
+    }
+    num_elements_in_table = old_elements;
+
+    if (owns_block)
+    {
+        dfree(old_block, old_capacity, MEM_TAG_DHASHTABLE);
+    }
+    owns_block = true;
+}
+// runs the destructors of the values still in the table, nothing to do for trivial types.
+template <typename T> void dhashtable<T>::_destroy_entries()
+{
+    if constexpr (!is_trivial)
+    {
+        for (u64 i = 0; block && i < dense_count; i++)
+        {
+            if (entries[i].kind != KEY_KIND_FREE)
+            {
+                entries[i].type.~T();
+                entries[i].kind = KEY_KIND_FREE;
+            }
+        }
+    }
+}
+
+template <typename T> void dhashtable<T>::_im_paranoid()
+{
+    _destroy_entries();
+    dzero_memory(block, capacity);
+    _init_empty();
+}
+template <typename T> void dhashtable<T>::_print_hashtable()
+{
+    for (u64 i = 0; i < slot_count; i++)
+    {
+        if (ctrl[i] != DHASHTABLE_CTRL_EMPTY)
+        {
+            DTRACE("%s", entries[slots[i]].key);
+        }
+    }
 }
 
 template <typename T> dhashtable<T>::dhashtable(struct arena *arena)
 {
-    element_size          = sizeof(entry);
-    capacity              = DEFAULT_HASH_TABLE_SIZE * element_size;
-    max_length            = DEFAULT_HASH_TABLE_SIZE;
-    num_elements_in_table = 0;
-    default_entry         = nullptr;
-    table                 = static_cast<entry *>(dallocate(arena, capacity, MEM_TAG_DHASHTABLE));
+    c_init(arena, DEFAULT_HASH_TABLE_SIZE);
 }
 
 template <typename T> dhashtable<T>::dhashtable(struct arena *arena, u64 table_size)
 {
-    element_size          = sizeof(entry);
-    capacity              = table_size * element_size;
-    max_length            = table_size;
-    num_elements_in_table = 0;
-    table                 = static_cast<entry *>(dallocate(arena, capacity, MEM_TAG_DHASHTABLE));
-    default_entry         = nullptr;
+    c_init(arena, table_size);
 }
 
 template <typename T> void dhashtable<T>::c_init(struct arena *arena)
 {
-    element_size          = sizeof(entry);
-    capacity              = DEFAULT_HASH_TABLE_SIZE * element_size;
-    max_length            = DEFAULT_HASH_TABLE_SIZE;
-    num_elements_in_table = 0;
-    default_entry         = nullptr;
-    table                 = static_cast<entry *>(dallocate(arena, capacity, MEM_TAG_DHASHTABLE));
+    c_init(arena, DEFAULT_HASH_TABLE_SIZE);
 }
-template <typename T> void dhashtable<T>::c_init(void *block, u64 table_size)
+template <typename T> void dhashtable<T>::c_init(void *in_block, u64 table_size)
 {
-    element_size          = sizeof(entry);
-    capacity              = table_size * element_size;
-    max_length            = table_size;
-    num_elements_in_table = 0;
-    table                 = static_cast<entry *>(block);
-    default_entry         = nullptr;
+    capacity      = get_size_requirements(table_size);
+    owns_block    = false;
+    default_entry = nullptr;
+    _layout(in_block, dhashtable_slots_for(table_size));
+    _init_empty();
 }
 
 template <typename T> void dhashtable<T>::c_init(struct arena *arena, u64 table_size)
 {
-    element_size          = sizeof(entry);
-    capacity              = table_size * element_size;
-    max_length            = table_size;
-    num_elements_in_table = 0;
-    table                 = static_cast<entry *>(dallocate(arena, capacity, MEM_TAG_DHASHTABLE));
-    default_entry         = nullptr;
+    this->arena   = arena;
+    capacity      = get_size_requirements(table_size);
+    owns_block    = true;
+    default_entry = nullptr;
+    _layout(dallocate(arena, capacity, MEM_TAG_DHASHTABLE), dhashtable_slots_for(table_size));
+    _init_empty();
 }
 
 template <typename T> dhashtable<T>::~dhashtable()
 {
-    dfree(table, capacity, MEM_TAG_DHASHTABLE);
-    element_size          = 0;
+    _destroy_entries();
+    if (owns_block && block)
+    {
+        dfree(block, capacity, MEM_TAG_DHASHTABLE);
+    }
+    block                 = nullptr;
     capacity              = 0;
     max_length            = 0;
     num_elements_in_table = 0;
@@ -250,107 +531,67 @@ template <typename T> void dhashtable<T>::set_default_value(T default_val)
 {
     if (!default_entry)
     {
-        default_entry = static_cast<entry *>(dallocate(arena, sizeof(entry), MEM_TAG_DHASHTABLE));
+        default_entry = static_cast<T *>(dallocate(arena, sizeof(T), MEM_TAG_DHASHTABLE));
+        new (default_entry) T(default_val);
+        return;
     }
-    default_entry->type = default_val;
+    *default_entry = default_val;
 }
 
 template <typename T> bool dhashtable<T>::update(const u64 key, T type)
 {
-    s64 dummy = key;
     if (key == INVALID_ID_64)
     {
         DERROR("Invalid key for updating the entry.");
+        return false;
     }
-    u32 high = static_cast<u32>(dummy >> 32);
-    u32 low  = static_cast<u32>(dummy);
-
-    entry *entry_ptr = &table[low];
-    if (table[low].is_initialized)
-    {
-        entry_ptr->type              = type;
-    }
-    else
+    u64 slot = _probe(hash_func(key), KEY_KIND_U64, nullptr, key);
+    if (slot == INVALID_ID_64)
     {
-        DERROR("Coulndt associate a entry with key %llu, high %d low %d.",key, high, low);
+        DERROR("Coulndt associate a entry with key %llu.", key);
         return false;
     }
+    entries[slots[slot]].type = type;
     return true;
 }
-//
-// should make the bottom 32 bits as the index for the hastable entry and the top 32 bits for the unique-id;
-template <typename T> u64 dhashtable<T>::insert(const u64 key, T type)
+
+template <typename T> void dhashtable<T>::update(const char *key, T type)
 {
-    s64 dummy = key;
-    if (key == INVALID_ID_64)
+    DASSERT(key);
+    u64 hash = hash_func(key);
+    u64 slot = _probe(hash, KEY_KIND_STRING, key, 0);
+    if (slot == INVALID_ID_64)
     {
-        dummy = drandom_s64();
+        _insert(hash, KEY_KIND_STRING, key, 0, type);
+        return;
     }
+    entries[slots[slot]].type = type;
+}
 
-    // generate a unqiue identifier and a index
-    u64 hash_code = hash_func(dummy);
-
-    // the high 32 bits will be the unique identifier that we will match for when the user queries for the data.
-    // the low 32 bits will be the index for the query.
-    u32 high = static_cast<u32>(dummy >> 32);
-    u32 low  = static_cast<u32>(dummy);
-
-    low %= max_length;
-
-    if (num_elements_in_table + 1 > max_length)
+template <typename T> u64 dhashtable<T>::insert(const u64 key, T type)
+{
+    u64 final_key = key;
+    if (key == INVALID_ID_64)
     {
-
-        if (is_non_resizable)
+        // make up a key that isnt taken yet.
+        do
         {
-            DASSERT_MSG(
-                1 == 0,
-                "Hashtable is signaled as non-resizable. Max entries reached. Increase the capacity of the table!!!");
-        }
-        DTRACE("Max capacity reached. Resizing and rehashing hahstable entries");
-        _resize_and_rehash();
-
-        hash_code = hash_func(dummy);
-
-        high  = static_cast<u32>(dummy >> 32);
-        low   = static_cast<u32>(dummy);
-        low  %= max_length;
+            final_key = static_cast<u64>(drandom_s64());
+        } while (final_key == INVALID_ID_64 ||
+                 _probe(hash_func(final_key), KEY_KIND_U64, nullptr, final_key) != INVALID_ID_64);
     }
 
-    entry *entry_ptr = &table[low];
-    if (table[low].is_initialized)
+    u64 hash = hash_func(final_key);
+    u64 slot = _probe(hash, KEY_KIND_U64, nullptr, final_key);
+    if (slot != INVALID_ID_64)
     {
-
-        entry *prev = nullptr;
-        while (entry_ptr->next)
-        {
-            prev      = entry_ptr;
-            entry_ptr = entry_ptr->next;
-        }
-        u64 get_empty_id = _find_empty_spot(hash_code);
-
-        if (get_empty_id == INVALID_ID_64)
-        {
-            DFATAL("Table size: %d, elements_in_table: %d", max_length, num_elements_in_table);
-        }
-
-        entry_ptr->next = &table[get_empty_id];
-        entry_ptr->prev = prev;
-        entry_ptr       = entry_ptr->next;
-
-        low = get_empty_id;
+        entries[slots[slot]].type = type;
+        return final_key;
     }
+    _insert(hash, KEY_KIND_U64, nullptr, final_key, type);
 
-    entry_ptr->unique_identifier = high;
-    entry_ptr->type              = type;
-    entry_ptr->next              = nullptr;
-    entry_ptr->is_initialized    = true;
-
-    num_elements_in_table++;
-
-    u64 final_id = (static_cast<u64>(high) << 32) | low;
-    DASSERT(final_id != INVALID_ID_64);
-
-    return final_id;
+    DASSERT(final_key != INVALID_ID_64);
+    return final_key;
 }
 
 template <typename T> void dhashtable<T>::insert(const char *key, T type)
@@ -360,51 +601,15 @@ template <typename T> void dhashtable<T>::insert(const char *key, T type)
         DERROR("Key is nullptr. must have a key.");
         return;
     }
-    u64 hash_code  = hash_func(key);
-    hash_code     %= max_length;
-    if (num_elements_in_table + 1 > max_length)
+    u64 hash = hash_func(key);
+    u64 slot = _probe(hash, KEY_KIND_STRING, key, 0);
+    if (slot != INVALID_ID_64)
     {
-
-        if (is_non_resizable)
-        {
-            DASSERT_MSG(
-                1 == 0,
-                "Hashtable is signaled as non-resizable. Max entries reached. Increase the capacity of the table!!!");
-        }
-        DTRACE("Max capacity reached. Resizing and rehashing hahstable entries");
-        _resize_and_rehash();
-
-        hash_code  = hash_func(key);
-        hash_code %= max_length;
-    }
-
-    entry *entry_ptr = &table[hash_code];
-    if (table[hash_code].is_initialized)
-    {
-
-        entry *prev = nullptr;
-        while (entry_ptr->next)
-        {
-            prev      = entry_ptr;
-            entry_ptr = entry_ptr->next;
-        }
-        u64 get_empty_id = _find_empty_spot(hash_code);
-        if (get_empty_id == INVALID_ID_64)
-        {
-            DFATAL("Table size: %d, elements_in_table: %d", max_length, num_elements_in_table);
-        }
-        DASSERT(get_empty_id != INVALID_ID_64);
-
-        entry_ptr->next = &table[get_empty_id];
-        entry_ptr->prev = prev;
-        entry_ptr       = entry_ptr->next;
+        DWARN("Key %s is already in the hashtable, overwriting it.", key);
+        entries[slots[slot]].type = type;
+        return;
     }
-    dcopy_memory(entry_ptr->key, static_cast<const void *>(key), strlen(key));
-    entry_ptr->type           = type;
-    entry_ptr->next           = nullptr;
-    entry_ptr->is_initialized = true;
-
-    num_elements_in_table++;
+    _insert(hash, KEY_KIND_STRING, key, 0, type);
     return;
 }
 
@@ -415,41 +620,24 @@ template <typename T> T *dhashtable<T>::find(const u64 key)
         DFATAL("Key is invalid_id_64");
     }
 
-    u32 high = static_cast<u32>(key >> 32);
-    u32 low  = static_cast<u32>(key);
-
-    entry *entry_ptr = &table[low];
-
-    if (!table[low].is_initialized)
+    u64 slot = _probe(hash_func(key), KEY_KIND_U64, nullptr, key);
+    if (slot == INVALID_ID_64)
     {
         if (default_entry)
         {
-            DWARN("Couldnt find unique_identifer: %d for index: %d. It doesnt exist in the hashtable, returning "
-                  "default_val",
-                  key);
-            return &default_entry->type;
+            DWARN("Couldnt find key: %llu. It doesnt exist in the hashtable, returning default_val", key);
+            return default_entry;
         }
-        DERROR("The provided key %llu high: %d , low: %d, doesnt map to a entry. Returning nullptr", key, high, low);
+        DERROR("The provided key %llu doesnt map to a entry. Returning nullptr", key);
         return nullptr;
     }
-    if (entry_ptr->unique_identifier != high)
-    {
-        if (is_non_resizable)
-        {
-            DFATAL("The provided key %llu high: %d , low: %d, maps to a incorrent entry. You mayhave resized a "
-                   "un-resizable array so that the hash codes were changed.",
-                   key, high, low);
-        }
-        else
-        {
-            DFATAL(
-                "The provided key %llu high: %d , low: %d, maps to a incorrent entry. Something is really wrong here.",
-                key, high, low);
-        }
-    }
+    return &entries[slots[slot]].type;
+}
 
-    T *type_ref = &entry_ptr->type;
-    return type_ref;
+template <typename T> T *dhashtable<T>::try_find(const u64 key)
+{
+    u64 slot = _probe(hash_func(key), KEY_KIND_U64, nullptr, key);
+    return slot == INVALID_ID_64 ? nullptr : &entries[slots[slot]].type;
 }
 
 template <typename T> T *dhashtable<T>::find(const char *key)
@@ -459,31 +647,18 @@ template <typename T> T *dhashtable<T>::find(const char *key)
         DFATAL("Key is nullptr");
     }
 
-    u64 hash_code  = hash_func(key);
-    hash_code     %= max_length;
-
-    entry *entry_ptr = &table[hash_code];
-
-    while (entry_ptr)
-    {
-        if (string_compare(key, entry_ptr->key))
-        {
-            break;
-        }
-        entry_ptr = entry_ptr->next;
-    }
-    if (!entry_ptr)
+    u64 slot = _probe(hash_func(key), KEY_KIND_STRING, key, 0);
+    if (slot == INVALID_ID_64)
     {
         if (default_entry)
         {
             DWARN("Couldnt find key: %s. It doesnt exist in the hashtable, returning default_val", key);
-            return &default_entry->type;
+            return default_entry;
         }
         DWARN("Couldnt find key: %s. It doesnt exist in the hashtable, returning nullptr", key);
         return nullptr;
     }
-    T *type_ref = &entry_ptr->type;
-    return type_ref;
+    return &entries[slots[slot]].type;
 }
 
 template <typename T> bool dhashtable<T>::erase(u64 key)
@@ -493,67 +668,33 @@ template <typename T> bool dhashtable<T>::erase(u64 key)
         DFATAL("Key is invalid_id_64");
     }
 
-    u32 high = static_cast<u32>(key >> 32);
-    u32 low  = static_cast<u32>(key);
-
-    entry *entry_ptr = &table[low];
-
-    if (!table[low].is_initialized)
+    u64 slot = _probe(hash_func(key), KEY_KIND_U64, nullptr, key);
+    if (slot == INVALID_ID_64)
     {
-        DERROR("The provided key %llu high: %d , low: %d, doesnt map to a entry. Cannot erase with incorrect id.", key,
-               high, low);
+        DERROR("The provided key %llu doesnt map to a entry. Cannot erase with incorrect id.", key);
         return false;
     }
-    if (entry_ptr->unique_identifier != high)
-    {
-        if (is_non_resizable)
-        {
-            DFATAL("The provided key %llu high: %d , low: %d, maps to a incorrent entry. You mayhave resized a "
-                   "un-resizable array so that the hash codes were changed.",
-                   key, high, low);
-        }
-        else
-        {
-            DFATAL(
-                "The provided key %llu high: %d , low: %d, maps to a incorrent entry. Something is really wrong here.",
-                key, high, low);
-        }
-    }
-
-    dset_memory_value(entry_ptr, 0, element_size);
-    num_elements_in_table--;
+    _erase_slot(slot);
     return true;
 }
 template <typename T> bool dhashtable<T>::erase(const char *key)
 {
-    u64 hash_code  = hash_func(key);
-    hash_code     %= max_length;
-
-    entry *entry_ptr = &table[hash_code];
-    bool   found     = string_compare(key, entry_ptr->key);
-
-    if (!found && entry_ptr->next)
+    DASSERT(key);
+    u64 slot = _probe(hash_func(key), KEY_KIND_STRING, key, 0);
+    if (slot == INVALID_ID_64)
     {
-        entry *prev = entry_ptr;
-        while (entry_ptr)
-        {
-            if (string_compare(key, entry_ptr->key))
-            {
-                dset_memory_value(entry_ptr, 0, element_size);
-            }
-            prev      = entry_ptr;
-            entry_ptr = entry_ptr->next;
-        }
+        return false;
     }
-    dset_memory_value(entry_ptr, 0, element_size);
-    num_elements_in_table--;
+    _erase_slot(slot);
     return true;
 }
 
 template <typename T> void dhashtable<T>::clear()
 {
     DWARN("Clearing everything!!!");
-    dzero_memory(table, capacity);
+    _destroy_entries();
+    dzero_memory(block, capacity);
+    _init_empty();
 }
 template <typename T> u64 dhashtable<T>::size()
 {
@@ -0,0 +1,274 @@
+#pragma once
+// INFO: bounded lock-free queues for handing work from one thread to another (log lines to the log thread, decoded
+// textures from a loader to the render thread, events). Both have a power of two capacity (rounded up), the storage
+// comes out of an arena and every index that a different thread writes sits on its own cache line so the producer and
+// the consumer dont keep stealing the line from each other.
+//
+// dspsc_ring: exactly one producer thread and one consumer thread. Each side keeps a cached copy of the other side's
+// index and only reloads it when the ring looks full/empty, so most pushes/pops touch no shared cache line at all.
+//
+// dmpmc_ring: any number of producers and consumers (Dmitry Vyukov's bounded queue). Every cell has a sequence number
+// that says whose turn it is, a push/pop is one CAS on the shared index plus the cell.
+//
+// try_push/try_pop never block, they return false when the ring is full/empty. What to do then (spin, yield, drop) is
+// up to the caller.
+
+#include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "defines.hpp"
+#include "memory/arenas.hpp"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#define DRING_BUFFER_CACHE_LINE 64
+
+static inline u64 dring_buffer_round_capacity(u64 capacity)
+{
+    u64 rounded = 2;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+// cache line aligned block out of the arena, the raw pointer is what has to be handed to dfree.
+static inline void *dring_buffer_allocate(arena *arena, u64 size, void **out_block, u64 *out_block_size)
+{
+    *out_block_size = size + DRING_BUFFER_CACHE_LINE;
+    *out_block      = dallocate(arena, *out_block_size, MEM_TAG_RING_BUFFER);
+    uintptr_t addr  = reinterpret_cast<uintptr_t>(*out_block);
+    return reinterpret_cast<void *>((addr + DRING_BUFFER_CACHE_LINE - 1) &
+                                    ~static_cast<uintptr_t>(DRING_BUFFER_CACHE_LINE - 1));
+}
+
+template <typename T> class dspsc_ring
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ring elements are copied around with plain stores");
+
+  private:
+    // producer line
+    alignas(DRING_BUFFER_CACHE_LINE) std::atomic<u64> tail{0};
+    u64 cached_head = 0;
+    // consumer line
+    alignas(DRING_BUFFER_CACHE_LINE) std::atomic<u64> head{0};
+    u64 cached_tail = 0;
+    // read only after init
+    alignas(DRING_BUFFER_CACHE_LINE) T *buffer = nullptr;
+    u64   mask       = 0;
+    void *block      = nullptr;
+    u64   block_size = 0;
+
+  public:
+    void init(arena *arena, u64 capacity);
+    void destroy();
+
+    // producer thread only
+    bool try_push(const T &element);
+    // consumer thread only
+    bool try_pop(T *out_element);
+
+    // exact from either side when the other one is idle, a snapshot otherwise.
+    u64 size();
+    u64 capacity();
+};
+
+template <typename T> void dspsc_ring<T>::init(arena *arena, u64 in_capacity)
+{
+    DASSERT(arena);
+    DASSERT_MSG(!buffer, "THE RING HAS BEEN ALREADY INITIALIZED.");
+    u64 ring_capacity = dring_buffer_round_capacity(in_capacity);
+    buffer            = static_cast<T *>(dring_buffer_allocate(arena, sizeof(T) * ring_capacity, &block, &block_size));
+    mask              = ring_capacity - 1;
+    tail.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_relaxed);
+    cached_head = 0;
+    cached_tail = 0;
+}
+
+template <typename T> void dspsc_ring<T>::destroy()
+{
+    if (block)
+    {
+        dfree(block, block_size, MEM_TAG_RING_BUFFER);
+    }
+    buffer = nullptr;
+    block  = nullptr;
+}
+
+template <typename T> bool dspsc_ring<T>::try_push(const T &element)
+{
+    u64 write = tail.load(std::memory_order_relaxed);
+    if (write - cached_head > mask)
+    {
+        cached_head = head.load(std::memory_order_acquire);
+        if (write - cached_head > mask)
+        {
+            return false;
+        }
+    }
+    buffer[write & mask] = element;
+    tail.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> bool dspsc_ring<T>::try_pop(T *out_element)
+{
+    u64 read = head.load(std::memory_order_relaxed);
+    if (read == cached_tail)
+    {
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (read == cached_tail)
+        {
+            return false;
+        }
+    }
+    *out_element = buffer[read & mask];
+    head.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> u64 dspsc_ring<T>::size()
+{
+    u64 read  = head.load(std::memory_order_acquire);
+    u64 write = tail.load(std::memory_order_acquire);
+    return write - read;
+}
+
+template <typename T> u64 dspsc_ring<T>::capacity()
+{
+    return mask + 1;
+}
+
+template <typename T> class dmpmc_ring
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ring elements are copied around with plain stores");
+
+  private:
+    struct cell
+    {
+        // == position: free for the push at that position, == position + 1: full, for the pop at that position.
+        std::atomic<u64> sequence;
+        T                element;
+    };
+
+    alignas(DRING_BUFFER_CACHE_LINE) std::atomic<u64> enqueue_position{0};
+    alignas(DRING_BUFFER_CACHE_LINE) std::atomic<u64> dequeue_position{0};
+    alignas(DRING_BUFFER_CACHE_LINE) cell *cells = nullptr;
+    u64   mask       = 0;
+    void *block      = nullptr;
+    u64   block_size = 0;
+
+  public:
+    void init(arena *arena, u64 capacity);
+    void destroy();
+
+    bool try_push(const T &element);
+    bool try_pop(T *out_element);
+
+    // a snapshot, other threads can move it right after.
+    u64 size();
+    u64 capacity();
+};
+
+template <typename T> void dmpmc_ring<T>::init(arena *arena, u64 in_capacity)
+{
+    DASSERT(arena);
+    DASSERT_MSG(!cells, "THE RING HAS BEEN ALREADY INITIALIZED.");
+    u64 ring_capacity = dring_buffer_round_capacity(in_capacity);
+    cells = static_cast<cell *>(dring_buffer_allocate(arena, sizeof(cell) * ring_capacity, &block, &block_size));
+    mask  = ring_capacity - 1;
+    for (u64 i = 0; i < ring_capacity; i++)
+    {
+        new (&cells[i].sequence) std::atomic<u64>(i);
+    }
+    enqueue_position.store(0, std::memory_order_relaxed);
+    dequeue_position.store(0, std::memory_order_relaxed);
+}
+
+template <typename T> void dmpmc_ring<T>::destroy()
+{
+    if (block)
+    {
+        dfree(block, block_size, MEM_TAG_RING_BUFFER);
+    }
+    cells = nullptr;
+    block = nullptr;
+}
+
+template <typename T> bool dmpmc_ring<T>::try_push(const T &element)
+{
+    u64   position = enqueue_position.load(std::memory_order_relaxed);
+    cell *target   = nullptr;
+    while (true)
+    {
+        target       = &cells[position & mask];
+        u64 sequence = target->sequence.load(std::memory_order_acquire);
+        s64 diff     = static_cast<s64>(sequence - position);
+        if (diff == 0)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // the pop for this cell one lap ago hasnt happened yet, full.
+            return false;
+        }
+        else
+        {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+    target->element = element;
+    target->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> bool dmpmc_ring<T>::try_pop(T *out_element)
+{
+    u64   position = dequeue_position.load(std::memory_order_relaxed);
+    cell *target   = nullptr;
+    while (true)
+    {
+        target       = &cells[position & mask];
+        u64 sequence = target->sequence.load(std::memory_order_acquire);
+        s64 diff     = static_cast<s64>(sequence - (position + 1));
+        if (diff == 0)
+        {
+            if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // nothing has been pushed into this cell yet, empty.
+            return false;
+        }
+        else
+        {
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+    *out_element = target->element;
+    // free for the push one lap later.
+    target->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> u64 dmpmc_ring<T>::size()
+{
+    u64 read  = dequeue_position.load(std::memory_order_acquire);
+    u64 write = enqueue_position.load(std::memory_order_acquire);
+    return write > read ? write - read : 0;
+}
+
+template <typename T> u64 dmpmc_ring<T>::capacity()
+{
+    return mask + 1;
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "containers/dstable_array.hpp"
+#include "core/dasserts.hpp"
+#include "core/logger.hpp"
+
+#include "defines.hpp"
+
+#include <utility>
+
+// low 32 bits are the slot index, high 32 bits the generation of the slot when the handle was made.
+typedef u64 dslot_handle;
+#define INVALID_SLOT_HANDLE INVALID_ID_64
+
+#define DSLOT_MAP_NO_INDEX 0xFFFFFFFFu
+
+// INFO: slot map. Every value lives in its slot, a handle is the slot index plus the generation of the slot when the
+// handle was made. Erasing destroys the value in place and bumps the slot's generation, so a stale handle is caught by
+// get() instead of handing out whatever got put in the slot next. Lookups are two array reads and a compare, no hashing.
+//
+// Values never move: inserting appends to a dstable_array and erasing leaves the other values where they are, so the
+// raw pointers the resource records keep to each other (geometry -> material -> textures) stay valid until the value
+// they point at is erased itself. A packed list of the used slots is kept for iteration (size()/at()), only that list
+// gets swap-removed.
+template <typename T> class dslot_map
+{
+  private:
+    struct slot
+    {
+        // index into used while the slot is used, next free slot while it is on the free list.
+        u32 index;
+        u32 generation;
+    };
+
+    // indexed by slot, erased values are default constructed again until the slot is reused.
+    dstable_array<T>    values;
+    dstable_array<slot> slots;
+    // the used slot indices, packed for iteration.
+    dstable_array<u32>  used;
+    u32                 free_head = DSLOT_MAP_NO_INDEX;
+
+  public:
+    void init(u64 max_elements);
+    void destroy();
+
+    dslot_handle insert(const T &value);
+    template <typename... Args> dslot_handle emplace(Args &&...args);
+    bool                                     erase(dslot_handle handle);
+
+    // nullptr if the handle is stale or was never valid.
+    T   *get(dslot_handle handle);
+    bool contains(dslot_handle handle);
+
+    // iteration over the used slots, the order changes when something is erased.
+    u64          size();
+    T           *at(u64 used_index);
+    dslot_handle handle_at(u64 used_index);
+    void         clear();
+};
+
+static inline u32 dslot_handle_index(dslot_handle handle)
+{
+    return static_cast<u32>(handle);
+}
+
+static inline u32 dslot_handle_generation(dslot_handle handle)
+{
+    return static_cast<u32>(handle >> 32);
+}
+
+static inline dslot_handle dslot_make_handle(u32 index, u32 generation)
+{
+    return (static_cast<u64>(generation) << 32) | index;
+}
+
+template <typename T> void dslot_map<T>::init(u64 max_elements)
+{
+    DASSERT(max_elements && max_elements < DSLOT_MAP_NO_INDEX);
+    values.init(max_elements);
+    slots.init(max_elements);
+    used.init(max_elements);
+    free_head = DSLOT_MAP_NO_INDEX;
+}
+
+template <typename T> void dslot_map<T>::destroy()
+{
+    values.destroy();
+    slots.destroy();
+    used.destroy();
+    free_head = DSLOT_MAP_NO_INDEX;
+}
+
+template <typename T> dslot_handle dslot_map<T>::insert(const T &value)
+{
+    return emplace(value);
+}
+
+template <typename T> template <typename... Args> dslot_handle dslot_map<T>::emplace(Args &&...args)
+{
+    u32 slot_index;
+    if (free_head != DSLOT_MAP_NO_INDEX)
+    {
+        slot_index         = free_head;
+        free_head          = slots[slot_index].index;
+        values[slot_index] = T(std::forward<Args>(args)...);
+    }
+    else
+    {
+        // generations start at 1, a zeroed handle is never valid.
+        slot_index = static_cast<u32>(slots.size());
+        slots.push_back({0, 1});
+        values.emplace_back(std::forward<Args>(args)...);
+    }
+
+    slots[slot_index].index = static_cast<u32>(used.size());
+    used.push_back(slot_index);
+    return dslot_make_handle(slot_index, slots[slot_index].generation);
+}
+
+template <typename T> T *dslot_map<T>::get(dslot_handle handle)
+{
+    u32 slot_index = dslot_handle_index(handle);
+    if (slot_index >= slots.size() || slots[slot_index].generation != dslot_handle_generation(handle))
+    {
+        return nullptr;
+    }
+    return &values[slot_index];
+}
+
+template <typename T> bool dslot_map<T>::contains(dslot_handle handle)
+{
+    return get(handle) != nullptr;
+}
+
+template <typename T> bool dslot_map<T>::erase(dslot_handle handle)
+{
+    if (!contains(handle))
+    {
+        return false;
+    }
+    u32 slot_index = dslot_handle_index(handle);
+    u32 hole       = slots[slot_index].index;
+    u32 last       = static_cast<u32>(used.size() - 1);
+    if (hole != last)
+    {
+        used[hole]              = used[last];
+        slots[used[hole]].index = hole;
+    }
+    used.pop_back();
+
+    // gives back whatever the value owns, the memory stays for the next value in this slot.
+    values[slot_index] = T();
+
+    // skip 0 on wrap around so a zeroed handle stays invalid.
+    slot *freed       = &slots[slot_index];
+    freed->generation = freed->generation + 1 ? freed->generation + 1 : 1;
+    freed->index      = free_head;
+    free_head         = slot_index;
+    return true;
+}
+
+template <typename T> u64 dslot_map<T>::size()
+{
+    return used.size();
+}
+
+template <typename T> T *dslot_map<T>::at(u64 used_index)
+{
+    return &values[used[used_index]];
+}
+
+template <typename T> dslot_handle dslot_map<T>::handle_at(u64 used_index)
+{
+    u32 slot_index = used[used_index];
+    return dslot_make_handle(slot_index, slots[slot_index].generation);
+}
+
+// every handle handed out so far goes stale.
+template <typename T> void dslot_map<T>::clear()
+{
+    while (used.size())
+    {
+        erase(handle_at(used.size() - 1));
+    }
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include "core/dasserts.hpp"
+#include "core/logger.hpp"
+#include "platform/platform.hpp"
+
+#include "defines.hpp"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// the array commits this many pages at a time as it grows.
+#define DSTABLE_ARRAY_COMMIT_PAGES 16
+
+// INFO: array that never moves its elements. init() reserves address space for max_elements up front and pages are
+// only committed as the array grows into them, so pointers into it stay valid for its whole lifetime and appending
+// never copies. Memory goes back to the os a page at a time with shrink()/clear(). The price is that max_elements is a
+// hard limit, pick it generously, reserved address space is free.
+template <typename T> class dstable_array
+{
+  public:
+    T  *data      = nullptr;
+    u64 length    = 0;
+    u64 capacity  = 0; // max_elements
+    u64 committed = 0; // bytes
+    u64 reserved  = 0; // bytes
+
+    void init(u64 max_elements);
+    void destroy();
+
+    const T &operator[](u64 index) const;
+    T       &operator[](u64 index);
+
+    T &push_back(const T &element);
+    T &push_back(T &&element);
+    template <typename... Args> T &emplace_back(Args &&...args);
+
+    T   &back();
+    void pop_back();
+    u64  size();
+
+    // gives the pages above the last element back to the os.
+    void shrink();
+    // destroys everything and gives all the pages back, the reserved range stays.
+    void clear();
+
+  private:
+    void commit_up_to(u64 bytes);
+    void destroy_range(u64 first, u64 last);
+};
+
+template <typename T> void dstable_array<T>::init(u64 max_elements)
+{
+    DASSERT_MSG(!data, "THE ARRAY HAS BEEN ALREADY INITIALIZED.");
+    DASSERT(max_elements);
+
+    u64 page_size = platform_get_info().page_size;
+    reserved      = (max_elements * sizeof(T) + page_size - 1) & ~(page_size - 1);
+    capacity      = max_elements;
+    committed     = 0;
+    length        = 0;
+    data          = static_cast<T *>(platform_virtual_reserve(reserved, true));
+}
+
+template <typename T> void dstable_array<T>::destroy()
+{
+    if (!data)
+    {
+        return;
+    }
+    destroy_range(0, length);
+    platform_virtual_unreserve(data, reserved);
+    data      = nullptr;
+    length    = 0;
+    capacity  = 0;
+    committed = 0;
+    reserved  = 0;
+}
+
+template <typename T> void dstable_array<T>::commit_up_to(u64 bytes)
+{
+    if (bytes <= committed)
+    {
+        return;
+    }
+    u64 chunk_size = static_cast<u64>(platform_get_info().page_size) * DSTABLE_ARRAY_COMMIT_PAGES;
+    u64 new_commit = (bytes + chunk_size - 1) & ~(chunk_size - 1);
+    if (new_commit > reserved)
+    {
+        new_commit = reserved;
+    }
+    u64 page_size = platform_get_info().page_size;
+    u8 *commit_at = reinterpret_cast<u8 *>(data) + committed;
+    platform_virtual_commit(commit_at, static_cast<u32>((new_commit - committed) / page_size));
+    committed = new_commit;
+}
+
+template <typename T> void dstable_array<T>::destroy_range(u64 first, u64 last)
+{
+    if constexpr (!std::is_trivially_destructible<T>::value)
+    {
+        for (u64 i = first; i < last; i++)
+        {
+            data[i].~T();
+        }
+    }
+}
+
+template <typename T> const T &dstable_array<T>::operator[](u64 index) const
+{
+    DASSERT_MSG(index < length, "Index is out of bounds....");
+    return data[index];
+}
+
+template <typename T> T &dstable_array<T>::operator[](u64 index)
+{
+    DASSERT_MSG(index < length, "Index is out of bounds....");
+    return data[index];
+}
+
+template <typename T> T &dstable_array<T>::push_back(const T &element)
+{
+    return emplace_back(element);
+}
+
+template <typename T> T &dstable_array<T>::push_back(T &&element)
+{
+    return emplace_back(std::move(element));
+}
+
+template <typename T> template <typename... Args> T &dstable_array<T>::emplace_back(Args &&...args)
+{
+    DASSERT_MSG(data, "Array hasn't been initialized. Call init with the max number of elements.");
+    if (length >= capacity)
+    {
+        DFATAL("Stable array is full (%llu elements), raise its max_elements.", capacity);
+    }
+    commit_up_to((length + 1) * sizeof(T));
+
+    T *elem = new (&data[length]) T(std::forward<Args>(args)...);
+    length++;
+    return *elem;
+}
+
+template <typename T> T &dstable_array<T>::back()
+{
+    DASSERT_MSG(length != 0, "No elements in the array.");
+    return data[length - 1];
+}
+
+template <typename T> void dstable_array<T>::pop_back()
+{
+    DASSERT_MSG(length != 0, "No elements in the array to pop back.");
+    length--;
+    destroy_range(length, length + 1);
+}
+
+template <typename T> u64 dstable_array<T>::size()
+{
+    return length;
+}
+
+template <typename T> void dstable_array<T>::shrink()
+{
+    u64 page_size = platform_get_info().page_size;
+    u64 needed    = (length * sizeof(T) + page_size - 1) & ~(page_size - 1);
+    if (needed >= committed)
+    {
+        return;
+    }
+    platform_virtual_free(reinterpret_cast<u8 *>(data) + needed, committed - needed, true);
+    committed = needed;
+}
+
+template <typename T> void dstable_array<T>::clear()
+{
+    destroy_range(0, length);
+    length = 0;
+    shrink();
+}
@@ -1,16 +1,21 @@
 #include "core/application.hpp"
 #include "core/dasserts.hpp"
 #include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "core/dstring_id.hpp"
 #include "core/event.hpp"
 #include "core/input.hpp"
 #include "core/logger.hpp"
 
 #include "defines.hpp"
 #include "main.hpp"
+#include "memory/arena_snapshot.hpp"
 #include "memory/arenas.hpp"
+#include "memory/frame_arena.hpp"
 #include "platform/platform.hpp"
 
 #include "renderer/renderer.hpp"
+#include "renderer/vulkan/vulkan_types.hpp"
 
 #include "resources/font_system.hpp"
 #include "resources/geometry_system.hpp"
@@ -24,9 +29,13 @@ bool event_callback_resize(event_context context, void *data);
 bool event_callback_key_released(event_context context, void *data);
 bool event_callback_quit(event_context context, void *data);
 
+// relative to the working directory, same as the assets.
+#define APPLICATION_RESOURCE_SNAPSHOT_PATH "resource_snapshot.bin"
+
 bool application_initialize(application_state *state, application_config *config)
 {
     DINFO("Initializing application...");
+    f64 init_start_time = platform_get_absolute_time();
 
     if (!state)
     {
@@ -44,51 +53,89 @@ bool application_initialize(application_state *state, application_config *config
     app_state_ptr->is_running         = true;
     app_state_ptr->is_minimized       = false;
 
-    u64 arena_pool_size = GB(1);
-    u32 num_arenas      = 8;
-    arena_allocate_arena_pool(arena_pool_size, num_arenas);
+    // INFO: the pool is only reserved, arenas commit pages as they grow so each arena gets a big address range and
+    // only pays for what it actually uses. The pool is split into small/medium/large arenas (64 MiB / 512 MiB / 4 GiB
+    // reserved), the small and medium ones are for scratch, frame and loader thread arenas.
+    u64 arena_pool_size = GB(64);
+    // set to ARENA_HUGE_PAGES_TRANSPARENT/EXPLICIT to back the arenas with 2 MiB pages.
+    arena_huge_page_mode huge_pages = ARENA_HUGE_PAGES_OFF;
+    arena_allocate_arena_pool(arena_pool_size, huge_pages);
 
     app_state_ptr->system_arena   = arena_get_arena();
     app_state_ptr->resource_arena = arena_get_arena();
     DASSERT(app_state_ptr->system_arena);
     DASSERT(app_state_ptr->resource_arena);
 
+    // one arena per frame in flight for the transient per frame data.
+    bool result = frame_arena_initialize(MAX_FRAMES_IN_FLIGHT);
+    DASSERT(result == true);
+
     arena *system_arena          = app_state_ptr->system_arena;
     arena *resource_system_arena = app_state_ptr->resource_arena;
 
+    // decoded texture pixels from the last launch. If there is no (valid) snapshot we record one while loading.
+    bool snapshot_loaded = arena_snapshot_open(APPLICATION_RESOURCE_SNAPSHOT_PATH);
+
     u64  memory_system_memory_requirements = INVALID_ID_64;
-    bool result                            = memory_system_startup(system_arena);
+    result                                 = memory_system_startup(system_arena);
     DASSERT(result == true);
 
+    // both of these hold the containers of the systems, let dfree() actually reuse their blocks.
+    memory_system_enable_slab(system_arena);
+    memory_system_enable_slab(resource_system_arena);
+
+    // resource names get interned by every resource system, this has to come first.
+    result = string_id_system_startup(system_arena);
+    DASSERT(result == true);
+    // names/paths in the resource records that dont fit inline in a dstr.
+    dstr_set_arena(resource_system_arena);
+
     result = event_system_startup(system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("event_system");
 
     event_system_register(EVENT_CODE_APPLICATION_QUIT, 0, event_callback_quit);
     event_system_register(EVENT_CODE_APPLICATION_RESIZED, 0, event_callback_resize);
 
     result = input_system_startup(system_arena);
     DASSERT(result);
+    memory_system_timeline_sample("input_system");
 
     result = platform_system_startup(system_arena, app_state_ptr->application_config);
     DASSERT(result == true);
+    memory_system_timeline_sample("platform_system");
 
     result = shader_system_startup(system_arena, resource_system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("shader_system");
 
     result = renderer_system_startup(system_arena, resource_system_arena, app_state_ptr->application_config);
     DASSERT(result == true);
+    memory_system_timeline_sample("renderer_system");
 
     result = texture_system_initialize(system_arena, resource_system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("texture_system");
 
     result = material_system_initialize(system_arena, resource_system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("material_system");
 
     result = font_system_initialize(system_arena, resource_system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("font_system");
 
     result = geometry_system_initialize(system_arena, resource_system_arena);
     DASSERT(result == true);
+    memory_system_timeline_sample("geometry_system");
+
+    if (!snapshot_loaded)
+    {
+        arena_snapshot_write();
+    }
+    f64 init_time = platform_get_absolute_time() - init_start_time;
+    DINFO("application_initialize took %.2f ms (resource snapshot %s).", init_time * 1000.0,
+          snapshot_loaded ? "loaded" : "recorded");
 
     u64 buffer_usg_mem_requirements = 0;
     get_memory_usg_str(&buffer_usg_mem_requirements, static_cast<char *>(0));
@@ -97,6 +144,21 @@ bool application_initialize(application_state *state, application_config *config
     get_memory_usg_str(&buffer_usg_mem_requirements, buffer);
     DDEBUG("%s", buffer);
 
+    get_arena_usg_str(&buffer_usg_mem_requirements, static_cast<char *>(0));
+    DASSERT(buffer_usg_mem_requirements <= sizeof(buffer));
+    get_arena_usg_str(&buffer_usg_mem_requirements, buffer);
+    DDEBUG("%s", buffer);
+
+    get_memory_slab_usg_str(&buffer_usg_mem_requirements, static_cast<char *>(0));
+    DASSERT(buffer_usg_mem_requirements <= sizeof(buffer));
+    get_memory_slab_usg_str(&buffer_usg_mem_requirements, buffer);
+    DDEBUG("%s", buffer);
+
+    get_memory_callsite_usg_str(&buffer_usg_mem_requirements, static_cast<char *>(0));
+    DASSERT(buffer_usg_mem_requirements <= sizeof(buffer));
+    get_memory_callsite_usg_str(&buffer_usg_mem_requirements, buffer);
+    DDEBUG("%s", buffer);
+
     return true;
 }
 
@@ -108,13 +170,20 @@ void application_shutdown()
     event_system_unregister(EVENT_CODE_APPLICATION_RESIZED, 0, event_callback_resize);
 
     texture_system_shutdown();
+    // writes the textures that were loaded after initialize, or drops the file if it went stale.
+    arena_snapshot_close();
     renderer_system_shutdown();
     platform_system_shutdown();
     input_system_shutdown();
     event_system_shutdown();
+    string_id_system_shutdown();
 
+#ifdef DEBUG
+    memory_system_export_timeline("memory_timeline.csv");
+#endif
     memory_system_shutdown();
 
+    frame_arena_shutdown();
     arena_free_arena(app_state_ptr->resource_arena);
     arena_free_arena(app_state_ptr->system_arena);
 
@@ -1,9 +1,12 @@
 #include "dfile_system.hpp"
 
 #include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
 #include "core/logger.hpp"
 #include "dstring.hpp"
 
+#include <cstdio>
+
 
 bool file_open(dstring file_name, std::fstream *out_file_handle, bool for_writing, bool is_binary)
 {
@@ -42,6 +45,25 @@ bool file_exists(dstring *path)
     return file.good();
 }
 
+bool file_get_size(const char *file_name, u64 *out_size)
+{
+    DASSERT(file_name);
+    DASSERT(out_size);
+    std::ifstream file(file_name, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    *out_size = file.tellg();
+    return true;
+}
+
+bool file_delete(const char *file_name)
+{
+    DASSERT(file_name);
+    return std::remove(file_name) == 0;
+}
+
 bool file_close(std::fstream *f)
 {
     DASSERT(f);
@@ -127,3 +149,43 @@ bool file_write(std::fstream *f, const char *buffer, u64 size)
 
     return true;
 }
+
+bool file_read_lines(arena *arena, const char *file_name, file_lines *out_lines)
+{
+    DASSERT(arena);
+    DASSERT(file_name);
+    DASSERT(out_lines);
+
+    u64 size = INVALID_ID_64;
+    if (!file_open_and_read(file_name, &size, 0, 0) || size == INVALID_ID_64)
+    {
+        return false;
+    }
+    out_lines->buffer = static_cast<char *>(DALLOCATE(arena, size + 1, MEM_TAG_UNKNOWN));
+    file_open_and_read(file_name, &size, out_lines->buffer, 0);
+    out_lines->buffer[size] = '\0';
+    out_lines->size         = size;
+    out_lines->reader       = text_line_reader(out_lines->buffer, size);
+    return true;
+}
+
+bool file_next_line(file_lines *lines, dstring *out_line)
+{
+    DASSERT(lines);
+    DASSERT(out_line);
+
+    dstring_view line;
+    if (!lines->reader.next(&line))
+    {
+        return false;
+    }
+    if (line.length >= MAX_STRING_LENGTH)
+    {
+        DWARN("Line is longer than %d characters, cutting it off.", MAX_STRING_LENGTH - 1);
+        line.length = MAX_STRING_LENGTH - 1;
+    }
+    dcopy_memory(out_line->string, line.data, line.length);
+    out_line->string[line.length] = '\0';
+    out_line->str_len             = line.length;
+    return true;
+}
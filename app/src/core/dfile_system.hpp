@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/dstring.hpp"
+#include "core/dtext_scan.hpp"
 #include "defines.hpp"
 
 #include <fstream>
@@ -12,6 +13,22 @@ bool file_close(std::fstream* f);
 bool file_get_line(std::fstream& f, dstring* out_line);
 
 bool file_exists(dstring *path);
+// non fatal, returns false if the file cant be opened.
+bool file_get_size(const char *file_name, u64 *out_size);
+bool file_delete(const char *file_name);
 
 bool file_write(std::fstream* f, const char* buffer, u64 size);
 bool file_open_and_read(const char *file_name, u64 *buffer_size_requirements, char *buffer, bool is_binary);
+
+// INFO: a text file read in one go, the lines are found with the text scanner. This is what the conf parsers read
+// through instead of an fstream + file_get_line.
+struct file_lines
+{
+    char            *buffer = nullptr;
+    u64              size   = 0;
+    text_line_reader reader = text_line_reader(nullptr, 0);
+};
+// the buffer goes into the arena, false if the file cant be opened.
+bool file_read_lines(arena *arena, const char *file_name, file_lines *out_lines);
+// copies the next line into out_line, '\0' terminated and without the line ending. False once there are no lines left.
+bool file_next_line(file_lines *lines, dstring *out_line);
@@ -2,22 +2,72 @@
 #include "core/dasserts.hpp"
 #include "core/logger.hpp"
 
+#include "core/dfile_system.hpp"
+#include "core/dstring.hpp"
 #include "defines.hpp"
+#include "memory/slab_allocator.hpp"
 #include "platform/platform.hpp"
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <new>
+
+// INFO: all the counters are relaxed atomics so that loader threads can allocate too and it is cheap enough to leave
+// on in release.
+struct memory_tag_stats
+{
+    std::atomic<u64> current_bytes;
+    std::atomic<u64> peak_bytes;
+    std::atomic<u64> allocations;
+    std::atomic<u64> frees;
+};
 
 struct memory_system_stats
 {
-    u64 total_allocated;
-    u64 tagged_allocations[MEM_TAG_MAX_TAGS];
+    memory_tag_stats tags[MEM_TAG_MAX_TAGS];
+
+    // reset by memory_system_begin_frame
+    std::atomic<u64> frame_allocations;
+    std::atomic<u64> frame_bytes;
+};
+
+struct memory_callsite
+{
+    // 0 means the slot is free. The file/line are written once by whoever claims the slot.
+    std::atomic<u64> key;
+    const char      *file;
+    u32              line;
+    std::atomic<u64> samples;
+    std::atomic<u64> sampled_bytes;
+};
+
+struct memory_timeline_sample
+{
+    const char *label;
+    f64         time;
+    u64         frame;
+    u64         frame_allocations;
+    u64         frame_bytes;
+    u64         tag_bytes[MEM_TAG_MAX_TAGS];
 };
 
 struct memory_system
 {
     //dfreelist          *dfreelist = nullptr;
     memory_system_stats stats;
+
+    memory_callsite callsites[MEMORY_CALLSITE_MAX_ENTRIES];
+
+    // ring buffer, only the main thread takes samples.
+    memory_timeline_sample timeline[MEMORY_TIMELINE_MAX_SAMPLES];
+    u64                    timeline_count;
+    u64                    frame_number;
+    f64                    start_time;
+
+    // the slab gets its own arena from the pool.
+    arena         *slab_arena;
+    slab_allocator slab;
 };
 
 static memory_system *memory_system_ptr;
@@ -30,15 +80,158 @@ static const char *memory_tag_strings[MEM_TAG_MAX_TAGS] = {
     "DARRAY     ",
     "APPLICATION",
     "RENDERER   ",
-    "GEOMETRY   "
+    "GEOMETRY   ",
+    "RING_BUFFER"
 };
 // clang-format on
 
+static thread_local u32 callsite_sample_countdown = 0;
+
+static void memory_stats_flush();
+
+// INFO: every thread collects its deltas locally and pushes them into the shared atomics every
+// MEMORY_STATS_FLUSH_INTERVAL allocations/frees. A handful of atomic adds per allocation was ~10x the cost of the
+// allocation itself. The reports can lag behind by that many allocations per thread, peaks are tracked at flush
+// granularity.
+#define MEMORY_STATS_FLUSH_INTERVAL 64
+
+struct memory_thread_stats
+{
+    u64 tag_allocated[MEM_TAG_MAX_TAGS];
+    u64 tag_freed[MEM_TAG_MAX_TAGS];
+    u64 tag_allocations[MEM_TAG_MAX_TAGS];
+    u64 tag_frees[MEM_TAG_MAX_TAGS];
+    u64 frame_allocations;
+    u64 frame_bytes;
+    u32 pending;
+
+    ~memory_thread_stats()
+    {
+        memory_stats_flush();
+    }
+};
+
+static thread_local memory_thread_stats thread_stats;
+
+static void memory_stats_flush()
+{
+    if (!memory_system_ptr || !thread_stats.pending)
+    {
+        return;
+    }
+    memory_system_stats *stats = &memory_system_ptr->stats;
+
+    for (u32 i = 0; i < MEM_TAG_MAX_TAGS; i++)
+    {
+        if (!thread_stats.tag_allocations[i] && !thread_stats.tag_frees[i])
+        {
+            continue;
+        }
+        memory_tag_stats *tag_stats = &stats->tags[i];
+
+        u64 delta   = thread_stats.tag_allocated[i] - thread_stats.tag_freed[i];
+        u64 current = tag_stats->current_bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+        u64 peak    = tag_stats->peak_bytes.load(std::memory_order_relaxed);
+        while (static_cast<s64>(current) > 0 && current > peak &&
+               !tag_stats->peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        {
+        }
+        tag_stats->allocations.fetch_add(thread_stats.tag_allocations[i], std::memory_order_relaxed);
+        tag_stats->frees.fetch_add(thread_stats.tag_frees[i], std::memory_order_relaxed);
+
+        thread_stats.tag_allocated[i]   = 0;
+        thread_stats.tag_freed[i]       = 0;
+        thread_stats.tag_allocations[i] = 0;
+        thread_stats.tag_frees[i]       = 0;
+    }
+    stats->frame_allocations.fetch_add(thread_stats.frame_allocations, std::memory_order_relaxed);
+    stats->frame_bytes.fetch_add(thread_stats.frame_bytes, std::memory_order_relaxed);
+    thread_stats.frame_allocations = 0;
+    thread_stats.frame_bytes       = 0;
+    thread_stats.pending           = 0;
+}
+
+static void memory_stats_add(memory_tags tag, u64 mem_size)
+{
+    thread_stats.tag_allocated[tag] += mem_size;
+    thread_stats.tag_allocations[tag]++;
+    thread_stats.frame_allocations++;
+    thread_stats.frame_bytes += mem_size;
+    if (++thread_stats.pending >= MEMORY_STATS_FLUSH_INTERVAL)
+    {
+        memory_stats_flush();
+    }
+}
+
+static void memory_stats_remove(memory_tags tag, u64 mem_size)
+{
+    thread_stats.tag_freed[tag] += mem_size;
+    thread_stats.tag_frees[tag]++;
+    if (++thread_stats.pending >= MEMORY_STATS_FLUSH_INTERVAL)
+    {
+        memory_stats_flush();
+    }
+}
+
+static void memory_record_callsite(const char *file, u32 line, u64 mem_size)
+{
+    // only every MEMORY_CALLSITE_SAMPLE_RATE'th allocation on a thread is recorded.
+    if (callsite_sample_countdown)
+    {
+        callsite_sample_countdown--;
+        return;
+    }
+    callsite_sample_countdown = MEMORY_CALLSITE_SAMPLE_RATE - 1;
+
+    // __FILE__ is a string literal so the pointer is good enough as an identity.
+    u64 key = (reinterpret_cast<uintptr_t>(file) * 0x9E3779B97F4A7C15ull) ^ line;
+    key     = key ? key : 1;
+
+    for (u32 probe = 0; probe < MEMORY_CALLSITE_MAX_ENTRIES; probe++)
+    {
+        memory_callsite *site     = &memory_system_ptr->callsites[(key + probe) % MEMORY_CALLSITE_MAX_ENTRIES];
+        u64              expected = site->key.load(std::memory_order_acquire);
+        if (expected == 0)
+        {
+            if (site->key.compare_exchange_strong(expected, key, std::memory_order_acq_rel))
+            {
+                site->file = file;
+                site->line = line;
+            }
+        }
+        if (expected == key || site->key.load(std::memory_order_relaxed) == key)
+        {
+            site->samples.fetch_add(1, std::memory_order_relaxed);
+            site->sampled_bytes.fetch_add(mem_size, std::memory_order_relaxed);
+            return;
+        }
+    }
+    // table is full, the call site just doesnt get attributed.
+}
+
+// memory_tag_strings are padded for the console, the exports want them without the spaces.
+static u32 memory_tag_name_length(memory_tags tag)
+{
+    const char *name   = memory_tag_strings[tag];
+    u32         length = 0;
+    while (name[length] && name[length] != ' ')
+    {
+        length++;
+    }
+    return length;
+}
+
 bool memory_system_startup(arena* arena)
 {
     DINFO("Starting up memory system...");
     DASSERT(arena);
     memory_system_ptr = static_cast<memory_system *>(dallocate(arena, sizeof(memory_system), MEM_TAG_APPLICATION));
+    new (memory_system_ptr) memory_system();
+    memory_system_ptr->start_time = platform_get_absolute_time();
+
+    memory_system_ptr->slab_arena = arena_get_arena(ARENA_SIZE_MEDIUM);
+    bool result                   = slab_allocator_create(memory_system_ptr->slab_arena, &memory_system_ptr->slab);
+    DASSERT(result);
 
     return true;
 }
@@ -46,9 +239,19 @@ bool memory_system_startup(arena* arena)
 void memory_system_shutdown()
 {
     DINFO("Shutting down memory system...");
+    memory_stats_flush();
+    slab_allocator_destroy(&memory_system_ptr->slab);
+    arena_free_arena(memory_system_ptr->slab_arena);
     memory_system_ptr = 0;
 }
 
+void memory_system_enable_slab(arena *in_arena)
+{
+    DASSERT(in_arena);
+    DASSERT_MSG(memory_system_ptr, "Memory system has to be started before enabling the slab on an arena.");
+    in_arena->slab_backed = true;
+}
+
 void *dallocate(arena* arena, u64 mem_size, memory_tags tag)
 {
     // we might not be tracking it accuretly though;
@@ -58,18 +261,33 @@ void *dallocate(arena* arena, u64 mem_size, memory_tags tag)
         {
             DWARN("dallocate() called with MEM_TAG_UNKNOWN. Classify the allocation.");
         }
-        if (memory_system_ptr)
-        {
-            memory_system_ptr->stats.tagged_allocations[tag] += mem_size;
-            memory_system_ptr->stats.total_allocated++;
-        }
+        memory_stats_add(tag, mem_size);
     }
     //void *block = platform_allocate(mem_size, false);
     //void *block = dfreelist_allocate(memory_system_ptr->dfreelist, mem_size);
-    void *block = arena_allocate_block(arena, mem_size);
+    void *block = nullptr;
+    if (memory_system_ptr && arena->slab_backed)
+    {
+        // returns nullptr for anything bigger than the biggest size class, those still come from the arena.
+        block = slab_allocator_allocate(&memory_system_ptr->slab, mem_size);
+    }
+    if (!block)
+    {
+        block = arena_allocate_block(arena, mem_size);
+    }
     DASSERT(block);
     return block;
 }
+
+void *dallocate_at(arena *arena, u64 mem_size, memory_tags tag, const char *file, u32 line)
+{
+    if (memory_system_ptr)
+    {
+        memory_record_callsite(file, line, mem_size);
+    }
+    return dallocate(arena, mem_size, tag);
+}
+
 void dfree(void *block, u64 mem_size, memory_tags tag)
 {
     if (tag == MEM_TAG_UNKNOWN)
@@ -78,14 +296,14 @@ void dfree(void *block, u64 mem_size, memory_tags tag)
     }
     if (memory_system_ptr)
     {
-        memory_system_ptr->stats.tagged_allocations[tag] -= mem_size;
-        memory_system_ptr->stats.total_allocated--;
+        memory_stats_remove(tag, mem_size);
+    }
+    // INFO: only slab blocks can be given back, anything that came straight from an arena stays there until the arena
+    // is reset.
+    if (memory_system_ptr && block && slab_allocator_owns(&memory_system_ptr->slab, block))
+    {
+        slab_allocator_free(&memory_system_ptr->slab, block);
     }
-    //bool result = dfreelist_dealocate(memory_system_ptr->dfreelist, block);
-    //if(!result)
-    //{
-    //    DERROR("dfreelist_dealocate failded!!!");
-    //}
     return;
 }
 void dset_memory_value(void *block, u64 value, u64 size)
@@ -100,6 +318,38 @@ void dcopy_memory(void *dest, const void *source, u64 size)
 {
     memcpy(dest, source, size);
 }
+void dmove_memory(void *dest, const void *source, u64 size)
+{
+    memmove(dest, source, size);
+}
+static void memory_format_size(u64 size, f32 *out_amount, const char **out_unit)
+{
+    const u64 gib = 1024 * 1024 * 1024;
+    const u64 mib = 1024 * 1024;
+    const u64 kib = 1024;
+
+    if (size >= gib)
+    {
+        *out_unit   = "GiB";
+        *out_amount = static_cast<f32>(size) / static_cast<f32>(gib);
+    }
+    else if (size >= mib)
+    {
+        *out_unit   = "MiB";
+        *out_amount = static_cast<f32>(size) / static_cast<f32>(mib);
+    }
+    else if (size >= kib)
+    {
+        *out_unit   = "KiB";
+        *out_amount = static_cast<f32>(size) / static_cast<f32>(kib);
+    }
+    else
+    {
+        *out_unit   = "B";
+        *out_amount = static_cast<f32>(size);
+    }
+}
+
 void get_memory_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer)
 {
     *buffer_usg_mem_requirements = 8000;
@@ -108,50 +358,206 @@ void get_memory_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer)
         return;
     }
 
-    const u64 gib      = 1024 * 1024 * 1024;
-    const u64 mib      = 1024 * 1024;
-    const u64 kib      = 1024;
-
-    const char *header = "System memory use (tagged):\n";
-    u64         offset = strlen(header);
+    memory_stats_flush();
 
-    dcopy_memory(out_buffer, reinterpret_cast<const void *>(header), offset);
+    u64 size   = *buffer_usg_mem_requirements;
+    u64 offset = string_append_format(out_buffer, size, 0, "System memory use (tagged, current / peak, allocations):\n");
 
     for (u32 i = 0; i < MEM_TAG_MAX_TAGS; ++i)
     {
-        char unit[4] = "XiB";
-        f32  amount  = 1.0f;
-        if (memory_system_ptr->stats.tagged_allocations[i] >= gib)
+        memory_tag_stats *tag_stats = &memory_system_ptr->stats.tags[i];
+
+        f32         current_amount;
+        const char *current_unit;
+        memory_format_size(tag_stats->current_bytes.load(std::memory_order_relaxed), &current_amount, &current_unit);
+
+        f32         peak_amount;
+        const char *peak_unit;
+        memory_format_size(tag_stats->peak_bytes.load(std::memory_order_relaxed), &peak_amount, &peak_unit);
+
+        offset = string_append_format(out_buffer, size, offset, "  %s: %.2f%s / %.2f%s, %llu\n", memory_tag_strings[i],
+                                      static_cast<f64>(current_amount), current_unit, static_cast<f64>(peak_amount),
+                                      peak_unit,
+                                      static_cast<unsigned long long>(
+                                          tag_stats->allocations.load(std::memory_order_relaxed)));
+    }
+
+    return;
+}
+
+void get_memory_callsite_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer)
+{
+    const u32 max_lines          = 16;
+    *buffer_usg_mem_requirements = 128 + max_lines * (MAX_FILE_NAME_PATH_SIZE + 64);
+    if (!out_buffer)
+    {
+        return;
+    }
+
+    u64 size   = *buffer_usg_mem_requirements;
+    u64 offset = string_append_format(out_buffer, size, 0,
+                                      "Top allocation call sites (estimated bytes, 1 in %d sampled):\n",
+                                      MEMORY_CALLSITE_SAMPLE_RATE);
+
+    // selection of the biggest few, the table is small and this is only for reporting.
+    bool printed[MEMORY_CALLSITE_MAX_ENTRIES] = {};
+    for (u32 line = 0; line < max_lines; line++)
+    {
+        u32 best       = INVALID_ID;
+        u64 best_bytes = 0;
+        for (u32 i = 0; i < MEMORY_CALLSITE_MAX_ENTRIES; i++)
+        {
+            memory_callsite *site  = &memory_system_ptr->callsites[i];
+            u64              bytes = site->sampled_bytes.load(std::memory_order_relaxed);
+            if (!printed[i] && site->file && bytes > best_bytes)
+            {
+                best       = i;
+                best_bytes = bytes;
+            }
+        }
+        if (best == INVALID_ID)
         {
-            unit[0] = 'G';
-            amount  = static_cast<f32>(memory_system_ptr->stats.tagged_allocations[i]) / static_cast<f32>(gib);
+            break;
         }
-        else if (memory_system_ptr->stats.tagged_allocations[i] >= mib)
+        printed[best] = true;
+
+        memory_callsite *site = &memory_system_ptr->callsites[best];
+        f32              amount;
+        const char      *unit;
+        memory_format_size(best_bytes * MEMORY_CALLSITE_SAMPLE_RATE, &amount, &unit);
+        offset = string_append_format(out_buffer, size, offset, "  %s:%u: %.2f%s (%llu samples)\n", site->file,
+                                      site->line, static_cast<f64>(amount), unit,
+                                      static_cast<unsigned long long>(site->samples.load(std::memory_order_relaxed)));
+    }
+}
+
+void memory_system_timeline_sample(const char *label)
+{
+    if (!memory_system_ptr)
+    {
+        return;
+    }
+    // the samples are taken on the main thread, so at least its own numbers are exact.
+    memory_stats_flush();
+
+    memory_timeline_sample *sample =
+        &memory_system_ptr->timeline[memory_system_ptr->timeline_count % MEMORY_TIMELINE_MAX_SAMPLES];
+    memory_system_ptr->timeline_count++;
+
+    sample->label             = label;
+    sample->time              = platform_get_absolute_time() - memory_system_ptr->start_time;
+    sample->frame             = memory_system_ptr->frame_number;
+    sample->frame_allocations = memory_system_ptr->stats.frame_allocations.load(std::memory_order_relaxed);
+    sample->frame_bytes       = memory_system_ptr->stats.frame_bytes.load(std::memory_order_relaxed);
+    for (u32 i = 0; i < MEM_TAG_MAX_TAGS; i++)
+    {
+        sample->tag_bytes[i] = memory_system_ptr->stats.tags[i].current_bytes.load(std::memory_order_relaxed);
+    }
+}
+
+void memory_system_begin_frame()
+{
+    if (!memory_system_ptr)
+    {
+        return;
+    }
+    // the sample closes the frame that just finished.
+    memory_system_timeline_sample("frame");
+    memory_system_ptr->frame_number++;
+    memory_system_ptr->stats.frame_allocations.store(0, std::memory_order_relaxed);
+    memory_system_ptr->stats.frame_bytes.store(0, std::memory_order_relaxed);
+}
+
+bool memory_system_export_timeline(const char *file_path)
+{
+    DASSERT(memory_system_ptr);
+    DASSERT(file_path);
+
+    std::fstream f;
+    bool         result = file_open(file_path, &f, true, false);
+    if (!result)
+    {
+        DERROR("Failed to open %s for the memory timeline export.", file_path);
+        return false;
+    }
+
+    u32  path_length = static_cast<u32>(strlen(file_path));
+    bool json        = path_length > 5 && strcmp(file_path + path_length - 5, ".json") == 0;
+
+    u64 count = memory_system_ptr->timeline_count;
+    u64 first = count > MEMORY_TIMELINE_MAX_SAMPLES ? count - MEMORY_TIMELINE_MAX_SAMPLES : 0;
+
+    // a line that doesnt fit is cut off, string_append_format keeps length inside the buffer.
+    char line[1024];
+    u64  length = 0;
+
+    if (json)
+    {
+        file_write(&f, "[\n", 2);
+    }
+    else
+    {
+        length = string_append_format(line, sizeof(line), 0, "label,time,frame,frame_allocations,frame_bytes");
+        for (u32 t = 0; t < MEM_TAG_MAX_TAGS; t++)
         {
-            unit[0] = 'M';
-            amount  = static_cast<f32>(memory_system_ptr->stats.tagged_allocations[i]) / static_cast<f32>(mib);
+            length = string_append_format(line, sizeof(line), length, ",%.*s",
+                                          memory_tag_name_length(memory_tags(t)), memory_tag_strings[t]);
         }
-        else if (memory_system_ptr->stats.tagged_allocations[i] >= kib)
+        length = string_append_format(line, sizeof(line), length, "\n");
+        file_write(&f, line, length);
+    }
+
+    for (u64 i = first; i < count; i++)
+    {
+        memory_timeline_sample *sample = &memory_system_ptr->timeline[i % MEMORY_TIMELINE_MAX_SAMPLES];
+        if (json)
         {
-            unit[0] = 'K';
-            amount  = static_cast<f32>(memory_system_ptr->stats.tagged_allocations[i]) / static_cast<f32>(kib);
+            length = string_append_format(
+                line, sizeof(line), 0,
+                "  {\"label\": \"%s\", \"time\": %f, \"frame\": %llu, \"frame_allocations\": %llu, "
+                "\"frame_bytes\": %llu",
+                sample->label, sample->time, static_cast<unsigned long long>(sample->frame),
+                static_cast<unsigned long long>(sample->frame_allocations),
+                static_cast<unsigned long long>(sample->frame_bytes));
+            for (u32 t = 0; t < MEM_TAG_MAX_TAGS; t++)
+            {
+                length = string_append_format(line, sizeof(line), length, ", \"%.*s\": %llu",
+                                              memory_tag_name_length(memory_tags(t)), memory_tag_strings[t],
+                                              static_cast<unsigned long long>(sample->tag_bytes[t]));
+            }
+            length = string_append_format(line, sizeof(line), length, "}%s\n", i + 1 < count ? "," : "");
         }
         else
         {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount  = static_cast<float>(memory_system_ptr->stats.tagged_allocations[i]);
+            length = string_append_format(line, sizeof(line), 0, "%s,%f,%llu,%llu,%llu", sample->label, sample->time,
+                                          static_cast<unsigned long long>(sample->frame),
+                                          static_cast<unsigned long long>(sample->frame_allocations),
+                                          static_cast<unsigned long long>(sample->frame_bytes));
+            for (u32 t = 0; t < MEM_TAG_MAX_TAGS; t++)
+            {
+                length = string_append_format(line, sizeof(line), length, ",%llu",
+                                              static_cast<unsigned long long>(sample->tag_bytes[t]));
+            }
+            length = string_append_format(line, sizeof(line), length, "\n");
         }
-
-        s32 length  = snprintf(out_buffer + offset, 8000, "  %s: %.2f%s\n", memory_tag_strings[i], static_cast<f64>(amount), unit);
-        offset     += length;
+        file_write(&f, line, length);
     }
 
-    return;
+    if (json)
+    {
+        file_write(&f, "]\n", 2);
+    }
+    file_close(&f);
+    return true;
 }
 
 void set_memory_stats_for_tag(u64 size_in_bytes, memory_tags tag)
 {
-    memory_system_ptr->stats.tagged_allocations[tag] += size_in_bytes;
-    memory_system_ptr->stats.total_allocated++;
+    memory_stats_add(tag, size_in_bytes);
+}
+
+void get_memory_slab_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer)
+{
+    DASSERT(memory_system_ptr);
+    get_slab_usg_str(&memory_system_ptr->slab, buffer_usg_mem_requirements, out_buffer);
 }
@@ -13,6 +13,7 @@ enum memory_tags
     MEM_TAG_APPLICATION,
     MEM_TAG_RENDERER,
     MEM_TAG_GEOMETRY,
+    MEM_TAG_RING_BUFFER,
     MEM_TAG_MAX_TAGS,
 };
 
@@ -20,15 +21,38 @@ enum memory_tags
 bool memory_system_startup(arena* arena);
 void memory_system_shutdown();
 
+// route the small allocations of this arena through the slab allocator so that dfree() actually reuses them. Only for
+// long lived arenas that are used from the main thread, the slab is not thread safe.
+void memory_system_enable_slab(arena *in_arena);
+
 void *dallocate(arena* arena, u64 mem_size, memory_tags tag);
 void  dfree(void *block, u64 size, memory_tags tag);
 
+// Same as dallocate but also attributes the allocation to file:line. Only 1 in MEMORY_CALLSITE_SAMPLE_RATE
+// allocations are recorded so that it stays cheap.
+#define MEMORY_CALLSITE_SAMPLE_RATE 16
+#define MEMORY_CALLSITE_MAX_ENTRIES 512
+#define DALLOCATE(arena, mem_size, tag) dallocate_at(arena, mem_size, tag, __FILE__, __LINE__)
+void *dallocate_at(arena *arena, u64 mem_size, memory_tags tag, const char *file, u32 line);
+
 void dset_memory_value(void *block, u64 value, u64 size);
 void dzero_memory(void *block, u64 size);
 
 void dcopy_memory(void *dest, const void *source, u64 size);
+// dcopy_memory for overlapping blocks.
+void dmove_memory(void *dest, const void *source, u64 size);
 
 void get_memory_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer);
+void get_memory_callsite_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer);
+void get_memory_slab_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer);
+
+// INFO: timeline of the tagged memory use. The label has to be a string literal, only the pointer is stored.
+// begin_frame takes a "frame" sample for the frame that just finished and resets the per frame counters.
+#define MEMORY_TIMELINE_MAX_SAMPLES 4096
+void memory_system_timeline_sample(const char *label);
+void memory_system_begin_frame();
+// writes json if the path ends with .json, csv otherwise.
+bool memory_system_export_timeline(const char *file_path);
 
 // WARN: this is a hack because we initialize the systems linear allocator before the memory sub system and thats why it
 // doesnt report correctly for the first time.
@@ -0,0 +1,567 @@
+#include "dnumber.hpp"
+
+#include "core/dasserts.hpp"
+
+#include <cstring>
+
+// significant digits kept for the exact path. A point halfway between two floats never has more than 112 of them, so
+// whatever comes after these can only tell us the number is a tiny bit bigger than the digits that were kept.
+#define NUMBER_MAX_DIGITS 128
+// 2048 bits, the exact path needs about 720 at most.
+#define NUMBER_BIGINT_LIMBS 64
+// the fast path can only use up to 19 digits (they fit in a u64).
+#define NUMBER_FAST_DIGITS 19
+
+static const f64 number_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+static const u32 number_pow5[]  = {1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625};
+static const u32 number_pow10_u32[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// 2^-126 and the largest float, as doubles.
+#define NUMBER_F32_MIN_NORMAL 1.1754943508222875e-38
+#define NUMBER_F32_MAX 3.4028234663852886e+38
+#define NUMBER_F32_INFINITY_BITS 0x7F800000u
+#define NUMBER_F32_NAN_BITS 0x7FC00000u
+
+// the text of a float, split up into its significant digits and a power of ten.
+struct number_decimal
+{
+    bool negative;
+    // the first NUMBER_FAST_DIGITS significant digits.
+    u64  mantissa;
+    // all significant digits, also the ones that didnt fit in digits.
+    u64  digit_count;
+    // value = all significant digits as one integer * 10^exponent.
+    s64  exponent;
+    u8   digits[NUMBER_MAX_DIGITS];
+    // a digit after the first NUMBER_MAX_DIGITS wasnt 0.
+    bool tail_nonzero;
+};
+
+struct number_bigint
+{
+    u32 limbs[NUMBER_BIGINT_LIMBS];
+    u32 size;
+};
+
+static inline bool number_is_digit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static inline bool number_is_blank(char ch)
+{
+    return ch == ' ' || ch == '\t';
+}
+
+static inline u64 number_skip_blanks(dstring_view text)
+{
+    u64 i = 0;
+    while (i < text.length && number_is_blank(text.data[i]))
+    {
+        i++;
+    }
+    return i;
+}
+
+static inline f32 number_f32_from_bits(u32 bits)
+{
+    f32 value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void bigint_set(number_bigint *a, u64 value)
+{
+    a->size = 0;
+    while (value)
+    {
+        a->limbs[a->size++]   = static_cast<u32>(value);
+        value               >>= 32;
+    }
+}
+
+static void bigint_mul_small(number_bigint *a, u32 factor)
+{
+    u64 carry = 0;
+    for (u32 i = 0; i < a->size; i++)
+    {
+        u64 product = static_cast<u64>(a->limbs[i]) * factor + carry;
+        a->limbs[i] = static_cast<u32>(product);
+        carry       = product >> 32;
+    }
+    if (carry)
+    {
+        DASSERT(a->size < NUMBER_BIGINT_LIMBS);
+        a->limbs[a->size++] = static_cast<u32>(carry);
+    }
+}
+
+static void bigint_add_small(number_bigint *a, u32 value)
+{
+    u64 carry = value;
+    for (u32 i = 0; i < a->size && carry; i++)
+    {
+        u64 sum     = static_cast<u64>(a->limbs[i]) + carry;
+        a->limbs[i] = static_cast<u32>(sum);
+        carry       = sum >> 32;
+    }
+    if (carry)
+    {
+        DASSERT(a->size < NUMBER_BIGINT_LIMBS);
+        a->limbs[a->size++] = static_cast<u32>(carry);
+    }
+}
+
+static void bigint_mul_pow5(number_bigint *a, u64 exponent)
+{
+    while (exponent >= 13)
+    {
+        bigint_mul_small(a, number_pow5[12] * 5);
+        exponent -= 13;
+    }
+    if (exponent)
+    {
+        bigint_mul_small(a, number_pow5[exponent]);
+    }
+}
+
+static void bigint_shift_left(number_bigint *a, u64 bits)
+{
+    if (a->size == 0 || bits == 0)
+    {
+        return;
+    }
+    u32 limb_shift = static_cast<u32>(bits / 32);
+    u32 bit_shift  = static_cast<u32>(bits % 32);
+    DASSERT(a->size + limb_shift + 1 <= NUMBER_BIGINT_LIMBS);
+
+    u32 top = 0;
+    if (bit_shift)
+    {
+        top = a->limbs[a->size - 1] >> (32 - bit_shift);
+        for (u32 i = a->size - 1; i > 0; i--)
+        {
+            a->limbs[i] = (a->limbs[i] << bit_shift) | (a->limbs[i - 1] >> (32 - bit_shift));
+        }
+        a->limbs[0] <<= bit_shift;
+    }
+    memmove(a->limbs + limb_shift, a->limbs, a->size * sizeof(u32));
+    memset(a->limbs, 0, limb_shift * sizeof(u32));
+    a->size += limb_shift;
+    if (top)
+    {
+        a->limbs[a->size++] = top;
+    }
+}
+
+static s32 bigint_compare(const number_bigint *a, const number_bigint *b)
+{
+    if (a->size != b->size)
+    {
+        return a->size < b->size ? -1 : 1;
+    }
+    for (u32 i = a->size; i > 0; i--)
+    {
+        if (a->limbs[i - 1] != b->limbs[i - 1])
+        {
+            return a->limbs[i - 1] < b->limbs[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static void bigint_from_digits(number_bigint *a, const u8 *digits, u64 count)
+{
+    bigint_set(a, 0);
+    // 9 digits at a time, that still fits in a u32.
+    for (u64 i = 0; i < count;)
+    {
+        u64 chunk_length = count - i < 9 ? count - i : 9;
+        u32 chunk        = 0;
+        for (u64 j = 0; j < chunk_length; j++)
+        {
+            chunk = chunk * 10 + digits[i + j];
+        }
+        bigint_mul_small(a, number_pow10_u32[chunk_length]);
+        bigint_add_small(a, chunk);
+        i += chunk_length;
+    }
+}
+
+// the sign of value - halfway, halfway being the point between the float with these bits and the next one up.
+// value = digits * 10^exponent (+ a bit more if tail_nonzero).
+static s32 number_compare_halfway(const number_decimal *dec, u64 stored, s64 exponent, u32 bits)
+{
+    u32 biased   = bits >> 23;
+    u32 fraction = bits & 0x7FFFFF;
+    u64 m        = biased ? (fraction | 0x800000) : fraction;
+    s64 k        = biased ? static_cast<s64>(biased) - 150 : -149;
+
+    // halfway = (2m + 1) * 2^(k - 1), 10^exponent is split into 5^exponent and 2^exponent so only whole numbers and
+    // shifts are left.
+    number_bigint value;
+    number_bigint halfway;
+    bigint_from_digits(&value, dec->digits, stored);
+    bigint_set(&halfway, 2 * m + 1);
+    s64 value_shift   = 0;
+    s64 halfway_shift = k - 1;
+    if (exponent >= 0)
+    {
+        bigint_mul_pow5(&value, exponent);
+        value_shift += exponent;
+    }
+    else
+    {
+        bigint_mul_pow5(&halfway, -exponent);
+        halfway_shift -= exponent;
+    }
+    s64 common = value_shift < halfway_shift ? value_shift : halfway_shift;
+    bigint_shift_left(&value, value_shift - common);
+    bigint_shift_left(&halfway, halfway_shift - common);
+
+    s32 result = bigint_compare(&value, &halfway);
+    return result == 0 && dec->tail_nonzero ? 1 : result;
+}
+
+// the magnitude as float bits, correctly rounded. Starts from a double guess that is at most an ulp or two off and
+// walks to the right float by comparing against the halfway points exactly.
+static u32 number_decimal_to_f32_bits(const number_decimal *dec)
+{
+    // value is in [10^leading, 10^(leading + 1)).
+    s64 leading = static_cast<s64>(dec->digit_count) - 1 + dec->exponent;
+    if (leading < -47)
+    {
+        // below 1e-46, less than half of the smallest subnormal.
+        return 0;
+    }
+    if (leading > 38)
+    {
+        return NUMBER_F32_INFINITY_BITS;
+    }
+
+    u64 fast_digits = dec->digit_count < NUMBER_FAST_DIGITS ? dec->digit_count : NUMBER_FAST_DIGITS;
+    s64 exponent    = dec->exponent + static_cast<s64>(dec->digit_count - fast_digits);
+    f64 guess       = static_cast<f64>(dec->mantissa);
+    while (exponent > 0)
+    {
+        s64 step  = exponent < 22 ? exponent : 22;
+        guess    *= number_pow10[step];
+        exponent -= step;
+    }
+    while (exponent < 0)
+    {
+        s64 step  = -exponent < 22 ? -exponent : 22;
+        guess    /= number_pow10[step];
+        exponent += step;
+    }
+
+    u32 bits = NUMBER_F32_INFINITY_BITS;
+    if (guess <= NUMBER_F32_MAX)
+    {
+        f32 rounded = static_cast<f32>(guess);
+        memcpy(&bits, &rounded, sizeof(bits));
+    }
+
+    u64 stored        = dec->digit_count < NUMBER_MAX_DIGITS ? dec->digit_count : NUMBER_MAX_DIGITS;
+    s64 stored_exponent = dec->exponent + static_cast<s64>(dec->digit_count - stored);
+    for (;;)
+    {
+        // ties go to the float with an even mantissa.
+        if (bits < NUMBER_F32_INFINITY_BITS)
+        {
+            s32 above = number_compare_halfway(dec, stored, stored_exponent, bits);
+            if (above > 0 || (above == 0 && (bits & 1)))
+            {
+                bits++;
+                continue;
+            }
+        }
+        if (bits > 0)
+        {
+            s32 below = number_compare_halfway(dec, stored, stored_exponent, bits - 1);
+            if (below < 0 || (below == 0 && (bits & 1)))
+            {
+                bits--;
+                continue;
+            }
+        }
+        return bits;
+    }
+}
+
+// "inf", "infinity" or "nan" in any case, returns the characters used or 0.
+static u64 number_parse_special(dstring_view text, u64 start, u32 *out_bits)
+{
+    auto match = [&](const char *word) -> u64 {
+        u64 length = strlen(word);
+        if (text.length - start < length)
+        {
+            return 0;
+        }
+        for (u64 i = 0; i < length; i++)
+        {
+            char ch = text.data[start + i];
+            if ((ch | 0x20) != word[i])
+            {
+                return 0;
+            }
+        }
+        return length;
+    };
+    u64 used = 0;
+    if ((used = match("infinity")) || (used = match("inf")))
+    {
+        *out_bits = NUMBER_F32_INFINITY_BITS;
+        return used;
+    }
+    if ((used = match("nan")))
+    {
+        *out_bits = NUMBER_F32_NAN_BITS;
+        return used;
+    }
+    return 0;
+}
+
+// [e|E][+-]digits at i, returns where the number ends. Without a digit after the e it isnt an exponent.
+static u64 number_parse_exponent(dstring_view text, u64 i, s64 *exponent)
+{
+    if (i >= text.length || (text.data[i] != 'e' && text.data[i] != 'E'))
+    {
+        return i;
+    }
+    u64  j        = i + 1;
+    bool negative = false;
+    if (j < text.length && (text.data[j] == '+' || text.data[j] == '-'))
+    {
+        negative = text.data[j] == '-';
+        j++;
+    }
+    if (j >= text.length || !number_is_digit(text.data[j]))
+    {
+        return i;
+    }
+    s64 value = 0;
+    while (j < text.length && number_is_digit(text.data[j]))
+    {
+        // way past anything a float can hold, the only thing that matters from here is the sign.
+        if (value < 100000)
+        {
+            value = value * 10 + (text.data[j] - '0');
+        }
+        j++;
+    }
+    *exponent += negative ? -value : value;
+    return j;
+}
+
+// all the significant digits from i on (after the sign), for the exact path. Returns where the number ends.
+static u64 number_parse_decimal(dstring_view text, u64 i, number_decimal *dec)
+{
+    const char *data = text.data;
+    dec->mantissa     = 0;
+    dec->digit_count  = 0;
+    dec->exponent     = 0;
+    dec->tail_nonzero = false;
+
+    // leading zeros arent significant, they only move the exponent if they are after the point.
+    auto take_digit = [dec](u8 digit) {
+        if (dec->digit_count == 0 && digit == 0)
+        {
+            return;
+        }
+        if (dec->digit_count < NUMBER_FAST_DIGITS)
+        {
+            dec->mantissa = dec->mantissa * 10 + digit;
+        }
+        if (dec->digit_count < NUMBER_MAX_DIGITS)
+        {
+            dec->digits[dec->digit_count] = digit;
+        }
+        else
+        {
+            dec->tail_nonzero |= digit != 0;
+        }
+        dec->digit_count++;
+    };
+
+    while (i < text.length && number_is_digit(data[i]))
+    {
+        take_digit(static_cast<u8>(data[i++] - '0'));
+    }
+    if (i < text.length && data[i] == '.')
+    {
+        i++;
+        while (i < text.length && number_is_digit(data[i]))
+        {
+            take_digit(static_cast<u8>(data[i++] - '0'));
+            dec->exponent--;
+        }
+    }
+    return number_parse_exponent(text, i, &dec->exponent);
+}
+
+u64 number_parse_f32(dstring_view text, f32 *out)
+{
+    DASSERT(out);
+    const char *data     = text.data;
+    u64         i        = number_skip_blanks(text);
+    bool        negative = false;
+    if (i < text.length && (data[i] == '+' || data[i] == '-'))
+    {
+        negative = data[i] == '-';
+        i++;
+    }
+    u64 digits_start = i;
+
+    // INFO: fast path. Up to 19 digits go straight into a u64 while scanning, nothing else is kept. If they and the
+    // power of ten are both exact doubles one multiply/divide gives the correctly rounded double. Rounding that to a
+    // float is only wrong if it landed exactly on a point halfway between two floats, or in the subnormal range where
+    // the halfway points are somewhere else. Everything that doesnt fit goes the exact way.
+    u64 mantissa = 0;
+    u64 digits   = 0;
+    s64 exponent = 0;
+    while (i < text.length && number_is_digit(data[i]))
+    {
+        mantissa = mantissa * 10 + static_cast<u64>(data[i++] - '0');
+        digits++;
+    }
+    if (i < text.length && data[i] == '.')
+    {
+        i++;
+        while (i < text.length && number_is_digit(data[i]))
+        {
+            mantissa = mantissa * 10 + static_cast<u64>(data[i++] - '0');
+            digits++;
+            exponent--;
+        }
+    }
+    if (!digits)
+    {
+        u32 special_bits = 0;
+        u64 used         = number_parse_special(text, digits_start, &special_bits);
+        if (used)
+        {
+            *out = number_f32_from_bits(special_bits | (negative ? 0x80000000u : 0));
+            return digits_start + used;
+        }
+        return 0;
+    }
+    i = number_parse_exponent(text, i, &exponent);
+
+    if (digits <= NUMBER_FAST_DIGITS)
+    {
+        if (mantissa == 0)
+        {
+            *out = negative ? -0.0f : 0.0f;
+            return i;
+        }
+        if (mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+        {
+            f64 value = static_cast<f64>(mantissa);
+            value     = exponent < 0 ? value / number_pow10[-exponent] : value * number_pow10[exponent];
+            u64 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            if (value >= NUMBER_F32_MIN_NORMAL && value <= NUMBER_F32_MAX && (bits & 0x1FFFFFFF) != 0x10000000)
+            {
+                f32 result = static_cast<f32>(value);
+                *out       = negative ? -result : result;
+                return i;
+            }
+        }
+    }
+
+    number_decimal dec;
+    dec.negative = negative;
+    number_parse_decimal(text, digits_start, &dec);
+    if (dec.digit_count == 0)
+    {
+        *out = negative ? -0.0f : 0.0f;
+        return i;
+    }
+    u32 bits = number_decimal_to_f32_bits(&dec);
+    *out     = number_f32_from_bits(bits | (negative ? 0x80000000u : 0));
+    return i;
+}
+
+u64 number_parse_s64(dstring_view text, s64 *out)
+{
+    DASSERT(out);
+    u64  i        = number_skip_blanks(text);
+    bool negative = false;
+    if (i < text.length && (text.data[i] == '+' || text.data[i] == '-'))
+    {
+        negative = text.data[i] == '-';
+        i++;
+    }
+    u64 limit = negative ? 9223372036854775808ull : 9223372036854775807ull;
+    u64 value = 0;
+    u64 first = i;
+    while (i < text.length && number_is_digit(text.data[i]))
+    {
+        u64 digit = static_cast<u64>(text.data[i] - '0');
+        if (value > (limit - digit) / 10)
+        {
+            return 0;
+        }
+        value = value * 10 + digit;
+        i++;
+    }
+    if (i == first)
+    {
+        return 0;
+    }
+    *out = negative ? static_cast<s64>(0 - value) : static_cast<s64>(value);
+    return i;
+}
+
+u64 number_parse_u32(dstring_view text, u32 *out)
+{
+    DASSERT(out);
+    u64 i = number_skip_blanks(text);
+    if (i < text.length && text.data[i] == '+')
+    {
+        i++;
+    }
+    u64 value = 0;
+    u64 first = i;
+    while (i < text.length && number_is_digit(text.data[i]))
+    {
+        value = value * 10 + static_cast<u64>(text.data[i] - '0');
+        if (value > 0xFFFFFFFFull)
+        {
+            return 0;
+        }
+        i++;
+    }
+    if (i == first)
+    {
+        return 0;
+    }
+    *out = static_cast<u32>(value);
+    return i;
+}
+
+u32 number_parse_f32s(dstring_view *line, f32 *out, u32 count)
+{
+    DASSERT(line);
+    DASSERT(out);
+    u32 parsed = 0;
+    u64 i      = 0;
+    while (parsed < count)
+    {
+        while (i < line->length && (number_is_blank(line->data[i]) || line->data[i] == ',' || line->data[i] == '\r'))
+        {
+            i++;
+        }
+        u64 used = number_parse_f32(dstring_view(line->data + i, line->length - i), &out[parsed]);
+        if (!used)
+        {
+            break;
+        }
+        i += used;
+        parsed++;
+    }
+    *line = dstring_view(line->data + i, line->length - i);
+    return parsed;
+}
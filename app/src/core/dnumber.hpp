@@ -0,0 +1,20 @@
+#pragma once
+#include "core/dstring.hpp"
+#include "defines.hpp"
+
+// INFO: number parsing for the text asset formats (obj, mtl, conf). The decimal point is always '.' no matter what the
+// locale is, nothing gets allocated and floats are rounded correctly, you get the same bits strtof gives in the "C"
+// locale. Almost every number in an asset file takes the fast path, the rest is decided exactly with big integers.
+//
+// All of them skip leading spaces/tabs and return how many characters they used, 0 if the text doesnt start with a
+// number. out is only written when something was parsed.
+
+// [+-] digits [. digits] [(e|E) [+-] digits], also inf, infinity and nan.
+u64 number_parse_f32(dstring_view text, f32 *out);
+// 0 as well if the number doesnt fit.
+u64 number_parse_s64(dstring_view text, s64 *out);
+u64 number_parse_u32(dstring_view text, u32 *out);
+
+// up to count floats separated by spaces, tabs or commas off the front of line, line is moved past them. This is how a
+// whole "v x y z" line is read after its keyword. Returns how many floats were parsed.
+u32 number_parse_f32s(dstring_view *line, f32 *out, u32 count);
@@ -2,6 +2,7 @@
 #include "core/dmemory.hpp"
 #include "core/logger.hpp"
 #include "dstring.hpp"
+#include "dnumber.hpp"
 
 // TODO: temporary
 #include <cstdio>
@@ -56,6 +57,27 @@ u32 string_copy_format(char *dest, const char *format, u32 offset_to_dest, ...)
     return written + 1;
 }
 
+u64 string_append_format(char *buffer, u64 size, u64 offset, const char *format, ...)
+{
+    DASSERT(buffer && size);
+    if (offset >= size - 1)
+    {
+        return size - 1;
+    }
+
+    __builtin_va_list arg_ptr;
+    va_start(arg_ptr, format);
+    s32 written = vsnprintf(buffer + offset, size - offset, format, arg_ptr);
+    va_end(arg_ptr);
+
+    if (written < 0)
+    {
+        return offset;
+    }
+    // vsnprintf returns what it would have written, not what fit.
+    return offset + written < size - 1 ? offset + written : size - 1;
+}
+
 char &dstring::operator[](u32 index)
 {
     DASSERT_MSG(index < MAX_STRING_LENGTH, "Index should be less than MAX_STRING_LENGTH");
@@ -201,54 +223,61 @@ dstring::dstring(const char *c_string)
 // @param: ch-> keep searching till the first occurecne of the character
 bool string_to_vec4(const char *string, vec4 *vector)
 {
-    char        floats[64] = {};
-    const char *ptr        = string;
+    dstring_view text(string);
 
-    s32 occurence = string_first_char_occurence(ptr, '{');
-    if (occurence == -1)
+    s64 open = text.find('{');
+    if (open == -1)
     {
         DERROR("Couldnt find opening brace '{' in %s", string);
         return false;
     }
-    ptr += occurence + 1;
-
-    occurence = string_first_char_occurence(string, '}');
-    if (occurence == -1)
+    s64 close = text.find('}');
+    if (close == -1 || close < open)
     {
         DERROR("Couldnt find closing brace '}' in %s", string);
         return false;
     }
 
-    string_copy_length(floats, ptr, occurence - 1);
-
-    for (s32 i = 0; i < occurence - 1; i++)
+    // the values can be separated by spaces, commas, quotes or square brackets. Whatever isnt there stays 0.
+    dstring_view inside = text.substr(open + 1, close - open - 1);
+    f32          values[4] = {};
+    u32          parsed    = 0;
+    for (u64 i = 0; i < inside.length && parsed < 4;)
     {
-        if (floats[i] == ',' || floats[i] == '"' || floats[i] == '[' || floats[i] == ']')
+        char ch = inside[i];
+        if (ch == ' ' || ch == '\t' || ch == ',' || ch == '"' || ch == '[' || ch == ']')
+        {
+            i++;
+            continue;
+        }
+        u64 used = number_parse_f32(inside.substr(i, inside.length), &values[parsed]);
+        if (!used)
         {
-            floats[i] = ' ';
+            DWARN("Couldnt parse %s as a vec4, only got %u values.", string, parsed);
+            break;
         }
+        i += used;
+        parsed++;
     }
 
     vec4 result = vec4();
-#ifdef DPLATFORM_WINDOWS
-    sscanf_s(floats, "%f %f %f %f", &result.r, &result.g, &result.b, &result.a);
-#elif DPLATFORM_LINUX
-    sscanf(floats, "%f %f %f %f", &result.r, &result.g, &result.b, &result.a);
-#endif
-    *vector = result;
+    result.r    = values[0];
+    result.g    = values[1];
+    result.b    = values[2];
+    result.a    = values[3];
+    *vector     = result;
     return true;
 }
 
 bool string_to_u32(const char *string, u32 *integer)
 {
     u32 res = INVALID_ID;
-
-#ifdef DPLATFORM_WINDOWS
-    sscanf_s(string, "%ld", &res);
-#elif DPLATFORM_LINUX
-    sscanf(string, "%ld", &res);
-#endif
-    DASSERT(res != INVALID_ID);
+    if (!number_parse_u32(dstring_view(string), &res))
+    {
+        DERROR("Couldnt parse %s as a u32.", string);
+        return false;
+    }
+    *integer = res;
     return true;
 }
 
@@ -264,3 +293,208 @@ u32 f32_to_string(char * string, f32 integer)
     u32 bytes_written = sprintf(string, "%f", integer);
     return bytes_written;
 }
+
+// NOTE: a lot of code writes into dstring::string directly and never touches str_len, so go by the terminator.
+dstring_view::dstring_view(const dstring &str) : data(str.string), length(strnlen(str.string, MAX_STRING_LENGTH))
+{
+}
+
+char dstring_view::operator[](u64 index) const
+{
+    DASSERT(index < length);
+    return data[index];
+}
+
+s64 dstring_view::find(char ch) const
+{
+    const void *found = length ? memchr(data, ch, length) : nullptr;
+    return found ? static_cast<const char *>(found) - data : -1;
+}
+
+dstring_view dstring_view::substr(u64 start, u64 count) const
+{
+    if (start >= length)
+    {
+        return dstring_view(data + length, 0);
+    }
+    u64 left = length - start;
+    return dstring_view(data + start, count < left ? count : left);
+}
+
+dstring_view dstring_view::trim() const
+{
+    auto is_space = [](char ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; };
+
+    u64 first = 0;
+    u64 last  = length;
+    while (first < last && is_space(data[first]))
+    {
+        first++;
+    }
+    while (last > first && is_space(data[last - 1]))
+    {
+        last--;
+    }
+    return dstring_view(data + first, last - first);
+}
+
+static arena *dstr_arena = nullptr;
+
+void dstr_set_arena(arena *arena)
+{
+    dstr_arena = arena;
+}
+
+dstr::dstr()
+{
+    inline_chars[0] = '\0';
+}
+
+dstr::dstr(const char *c_string) : dstr()
+{
+    dstring_view view(c_string);
+    assign(view.data, view.length);
+}
+
+dstr::dstr(dstring_view view) : dstr()
+{
+    assign(view.data, view.length);
+}
+
+dstr::dstr(const dstr &other) : dstr()
+{
+    assign(other.c_str(), other.len);
+}
+
+dstr::dstr(dstr &&other)
+{
+    dcopy_memory(this, &other, sizeof(dstr));
+    // the block belongs to us now.
+    other.on_heap         = 0;
+    other.len             = 0;
+    other.inline_chars[0] = '\0';
+}
+
+dstr::~dstr()
+{
+    release();
+}
+
+void dstr::release()
+{
+    if (on_heap)
+    {
+        dfree(heap.ptr, heap.capacity, MEM_TAG_DSTRING);
+        on_heap = 0;
+    }
+    len             = 0;
+    inline_chars[0] = '\0';
+}
+
+dstr &dstr::operator=(const dstr &other)
+{
+    if (this != &other)
+    {
+        assign(other.c_str(), other.len);
+    }
+    return *this;
+}
+
+dstr &dstr::operator=(dstr &&other)
+{
+    if (this != &other)
+    {
+        release();
+        dcopy_memory(this, &other, sizeof(dstr));
+        other.on_heap         = 0;
+        other.len             = 0;
+        other.inline_chars[0] = '\0';
+    }
+    return *this;
+}
+
+dstr &dstr::operator=(const char *c_string)
+{
+    dstring_view view(c_string);
+    assign(view.data, view.length);
+    return *this;
+}
+
+dstr &dstr::operator=(dstring_view view)
+{
+    assign(view.data, view.length);
+    return *this;
+}
+
+void dstr::assign(const char *data, u64 length)
+{
+    DASSERT_MSG(length < INVALID_ID, "String is too long for a dstr.");
+
+    // the source can point into our own characters, copy it out before the block goes away.
+    if (on_heap && length < heap.capacity)
+    {
+        dmove_memory(heap.ptr, data, length);
+        heap.ptr[length] = '\0';
+        len              = static_cast<u32>(length);
+        return;
+    }
+    if (!on_heap && length <= DSTR_INLINE_CAPACITY)
+    {
+        dmove_memory(inline_chars, data, length);
+        inline_chars[length] = '\0';
+        len                  = static_cast<u32>(length);
+        return;
+    }
+
+    DASSERT_MSG(dstr_arena, "dstr_set_arena has to be called before strings longer than the inline capacity.");
+    u64   capacity = (length + 1 + 15) & ~static_cast<u64>(15);
+    char *block    = static_cast<char *>(dallocate(dstr_arena, capacity, MEM_TAG_DSTRING));
+    dcopy_memory(block, data, length);
+    block[length] = '\0';
+    release();
+
+    heap.ptr      = block;
+    heap.capacity = capacity;
+    on_heap       = 1;
+    len           = static_cast<u32>(length);
+}
+
+void dstr::clear()
+{
+    release();
+}
+
+const char *dstr::c_str() const
+{
+    return on_heap ? heap.ptr : inline_chars;
+}
+
+u64 dstr::size() const
+{
+    return len;
+}
+
+bool dstr::empty() const
+{
+    return len == 0;
+}
+
+bool dstr::is_inline() const
+{
+    return !on_heap;
+}
+
+u64 dstr::heap_bytes() const
+{
+    return on_heap ? heap.capacity : 0;
+}
+
+dstring_view dstr::view() const
+{
+    return dstring_view(c_str(), len);
+}
+
+dstr::operator dstring_view() const
+{
+    return view();
+}
@@ -2,6 +2,8 @@
 #include "containers/darray.hpp"
 #include "defines.hpp"
 #include "math/dmath_types.hpp"
+
+#include <cstring>
 //
 // strings because I dont know c strings good enough :(
 //
@@ -29,6 +31,95 @@ class dstring
     const char *c_str();
 };
 
+// INFO: a (pointer, length) into characters someone else owns: a dstring, a dstr, a literal, a line in a file buffer.
+// Doesnt have to be '\0' terminated, always go by length. Only good for as long as what it points into.
+struct dstring_view
+{
+    const char *data   = "";
+    u64         length = 0;
+
+    dstring_view() = default;
+    // inline so a literal's length is known at compile time, the parsers compare every line against a few of them.
+    dstring_view(const char *c_string) : data(c_string ? c_string : ""), length(c_string ? strlen(c_string) : 0)
+    {
+    }
+    dstring_view(const dstring &str);
+    constexpr dstring_view(const char *in_data, u64 in_length) : data(in_data), length(in_length)
+    {
+    }
+
+    char operator[](u64 index) const;
+    bool operator==(dstring_view other) const
+    {
+        return length == other.length && (length == 0 || memcmp(data, other.data, length) == 0);
+    }
+    bool operator!=(dstring_view other) const
+    {
+        return !(*this == other);
+    }
+
+    // -1 if ch isnt in the view.
+    s64          find(char ch) const;
+    // clamped to the view, never reads past it.
+    dstring_view substr(u64 start, u64 count) const;
+    // without leading/trailing spaces, tabs and line endings.
+    dstring_view trim() const;
+};
+
+#define DSTR_INLINE_CAPACITY 23
+
+// INFO: compact owning string for the names and paths that sit in resource records. 32 bytes instead of the 528 of a
+// dstring: up to DSTR_INLINE_CAPACITY characters live inline, longer ones get a block from the string arena (see
+// dstr_set_arena) that goes back through dfree. All zero bytes is a valid empty dstr, but arena memory is only zeroed
+// when the arena is fresh or reset with zero_memory. After a scope pop or a frame arena reset it is whatever was there
+// before, so records holding a dstr that come out of DALLOCATE get placement new'd first.
+class dstr
+{
+  private:
+    struct heap_block
+    {
+        char *ptr;
+        u64   capacity;
+    };
+    union {
+        char       inline_chars[DSTR_INLINE_CAPACITY + 1];
+        heap_block heap;
+    };
+    u32 len     = 0;
+    u32 on_heap = 0;
+
+    void release();
+
+  public:
+    dstr();
+    dstr(const char *c_string);
+    dstr(dstring_view view);
+    dstr(const dstr &other);
+    dstr(dstr &&other);
+    ~dstr();
+
+    dstr &operator=(const dstr &other);
+    dstr &operator=(dstr &&other);
+    dstr &operator=(const char *c_string);
+    dstr &operator=(dstring_view view);
+
+    void assign(const char *data, u64 length);
+    // frees the heap block if there is one.
+    void clear();
+
+    const char  *c_str() const;
+    u64          size() const;
+    bool         empty() const;
+    bool         is_inline() const;
+    // bytes held in the string arena, 0 while inline.
+    u64          heap_bytes() const;
+    dstring_view view() const;
+    operator dstring_view() const;
+};
+
+// where dstr gets its heap blocks from, has to be set before the first string longer than DSTR_INLINE_CAPACITY.
+void dstr_set_arena(arena *arena);
+
 // @param: return false if strings are not equal, true if they are equal
 bool string_compare(const char *str0, const char *str1);
 // ch -> identifer to split the string to or if it cannot find the identifer
@@ -43,6 +134,9 @@ void string_ncopy(char *dest, const char *src, u32 length);
 // void string_copy_length(char *dest, const char *src, u32 len);
 
 u32 string_copy_format(char *dest, const char *format, u32 offset_to_dest, ...);
+// formats into buffer (size bytes) at offset and cuts the text off if it doesnt fit. Returns the new offset, which is
+// never past size - 1, so calls can be chained without checking and the buffer stays null terminated.
+u64 string_append_format(char *buffer, u64 size, u64 offset, const char *format, ...);
 
 s32         string_first_char_occurence(const char *string, const char ch);
 const char *string_first_string_occurence(const char *string, const char *sub_str);
@@ -0,0 +1,69 @@
+#include "dstring_id.hpp"
+#include "containers/dhashtable.hpp"
+#include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "core/logger.hpp"
+
+struct string_id_system_state
+{
+    // id -> interned copy of the string, the copies live in the arena.
+    dhashtable<const char *> strings;
+    arena                   *arena;
+};
+
+static string_id_system_state *string_id_state_ptr = nullptr;
+
+bool string_id_system_startup(arena *arena)
+{
+    DASSERT(arena);
+    string_id_state_ptr = static_cast<string_id_system_state *>(
+        DALLOCATE(arena, sizeof(string_id_system_state), MEM_TAG_APPLICATION));
+    string_id_state_ptr->arena = arena;
+    string_id_state_ptr->strings.c_init(arena, STRING_ID_MAX_INTERNED);
+    return true;
+}
+
+void string_id_system_shutdown()
+{
+    string_id_state_ptr = nullptr;
+}
+
+string_id string_id_intern(const char *string)
+{
+    DASSERT(string);
+    string_id id = string_id_hash(string);
+    DASSERT_MSG(id != INVALID_STRING_ID && id != INVALID_ID_64, "String hashes to a reserved id.");
+    if (!string_id_state_ptr)
+    {
+        // INFO: ids still work without the system, there just is no way to get the string back.
+        return id;
+    }
+
+    const char **interned = string_id_state_ptr->strings.try_find(id);
+    if (interned)
+    {
+        if (!string_compare(*interned, string))
+        {
+            DFATAL("String id collision: %s and %s both hash to %llu.", *interned, string, id);
+        }
+        return id;
+    }
+
+    u32   length = string_length(string);
+    char *copy   = static_cast<char *>(arena_allocate_block(string_id_state_ptr->arena, length + 1));
+    dcopy_memory(copy, string, length);
+    copy[length] = '\0';
+    string_id_state_ptr->strings.insert(id, copy);
+    return id;
+}
+
+const char *string_id_get_string(string_id id)
+{
+    if (!string_id_state_ptr)
+    {
+        return nullptr;
+    }
+    const char **interned = string_id_state_ptr->strings.try_find(id);
+    return interned ? *interned : nullptr;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "defines.hpp"
+#include "memory/arenas.hpp"
+
+#include <type_traits>
+
+// INFO: names get turned into 64 bit ids once and everything after that (lookups in the resource systems, comparing
+// handles) works on the ids. The hash is constexpr so the id of a string literal is known at compile time, DSID("name")
+// costs nothing at runtime and matches what string_id_intern("name") returns.
+typedef u64 string_id;
+
+#define INVALID_STRING_ID 0ull
+
+// FNV-1a 64
+constexpr string_id string_id_hash(const char *string)
+{
+    string_id hash = 0xcbf29ce484222325ull;
+    while (*string)
+    {
+        hash ^= static_cast<u8>(*string++);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// same hash for a string that isnt '\0' terminated (a view into a file buffer), stops early at an embedded '\0' so it
+// agrees with the c string version.
+constexpr string_id string_id_hash(const char *string, u64 length)
+{
+    string_id hash = 0xcbf29ce484222325ull;
+    for (u64 i = 0; i < length && string[i]; i++)
+    {
+        hash ^= static_cast<u8>(string[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// forces the hash to be evaluated at compile time, only for literals.
+#define DSID(literal) (std::integral_constant<string_id, string_id_hash(literal)>::value)
+
+#define STRING_ID_MAX_INTERNED 4096
+
+bool string_id_system_startup(arena *arena);
+void string_id_system_shutdown();
+
+// returns the id of the string and remembers the string so that string_id_get_string can give it back. Two different
+// strings with the same id is a fatal error.
+string_id   string_id_intern(const char *string);
+// nullptr if the id was never interned (a DSID that no one interned yet for example).
+const char *string_id_get_string(string_id id);
@@ -0,0 +1,381 @@
+#include "dtext_scan.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DTEXT_SCAN_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+// only these functions get compiled for avx2, the rest of the build doesnt assume it.
+#define DTEXT_SCAN_AVX2 __attribute__((target("avx2")))
+#endif
+
+static inline bool text_is_blank(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+// INFO: scalar versions, also what the vector versions use for the bytes that dont fill a whole register.
+
+static const char *text_find_char_scalar(const char *data, u64 length, char ch)
+{
+    for (u64 i = 0; i < length; i++)
+    {
+        if (data[i] == ch)
+        {
+            return data + i;
+        }
+    }
+    return nullptr;
+}
+
+static u64 text_count_char_scalar(const char *data, u64 length, char ch)
+{
+    u64 count = 0;
+    for (u64 i = 0; i < length; i++)
+    {
+        count += data[i] == ch;
+    }
+    return count;
+}
+
+// needle is at least 2 characters, the single character case goes through find_char.
+static const char *text_find_scalar(const char *data, u64 length, const char *needle, u64 needle_length)
+{
+    if (length < needle_length)
+    {
+        return nullptr;
+    }
+    for (u64 i = 0; i <= length - needle_length; i++)
+    {
+        if (data[i] == needle[0] && memcmp(data + i + 1, needle + 1, needle_length - 1) == 0)
+        {
+            return data + i;
+        }
+    }
+    return nullptr;
+}
+
+#if DTEXT_SCAN_X86
+
+static const char *text_find_char_sse2(const char *data, u64 length, char ch)
+{
+    const __m128i needle = _mm_set1_epi8(ch);
+    u64           i      = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        u32     mask  = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (mask)
+        {
+            return data + i + __builtin_ctz(mask);
+        }
+    }
+    return text_find_char_scalar(data + i, length - i, ch);
+}
+
+static u64 text_count_char_sse2(const char *data, u64 length, char ch)
+{
+    const __m128i needle = _mm_set1_epi8(ch);
+    const __m128i zero   = _mm_setzero_si128();
+    u64           count  = 0;
+    u64           i      = 0;
+    while (i + 16 <= length)
+    {
+        // every lane counts up to 255 matches, fold them into count before they can wrap.
+        u64     blocks   = (length - i) / 16 < 255 ? (length - i) / 16 : 255;
+        __m128i counters = zero;
+        for (u64 b = 0; b < blocks; b++, i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            // a match is 0xff which is -1, subtracting it adds one.
+            counters      = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, needle));
+        }
+        __m128i sums  = _mm_sad_epu8(counters, zero);
+        count        += _mm_cvtsi128_si64(sums) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    }
+    return count + text_count_char_scalar(data + i, length - i, ch);
+}
+
+// first and last character of the needle are compared 16 positions at a time, only the positions where both match
+// get a memcmp of the middle.
+static const char *text_find_sse2(const char *data, u64 length, const char *needle, u64 needle_length)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last  = _mm_set1_epi8(needle[needle_length - 1]);
+    u64           i     = 0;
+    for (; i + needle_length - 1 + 16 <= length; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i block_last  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + needle_length - 1));
+        u32     mask        = static_cast<u32>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+        while (mask)
+        {
+            u32 bit = __builtin_ctz(mask);
+            if (memcmp(data + i + bit + 1, needle + 1, needle_length - 2) == 0)
+            {
+                return data + i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return text_find_scalar(data + i, length - i, needle, needle_length);
+}
+
+DTEXT_SCAN_AVX2 static const char *text_find_char_avx2(const char *data, u64 length, char ch)
+{
+    const __m256i needle = _mm256_set1_epi8(ch);
+    u64           i      = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        u32     mask  = static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask)
+        {
+            return data + i + __builtin_ctz(mask);
+        }
+    }
+    return text_find_char_sse2(data + i, length - i, ch);
+}
+
+DTEXT_SCAN_AVX2 static u64 text_count_char_avx2(const char *data, u64 length, char ch)
+{
+    const __m256i needle = _mm256_set1_epi8(ch);
+    const __m256i zero   = _mm256_setzero_si256();
+    u64           count  = 0;
+    u64           i      = 0;
+    while (i + 32 <= length)
+    {
+        u64     blocks   = (length - i) / 32 < 255 ? (length - i) / 32 : 255;
+        __m256i counters = zero;
+        for (u64 b = 0; b < blocks; b++, i += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            counters      = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, needle));
+        }
+        u64 sums[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), _mm256_sad_epu8(counters, zero));
+        count += sums[0] + sums[1] + sums[2] + sums[3];
+    }
+    return count + text_count_char_sse2(data + i, length - i, ch);
+}
+
+DTEXT_SCAN_AVX2 static const char *text_find_avx2(const char *data, u64 length, const char *needle,
+                                                  u64 needle_length)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last  = _mm256_set1_epi8(needle[needle_length - 1]);
+    u64           i     = 0;
+    for (; i + needle_length - 1 + 32 <= length; i += 32)
+    {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i block_last  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + needle_length - 1));
+        u32     mask        = static_cast<u32>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))));
+        while (mask)
+        {
+            u32 bit = __builtin_ctz(mask);
+            if (memcmp(data + i + bit + 1, needle + 1, needle_length - 2) == 0)
+            {
+                return data + i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return text_find_sse2(data + i, length - i, needle, needle_length);
+}
+
+#endif
+
+static text_scan_level text_scan_detect_level()
+{
+#if DTEXT_SCAN_X86
+    u32 eax = 0;
+    u32 ebx = 0;
+    u32 ecx = 0;
+    u32 edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return TEXT_SCAN_SSE2;
+    }
+    // avx2 also needs the os to save the upper halves of the ymm registers on a context switch.
+    bool os_saves_ymm = false;
+    if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX))
+    {
+        u32 xcr0_low  = 0;
+        u32 xcr0_high = 0;
+        __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+        os_saves_ymm = (xcr0_low & 0x6) == 0x6;
+    }
+    if (os_saves_ymm && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2))
+    {
+        return TEXT_SCAN_AVX2;
+    }
+    return TEXT_SCAN_SSE2;
+#else
+    return TEXT_SCAN_SCALAR;
+#endif
+}
+
+static const text_scan_level best_level   = text_scan_detect_level();
+static text_scan_level       active_level = best_level;
+
+text_scan_level text_scan_get_level()
+{
+    return active_level;
+}
+
+text_scan_level text_scan_set_level(text_scan_level level)
+{
+    active_level = level < best_level ? level : best_level;
+    return active_level;
+}
+
+const char *text_scan_level_name(text_scan_level level)
+{
+    switch (level)
+    {
+    case TEXT_SCAN_SCALAR:
+        return "scalar";
+    case TEXT_SCAN_SSE2:
+        return "sse2";
+    case TEXT_SCAN_AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+const char *text_find_char(const char *data, u64 length, char ch)
+{
+    switch (active_level)
+    {
+#if DTEXT_SCAN_X86
+    case TEXT_SCAN_AVX2:
+        return text_find_char_avx2(data, length, ch);
+    case TEXT_SCAN_SSE2:
+        return text_find_char_sse2(data, length, ch);
+#endif
+    default:
+        return text_find_char_scalar(data, length, ch);
+    }
+}
+
+u64 text_count_char(const char *data, u64 length, char ch)
+{
+    switch (active_level)
+    {
+#if DTEXT_SCAN_X86
+    case TEXT_SCAN_AVX2:
+        return text_count_char_avx2(data, length, ch);
+    case TEXT_SCAN_SSE2:
+        return text_count_char_sse2(data, length, ch);
+#endif
+    default:
+        return text_count_char_scalar(data, length, ch);
+    }
+}
+
+const char *text_find(const char *data, u64 length, dstring_view needle)
+{
+    if (needle.length == 0)
+    {
+        return data;
+    }
+    if (needle.length == 1)
+    {
+        return text_find_char(data, length, needle.data[0]);
+    }
+    switch (active_level)
+    {
+#if DTEXT_SCAN_X86
+    case TEXT_SCAN_AVX2:
+        return text_find_avx2(data, length, needle.data, needle.length);
+    case TEXT_SCAN_SSE2:
+        return text_find_sse2(data, length, needle.data, needle.length);
+#endif
+    default:
+        return text_find_scalar(data, length, needle.data, needle.length);
+    }
+}
+
+u64 text_count(const char *data, u64 length, dstring_view needle)
+{
+    if (needle.length == 0)
+    {
+        return 0;
+    }
+    const char *end   = data + length;
+    const char *found = data;
+    u64         count = 0;
+    while ((found = text_find(found, end - found, needle)) != nullptr)
+    {
+        count++;
+        found += needle.length;
+    }
+    return count;
+}
+
+u64 text_count_keyword(const char *data, u64 length, dstring_view keyword)
+{
+    if (keyword.length == 0)
+    {
+        return 0;
+    }
+    const char *end   = data + length;
+    const char *found = data;
+    u64         count = 0;
+    while ((found = text_find(found, end - found, keyword)) != nullptr)
+    {
+        const char *before = found;
+        while (before > data && (before[-1] == ' ' || before[-1] == '\t'))
+        {
+            before--;
+        }
+        const char *after         = found + keyword.length;
+        bool        starts_line   = before == data || before[-1] == '\n';
+        bool        ends_keyword  = after == end || text_is_blank(*after) || *after == '\n';
+        count                    += starts_line && ends_keyword;
+        found                     = after;
+    }
+    return count;
+}
+
+dstring_view text_next_token(dstring_view *line)
+{
+    u64 start = 0;
+    while (start < line->length && text_is_blank(line->data[start]))
+    {
+        start++;
+    }
+    u64 end = start;
+    while (end < line->length && !text_is_blank(line->data[end]))
+    {
+        end++;
+    }
+    dstring_view token(line->data + start, end - start);
+    *line = dstring_view(line->data + end, line->length - end);
+    return token;
+}
+
+text_line_reader::text_line_reader(const char *data, u64 length) : cursor(data), end(data + length)
+{
+}
+
+bool text_line_reader::next(dstring_view *out_line)
+{
+    if (cursor >= end)
+    {
+        return false;
+    }
+    const char *new_line = text_find_char(cursor, end - cursor, '\n');
+    const char *line_end = new_line ? new_line : end;
+    u64         length   = line_end - cursor;
+    if (length && cursor[length - 1] == '\r')
+    {
+        length--;
+    }
+    *out_line = dstring_view(cursor, length);
+    cursor    = new_line ? new_line + 1 : end;
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "core/dstring.hpp"
+#include "defines.hpp"
+
+// INFO: scanning over text buffers (whole obj/mtl/conf files) for the asset parsers. The searches look at 16 (sse2) or
+// 32 (avx2) bytes per step, which one is picked once from cpuid, everything else falls back to plain loops. None of
+// them need a '\0' at the end and none read past data + length.
+
+enum text_scan_level
+{
+    TEXT_SCAN_SCALAR = 0,
+    TEXT_SCAN_SSE2   = 1,
+    TEXT_SCAN_AVX2   = 2,
+};
+
+// the best level this cpu supports, unless text_scan_set_level picked a lower one.
+text_scan_level text_scan_get_level();
+// for the benches, clamped to what the cpu supports. Returns the level that is actually used now.
+text_scan_level text_scan_set_level(text_scan_level level);
+const char     *text_scan_level_name(text_scan_level level);
+
+// nullptr if ch isnt in the text.
+const char *text_find_char(const char *data, u64 length, char ch);
+u64         text_count_char(const char *data, u64 length, char ch);
+// first occurrence of needle, nullptr if it isnt in the text. An empty needle is found at data.
+const char *text_find(const char *data, u64 length, dstring_view needle);
+// non overlapping occurrences anywhere in the text, same as string_num_of_substring_occurence but by length.
+u64         text_count(const char *data, u64 length, dstring_view needle);
+// lines whose first token is exactly keyword ("v" doesnt count "vn" or "vt" lines), leading spaces/tabs are skipped.
+u64         text_count_keyword(const char *data, u64 length, dstring_view keyword);
+
+// pops the next space/tab separated token off the front of line, an empty view once there are none left.
+dstring_view text_next_token(dstring_view *line);
+
+// hands out the lines of a buffer one by one, the '\n' and a '\r' in front of it are not part of the line. Empty lines
+// are handed out as empty views, a last line without a '\n' is still a line.
+struct text_line_reader
+{
+    const char *cursor = nullptr;
+    const char *end    = nullptr;
+
+    text_line_reader(const char *data, u64 length);
+    // false once everything has been handed out.
+    bool next(dstring_view *out_line);
+};
@@ -12,6 +12,7 @@
 #include "math/dmath.hpp"
 
 #include "math/dmath_types.hpp"
+#include "memory/frame_arena.hpp"
 #include "platform/platform.hpp"
 
 #include "renderer/renderer.hpp"
@@ -90,12 +91,11 @@ int main()
         geometry_config green_light = *geometry_system_generate_config(sphere_obj);
         geometry_config blue_light  = *geometry_system_generate_config(sphere_obj);
 
-        dstring mat_name   = DEFAULT_LIGHT_MATERIAL_HANDLE;
-        red_light.material = material_system_get_from_name(&mat_name);
+        red_light.material = material_system_get_from_string_id(DEFAULT_LIGHT_MATERIAL_ID);
         scale_geometries(&red_light, {0.2f, 0.2f, 0.2f});
-        green_light.material = material_system_get_from_name(&mat_name);
+        green_light.material = material_system_get_from_string_id(DEFAULT_LIGHT_MATERIAL_ID);
         scale_geometries(&green_light, {0.2f, 0.2f, 0.2f});
-        blue_light.material = material_system_get_from_name(&mat_name);
+        blue_light.material = material_system_get_from_string_id(DEFAULT_LIGHT_MATERIAL_ID);
         scale_geometries(&blue_light, {0.2f, 0.2f, 0.2f});
 
         u64 red   = geometry_system_create_geometry(&red_light, false);
@@ -104,9 +104,8 @@ int main()
 
         geos_3D = static_cast<geometry **>(dallocate(app_state.system_arena, sizeof(geometry *) * 6, MEM_TAG_UNKNOWN));
         geos_3D[0]           = geometry_system_get_default_geometry();
-        mat_name             = "orange_lines_512.conf";
+        dstring mat_name     = "orange_lines_512.conf";
         geos_3D[0]->material = material_system_get_from_config_file(&mat_name);
-        mat_name.clear();
 
         geos_3D[1]            = geometry_system_get_geometry(red);
         geos_3D[1]->ubo.model = mat4_translation({2, 0, 0});
@@ -148,8 +147,6 @@ int main()
     u64 def_grid_shader     = shader_system_get_default_grid_shader_id();
     u64 def_ui_shader       = shader_system_get_default_ui_shader_id();
 
-    dstring font_atlas = DEFAULT_FONT_ATLAS_TEXTURE_HANDLE;
-
     dstring test;
     test       = "FPS: ";
     u32 frames = 0;
@@ -161,11 +158,19 @@ int main()
     dstring mouse;
 
     dstring camera_pos;
+    dstring culling;
+    dstring picked;
+    dstring nearest;
+    picked = "Picked: nothing";
     while (app_state.is_running)
     {
         ZoneScoped;
         frame_start_time = platform_get_absolute_time();
 
+        // everything allocated from the frame arena last time this slot was used is gone after this.
+        frame_arena_begin_frame();
+        memory_system_begin_frame();
+
         result = platform_pump_messages();
         DASSERT(result);
 
@@ -183,12 +188,36 @@ int main()
         input_get_mouse_position(&mouse_x, &mouse_y);
         mouse.str_len = string_copy_format(mouse.string, "Cursor_pos: x: %d y: %d", 0, mouse_x, mouse_y);
 
+        // the counts are from the last frame, this one is culled when it is drawn.
+        renderer_cull_stats cull_stats = renderer_get_cull_stats();
+
+        culling.str_len = string_copy_format(culling.string, "Visible: %u Culled: %u", 0, cull_stats.visible,
+                                             cull_stats.culled);
+
+        // picking and the nearest object go by the scene bvh of the last frame as well.
+        if (input_was_button_down(BUTTON_LEFT) && input_is_button_up(BUTTON_LEFT))
+        {
+            f32       distance = 0;
+            geometry *geo      = renderer_pick_geometry(mouse_x, mouse_y, &distance);
+            picked.str_len =
+                geo ? string_copy_format(picked.string, "Picked: %s %.2f", 0, geo->name.c_str(), distance)
+                    : string_copy_format(picked.string, "Picked: nothing", 0);
+        }
+        f32       nearest_distance = 0;
+        geometry *nearest_geo      = renderer_nearest_geometry(triangle.scene_ubo.camera_pos, &nearest_distance);
+        nearest.str_len = nearest_geo ? string_copy_format(nearest.string, "Nearest: %s %.2f", 0,
+                                                           nearest_geo->name.c_str(), nearest_distance)
+                                      : string_copy_format(nearest.string, "Nearest: nothing", 0);
+
         geometry_system_generate_text_geometry(&mouse, {0, 440}, RED);
         geometry_system_generate_text_geometry(&camera_pos, {0, 500}, GREEN);
+        geometry_system_generate_text_geometry(&culling, {0, 560}, BLUE);
+        geometry_system_generate_text_geometry(&picked, {0, 620}, YELLOW);
+        geometry_system_generate_text_geometry(&nearest, {0, 680}, SKYBLUE);
 
         u64 quad_id          = geometry_system_flush_text_geometries();
         geos_2D[0]           = geometry_system_get_geometry(quad_id);
-        geos_2D[0]->material = material_system_get_from_name(&font_atlas);
+        geos_2D[0]->material = material_system_get_from_string_id(DEFAULT_FONT_ATLAS_TEXTURE_ID);
 
 
         shader_system_bind_shader(def_material_shader);
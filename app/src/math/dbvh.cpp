@@ -0,0 +1,523 @@
+#include "dbvh.hpp"
+#include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "math/dmath.hpp"
+#include "memory/frame_arena.hpp"
+
+struct bvh_build_state
+{
+    const bounds_3D *boxes;
+    vec3            *centroids;
+    u32             *items;
+    bvh_node        *nodes;
+    u32              node_count;
+};
+
+struct bvh_bin
+{
+    vec3 min;
+    vec3 max;
+    u32  count;
+};
+
+// NOTE: fminf/fmaxf are libm calls without -ffinite-math-only, these are one minss/maxss. Nothing in here is ever nan,
+// the ray direction is kept away from 0 for that.
+static inline f32 bvh_min(f32 a, f32 b)
+{
+    return a < b ? a : b;
+}
+
+static inline f32 bvh_max(f32 a, f32 b)
+{
+    return a > b ? a : b;
+}
+
+static inline void bvh_grow(vec3 *min, vec3 *max, vec3 box_min, vec3 box_max)
+{
+    *min = vec3(bvh_min(min->x, box_min.x), bvh_min(min->y, box_min.y), bvh_min(min->z, box_min.z));
+    *max = vec3(bvh_max(max->x, box_max.x), bvh_max(max->y, box_max.y), bvh_max(max->z, box_max.z));
+}
+
+// half the surface area, the heuristic only compares them.
+static inline f32 bvh_half_area(vec3 min, vec3 max)
+{
+    vec3 d = max - min;
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+static void bvh_make_leaf(bvh_node *node, u32 first, u32 count)
+{
+    node->first = first;
+    node->count = count;
+}
+
+static void bvh_build_node(bvh_build_state *state, u32 node_index, u32 first, u32 count, u32 depth)
+{
+    bvh_node *node = state->nodes + node_index;
+
+    vec3 min(D_INFINITY, D_INFINITY, D_INFINITY);
+    vec3 max(-D_INFINITY, -D_INFINITY, -D_INFINITY);
+    vec3 centroid_min = min;
+    vec3 centroid_max = max;
+    for (u32 i = first; i < first + count; i++)
+    {
+        u32 item = state->items[i];
+        bvh_grow(&min, &max, state->boxes[item].min, state->boxes[item].max);
+        bvh_grow(&centroid_min, &centroid_max, state->centroids[item], state->centroids[item]);
+    }
+    node->min = min;
+    node->max = max;
+
+    if (count == 1 || depth + 1 >= BVH_MAX_DEPTH)
+    {
+        bvh_make_leaf(node, first, count);
+        return;
+    }
+
+    // the bins go along the axis the centroids are spread out the most on.
+    vec3 spread = centroid_max - centroid_min;
+    u32  axis   = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+    f32  extent = spread.elements[axis];
+
+    u32 mid = first + count / 2;
+    if (extent > 0)
+    {
+        bvh_bin bins[BVH_SAH_BINS];
+        for (u32 b = 0; b < BVH_SAH_BINS; b++)
+        {
+            bins[b].min   = vec3(D_INFINITY, D_INFINITY, D_INFINITY);
+            bins[b].max   = vec3(-D_INFINITY, -D_INFINITY, -D_INFINITY);
+            bins[b].count = 0;
+        }
+        f32  scale  = BVH_SAH_BINS / extent;
+        f32  base   = centroid_min.elements[axis];
+        auto bin_of = [&](u32 item) -> u32 {
+            u32 b = static_cast<u32>((state->centroids[item].elements[axis] - base) * scale);
+            return b < BVH_SAH_BINS ? b : BVH_SAH_BINS - 1;
+        };
+        for (u32 i = first; i < first + count; i++)
+        {
+            u32      item = state->items[i];
+            bvh_bin *bin  = bins + bin_of(item);
+            bvh_grow(&bin->min, &bin->max, state->boxes[item].min, state->boxes[item].max);
+            bin->count++;
+        }
+
+        // cost of splitting after bin b, the area of either side times its count. The right sides are summed up from
+        // the back first.
+        f32  right_cost[BVH_SAH_BINS];
+        vec3 right_min = bins[BVH_SAH_BINS - 1].min;
+        vec3 right_max = bins[BVH_SAH_BINS - 1].max;
+        u32  right     = bins[BVH_SAH_BINS - 1].count;
+        for (u32 b = BVH_SAH_BINS - 1; b > 0; b--)
+        {
+            right_cost[b - 1] = right ? bvh_half_area(right_min, right_max) * right : 0;
+            bvh_grow(&right_min, &right_max, bins[b - 1].min, bins[b - 1].max);
+            right += bins[b - 1].count;
+        }
+
+        vec3 left_min   = vec3(D_INFINITY, D_INFINITY, D_INFINITY);
+        vec3 left_max   = vec3(-D_INFINITY, -D_INFINITY, -D_INFINITY);
+        u32  left       = 0;
+        f32  best_cost  = D_INFINITY;
+        u32  best_split = INVALID_ID;
+        for (u32 b = 0; b < BVH_SAH_BINS - 1; b++)
+        {
+            bvh_grow(&left_min, &left_max, bins[b].min, bins[b].max);
+            left += bins[b].count;
+            if (!left || left == count)
+            {
+                continue;
+            }
+            f32 cost = bvh_half_area(left_min, left_max) * left + right_cost[b];
+            if (cost < best_cost)
+            {
+                best_cost  = cost;
+                best_split = b;
+            }
+        }
+
+        // a traversal step costs about as much as testing one item, a leaf costs one test per item.
+        f32 parent_area = bvh_half_area(min, max);
+        if (count <= BVH_MAX_LEAF_ITEMS && parent_area * (count - 1.0f) <= best_cost)
+        {
+            bvh_make_leaf(node, first, count);
+            return;
+        }
+
+        // no split only happens with nan boxes, those stay split down the middle.
+        if (best_split != INVALID_ID)
+        {
+            u32 *items = state->items;
+            u32  i     = first;
+            u32  j     = first + count;
+            while (i < j)
+            {
+                if (bin_of(items[i]) <= best_split)
+                {
+                    i++;
+                }
+                else
+                {
+                    u32 swap = items[i];
+                    items[i] = items[--j];
+                    items[j] = swap;
+                }
+            }
+            mid = i;
+        }
+    }
+    else if (count <= BVH_MAX_LEAF_ITEMS)
+    {
+        bvh_make_leaf(node, first, count);
+        return;
+    }
+    // NOTE: with every centroid in the same spot there is nothing to bin, the items just get split down the middle.
+
+    u32 left_child     = state->node_count;
+    state->node_count += 2;
+    node->first        = left_child;
+    node->count        = 0;
+    bvh_build_node(state, left_child, first, mid - first, depth + 1);
+    bvh_build_node(state, left_child + 1, mid, first + count - mid, depth + 1);
+}
+
+u64 bvh_memory_requirements(u32 count)
+{
+    // a binary tree with a leaf per item at the most, the items after the nodes.
+    return count ? sizeof(bvh_node) * (2 * static_cast<u64>(count) - 1) + sizeof(u32) * count : 0;
+}
+
+void bvh_build(arena *arena, const bounds_3D *boxes, u32 count, bvh *out_bvh)
+{
+    DASSERT(arena && out_bvh);
+    void *memory = count ? DALLOCATE(arena, bvh_memory_requirements(count), MEM_TAG_RENDERER) : nullptr;
+    bvh_build_in_place(memory, boxes, count, out_bvh);
+}
+
+void bvh_build_in_place(void *memory, const bounds_3D *boxes, u32 count, bvh *out_bvh)
+{
+    DASSERT(out_bvh);
+    DASSERT(boxes || !count);
+    DASSERT(memory || !count);
+
+    *out_bvh            = bvh{};
+    out_bvh->boxes      = boxes;
+    out_bvh->item_count = count;
+    if (!count)
+    {
+        return;
+    }
+    out_bvh->nodes = static_cast<bvh_node *>(memory);
+    out_bvh->items = reinterpret_cast<u32 *>(out_bvh->nodes + (2 * count - 1));
+
+    arena_scope scratch(scratch_arena_get());
+    bvh_build_state state;
+    state.boxes      = boxes;
+    state.centroids  = static_cast<vec3 *>(arena_allocate_block(scratch.owner, sizeof(vec3) * count));
+    state.items      = out_bvh->items;
+    state.nodes      = out_bvh->nodes;
+    state.node_count = 1;
+    for (u32 i = 0; i < count; i++)
+    {
+        state.items[i]     = i;
+        state.centroids[i] = (vec3(boxes[i].min) + boxes[i].max) * 0.5f;
+    }
+    bvh_build_node(&state, 0, 0, count, 0);
+    out_bvh->node_count = state.node_count;
+}
+
+void bvh_refit(bvh *bvh, const bounds_3D *boxes)
+{
+    DASSERT(bvh);
+    DASSERT(boxes || !bvh->item_count);
+    bvh->boxes = boxes;
+
+    // children are always after their parent, going backwards every child is done before the parent needs it.
+    for (u32 i = bvh->node_count; i-- > 0;)
+    {
+        bvh_node *node = bvh->nodes + i;
+        if (node->count)
+        {
+            const bounds_3D *box = boxes + bvh->items[node->first];
+            node->min            = box->min;
+            node->max            = box->max;
+            for (u32 j = node->first + 1; j < node->first + node->count; j++)
+            {
+                bvh_grow(&node->min, &node->max, boxes[bvh->items[j]].min, boxes[bvh->items[j]].max);
+            }
+        }
+        else
+        {
+            const bvh_node *left  = bvh->nodes + node->first;
+            const bvh_node *right = left + 1;
+            node->min             = left->min;
+            node->max             = left->max;
+            bvh_grow(&node->min, &node->max, right->min, right->max);
+        }
+    }
+}
+
+#define BVH_ALL_PLANES ((1u << FRUSTUM_PLANE_COUNT) - 1)
+
+// the frustum planes with the absolute normals next to them, those give the box radius along the normal.
+struct bvh_frustum_planes
+{
+    vec4 planes[FRUSTUM_PLANE_COUNT];
+    vec3 abs_normals[FRUSTUM_PLANE_COUNT];
+};
+
+// the planes in plane_mask that the box still crosses, planes it is completely in front of drop out of the mask.
+// Returns false when the box is completely behind one of them.
+static inline bool bvh_frustum_test(const bvh_frustum_planes *planes, vec3 min, vec3 max, u32 *plane_mask)
+{
+    vec3 center = (vec3(min) + max) * 0.5f;
+    vec3 extent = (vec3(max) - min) * 0.5f;
+    u32  mask   = *plane_mask;
+    for (u32 bits = mask; bits; bits &= bits - 1)
+    {
+        u32         p        = __builtin_ctz(bits);
+        const vec4 *plane    = &planes->planes[p];
+        const vec3 *a        = &planes->abs_normals[p];
+        f32         distance = center.x * plane->x + center.y * plane->y + center.z * plane->z + plane->w;
+        f32         radius   = extent.x * a->x + extent.y * a->y + extent.z * a->z;
+        if (distance < -radius)
+        {
+            return false;
+        }
+        if (distance >= radius)
+        {
+            mask &= ~(1u << p);
+        }
+    }
+    *plane_mask = mask;
+    return true;
+}
+
+u32 bvh_query_frustum(const bvh *bvh, const frustum *frustum, u32 *out_items)
+{
+    DASSERT(bvh && frustum);
+    if (!bvh->node_count)
+    {
+        return 0;
+    }
+
+    bvh_frustum_planes planes;
+    for (u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        planes.planes[p]      = frustum->planes[p];
+        planes.abs_normals[p] = vec3(fabsf(frustum->planes[p].x), fabsf(frustum->planes[p].y),
+                                     fabsf(frustum->planes[p].z));
+    }
+
+    // INFO: every entry carries the planes its parent still crossed. A subtree that is inside all of them is taken
+    // whole without testing anything in it.
+    struct entry
+    {
+        u32 node;
+        u32 plane_mask;
+    };
+    entry stack[BVH_MAX_DEPTH + 1];
+    u32   top = 0;
+    stack[top++] = {0, BVH_ALL_PLANES};
+
+    u32 visible_count = 0;
+    while (top)
+    {
+        entry           e    = stack[--top];
+        const bvh_node *node = bvh->nodes + e.node;
+        if (e.plane_mask && !bvh_frustum_test(&planes, node->min, node->max, &e.plane_mask))
+        {
+            continue;
+        }
+
+        if (!node->count)
+        {
+            DASSERT(top + 2 <= BVH_MAX_DEPTH + 1);
+            stack[top++] = {node->first + 1, e.plane_mask};
+            stack[top++] = {node->first, e.plane_mask};
+            continue;
+        }
+        for (u32 i = node->first; i < node->first + node->count; i++)
+        {
+            u32 item       = bvh->items[i];
+            u32 plane_mask = e.plane_mask;
+            if (!plane_mask || bvh_frustum_test(&planes, bvh->boxes[item].min, bvh->boxes[item].max, &plane_mask))
+            {
+                out_items[visible_count++] = item;
+            }
+        }
+    }
+    return visible_count;
+}
+
+// a 0 component would be an infinite inverse and 0 * infinity a nan for an origin right on a box face. A tiny one keeps
+// the ray just as parallel to the faces and the slab math finite.
+static inline f32 bvh_inverse(f32 d)
+{
+    f32 tiny = 1e-20f;
+    return 1.0f / (fabsf(d) > tiny ? d : (d < 0 ? -tiny : tiny));
+}
+
+// slab test, where the ray goes into and comes out of the box. Can be negative when the box is behind the origin.
+static inline bool bvh_ray_box(vec3 min, vec3 max, vec3 origin, vec3 inverse_direction, f32 *t_enter, f32 *t_exit)
+{
+    f32 tx0 = (min.x - origin.x) * inverse_direction.x;
+    f32 tx1 = (max.x - origin.x) * inverse_direction.x;
+    f32 ty0 = (min.y - origin.y) * inverse_direction.y;
+    f32 ty1 = (max.y - origin.y) * inverse_direction.y;
+    f32 tz0 = (min.z - origin.z) * inverse_direction.z;
+    f32 tz1 = (max.z - origin.z) * inverse_direction.z;
+
+    *t_enter = bvh_max(bvh_max(bvh_min(tx0, tx1), bvh_min(ty0, ty1)), bvh_min(tz0, tz1));
+    *t_exit  = bvh_min(bvh_min(bvh_max(tx0, tx1), bvh_max(ty0, ty1)), bvh_max(tz0, tz1));
+    return *t_exit >= *t_enter && *t_exit >= 0;
+}
+
+bool bvh_raycast(const bvh *bvh, vec3 origin, vec3 direction, f32 max_distance, bvh_hit *out_hit)
+{
+    DASSERT(bvh && out_hit);
+    *out_hit = bvh_hit{};
+    if (!bvh->node_count)
+    {
+        return false;
+    }
+
+    vec3 inverse_direction(bvh_inverse(direction.x), bvh_inverse(direction.y), bvh_inverse(direction.z));
+
+    struct entry
+    {
+        u32 node;
+        f32 t;
+    };
+    entry stack[BVH_MAX_DEPTH + 1];
+    u32   top = 0;
+
+    f32 best = max_distance;
+    f32 t_enter, t_exit;
+    if (!bvh_ray_box(bvh->nodes[0].min, bvh->nodes[0].max, origin, inverse_direction, &t_enter, &t_exit))
+    {
+        return false;
+    }
+    stack[top++] = {0, bvh_max(t_enter, 0)};
+
+    while (top)
+    {
+        entry e = stack[--top];
+        if (e.t > best)
+        {
+            continue;
+        }
+        const bvh_node *node = bvh->nodes + e.node;
+        if (node->count)
+        {
+            for (u32 i = node->first; i < node->first + node->count; i++)
+            {
+                u32              item = bvh->items[i];
+                const bounds_3D *box  = bvh->boxes + item;
+                if (bvh_ray_box(box->min, box->max, origin, inverse_direction, &t_enter, &t_exit) && t_enter > 0 &&
+                    t_enter <= best)
+                {
+                    best          = t_enter;
+                    out_hit->item = item;
+                }
+            }
+            continue;
+        }
+
+        // the nearer child goes on top so it is looked at first and shrinks best for the other one.
+        const bvh_node *left  = bvh->nodes + node->first;
+        const bvh_node *right = left + 1;
+        f32             left_enter, right_enter;
+        bool left_hit  = bvh_ray_box(left->min, left->max, origin, inverse_direction, &left_enter, &t_exit);
+        bool right_hit = bvh_ray_box(right->min, right->max, origin, inverse_direction, &right_enter, &t_exit);
+        left_enter     = bvh_max(left_enter, 0);
+        right_enter    = bvh_max(right_enter, 0);
+        left_hit       = left_hit && left_enter <= best;
+        right_hit      = right_hit && right_enter <= best;
+
+        DASSERT(top + 2 <= BVH_MAX_DEPTH + 1);
+        if (left_hit && right_hit)
+        {
+            bool left_first = left_enter <= right_enter;
+            stack[top++]    = left_first ? entry{node->first + 1, right_enter} : entry{node->first, left_enter};
+            stack[top++]    = left_first ? entry{node->first, left_enter} : entry{node->first + 1, right_enter};
+        }
+        else if (left_hit)
+        {
+            stack[top++] = {node->first, left_enter};
+        }
+        else if (right_hit)
+        {
+            stack[top++] = {node->first + 1, right_enter};
+        }
+    }
+
+    out_hit->distance = best;
+    return out_hit->item != INVALID_ID;
+}
+
+static inline f32 bvh_distance_squared(vec3 min, vec3 max, vec3 point)
+{
+    f32 dx = bvh_max(bvh_max(min.x - point.x, 0), point.x - max.x);
+    f32 dy = bvh_max(bvh_max(min.y - point.y, 0), point.y - max.y);
+    f32 dz = bvh_max(bvh_max(min.z - point.z, 0), point.z - max.z);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+bool bvh_nearest(const bvh *bvh, vec3 point, bvh_hit *out_hit)
+{
+    DASSERT(bvh && out_hit);
+    *out_hit = bvh_hit{};
+    if (!bvh->node_count)
+    {
+        return false;
+    }
+
+    struct entry
+    {
+        u32 node;
+        f32 distance_squared;
+    };
+    entry stack[BVH_MAX_DEPTH + 1];
+    u32   top    = 0;
+    stack[top++] = {0, bvh_distance_squared(bvh->nodes[0].min, bvh->nodes[0].max, point)};
+
+    f32 best = D_INFINITY;
+    while (top)
+    {
+        entry e = stack[--top];
+        if (e.distance_squared >= best)
+        {
+            continue;
+        }
+        const bvh_node *node = bvh->nodes + e.node;
+        if (node->count)
+        {
+            for (u32 i = node->first; i < node->first + node->count; i++)
+            {
+                u32 item             = bvh->items[i];
+                f32 distance_squared = bvh_distance_squared(bvh->boxes[item].min, bvh->boxes[item].max, point);
+                if (distance_squared < best)
+                {
+                    best          = distance_squared;
+                    out_hit->item = item;
+                }
+            }
+            continue;
+        }
+
+        const bvh_node *left           = bvh->nodes + node->first;
+        const bvh_node *right          = left + 1;
+        f32             left_distance  = bvh_distance_squared(left->min, left->max, point);
+        f32             right_distance = bvh_distance_squared(right->min, right->max, point);
+
+        DASSERT(top + 2 <= BVH_MAX_DEPTH + 1);
+        bool left_first = left_distance <= right_distance;
+        stack[top++]    = left_first ? entry{node->first + 1, right_distance} : entry{node->first, left_distance};
+        stack[top++]    = left_first ? entry{node->first, left_distance} : entry{node->first + 1, right_distance};
+    }
+
+    out_hit->distance = sqrtf(best);
+    return out_hit->item != INVALID_ID;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "defines.hpp"
+#include "math/dfrustum.hpp"
+#include "math/dmath_types.hpp"
+#include "memory/arenas.hpp"
+
+// INFO: bounding volume hierarchy over world space boxes, the geometry instances of a scene. It is built top down, and
+// every split is picked with the surface area heuristic over BVH_SAH_BINS centroid bins. Leaves hold a few items.
+// The nodes sit in one array and the two children of a node are next to each other, always after it. That makes a
+// refit one backwards pass over the nodes. A refit keeps the tree and only regrows the boxes, which is fine for objects
+// that move around a bit. Once they have moved a lot the tree gets loose and a rebuild pays off.
+//
+// The tree keeps a pointer to the boxes it was built or last refit from, the caller owns them. Items are indices into
+// that array, the queries hand those back.
+
+#define BVH_SAH_BINS       16
+#define BVH_MAX_LEAF_ITEMS 4
+// the build makes a leaf out of whatever is left at this depth, the queries keep a stack this deep.
+#define BVH_MAX_DEPTH      48
+
+struct bvh_node
+{
+    vec3 min;
+    // leaf: the first slot in bvh::items. Interior: the left child, the right one is first + 1.
+    u32  first;
+    vec3 max;
+    // 0 for interior nodes.
+    u32  count;
+};
+
+struct bvh
+{
+    bvh_node        *nodes      = nullptr;
+    u32             *items      = nullptr;
+    const bounds_3D *boxes      = nullptr;
+    u32              node_count = 0;
+    u32              item_count = 0;
+};
+
+struct bvh_hit
+{
+    u32 item     = INVALID_ID;
+    f32 distance = 0;
+};
+
+// bytes of nodes and items a tree over count boxes takes at the most.
+u64  bvh_memory_requirements(u32 count);
+// the nodes and items come out of the arena, only min/max of the boxes are used.
+void bvh_build(arena *arena, const bounds_3D *boxes, u32 count, bvh *out_bvh);
+// same, into memory of the caller that holds at least bvh_memory_requirements(count) bytes.
+void bvh_build_in_place(void *memory, const bounds_3D *boxes, u32 count, bvh *out_bvh);
+// boxes has to have the same items in the same order as the build, only their bounds changed.
+void bvh_refit(bvh *bvh, const bounds_3D *boxes);
+
+// the items whose boxes are at least partly inside, the same test as frustum_cull. out_items needs room for
+// bvh->item_count, returns how many were written. The order is the tree order, not the item order.
+u32 bvh_query_frustum(const bvh *bvh, const frustum *frustum, u32 *out_items);
+
+// the closest box the ray goes into, distance is along direction (doesnt have to be normalized). Boxes with the origin
+// inside them are skipped, so a ray from inside a big mesh (a sponza floor) still finds the things around it.
+bool bvh_raycast(const bvh *bvh, vec3 origin, vec3 direction, f32 max_distance, bvh_hit *out_hit);
+
+// the box closest to point, 0 distance for boxes point is inside of.
+bool bvh_nearest(const bvh *bvh, vec3 point, bvh_hit *out_hit);
@@ -0,0 +1,237 @@
+#include "dfrustum.hpp"
+#include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "math/dmath.hpp"
+#include "math/dsimd.hpp"
+
+frustum frustum_from_matrix(mat4 view_projection)
+{
+    // INFO: clip = point * view_projection, so clip.x/y/z/w are dot products with the columns. Inside is -w <= x <= w
+    // and so on, every one of those six is a plane: w + x >= 0 is the left one, w - x >= 0 the right one etc.
+    const f32 *m = view_projection.data;
+    vec4       column[4];
+    for (u32 j = 0; j < 4; j++)
+    {
+        column[j] = vec4(m[j], m[4 + j], m[8 + j], m[12 + j]);
+    }
+
+    frustum out_frustum;
+    out_frustum.planes[FRUSTUM_PLANE_LEFT]   = column[3] + column[0];
+    out_frustum.planes[FRUSTUM_PLANE_RIGHT]  = column[3] - column[0];
+    out_frustum.planes[FRUSTUM_PLANE_BOTTOM] = column[3] + column[1];
+    out_frustum.planes[FRUSTUM_PLANE_TOP]    = column[3] - column[1];
+    out_frustum.planes[FRUSTUM_PLANE_NEAR]   = column[3] + column[2];
+    out_frustum.planes[FRUSTUM_PLANE_FAR]    = column[3] - column[2];
+
+    for (u32 i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+    {
+        vec4 *plane  = &out_frustum.planes[i];
+        f32   length = sqrtf(plane->x * plane->x + plane->y * plane->y + plane->z * plane->z);
+        if (length > 0)
+        {
+            *plane /= length;
+        }
+    }
+    return out_frustum;
+}
+
+void frustum_cull_list_create(arena *arena, u32 capacity, frustum_cull_list *out_list)
+{
+    DASSERT(arena && out_list);
+    u32  padded = (capacity + FRUSTUM_CULL_WIDTH - 1) / FRUSTUM_CULL_WIDTH * FRUSTUM_CULL_WIDTH;
+    padded      = padded ? padded : FRUSTUM_CULL_WIDTH;
+    u64  size   = sizeof(f32) * padded * 6;
+    f32 *block  = static_cast<f32 *>(DALLOCATE(arena, size, MEM_TAG_RENDERER));
+    // the padding gets loaded along with the last group, zeroes keep it from being anything weird.
+    dzero_memory(block, size);
+
+    out_list->center_x = block;
+    out_list->center_y = block + padded;
+    out_list->center_z = block + padded * 2;
+    out_list->extent_x = block + padded * 3;
+    out_list->extent_y = block + padded * 4;
+    out_list->extent_z = block + padded * 5;
+    out_list->count    = 0;
+    out_list->capacity = capacity;
+}
+
+void frustum_cull_list_push(frustum_cull_list *list, const bounds_3D *bounds, mat4 model)
+{
+    DASSERT(list && bounds);
+    DASSERT(list->count < list->capacity);
+
+    // the center moves like a point. The world extent along an axis is the object extents weighted by how much of
+    // every object axis ends up on it, which is the absolute matrix (Arvo's box transform).
+    simd_f32x4 row0 = simd_load(model.data);
+    simd_f32x4 row1 = simd_load(model.data + 4);
+    simd_f32x4 row2 = simd_load(model.data + 8);
+    simd_f32x4 row3 = simd_load(model.data + 12);
+
+    simd_f32x4 center = simd_madd(simd_splat(bounds->center.z), row2,
+                                  simd_madd(simd_splat(bounds->center.y), row1,
+                                            simd_madd(simd_splat(bounds->center.x), row0, row3)));
+    simd_f32x4 extent = simd_mul(simd_splat(0.5f), simd_sub(simd_loadu(bounds->max.elements),
+                                                             simd_loadu(bounds->min.elements)));
+    simd_f32x4 world_extent = simd_madd(simd_lane<2>(extent), simd_abs(row2),
+                                        simd_madd(simd_lane<1>(extent), simd_abs(row1),
+                                                  simd_mul(simd_lane<0>(extent), simd_abs(row0))));
+
+    alignas(16) f32 c[4];
+    alignas(16) f32 e[4];
+    simd_store(c, center);
+    simd_store(e, world_extent);
+
+    u32 i             = list->count++;
+    list->center_x[i] = c[0];
+    list->center_y[i] = c[1];
+    list->center_z[i] = c[2];
+    list->extent_x[i] = e[0];
+    list->extent_y[i] = e[1];
+    list->extent_z[i] = e[2];
+}
+
+void frustum_cull_list_push_world(frustum_cull_list *list, const bounds_3D *world_bounds)
+{
+    DASSERT(list && world_bounds);
+    DASSERT(list->count < list->capacity);
+
+    u32 i             = list->count++;
+    list->center_x[i] = world_bounds->center.x;
+    list->center_y[i] = world_bounds->center.y;
+    list->center_z[i] = world_bounds->center.z;
+    list->extent_x[i] = 0.5f * (world_bounds->max.x - world_bounds->min.x);
+    list->extent_y[i] = 0.5f * (world_bounds->max.y - world_bounds->min.y);
+    list->extent_z[i] = 0.5f * (world_bounds->max.z - world_bounds->min.z);
+}
+
+// the visible bits of one group out as indices.
+static inline u32 frustum_write_visible(u32 visible, u32 first, u32 *out_visible, u32 visible_count)
+{
+    while (visible)
+    {
+        out_visible[visible_count++] = first + __builtin_ctz(visible);
+        visible &= visible - 1;
+    }
+    return visible_count;
+}
+
+#if DSIMD_AVX
+
+static inline __m256 frustum_madd8(__m256 a, __m256 b, __m256 c)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+u32 frustum_cull(const frustum *frustum, const frustum_cull_list *list, u32 *out_visible)
+{
+    DASSERT(frustum && list && (out_visible || !list->count));
+
+    // every plane float in its own register once, the negated absolute normal gives -radius straight away.
+    __m256 nx[FRUSTUM_PLANE_COUNT], ny[FRUSTUM_PLANE_COUNT], nz[FRUSTUM_PLANE_COUNT], d[FRUSTUM_PLANE_COUNT];
+    __m256 ax[FRUSTUM_PLANE_COUNT], ay[FRUSTUM_PLANE_COUNT], az[FRUSTUM_PLANE_COUNT];
+    for (u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        const vec4 *plane = &frustum->planes[p];
+        nx[p]             = _mm256_set1_ps(plane->x);
+        ny[p]             = _mm256_set1_ps(plane->y);
+        nz[p]             = _mm256_set1_ps(plane->z);
+        d[p]              = _mm256_set1_ps(plane->w);
+        ax[p]             = _mm256_set1_ps(-fabsf(plane->x));
+        ay[p]             = _mm256_set1_ps(-fabsf(plane->y));
+        az[p]             = _mm256_set1_ps(-fabsf(plane->z));
+    }
+
+    u32 visible_count = 0;
+    for (u32 first = 0; first < list->count; first += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(list->center_x + first);
+        __m256 cy = _mm256_loadu_ps(list->center_y + first);
+        __m256 cz = _mm256_loadu_ps(list->center_z + first);
+        __m256 ex = _mm256_loadu_ps(list->extent_x + first);
+        __m256 ey = _mm256_loadu_ps(list->extent_y + first);
+        __m256 ez = _mm256_loadu_ps(list->extent_z + first);
+
+        u32 outside = 0;
+        for (u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+        {
+            __m256 distance     = frustum_madd8(cz, nz[p], frustum_madd8(cy, ny[p], frustum_madd8(cx, nx[p], d[p])));
+            __m256 minus_radius = frustum_madd8(ez, az[p], frustum_madd8(ey, ay[p], _mm256_mul_ps(ex, ax[p])));
+            outside |= static_cast<u32>(_mm256_movemask_ps(_mm256_cmp_ps(minus_radius, distance, _CMP_GT_OQ)));
+        }
+        u32 valid     = list->count - first < 8 ? (1u << (list->count - first)) - 1 : 0xFFu;
+        visible_count = frustum_write_visible(~outside & valid, first, out_visible, visible_count);
+    }
+    return visible_count;
+}
+
+#else
+
+u32 frustum_cull(const frustum *frustum, const frustum_cull_list *list, u32 *out_visible)
+{
+    DASSERT(frustum && list && (out_visible || !list->count));
+
+    simd_f32x4 nx[FRUSTUM_PLANE_COUNT], ny[FRUSTUM_PLANE_COUNT], nz[FRUSTUM_PLANE_COUNT], d[FRUSTUM_PLANE_COUNT];
+    simd_f32x4 ax[FRUSTUM_PLANE_COUNT], ay[FRUSTUM_PLANE_COUNT], az[FRUSTUM_PLANE_COUNT];
+    for (u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+        const vec4 *plane = &frustum->planes[p];
+        nx[p]             = simd_splat(plane->x);
+        ny[p]             = simd_splat(plane->y);
+        nz[p]             = simd_splat(plane->z);
+        d[p]              = simd_splat(plane->w);
+        ax[p]             = simd_splat(-fabsf(plane->x));
+        ay[p]             = simd_splat(-fabsf(plane->y));
+        az[p]             = simd_splat(-fabsf(plane->z));
+    }
+
+    u32 visible_count = 0;
+    for (u32 first = 0; first < list->count; first += 4)
+    {
+        simd_f32x4 cx = simd_loadu(list->center_x + first);
+        simd_f32x4 cy = simd_loadu(list->center_y + first);
+        simd_f32x4 cz = simd_loadu(list->center_z + first);
+        simd_f32x4 ex = simd_loadu(list->extent_x + first);
+        simd_f32x4 ey = simd_loadu(list->extent_y + first);
+        simd_f32x4 ez = simd_loadu(list->extent_z + first);
+
+        u32 outside = 0;
+        for (u32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+        {
+            simd_f32x4 distance     = simd_madd(cz, nz[p], simd_madd(cy, ny[p], simd_madd(cx, nx[p], d[p])));
+            simd_f32x4 minus_radius = simd_madd(ez, az[p], simd_madd(ey, ay[p], simd_mul(ex, ax[p])));
+            outside                |= simd_mask_bits(simd_cmp_gt(minus_radius, distance));
+        }
+        u32 valid     = list->count - first < 4 ? (1u << (list->count - first)) - 1 : 0xFu;
+        visible_count = frustum_write_visible(~outside & valid, first, out_visible, visible_count);
+    }
+    return visible_count;
+}
+
+#endif
+
+u32 frustum_cull_scalar(const frustum *frustum, const frustum_cull_list *list, u32 *out_visible)
+{
+    u32 visible_count = 0;
+    for (u32 i = 0; i < list->count; i++)
+    {
+        bool inside = true;
+        for (u32 p = 0; p < FRUSTUM_PLANE_COUNT && inside; p++)
+        {
+            const vec4 *plane    = &frustum->planes[p];
+            f32         distance = list->center_x[i] * plane->x + list->center_y[i] * plane->y +
+                           list->center_z[i] * plane->z + plane->w;
+            f32 radius = list->extent_x[i] * fabsf(plane->x) + list->extent_y[i] * fabsf(plane->y) +
+                         list->extent_z[i] * fabsf(plane->z);
+            inside = distance >= -radius;
+        }
+        if (inside)
+        {
+            out_visible[visible_count++] = i;
+        }
+    }
+    return visible_count;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "defines.hpp"
+#include "math/dmath_types.hpp"
+#include "memory/arenas.hpp"
+
+// INFO: view frustum culling on the cpu. The planes come out of view * projection, every plane is a normal pointing
+// into the frustum plus a distance, a point is inside when dot(normal, point) + distance >= 0. Boxes are tested as
+// center and half extent: a box is culled when it is completely behind one of the planes. That keeps the odd box that
+// is outside but straddles two planes near a corner, which costs a draw call but never drops anything that is on
+// screen.
+//
+// frustum_cull runs 8 boxes per op with avx and 4 everywhere else, frustum_cull_scalar is the one box at a time
+// reference that the "frustum_cull" bench group checks against.
+
+enum frustum_plane
+{
+    FRUSTUM_PLANE_LEFT,
+    FRUSTUM_PLANE_RIGHT,
+    FRUSTUM_PLANE_BOTTOM,
+    FRUSTUM_PLANE_TOP,
+    FRUSTUM_PLANE_NEAR,
+    FRUSTUM_PLANE_FAR,
+    FRUSTUM_PLANE_COUNT,
+};
+
+struct frustum
+{
+    // xyz is the normalized normal, w the distance.
+    vec4 planes[FRUSTUM_PLANE_COUNT];
+};
+
+// the cull list arrays are padded to this many boxes so the last group can be loaded whole.
+#define FRUSTUM_CULL_WIDTH 8
+
+// world space boxes, one array per float so a group of boxes loads with one op per float.
+struct frustum_cull_list
+{
+    f32 *center_x;
+    f32 *center_y;
+    f32 *center_z;
+    f32 *extent_x;
+    f32 *extent_y;
+    f32 *extent_z;
+    u32  count;
+    u32  capacity;
+};
+
+// view_projection is view * projection (row vectors, so the view is applied first). The projection is the gl style
+// one from mat4_perspective, z from -w to w. The renderer only keeps 0 to w, so the near plane here is a bit further
+// back than the real one, which only ever keeps more.
+frustum frustum_from_matrix(mat4 view_projection);
+
+// the arrays come out of the arena, use the frame arena for a list that is rebuilt every frame.
+void frustum_cull_list_create(arena *arena, u32 capacity, frustum_cull_list *out_list);
+// adds the world space box around bounds moved by model.
+void frustum_cull_list_push(frustum_cull_list *list, const bounds_3D *bounds, mat4 model);
+// adds a box that is in world space already, bounds_3D_transform output for example.
+void frustum_cull_list_push_world(frustum_cull_list *list, const bounds_3D *world_bounds);
+
+// writes the indices of the boxes that are at least partly inside to out_visible, in order, and returns how many
+// there are. out_visible needs room for list->count indices.
+u32 frustum_cull(const frustum *frustum, const frustum_cull_list *list, u32 *out_visible);
+u32 frustum_cull_scalar(const frustum *frustum, const frustum_cull_list *list, u32 *out_visible);
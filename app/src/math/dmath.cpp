@@ -1,5 +1,6 @@
 #include "dmath.hpp"
 #include "core/dasserts.hpp"
+#include "math/dvertex_batch.hpp"
 #include "platform/platform.hpp"
 #include "resources/resource_types.hpp"
 //
@@ -59,25 +60,36 @@ f32 fdrandom_in_range(f32 min, f32 max)
 // HACK:
 //  for scaling
 
-void scale_geometries(const geometry_config *config, vec3 scaling_factor)
+void scale_geometries(geometry_config *config, vec3 scaling_factor)
 {
     u32 vertex_count = config->vertex_count;
 
     if(config->type == GEO_TYPE_3D)
     {
-        for (u32 i = 0; i < vertex_count; i++)
+        vertex_batch_scale_translate_3D(static_cast<vertex_3D *>(config->vertices), vertex_count, scaling_factor,
+                                        vec3());
+        // bounds that came out of the .bin cache are for the unscaled vertices, scale them along instead of going
+        // over the vertices again.
+        if (config->has_bounds)
         {
-            reinterpret_cast<vertex_3D *>(config->vertices)[i].position.x *= scaling_factor.x;
-            reinterpret_cast<vertex_3D *>(config->vertices)[i].position.y *= scaling_factor.y;
-            reinterpret_cast<vertex_3D *>(config->vertices)[i].position.z *= scaling_factor.z;
+            bounds_3D *bounds       = &config->bounds;
+            f32        radius_scale = 0;
+            for (u32 i = 0; i < 3; i++)
+            {
+                f32 a = bounds->min.elements[i] * scaling_factor.elements[i];
+                f32 b = bounds->max.elements[i] * scaling_factor.elements[i];
+
+                bounds->min.elements[i]     = a < b ? a : b;
+                bounds->max.elements[i]     = a < b ? b : a;
+                bounds->center.elements[i] *= scaling_factor.elements[i];
+                radius_scale                = fmaxf(radius_scale, fabsf(scaling_factor.elements[i]));
+            }
+            bounds->radius *= radius_scale;
         }
     }
     else
     {
-        for (u32 i = 0; i < vertex_count; i++)
-        {
-            reinterpret_cast<vertex_2D *>(config->vertices)[i].position.x *= scaling_factor.x;
-            reinterpret_cast<vertex_2D *>(config->vertices)[i].position.y *= scaling_factor.y;
-        }
+        vertex_batch_scale_translate_2D(static_cast<vertex_2D *>(config->vertices), vertex_count,
+                                        vec2(scaling_factor.x, scaling_factor.y), vec2());
     }
 }
@@ -5,6 +5,7 @@
 #include "core/dmemory.hpp"
 #include "defines.hpp"
 #include "dmath_types.hpp"
+#include "dsimd.hpp"
 #include <cmath>
 
 #define D_PI 3.14159265358979323846f
@@ -62,7 +63,9 @@ inline bool vec2_compare(vec2 vector_0, vec2 vector_1, f32 tolerance)
     return true;
 }
 
-inline vec3 vec3_normalized(vec3 a)
+// INFO: the *_scalar functions are the plain versions, the ones without the suffix go through math/dsimd.hpp. The
+// scalar ones stay around as the reference the simd ones are checked against (the "math" bench group).
+inline vec3 vec3_normalized_scalar(vec3 a)
 {
     const f32 length = a.magnitude();
     f32       x      = a.x / length;
@@ -70,6 +73,14 @@ inline vec3 vec3_normalized(vec3 a)
     f32       z      = a.z / length;
     return vec3(x, y, z);
 }
+inline vec3 vec3_normalized(vec3 a)
+{
+    simd_f32x4 v = simd_set(a.x, a.y, a.z, 0.0f);
+    v            = simd_mul(v, simd_rsqrt(simd_dot4(v, v)));
+    alignas(16) f32 out[4];
+    simd_store(out, v);
+    return vec3(out[0], out[1], out[2]);
+}
 inline f32 vec3_dot(vec3 vector_0, vec3 vector_1)
 {
     f32 p  = 0;
@@ -109,7 +120,7 @@ inline f32 vec3_distance(vec3 vector_0, vec3 vector_1)
     return d.magnitude();
 }
 
-inline vec4 vec4_normalized(vec4 a)
+inline vec4 vec4_normalized_scalar(vec4 a)
 {
     const f32 length = a.magnitude();
     f32       x      = a.x / length;
@@ -118,13 +129,20 @@ inline vec4 vec4_normalized(vec4 a)
     f32       w      = a.w / length;
     return vec4(x, y, z, w);
 }
+inline vec4 vec4_normalized(vec4 a)
+{
+    simd_f32x4 v = simd_load(a.elements);
+    vec4       out_vector;
+    simd_store(out_vector.elements, simd_mul(v, simd_rsqrt(simd_dot4(v, v))));
+    return out_vector;
+}
 inline f32 vec4_dot_f32(vec4 a, vec4 b)
 {
     f32 p = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
     return p;
 }
 
-inline mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1)
+inline mat4 mat4_mul_scalar(mat4 matrix_0, mat4 matrix_1)
 {
     mat4 out_matrix = mat4();
 
@@ -144,6 +162,85 @@ inline mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1)
     }
     return out_matrix;
 }
+inline mat4 mat4_mul(mat4 matrix_0, mat4 matrix_1)
+{
+    mat4 out_matrix;
+    simd_mat4_mul(matrix_0.data, matrix_1.data, out_matrix.data);
+    return out_matrix;
+}
+
+// matrices act on row vectors here (v * M, the translation sits in data[12..14]), which is M * v in glsl.
+inline vec4 mat4_mul_vec4_scalar(mat4 matrix, vec4 vector)
+{
+    const f32 *m = matrix.data;
+    vec4       out_vector;
+    for (s32 i = 0; i < 4; i++)
+    {
+        out_vector.elements[i] =
+            vector.x * m[0 + i] + vector.y * m[4 + i] + vector.z * m[8 + i] + vector.w * m[12 + i];
+    }
+    return out_vector;
+}
+inline vec4 mat4_mul_vec4(mat4 matrix, vec4 vector)
+{
+    simd_f32x4 v = simd_load(vector.elements);
+    simd_f32x4 r = simd_mul(simd_lane<0>(v), simd_load(matrix.data));
+    r            = simd_madd(simd_lane<1>(v), simd_load(matrix.data + 4), r);
+    r            = simd_madd(simd_lane<2>(v), simd_load(matrix.data + 8), r);
+    r            = simd_madd(simd_lane<3>(v), simd_load(matrix.data + 12), r);
+    vec4 out_vector;
+    simd_store(out_vector.elements, r);
+    return out_vector;
+}
+
+// point with w = 1, translation applies. No divide by w, this is for affine matrices.
+inline vec3 mat4_transform_point_scalar(mat4 matrix, vec3 point)
+{
+    vec4 out_vector = mat4_mul_vec4_scalar(matrix, vec4(point.x, point.y, point.z, 1.0f));
+    return vec3(out_vector.x, out_vector.y, out_vector.z);
+}
+// NOTE: stays scalar. The simd version measured 0.94x to 1.02x of the scalar one, for a single point the splats and
+// the store back into a vec3 cost as much as the multiply adds they save.
+inline vec3 mat4_transform_point(mat4 matrix, vec3 point)
+{
+    return mat4_transform_point_scalar(matrix, point);
+}
+
+// direction with w = 0, only the upper 3x3 applies.
+inline vec3 mat4_transform_vector_scalar(mat4 matrix, vec3 vector)
+{
+    vec4 out_vector = mat4_mul_vec4_scalar(matrix, vec4(vector.x, vector.y, vector.z, 0.0f));
+    return vec3(out_vector.x, out_vector.y, out_vector.z);
+}
+inline vec3 mat4_transform_vector(mat4 matrix, vec3 vector)
+{
+    simd_f32x4 r = simd_mul(simd_splat(vector.x), simd_load(matrix.data));
+    r            = simd_madd(simd_splat(vector.y), simd_load(matrix.data + 4), r);
+    r            = simd_madd(simd_splat(vector.z), simd_load(matrix.data + 8), r);
+    alignas(16) f32 out[4];
+    simd_store(out, r);
+    return vec3(out[0], out[1], out[2]);
+}
+
+// the world box of an object box (Arvo): the center moves like a point and the world extents are the object extents
+// through the absolute matrix. frustum_cull_list_push does the same thing straight into its arrays.
+inline bounds_3D bounds_3D_transform(const bounds_3D *bounds, mat4 model)
+{
+    const f32 *m      = model.data;
+    vec3       extent = (vec3(bounds->max) - bounds->min) * 0.5f;
+    vec3       world_extent;
+    for (u32 i = 0; i < 3; i++)
+    {
+        world_extent.elements[i] = extent.x * fabsf(m[i]) + extent.y * fabsf(m[4 + i]) + extent.z * fabsf(m[8 + i]);
+    }
+
+    bounds_3D out_bounds;
+    out_bounds.center = mat4_transform_point(model, (vec3(bounds->min) + bounds->max) * 0.5f);
+    out_bounds.min    = out_bounds.center - world_extent;
+    out_bounds.max    = out_bounds.center + world_extent;
+    out_bounds.radius = world_extent.magnitude();
+    return out_bounds;
+}
 
 inline mat4 mat4_orthographic(f32 left, f32 right, f32 bottom, f32 top, f32 near_clip, f32 far_clip)
 {
@@ -234,7 +331,7 @@ inline mat4 mat4_look_at(vec3 position, vec3 target, vec3 up)
  * @param matrix The matrix to be transposed.
  * @return A transposed copy of of the provided matrix.
  */
-inline mat4 mat4_transposed(mat4 matrix)
+inline mat4 mat4_transposed_scalar(mat4 matrix)
 {
     mat4 out_matrix     = mat4();
     out_matrix.data[0]  = matrix.data[0];
@@ -255,6 +352,20 @@ inline mat4 mat4_transposed(mat4 matrix)
     out_matrix.data[15] = matrix.data[15];
     return out_matrix;
 }
+inline mat4 mat4_transposed(mat4 matrix)
+{
+    simd_f32x4 r0 = simd_load(matrix.data);
+    simd_f32x4 r1 = simd_load(matrix.data + 4);
+    simd_f32x4 r2 = simd_load(matrix.data + 8);
+    simd_f32x4 r3 = simd_load(matrix.data + 12);
+    simd_transpose(&r0, &r1, &r2, &r3);
+    mat4 out_matrix;
+    simd_store(out_matrix.data, r0);
+    simd_store(out_matrix.data + 4, r1);
+    simd_store(out_matrix.data + 8, r2);
+    simd_store(out_matrix.data + 12, r3);
+    return out_matrix;
+}
 
 /**
  * @brief Creates and returns an inverse of the provided matrix.
@@ -262,7 +373,7 @@ inline mat4 mat4_transposed(mat4 matrix)
  * @param matrix The matrix to be inverted.
  * @return A inverted copy of the provided matrix.
  */
-inline mat4 mat4_inverse(mat4 matrix)
+inline mat4 mat4_inverse_scalar(mat4 matrix)
 {
     const f32 *m = matrix.data;
 
@@ -321,6 +432,75 @@ inline mat4 mat4_inverse(mat4 matrix)
     return out_matrix;
 }
 
+// INFO: the simd inverse works on the four 2x2 blocks of the matrix, | A B |
+//                                                                     | C D |
+// each block lives in one register as (m00, m01, m10, m11). With X# meaning the adjugate of X and |X| its
+// determinant the inverse is 1/|M| * | (|D|A - B(D#C))#   (|B|C - D(A#B)#)# |
+//                                    | (|C|B - A(D#C)#)#   (|A|D - C(A#B))#  |
+// and |M| = |A||D| + |B||C| - tr((A#B)(D#C)).
+// 2x2 block products, A * B, A# * B and A * B#.
+inline simd_f32x4 mat2_mul(simd_f32x4 a, simd_f32x4 b)
+{
+    return simd_add(simd_mul(a, simd_shuffle<0, 3, 0, 3>(b, b)),
+                    simd_mul(simd_shuffle<1, 0, 3, 2>(a, a), simd_shuffle<2, 1, 2, 1>(b, b)));
+}
+inline simd_f32x4 mat2_adj_mul(simd_f32x4 a, simd_f32x4 b)
+{
+    return simd_sub(simd_mul(simd_shuffle<3, 3, 0, 0>(a, a), b),
+                    simd_mul(simd_shuffle<1, 1, 2, 2>(a, a), simd_shuffle<2, 3, 0, 1>(b, b)));
+}
+inline simd_f32x4 mat2_mul_adj(simd_f32x4 a, simd_f32x4 b)
+{
+    return simd_sub(simd_mul(a, simd_shuffle<3, 0, 3, 0>(b, b)),
+                    simd_mul(simd_shuffle<1, 0, 3, 2>(a, a), simd_shuffle<2, 1, 2, 1>(b, b)));
+}
+
+inline mat4 mat4_inverse(mat4 matrix)
+{
+    simd_f32x4 r0 = simd_load(matrix.data);
+    simd_f32x4 r1 = simd_load(matrix.data + 4);
+    simd_f32x4 r2 = simd_load(matrix.data + 8);
+    simd_f32x4 r3 = simd_load(matrix.data + 12);
+
+    simd_f32x4 a = simd_shuffle<0, 1, 0, 1>(r0, r1);
+    simd_f32x4 b = simd_shuffle<2, 3, 2, 3>(r0, r1);
+    simd_f32x4 c = simd_shuffle<0, 1, 0, 1>(r2, r3);
+    simd_f32x4 d = simd_shuffle<2, 3, 2, 3>(r2, r3);
+
+    // (|A|, |B|, |C|, |D|) in one go.
+    simd_f32x4 det_sub = simd_sub(simd_mul(simd_shuffle<0, 2, 0, 2>(r0, r2), simd_shuffle<1, 3, 1, 3>(r1, r3)),
+                                  simd_mul(simd_shuffle<1, 3, 1, 3>(r0, r2), simd_shuffle<0, 2, 0, 2>(r1, r3)));
+    simd_f32x4 det_a   = simd_lane<0>(det_sub);
+    simd_f32x4 det_b   = simd_lane<1>(det_sub);
+    simd_f32x4 det_c   = simd_lane<2>(det_sub);
+    simd_f32x4 det_d   = simd_lane<3>(det_sub);
+
+    simd_f32x4 d_c = mat2_adj_mul(d, c);
+    simd_f32x4 a_b = mat2_adj_mul(a, b);
+    simd_f32x4 x   = simd_sub(simd_mul(det_d, a), mat2_mul(b, d_c));
+    simd_f32x4 w   = simd_sub(simd_mul(det_a, d), mat2_mul(c, a_b));
+    simd_f32x4 y   = simd_sub(simd_mul(det_b, c), mat2_mul_adj(d, a_b));
+    simd_f32x4 z   = simd_sub(simd_mul(det_c, b), mat2_mul_adj(a, d_c));
+
+    simd_f32x4 det_m = simd_add(simd_mul(det_a, det_d), simd_mul(det_b, det_c));
+    det_m            = simd_sub(det_m, simd_dot4(a_b, simd_shuffle<0, 2, 1, 3>(d_c, d_c)));
+
+    // the signs of the 2x2 adjugate go in with 1/|M|.
+    simd_f32x4 rcp_det = simd_div(simd_set(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+    x                  = simd_mul(x, rcp_det);
+    y                  = simd_mul(y, rcp_det);
+    z                  = simd_mul(z, rcp_det);
+    w                  = simd_mul(w, rcp_det);
+
+    // the adjugate swizzle and putting the blocks back into rows in one shuffle each.
+    mat4 out_matrix;
+    simd_store(out_matrix.data, simd_shuffle<3, 1, 3, 1>(x, y));
+    simd_store(out_matrix.data + 4, simd_shuffle<2, 0, 2, 0>(x, y));
+    simd_store(out_matrix.data + 8, simd_shuffle<3, 1, 3, 1>(z, w));
+    simd_store(out_matrix.data + 12, simd_shuffle<2, 0, 2, 0>(z, w));
+    return out_matrix;
+}
+
 inline mat4 mat4_translation(vec3 position)
 {
     mat4 out_matrix     = mat4();
@@ -503,11 +683,15 @@ inline f32 quat_normal(quat q)
     return sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
 }
 
-inline quat quat_normalize(quat q)
+inline quat quat_normalize_scalar(quat q)
 {
     f32 normal = quat_normal(q);
     return (quat){q.x / normal, q.y / normal, q.z / normal, q.w / normal};
 }
+inline quat quat_normalize(quat q)
+{
+    return vec4_normalized(q);
+}
 
 inline quat quat_conjugate(quat q)
 {
@@ -519,7 +703,7 @@ inline quat quat_inverse(quat q)
     return quat_normalize(quat_conjugate(q));
 }
 
-inline quat quat_mul(quat q_0, quat q_1)
+inline quat quat_mul_scalar(quat q_0, quat q_1)
 {
     quat out_quaternion;
 
@@ -533,6 +717,22 @@ inline quat quat_mul(quat q_0, quat q_1)
 
     return out_quaternion;
 }
+inline quat quat_mul(quat q_0, quat q_1)
+{
+    // q_0.x * (w, -z, y, -x) + q_0.y * (z, w, -x, -y) + q_0.z * (-y, x, w, -z) + q_0.w * q_1
+    simd_f32x4 a = simd_load(q_0.elements);
+    simd_f32x4 b = simd_load(q_1.elements);
+    simd_f32x4 r = simd_mul(simd_lane<3>(a), b);
+    r            = simd_madd(simd_mul(simd_lane<0>(a), simd_set(1.0f, -1.0f, 1.0f, -1.0f)),
+                             simd_shuffle<3, 2, 1, 0>(b, b), r);
+    r            = simd_madd(simd_mul(simd_lane<1>(a), simd_set(1.0f, 1.0f, -1.0f, -1.0f)),
+                             simd_shuffle<2, 3, 0, 1>(b, b), r);
+    r            = simd_madd(simd_mul(simd_lane<2>(a), simd_set(-1.0f, 1.0f, 1.0f, -1.0f)),
+                             simd_shuffle<1, 0, 3, 2>(b, b), r);
+    quat out_quaternion;
+    simd_store(out_quaternion.elements, r);
+    return out_quaternion;
+}
 
 inline f32 quat_dot(quat q_0, quat q_1)
 {
@@ -689,6 +889,6 @@ s64 drandom_in_range_s64(s64 min, s64 max);
 f32 fdrandom();
 f32 fdrandom_in_range(f32 min, f32 max);
 
-void scale_geometries(const struct geometry_config *config, vec3 scaling_factor);
+void scale_geometries(struct geometry_config *config, vec3 scaling_factor);
 
 #pragma clang diagnostic pop
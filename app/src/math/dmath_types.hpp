@@ -1,6 +1,7 @@
 #pragma once
 #include "core/dmemory.hpp"
 #include "defines.hpp"
+#include "math/dsimd.hpp"
 #include <cmath>
 
 struct vec2
@@ -43,23 +44,23 @@ struct vec2
         this->x /= n;
         this->y /= n;
     }
-    inline vec2 operator+(const vec2 &vec)
+    inline vec2 operator+(const vec2 &vec) const
     {
         return vec2(this->x + vec.x, this->y + vec.y);
     }
-    inline vec2 operator-(const vec2 &vec)
+    inline vec2 operator-(const vec2 &vec) const
     {
         return vec2(this->x - vec.x, this->y - vec.y);
     }
-    inline vec2 operator*(const f32 n)
+    inline vec2 operator*(const f32 n) const
     {
         return vec2(this->x * n, this->y * n);
     }
-    inline vec2 operator/(const f32 n)
+    inline vec2 operator/(const f32 n) const
     {
         return vec2(this->x / n, this->y / n);
     }
-    inline f32 magnitude()
+    inline f32 magnitude() const
     {
         return sqrtf(this->x * this->x + this->y * this->y);
     }
@@ -96,19 +97,19 @@ struct vec3
     vec3() : x(0), y(0), z(0) {};
     vec3(f32 x, f32 y, f32 z) : x(x), y(y), z(z) {};
 
-    inline vec3 operator+(const vec3 &vec)
+    inline vec3 operator+(const vec3 &vec) const
     {
         return vec3(this->x + vec.x, this->y + vec.y, this->z + vec.z);
     }
-    inline vec3 operator-(const vec3 &vec)
+    inline vec3 operator-(const vec3 &vec) const
     {
         return vec3(this->x - vec.x, this->y - vec.y, this->z - vec.z);
     }
-    inline vec3 operator*(const f32 n)
+    inline vec3 operator*(const f32 n) const
     {
         return vec3(this->x * n, this->y * n, this->z * n);
     }
-    inline vec3 operator/(const f32 n)
+    inline vec3 operator/(const f32 n) const
     {
         return vec3(this->x / n, this->y / n, this->z / n);
     }
@@ -142,7 +143,7 @@ struct vec3
         this->y /= n;
         this->z /= n;
     }
-    inline f32 magnitude()
+    inline f32 magnitude() const
     {
         return sqrtf(this->x * this->x + this->y * this->y + this->z * this->z);
     }
@@ -156,7 +157,8 @@ struct vec3
     // return true if 'this' vector is bigger
 };
 
-struct vec4
+// NOTE: vec4 and mat4 are 16 byte aligned so the simd paths in dmath.hpp can load them straight.
+struct alignas(16) vec4
 {
     union {
         // An array of x, y, z, w
@@ -185,19 +187,19 @@ struct vec4
     vec4() : x(0), y(0), z(0), w(0) {};
     vec4(f32 x, f32 y, f32 z, f32 w) : x(x), y(y), z(z), w(w) {};
 
-    inline vec4 operator+(const vec4 &vec)
+    inline vec4 operator+(const vec4 &vec) const
     {
         return vec4(this->x + vec.x, this->y + vec.y, this->z + vec.z, this->w + vec.w);
     }
-    inline vec4 operator-(const vec4 &vec)
+    inline vec4 operator-(const vec4 &vec) const
     {
         return vec4(this->x - vec.x, this->y - vec.y, this->z - vec.z, this->w - vec.w);
     }
-    inline vec4 operator*(const f32 n)
+    inline vec4 operator*(const f32 n) const
     {
         return vec4(this->x * n, this->y * n, this->z * n, this->w * n);
     }
-    inline vec4 operator/(const f32 n)
+    inline vec4 operator/(const f32 n) const
     {
         return vec4(this->x / n, this->y / n, this->z / n, this->w / n);
     }
@@ -229,7 +231,7 @@ struct vec4
         this->z /= n;
         this->w /= n;
     }
-    inline f32 magnitude()
+    inline f32 magnitude() const
     {
         return sqrtf(this->x * this->x + this->y * this->y + this->z * this->z + this->w * this->w);
     }
@@ -242,17 +244,14 @@ struct vec4
         this->w          /= length;
     }
 };
-struct mat4
+struct alignas(16) mat4
 {
     f32 data[16];
 
-    mat4()
+    // identity. Spelled out instead of zeroing through dzero_memory so the compiler can see through it, every simd
+    // op that returns a mat4 constructs one.
+    mat4() : data{1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f, 0, 0, 0, 0, 1.0f}
     {
-        dzero_memory(this->data, sizeof(f32) * 16);
-        data[0]  = 1.0f;
-        data[5]  = 1.0f;
-        data[10] = 1.0f;
-        data[15] = 1.0f;
     }
 
     inline mat4 operator+(mat4 matrix_1)
@@ -281,43 +280,23 @@ struct mat4
     };
     inline mat4 operator*(mat4 matrix_1)
     {
-        mat4 out_matrix = mat4();
-
-        const f32 *m1_ptr  = this->data;
-        const f32 *m2_ptr  = matrix_1.data;
-        f32       *dst_ptr = out_matrix.data;
-
-        for (s32 i = 0; i < 4; ++i)
-        {
-            for (s32 j = 0; j < 4; ++j)
-            {
-                *dst_ptr = m1_ptr[0] * m2_ptr[0 + j] + m1_ptr[1] * m2_ptr[4 + j] + m1_ptr[2] * m2_ptr[8 + j] +
-                           m1_ptr[3] * m2_ptr[12 + j];
-                dst_ptr++;
-            }
-            m1_ptr += 4;
-        }
+        mat4 out_matrix;
+        simd_mat4_mul(this->data, matrix_1.data, out_matrix.data);
         return out_matrix;
     }
     inline void operator*=(mat4 matrix_1)
     {
-        mat4 out_matrix = mat4();
-
-        const f32 *m1_ptr  = this->data;
-        const f32 *m2_ptr  = matrix_1.data;
-        f32       *dst_ptr = out_matrix.data;
-
-        for (s32 i = 0; i < 4; ++i)
-        {
-            for (s32 j = 0; j < 4; ++j)
-            {
-                *dst_ptr = m1_ptr[0] * m2_ptr[0 + j] + m1_ptr[1] * m2_ptr[4 + j] + m1_ptr[2] * m2_ptr[8 + j] +
-                           m1_ptr[3] * m2_ptr[12 + j];
-                dst_ptr++;
-            }
-            m1_ptr += 4;
-        }
-        dcopy_memory(this->data, out_matrix.data, sizeof(f32) * 16);
+        simd_mat4_mul(this->data, matrix_1.data, this->data);
     }
 };
 
+
+// object space bounds of a mesh: the box around its positions and a sphere around the box center. The sphere isnt
+// the tightest one, but it is a single pass over the vertices once the box is known.
+struct bounds_3D
+{
+    vec3 min;
+    vec3 max;
+    vec3 center;
+    f32  radius = 0;
+};
@@ -0,0 +1,448 @@
+#pragma once
+#include "defines.hpp"
+#include <cmath>
+
+// INFO: a small 4 wide float layer for the math library. The backend is picked at compile time from what the compiler
+// is allowed to emit:
+//  DSIMD_AVX    x86_64 built with -mavx or better (make simd_flags=-mavx2). Same as sse but vex encoded, fused multiply
+//               add when __FMA__ is on too, and mat4 multiplies do two rows per 8 wide op.
+//  DSIMD_SSE    every other x86_64 build, sse2 is part of the baseline there.
+//  DSIMD_NEON   arm64.
+//  DSIMD_SCALAR everything else, or when DSIMD_FORCE_SCALAR is defined.
+// The math code only uses simd_f32x4 and the simd_* functions below, a new backend only has to fill those in.
+
+#if !defined(DSIMD_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64))
+#define DSIMD_SSE 1
+#if defined(__AVX__)
+#define DSIMD_AVX 1
+#endif
+#elif !defined(DSIMD_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(__aarch64__))
+#define DSIMD_NEON 1
+#else
+#define DSIMD_SCALAR 1
+#endif
+
+#if DSIMD_AVX
+#include <immintrin.h>
+#define DSIMD_BACKEND_NAME "avx"
+#elif DSIMD_SSE
+#include <emmintrin.h>
+#define DSIMD_BACKEND_NAME "sse2"
+#elif DSIMD_NEON
+#include <arm_neon.h>
+#define DSIMD_BACKEND_NAME "neon"
+#else
+#define DSIMD_BACKEND_NAME "scalar"
+#endif
+
+#if DSIMD_SSE
+typedef __m128 simd_f32x4;
+#elif DSIMD_NEON
+typedef float32x4_t simd_f32x4;
+#else
+struct simd_f32x4
+{
+    f32 lanes[4];
+};
+#endif
+
+// per lane all ones / all zeros, what the comparisons return.
+#if DSIMD_SSE
+typedef __m128 simd_mask4;
+#elif DSIMD_NEON
+typedef uint32x4_t simd_mask4;
+#else
+struct simd_mask4
+{
+    u32 lanes[4];
+};
+#endif
+
+// p has to be 16 byte aligned.
+inline simd_f32x4 simd_load(const f32 *p)
+{
+#if DSIMD_SSE
+    return _mm_load_ps(p);
+#elif DSIMD_NEON
+    return vld1q_f32(p);
+#else
+    return {{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+inline simd_f32x4 simd_loadu(const f32 *p)
+{
+#if DSIMD_SSE
+    return _mm_loadu_ps(p);
+#elif DSIMD_NEON
+    return vld1q_f32(p);
+#else
+    return {{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+// p has to be 16 byte aligned.
+inline void simd_store(f32 *p, simd_f32x4 v)
+{
+#if DSIMD_SSE
+    _mm_store_ps(p, v);
+#elif DSIMD_NEON
+    vst1q_f32(p, v);
+#else
+    p[0] = v.lanes[0];
+    p[1] = v.lanes[1];
+    p[2] = v.lanes[2];
+    p[3] = v.lanes[3];
+#endif
+}
+
+// {p[0], p[1], 0, 0}, for vec2s. Doesnt touch anything past p[1].
+inline simd_f32x4 simd_load2(const f32 *p)
+{
+#if DSIMD_SSE
+    return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+#elif DSIMD_NEON
+    return vcombine_f32(vld1_f32(p), vdup_n_f32(0.0f));
+#else
+    return {{p[0], p[1], 0.0f, 0.0f}};
+#endif
+}
+
+inline void simd_storeu(f32 *p, simd_f32x4 v)
+{
+#if DSIMD_SSE
+    _mm_storeu_ps(p, v);
+#else
+    simd_store(p, v);
+#endif
+}
+
+inline simd_f32x4 simd_set(f32 x, f32 y, f32 z, f32 w)
+{
+#if DSIMD_SSE
+    return _mm_setr_ps(x, y, z, w);
+#elif DSIMD_NEON
+    float32x4_t v = {x, y, z, w};
+    return v;
+#else
+    return {{x, y, z, w}};
+#endif
+}
+
+inline simd_f32x4 simd_splat(f32 value)
+{
+#if DSIMD_SSE
+    return _mm_set1_ps(value);
+#elif DSIMD_NEON
+    return vdupq_n_f32(value);
+#else
+    return {{value, value, value, value}};
+#endif
+}
+
+inline f32 simd_get_x(simd_f32x4 v)
+{
+#if DSIMD_SSE
+    return _mm_cvtss_f32(v);
+#elif DSIMD_NEON
+    return vgetq_lane_f32(v, 0);
+#else
+    return v.lanes[0];
+#endif
+}
+
+#if DSIMD_SCALAR
+#define DSIMD_SCALAR_OP(a, b, op)                                                                                      \
+    {                                                                                                                  \
+        {                                                                                                              \
+            a.lanes[0] op b.lanes[0], a.lanes[1] op b.lanes[1], a.lanes[2] op b.lanes[2], a.lanes[3] op b.lanes[3]     \
+        }                                                                                                              \
+    }
+#endif
+
+inline simd_f32x4 simd_add(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_add_ps(a, b);
+#elif DSIMD_NEON
+    return vaddq_f32(a, b);
+#else
+    return DSIMD_SCALAR_OP(a, b, +);
+#endif
+}
+
+inline simd_f32x4 simd_sub(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_sub_ps(a, b);
+#elif DSIMD_NEON
+    return vsubq_f32(a, b);
+#else
+    return DSIMD_SCALAR_OP(a, b, -);
+#endif
+}
+
+inline simd_f32x4 simd_mul(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_mul_ps(a, b);
+#elif DSIMD_NEON
+    return vmulq_f32(a, b);
+#else
+    return DSIMD_SCALAR_OP(a, b, *);
+#endif
+}
+
+inline simd_f32x4 simd_div(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_div_ps(a, b);
+#elif DSIMD_NEON
+    return vdivq_f32(a, b);
+#else
+    return DSIMD_SCALAR_OP(a, b, /);
+#endif
+}
+
+// a * b + c, fused where the target has it.
+inline simd_f32x4 simd_madd(simd_f32x4 a, simd_f32x4 b, simd_f32x4 c)
+{
+#if DSIMD_SSE && defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#elif DSIMD_NEON
+    return vfmaq_f32(c, a, b);
+#else
+    return simd_add(simd_mul(a, b), c);
+#endif
+}
+
+inline simd_f32x4 simd_min(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_min_ps(a, b);
+#elif DSIMD_NEON
+    return vminq_f32(a, b);
+#else
+    return {{fminf(a.lanes[0], b.lanes[0]), fminf(a.lanes[1], b.lanes[1]), fminf(a.lanes[2], b.lanes[2]),
+             fminf(a.lanes[3], b.lanes[3])}};
+#endif
+}
+
+inline simd_f32x4 simd_max(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_max_ps(a, b);
+#elif DSIMD_NEON
+    return vmaxq_f32(a, b);
+#else
+    return {{fmaxf(a.lanes[0], b.lanes[0]), fmaxf(a.lanes[1], b.lanes[1]), fmaxf(a.lanes[2], b.lanes[2]),
+             fmaxf(a.lanes[3], b.lanes[3])}};
+#endif
+}
+
+inline simd_f32x4 simd_abs(simd_f32x4 v)
+{
+#if DSIMD_SSE
+    // clear the sign bits.
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+#elif DSIMD_NEON
+    return vabsq_f32(v);
+#else
+    return {{fabsf(v.lanes[0]), fabsf(v.lanes[1]), fabsf(v.lanes[2]), fabsf(v.lanes[3])}};
+#endif
+}
+
+// {v0[a], v0[b], v1[c], v1[d]}, the same as _mm_shuffle_ps. Pass the same vector twice to swizzle one.
+template <s32 a, s32 b, s32 c, s32 d> inline simd_f32x4 simd_shuffle(simd_f32x4 v0, simd_f32x4 v1)
+{
+#if DSIMD_SSE
+    return _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(d, c, b, a));
+#elif DSIMD_NEON
+    float32x4_t out = vdupq_n_f32(vgetq_lane_f32(v0, a));
+    out             = vsetq_lane_f32(vgetq_lane_f32(v0, b), out, 1);
+    out             = vsetq_lane_f32(vgetq_lane_f32(v1, c), out, 2);
+    out             = vsetq_lane_f32(vgetq_lane_f32(v1, d), out, 3);
+    return out;
+#else
+    return {{v0.lanes[a], v0.lanes[b], v1.lanes[c], v1.lanes[d]}};
+#endif
+}
+
+// lane i of v in all four lanes.
+template <s32 i> inline simd_f32x4 simd_lane(simd_f32x4 v)
+{
+#if DSIMD_SSE
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+#elif DSIMD_NEON
+    return vdupq_laneq_f32(v, i);
+#else
+    return {{v.lanes[i], v.lanes[i], v.lanes[i], v.lanes[i]}};
+#endif
+}
+
+// the 4 wide dot product in all four lanes.
+inline simd_f32x4 simd_dot4(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    simd_f32x4 p = _mm_mul_ps(a, b);
+    p            = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 0, 3, 2)));
+#elif DSIMD_NEON
+    return vdupq_n_f32(vaddvq_f32(vmulq_f32(a, b)));
+#else
+    f32 p = a.lanes[0] * b.lanes[0] + a.lanes[1] * b.lanes[1] + a.lanes[2] * b.lanes[2] + a.lanes[3] * b.lanes[3];
+    return {{p, p, p, p}};
+#endif
+}
+
+// 1 / sqrt(v). The hardware estimate plus newton raphson steps, within a couple of ulps of the real thing.
+inline simd_f32x4 simd_rsqrt(simd_f32x4 v)
+{
+#if DSIMD_SSE
+    // the estimate has 12 bits, one step gets to ~23.
+    simd_f32x4 e = _mm_rsqrt_ps(v);
+    simd_f32x4 h = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v), e);
+    return _mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(h, e)));
+#elif DSIMD_NEON
+    // this one only has 8 bits, so two steps.
+    float32x4_t e = vrsqrteq_f32(v);
+    e             = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+    return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+#else
+    return {{1.0f / sqrtf(v.lanes[0]), 1.0f / sqrtf(v.lanes[1]), 1.0f / sqrtf(v.lanes[2]), 1.0f / sqrtf(v.lanes[3])}};
+#endif
+}
+
+inline simd_mask4 simd_cmp_gt(simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_cmpgt_ps(a, b);
+#elif DSIMD_NEON
+    return vcgtq_f32(a, b);
+#else
+    simd_mask4 out;
+    for (s32 i = 0; i < 4; i++)
+    {
+        out.lanes[i] = a.lanes[i] > b.lanes[i] ? 0xFFFFFFFFu : 0;
+    }
+    return out;
+#endif
+}
+
+// a where mask is set, b everywhere else.
+inline simd_f32x4 simd_select(simd_mask4 mask, simd_f32x4 a, simd_f32x4 b)
+{
+#if DSIMD_SSE
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#elif DSIMD_NEON
+    return vbslq_f32(mask, a, b);
+#else
+    simd_f32x4 out;
+    for (s32 i = 0; i < 4; i++)
+    {
+        out.lanes[i] = mask.lanes[i] ? a.lanes[i] : b.lanes[i];
+    }
+    return out;
+#endif
+}
+
+// one bit per lane, lane 0 in bit 0.
+inline u32 simd_mask_bits(simd_mask4 mask)
+{
+#if DSIMD_SSE
+    return static_cast<u32>(_mm_movemask_ps(mask));
+#elif DSIMD_NEON
+    return (vgetq_lane_u32(mask, 0) & 1) | (vgetq_lane_u32(mask, 1) & 2) | (vgetq_lane_u32(mask, 2) & 4) |
+           (vgetq_lane_u32(mask, 3) & 8);
+#else
+    return (mask.lanes[0] & 1) | (mask.lanes[1] & 2) | (mask.lanes[2] & 4) | (mask.lanes[3] & 8);
+#endif
+}
+
+// rows -> columns in place.
+inline void simd_transpose(simd_f32x4 *r0, simd_f32x4 *r1, simd_f32x4 *r2, simd_f32x4 *r3)
+{
+#if DSIMD_SSE
+    _MM_TRANSPOSE4_PS(*r0, *r1, *r2, *r3);
+#elif DSIMD_NEON
+    float32x4x2_t t01 = vtrnq_f32(*r0, *r1);
+    float32x4x2_t t23 = vtrnq_f32(*r2, *r3);
+    *r0               = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    *r1               = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    *r2               = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    *r3               = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+    simd_f32x4 a = *r0, b = *r1, c = *r2, d = *r3;
+    *r0          = {{a.lanes[0], b.lanes[0], c.lanes[0], d.lanes[0]}};
+    *r1          = {{a.lanes[1], b.lanes[1], c.lanes[1], d.lanes[1]}};
+    *r2          = {{a.lanes[2], b.lanes[2], c.lanes[2], d.lanes[2]}};
+    *r3          = {{a.lanes[3], b.lanes[3], c.lanes[3], d.lanes[3]}};
+#endif
+}
+
+// out = a * b for row major 4x4 matrices (16 floats each), every row of out is a mix of b's rows weighted by a's row.
+// out may alias a or b. The mat4 operators and mat4_mul both go through here.
+inline void simd_mat4_mul(const f32 *a, const f32 *b, f32 *out)
+{
+#if DSIMD_AVX
+    // two rows of a per op, with every row of b copied into both halves.
+    __m256 b0  = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b));
+    __m256 b1  = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 4));
+    __m256 b2  = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 8));
+    __m256 b3  = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 12));
+    __m256 a01 = _mm256_loadu_ps(a);
+    __m256 a23 = _mm256_loadu_ps(a + 8);
+
+    __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+    __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+#if defined(__FMA__)
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1, r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1, r23);
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2, r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2, r23);
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3, r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3, r23);
+#else
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+#endif
+    _mm256_storeu_ps(out, r01);
+    _mm256_storeu_ps(out + 8, r23);
+#else
+    simd_f32x4 b0 = simd_loadu(b);
+    simd_f32x4 b1 = simd_loadu(b + 4);
+    simd_f32x4 b2 = simd_loadu(b + 8);
+    simd_f32x4 b3 = simd_loadu(b + 12);
+    simd_f32x4 a0 = simd_loadu(a);
+    simd_f32x4 a1 = simd_loadu(a + 4);
+    simd_f32x4 a2 = simd_loadu(a + 8);
+    simd_f32x4 a3 = simd_loadu(a + 12);
+
+    // spelled out, -O2 keeps a loop over the rows as a loop and goes through the stack.
+    simd_f32x4 r0 = simd_mul(simd_lane<0>(a0), b0);
+    simd_f32x4 r1 = simd_mul(simd_lane<0>(a1), b0);
+    simd_f32x4 r2 = simd_mul(simd_lane<0>(a2), b0);
+    simd_f32x4 r3 = simd_mul(simd_lane<0>(a3), b0);
+    r0            = simd_madd(simd_lane<1>(a0), b1, r0);
+    r1            = simd_madd(simd_lane<1>(a1), b1, r1);
+    r2            = simd_madd(simd_lane<1>(a2), b1, r2);
+    r3            = simd_madd(simd_lane<1>(a3), b1, r3);
+    r0            = simd_madd(simd_lane<2>(a0), b2, r0);
+    r1            = simd_madd(simd_lane<2>(a1), b2, r1);
+    r2            = simd_madd(simd_lane<2>(a2), b2, r2);
+    r3            = simd_madd(simd_lane<2>(a3), b2, r3);
+    r0            = simd_madd(simd_lane<3>(a0), b3, r0);
+    r1            = simd_madd(simd_lane<3>(a1), b3, r1);
+    r2            = simd_madd(simd_lane<3>(a2), b3, r2);
+    r3            = simd_madd(simd_lane<3>(a3), b3, r3);
+
+    simd_storeu(out, r0);
+    simd_storeu(out + 4, r1);
+    simd_storeu(out + 8, r2);
+    simd_storeu(out + 12, r3);
+#endif
+}
@@ -0,0 +1,407 @@
+#include "dvertex_batch.hpp"
+#include "core/dasserts.hpp"
+#include "math/dmath.hpp"
+#include "math/dsimd.hpp"
+
+// the rows of a matrix, every float in its own register: row r column c is m[r * 3 + c]. Only the upper 3x4 is used,
+// the last row is the translation.
+struct vertex_batch_matrix
+{
+    simd_f32x4 m[12];
+};
+
+static vertex_batch_matrix vertex_batch_splat(const mat4 *matrix)
+{
+    vertex_batch_matrix out;
+    for (u32 row = 0; row < 4; row++)
+    {
+        for (u32 column = 0; column < 3; column++)
+        {
+            out.m[row * 3 + column] = simd_splat(matrix->data[row * 4 + column]);
+        }
+    }
+    return out;
+}
+
+// row vectors, x * row0 + y * row1 + z * row2, plus row3 for points.
+static inline void vertex_batch_mul_vector(const vertex_batch_matrix *b, simd_f32x4 *x, simd_f32x4 *y, simd_f32x4 *z)
+{
+    simd_f32x4 ox = simd_madd(*z, b->m[6], simd_madd(*y, b->m[3], simd_mul(*x, b->m[0])));
+    simd_f32x4 oy = simd_madd(*z, b->m[7], simd_madd(*y, b->m[4], simd_mul(*x, b->m[1])));
+    simd_f32x4 oz = simd_madd(*z, b->m[8], simd_madd(*y, b->m[5], simd_mul(*x, b->m[2])));
+    *x            = ox;
+    *y            = oy;
+    *z            = oz;
+}
+
+static inline void vertex_batch_mul_point(const vertex_batch_matrix *b, simd_f32x4 *x, simd_f32x4 *y, simd_f32x4 *z)
+{
+    simd_f32x4 ox = simd_madd(*z, b->m[6], simd_madd(*y, b->m[3], simd_madd(*x, b->m[0], b->m[9])));
+    simd_f32x4 oy = simd_madd(*z, b->m[7], simd_madd(*y, b->m[4], simd_madd(*x, b->m[1], b->m[10])));
+    simd_f32x4 oz = simd_madd(*z, b->m[8], simd_madd(*y, b->m[5], simd_madd(*x, b->m[2], b->m[11])));
+    *x            = ox;
+    *y            = oy;
+    *z            = oz;
+}
+
+// zero length stays zero instead of turning into nans, obj files without normals give zero ones.
+static inline void vertex_batch_normalize(simd_f32x4 *x, simd_f32x4 *y, simd_f32x4 *z)
+{
+    simd_f32x4 length_squared = simd_madd(*z, *z, simd_madd(*y, *y, simd_mul(*x, *x)));
+    simd_f32x4 zero           = simd_splat(0.0f);
+    simd_f32x4 scale = simd_select(simd_cmp_gt(length_squared, zero), simd_rsqrt(length_squared), simd_splat(1.0f));
+    *x               = simd_mul(*x, scale);
+    *y               = simd_mul(*y, scale);
+    *z               = simd_mul(*z, scale);
+}
+
+// 4 floats at the same spot in 4 vertices in, one register per float out. And back.
+static inline void vertex_batch_gather(const f32 *p0, const f32 *p1, const f32 *p2, const f32 *p3, simd_f32x4 *x,
+                                       simd_f32x4 *y, simd_f32x4 *z, simd_f32x4 *w)
+{
+    *x = simd_loadu(p0);
+    *y = simd_loadu(p1);
+    *z = simd_loadu(p2);
+    *w = simd_loadu(p3);
+    simd_transpose(x, y, z, w);
+}
+
+static inline void vertex_batch_scatter(f32 *p0, f32 *p1, f32 *p2, f32 *p3, simd_f32x4 x, simd_f32x4 y, simd_f32x4 z,
+                                        simd_f32x4 w)
+{
+    simd_transpose(&x, &y, &z, &w);
+    simd_storeu(p0, x);
+    simd_storeu(p1, y);
+    simd_storeu(p2, z);
+    simd_storeu(p3, w);
+}
+
+void vertex_batch_scale_translate_3D(vertex_3D *vertices, u32 count, vec3 scale, vec3 translation)
+{
+    DASSERT(vertices || !count);
+    // the 4th lane is normal.x, * 1 + 0 leaves it alone.
+    simd_f32x4 s = simd_set(scale.x, scale.y, scale.z, 1.0f);
+    simd_f32x4 t = simd_set(translation.x, translation.y, translation.z, 0.0f);
+    for (u32 i = 0; i < count; i++)
+    {
+        f32 *position = vertices[i].position.elements;
+        simd_storeu(position, simd_madd(simd_loadu(position), s, t));
+    }
+}
+
+void vertex_batch_scale_translate_2D(vertex_2D *vertices, u32 count, vec2 scale, vec2 translation)
+{
+    DASSERT(vertices || !count);
+    // position and tex coord are next to each other, the tex coord gets * 1 + 0.
+    simd_f32x4 s = simd_set(scale.x, scale.y, 1.0f, 1.0f);
+    simd_f32x4 t = simd_set(translation.x, translation.y, 0.0f, 0.0f);
+    for (u32 i = 0; i < count; i++)
+    {
+        f32 *position = vertices[i].position.elements;
+        simd_storeu(position, simd_madd(simd_loadu(position), s, t));
+    }
+}
+
+static f32 vertex_batch_handedness(const mat4 *matrix)
+{
+    const f32 *m   = matrix->data;
+    f32        det = m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) +
+              m[2] * (m[4] * m[9] - m[5] * m[8]);
+    return det < 0.0f ? -1.0f : 1.0f;
+}
+
+void vertex_batch_transform_3D(vertex_3D *vertices, u32 count, mat4 matrix)
+{
+    DASSERT(vertices || !count);
+    if (!count)
+    {
+        return;
+    }
+
+    vertex_batch_matrix point_matrix  = vertex_batch_splat(&matrix);
+    mat4                normal        = mat4_transposed(mat4_inverse(matrix));
+    vertex_batch_matrix normal_matrix = vertex_batch_splat(&normal);
+    simd_f32x4          handedness    = simd_splat(vertex_batch_handedness(&matrix));
+
+    for (u32 first = 0; first < count; first += 4)
+    {
+        vertex_3D *v[4];
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            v[lane] = vertices + (first + lane < count ? first + lane : count - 1);
+        }
+        // everything is loaded before anything is stored, a 16 byte store followed by a load that half overlaps it
+        // (position.xyz + normal.x, then normal) cant be forwarded and stalls.
+        simd_f32x4 px, py, pz, pw, nx, ny, nz, nw, tx, ty, tz, tw;
+        // positions, w is normal.x.
+        vertex_batch_gather(v[0]->position.elements, v[1]->position.elements, v[2]->position.elements,
+                            v[3]->position.elements, &px, &py, &pz, &pw);
+        // normals, w is tex_coord.u.
+        vertex_batch_gather(v[0]->normal.elements, v[1]->normal.elements, v[2]->normal.elements,
+                            v[3]->normal.elements, &nx, &ny, &nz, &nw);
+        // tangents, w is the handedness.
+        vertex_batch_gather(v[0]->tangent.elements, v[1]->tangent.elements, v[2]->tangent.elements,
+                            v[3]->tangent.elements, &tx, &ty, &tz, &tw);
+
+        vertex_batch_mul_point(&point_matrix, &px, &py, &pz);
+        vertex_batch_mul_vector(&normal_matrix, &nx, &ny, &nz);
+        vertex_batch_normalize(&nx, &ny, &nz);
+        vertex_batch_mul_vector(&point_matrix, &tx, &ty, &tz);
+        vertex_batch_normalize(&tx, &ty, &tz);
+
+        // the position store puts the old normal.x back, the normal store after it writes the new one.
+        vertex_batch_scatter(v[0]->position.elements, v[1]->position.elements, v[2]->position.elements,
+                             v[3]->position.elements, px, py, pz, pw);
+        vertex_batch_scatter(v[0]->normal.elements, v[1]->normal.elements, v[2]->normal.elements,
+                             v[3]->normal.elements, nx, ny, nz, nw);
+        vertex_batch_scatter(v[0]->tangent.elements, v[1]->tangent.elements, v[2]->tangent.elements,
+                             v[3]->tangent.elements, tx, ty, tz, simd_mul(tw, handedness));
+    }
+}
+
+// corner c of 4 triangles, the 4th float of a position is normal.x. The tex coords are loaded on their own, a 16 byte
+// load would take tangent.xy along, which an earlier triangle may have just stored (that stalls).
+static inline void vertex_batch_gather_corner(vertex_3D *vertices, const u32 *const *triangle, u32 c, simd_f32x4 *px,
+                                              simd_f32x4 *py, simd_f32x4 *pz, simd_f32x4 *u, simd_f32x4 *v)
+{
+    vertex_3D *v0 = vertices + triangle[0][c];
+    vertex_3D *v1 = vertices + triangle[1][c];
+    vertex_3D *v2 = vertices + triangle[2][c];
+    vertex_3D *v3 = vertices + triangle[3][c];
+    simd_f32x4 unused_z, unused_w;
+    vertex_batch_gather(v0->position.elements, v1->position.elements, v2->position.elements, v3->position.elements, px,
+                        py, pz, &unused_w);
+    *u       = simd_load2(v0->tex_coord.elements);
+    *v       = simd_load2(v1->tex_coord.elements);
+    unused_z = simd_load2(v2->tex_coord.elements);
+    unused_w = simd_load2(v3->tex_coord.elements);
+    simd_transpose(u, v, &unused_z, &unused_w);
+}
+
+void vertex_batch_calculate_tangents(vertex_3D *vertices, const u32 *indices, u32 index_count)
+{
+    DASSERT(vertices && indices);
+    DASSERT(index_count % 3 == 0);
+
+    u32 triangle_count = index_count / 3;
+    for (u32 first = 0; first < triangle_count; first += 4)
+    {
+        const u32 *triangle[4];
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            triangle[lane] = indices + (first + lane < triangle_count ? first + lane : triangle_count - 1) * 3;
+        }
+
+        simd_f32x4 px0, py0, pz0, u0, v0;
+        simd_f32x4 px1, py1, pz1, u1, v1;
+        simd_f32x4 px2, py2, pz2, u2, v2;
+        vertex_batch_gather_corner(vertices, triangle, 0, &px0, &py0, &pz0, &u0, &v0);
+        vertex_batch_gather_corner(vertices, triangle, 1, &px1, &py1, &pz1, &u1, &v1);
+        vertex_batch_gather_corner(vertices, triangle, 2, &px2, &py2, &pz2, &u2, &v2);
+
+        simd_f32x4 edge1_x = simd_sub(px1, px0);
+        simd_f32x4 edge1_y = simd_sub(py1, py0);
+        simd_f32x4 edge1_z = simd_sub(pz1, pz0);
+        simd_f32x4 edge2_x = simd_sub(px2, px0);
+        simd_f32x4 edge2_y = simd_sub(py2, py0);
+        simd_f32x4 edge2_z = simd_sub(pz2, pz0);
+
+        simd_f32x4 delta_u1 = simd_sub(u1, u0);
+        simd_f32x4 delta_v1 = simd_sub(v1, v0);
+        simd_f32x4 delta_u2 = simd_sub(u2, u0);
+        simd_f32x4 delta_v2 = simd_sub(v2, v0);
+
+        simd_f32x4 dividend = simd_sub(simd_mul(delta_u1, delta_v2), simd_mul(delta_u2, delta_v1));
+        simd_f32x4 fc       = simd_div(simd_splat(1.0f), dividend);
+
+        simd_f32x4 tx = simd_mul(fc, simd_sub(simd_mul(delta_v2, edge1_x), simd_mul(delta_v1, edge2_x)));
+        simd_f32x4 ty = simd_mul(fc, simd_sub(simd_mul(delta_v2, edge1_y), simd_mul(delta_v1, edge2_y)));
+        simd_f32x4 tz = simd_mul(fc, simd_sub(simd_mul(delta_v2, edge1_z), simd_mul(delta_v1, edge2_z)));
+
+        // same as the scalar one, no zero check, a triangle with degenerate tex coords gets what it gets.
+        simd_f32x4 scale = simd_rsqrt(simd_madd(tz, tz, simd_madd(ty, ty, simd_mul(tx, tx))));
+        tx               = simd_mul(tx, scale);
+        ty               = simd_mul(ty, scale);
+        tz               = simd_mul(tz, scale);
+
+        // (v1 * u2 - v2 * u1) < 0 is dividend > 0.
+        simd_f32x4 handedness =
+            simd_select(simd_cmp_gt(dividend, simd_splat(0.0f)), simd_splat(-1.0f), simd_splat(1.0f));
+
+        // one row per triangle, stored in triangle order so shared vertices end up like they would one by one.
+        simd_transpose(&tx, &ty, &tz, &handedness);
+        simd_f32x4 rows[4] = {tx, ty, tz, handedness};
+        u32        valid   = triangle_count - first < 4 ? triangle_count - first : 4;
+        for (u32 lane = 0; lane < valid; lane++)
+        {
+            simd_storeu(vertices[triangle[lane][0]].tangent.elements, rows[lane]);
+            simd_storeu(vertices[triangle[lane][1]].tangent.elements, rows[lane]);
+            simd_storeu(vertices[triangle[lane][2]].tangent.elements, rows[lane]);
+        }
+    }
+}
+
+// the biggest of the 4 lanes in all of them.
+static inline simd_f32x4 vertex_batch_horizontal_max(simd_f32x4 v)
+{
+    v = simd_max(v, simd_shuffle<2, 3, 0, 1>(v, v));
+    return simd_max(v, simd_shuffle<1, 0, 3, 2>(v, v));
+}
+
+bounds_3D vertex_batch_bounds_3D(const vertex_3D *vertices, u32 count)
+{
+    DASSERT(vertices || !count);
+    bounds_3D out_bounds;
+    if (!count)
+    {
+        return out_bounds;
+    }
+
+    // the box, one vertex per op. The 4th lane is normal.x and gets ignored.
+    simd_f32x4 min = simd_loadu(vertices[0].position.elements);
+    simd_f32x4 max = min;
+    for (u32 i = 1; i < count; i++)
+    {
+        simd_f32x4 position = simd_loadu(vertices[i].position.elements);
+        min                 = simd_min(min, position);
+        max                 = simd_max(max, position);
+    }
+    alignas(16) f32 lanes[4];
+    simd_store(lanes, min);
+    out_bounds.min = vec3(lanes[0], lanes[1], lanes[2]);
+    simd_store(lanes, max);
+    out_bounds.max    = vec3(lanes[0], lanes[1], lanes[2]);
+    out_bounds.center = vec3((out_bounds.min.x + out_bounds.max.x) * 0.5f, (out_bounds.min.y + out_bounds.max.y) * 0.5f,
+                             (out_bounds.min.z + out_bounds.max.z) * 0.5f);
+
+    // the sphere, squared distances to the center 4 vertices at a time.
+    simd_f32x4 cx               = simd_splat(out_bounds.center.x);
+    simd_f32x4 cy               = simd_splat(out_bounds.center.y);
+    simd_f32x4 cz               = simd_splat(out_bounds.center.z);
+    simd_f32x4 distance_squared = simd_splat(0.0f);
+    for (u32 first = 0; first < count; first += 4)
+    {
+        const vertex_3D *v[4];
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            v[lane] = vertices + (first + lane < count ? first + lane : count - 1);
+        }
+        simd_f32x4 px, py, pz, unused_w;
+        vertex_batch_gather(v[0]->position.elements, v[1]->position.elements, v[2]->position.elements,
+                            v[3]->position.elements, &px, &py, &pz, &unused_w);
+        px               = simd_sub(px, cx);
+        py               = simd_sub(py, cy);
+        pz               = simd_sub(pz, cz);
+        distance_squared = simd_max(distance_squared, simd_madd(pz, pz, simd_madd(py, py, simd_mul(px, px))));
+    }
+    out_bounds.radius = sqrtf(simd_get_x(vertex_batch_horizontal_max(distance_squared)));
+    return out_bounds;
+}
+
+void vertex_batch_scale_translate_3D_scalar(vertex_3D *vertices, u32 count, vec3 scale, vec3 translation)
+{
+    for (u32 i = 0; i < count; i++)
+    {
+        vertices[i].position.x = vertices[i].position.x * scale.x + translation.x;
+        vertices[i].position.y = vertices[i].position.y * scale.y + translation.y;
+        vertices[i].position.z = vertices[i].position.z * scale.z + translation.z;
+    }
+}
+
+void vertex_batch_scale_translate_2D_scalar(vertex_2D *vertices, u32 count, vec2 scale, vec2 translation)
+{
+    for (u32 i = 0; i < count; i++)
+    {
+        vertices[i].position.x = vertices[i].position.x * scale.x + translation.x;
+        vertices[i].position.y = vertices[i].position.y * scale.y + translation.y;
+    }
+}
+
+static vec3 vertex_batch_normalized_or_zero(vec3 a)
+{
+    f32 length_squared = a.x * a.x + a.y * a.y + a.z * a.z;
+    return length_squared > 0.0f ? vec3_normalized_scalar(a) : a;
+}
+
+void vertex_batch_transform_3D_scalar(vertex_3D *vertices, u32 count, mat4 matrix)
+{
+    mat4 normal     = mat4_transposed_scalar(mat4_inverse_scalar(matrix));
+    f32  handedness = vertex_batch_handedness(&matrix);
+    for (u32 i = 0; i < count; i++)
+    {
+        vertex_3D *v = vertices + i;
+        v->position  = mat4_transform_point_scalar(matrix, v->position);
+        v->normal    = vertex_batch_normalized_or_zero(mat4_transform_vector_scalar(normal, v->normal));
+
+        vec3 tangent = vertex_batch_normalized_or_zero(
+            mat4_transform_vector_scalar(matrix, vec3(v->tangent.x, v->tangent.y, v->tangent.z)));
+        v->tangent   = vec4(tangent.x, tangent.y, tangent.z, v->tangent.w * handedness);
+    }
+}
+
+void vertex_batch_calculate_tangents_scalar(vertex_3D *vertices, const u32 *indices, u32 index_count)
+{
+    for (u32 i = 0; i < index_count; i += 3)
+    {
+        u32 i0 = indices[i + 0];
+        u32 i1 = indices[i + 1];
+        u32 i2 = indices[i + 2];
+
+        vec3 edge1 = vertices[i1].position - vertices[i0].position;
+        vec3 edge2 = vertices[i2].position - vertices[i0].position;
+
+        f32 deltaU1 = vertices[i1].tex_coord.x - vertices[i0].tex_coord.x;
+        f32 deltaV1 = vertices[i1].tex_coord.y - vertices[i0].tex_coord.y;
+
+        f32 deltaU2 = vertices[i2].tex_coord.x - vertices[i0].tex_coord.x;
+        f32 deltaV2 = vertices[i2].tex_coord.y - vertices[i0].tex_coord.y;
+
+        f32 dividend = (deltaU1 * deltaV2 - deltaU2 * deltaV1);
+        f32 fc       = 1.0f / dividend;
+
+        vec3 tangent =
+            (vec3){(fc * (deltaV2 * edge1.x - deltaV1 * edge2.x)), (fc * (deltaV2 * edge1.y - deltaV1 * edge2.y)),
+                   (fc * (deltaV2 * edge1.z - deltaV1 * edge2.z))};
+
+        tangent = vec3_normalized_scalar(tangent);
+
+        f32 sx = deltaU1, sy = deltaU2;
+        f32 tx = deltaV1, ty = deltaV2;
+        f32 handedness = ((tx * sy - ty * sx) < 0.0f) ? -1.0f : 1.0f;
+
+        vec4 t4 = {tangent.x, tangent.y, tangent.z, handedness};
+
+        vertices[i0].tangent = t4;
+        vertices[i1].tangent = t4;
+        vertices[i2].tangent = t4;
+    }
+}
+
+bounds_3D vertex_batch_bounds_3D_scalar(const vertex_3D *vertices, u32 count)
+{
+    bounds_3D out_bounds;
+    if (!count)
+    {
+        return out_bounds;
+    }
+    out_bounds.min = vertices[0].position;
+    out_bounds.max = vertices[0].position;
+    for (u32 i = 1; i < count; i++)
+    {
+        for (u32 j = 0; j < 3; j++)
+        {
+            out_bounds.min.elements[j] = fminf(out_bounds.min.elements[j], vertices[i].position.elements[j]);
+            out_bounds.max.elements[j] = fmaxf(out_bounds.max.elements[j], vertices[i].position.elements[j]);
+        }
+    }
+    out_bounds.center = (out_bounds.min + out_bounds.max) * 0.5f;
+
+    f32 distance_squared = 0;
+    for (u32 i = 0; i < count; i++)
+    {
+        vec3 d           = vertices[i].position - out_bounds.center;
+        distance_squared = fmaxf(distance_squared, vec3_dot(d, d));
+    }
+    out_bounds.radius = sqrtf(distance_squared);
+    return out_bounds;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "defines.hpp"
+#include "main.hpp"
+#include "math/dmath_types.hpp"
+
+// INFO: batch kernels over vertex arrays, for the geometry import path and anything else that bakes transforms into
+// vertices on the cpu. The 3D transform and the tangents work on 4 vertices at a time: 4 floats of each vertex
+// (position, normal, tangent, tex coords) are loaded straight out of the array and transposed into x/y/z/w registers,
+// the math runs on 4 vertices per op and the results get transposed back. The float that comes along with a vec3 is
+// the next field of the vertex, it rides through untouched so the 16 byte stores dont clobber anything. A short last
+// group fills the unused lanes with copies of the last vertex.
+//
+// The *_scalar versions are the one vertex at a time reference, the "vertex_batch" bench group checks against them.
+
+// positions * scale + translation. Normals and tangents are left alone, so this is for uniform scales.
+void vertex_batch_scale_translate_3D(vertex_3D *vertices, u32 count, vec3 scale, vec3 translation);
+void vertex_batch_scale_translate_2D(vertex_2D *vertices, u32 count, vec2 scale, vec2 translation);
+
+// positions as points, normals by the inverse transpose and tangents as directions, both renormalized (zero length
+// ones stay zero). A mirroring matrix flips tangent.w so the bitangent still points the right way.
+void vertex_batch_transform_3D(vertex_3D *vertices, u32 count, mat4 matrix);
+
+// a tangent per triangle from its positions and tex coords, written to all 3 corners. Shared vertices end up with the
+// tangent of the last triangle that uses them.
+void vertex_batch_calculate_tangents(vertex_3D *vertices, const u32 *indices, u32 index_count);
+
+// box and sphere around the positions. All zero for no vertices.
+bounds_3D vertex_batch_bounds_3D(const vertex_3D *vertices, u32 count);
+
+void vertex_batch_scale_translate_3D_scalar(vertex_3D *vertices, u32 count, vec3 scale, vec3 translation);
+void vertex_batch_scale_translate_2D_scalar(vertex_2D *vertices, u32 count, vec2 scale, vec2 translation);
+void vertex_batch_transform_3D_scalar(vertex_3D *vertices, u32 count, mat4 matrix);
+void vertex_batch_calculate_tangents_scalar(vertex_3D *vertices, const u32 *indices, u32 index_count);
+bounds_3D vertex_batch_bounds_3D_scalar(const vertex_3D *vertices, u32 count);
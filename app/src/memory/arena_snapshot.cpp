@@ -0,0 +1,267 @@
+#include "arena_snapshot.hpp"
+#include "core/dasserts.hpp"
+#include "core/dfile_system.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "core/logger.hpp"
+#include "platform/platform.hpp"
+
+struct arena_snapshot_state
+{
+    char file_path[ARENA_SNAPSHOT_KEY_LENGTH];
+
+    // loaded snapshot
+    const u8                    *mapped;
+    u64                          mapped_size;
+    const arena_snapshot_header *mapped_header;
+    const arena_snapshot_entry  *mapped_entries;
+    // a lookup missed, the file doesnt cover everything the app loads anymore.
+    bool                         stale;
+
+    // snapshot that is being recorded. The header and the entry table are the first allocations in the arena so offsets
+    // from start_ptr are the file offsets.
+    arena                 *recording;
+    arena_snapshot_header *header;
+    arena_snapshot_entry  *entries;
+    bool                   dirty;
+};
+
+static arena_snapshot_state  snapshot_state_data;
+static arena_snapshot_state *snapshot_state_ptr = nullptr;
+
+static bool arena_snapshot_validate(const u8 *data, u64 size)
+{
+    if (size < sizeof(arena_snapshot_header))
+    {
+        return false;
+    }
+    const arena_snapshot_header *header = reinterpret_cast<const arena_snapshot_header *>(data);
+    if (header->magic != ARENA_SNAPSHOT_MAGIC || header->version != ARENA_SNAPSHOT_VERSION)
+    {
+        return false;
+    }
+    if (header->total_size != size || header->entry_count > ARENA_SNAPSHOT_MAX_ENTRIES)
+    {
+        return false;
+    }
+    u64 entries_end = header->entries_offset + (sizeof(arena_snapshot_entry) * ARENA_SNAPSHOT_MAX_ENTRIES);
+    if (entries_end > size)
+    {
+        return false;
+    }
+    const arena_snapshot_entry *entries = reinterpret_cast<const arena_snapshot_entry *>(data + header->entries_offset);
+    for (u32 i = 0; i < header->entry_count; i++)
+    {
+        if (entries[i].offset < entries_end || entries[i].offset + entries[i].size > size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void arena_snapshot_begin_recording()
+{
+    arena_snapshot_state *state = snapshot_state_ptr;
+
+    state->recording = arena_get_arena();
+    state->header    = static_cast<arena_snapshot_header *>(
+        arena_allocate_block(state->recording, sizeof(arena_snapshot_header)));
+    state->entries   = static_cast<arena_snapshot_entry *>(
+        arena_allocate_block(state->recording, sizeof(arena_snapshot_entry) * ARENA_SNAPSHOT_MAX_ENTRIES));
+
+    state->header->magic          = ARENA_SNAPSHOT_MAGIC;
+    state->header->version        = ARENA_SNAPSHOT_VERSION;
+    state->header->entry_count    = 0;
+    state->header->total_size     = 0;
+    state->header->entries_offset =
+        reinterpret_cast<u8 *>(state->entries) - static_cast<u8 *>(state->recording->start_ptr);
+    state->dirty = false;
+}
+
+bool arena_snapshot_open(const char *file_path)
+{
+    DASSERT(file_path);
+    DASSERT_MSG(!snapshot_state_ptr, "arena_snapshot_open called twice");
+
+    snapshot_state_ptr          = &snapshot_state_data;
+    arena_snapshot_state *state = snapshot_state_ptr;
+    *state                      = {};
+    DASSERT(string_length(file_path) < ARENA_SNAPSHOT_KEY_LENGTH);
+    string_copy(state->file_path, file_path, 0);
+
+    u64       size = 0;
+    const u8 *data = static_cast<const u8 *>(platform_map_file(file_path, &size));
+    if (data && arena_snapshot_validate(data, size))
+    {
+        state->mapped         = data;
+        state->mapped_size    = size;
+        state->mapped_header  = reinterpret_cast<const arena_snapshot_header *>(data);
+        state->mapped_entries =
+            reinterpret_cast<const arena_snapshot_entry *>(data + state->mapped_header->entries_offset);
+        DDEBUG("Loaded resource snapshot %s: %d entries, %lld bytes.", file_path, state->mapped_header->entry_count,
+              size);
+        return true;
+    }
+
+    if (data)
+    {
+        DWARN("Resource snapshot %s is invalid or from an older version, recording a new one.", file_path);
+        platform_unmap_file(data, size);
+    }
+    arena_snapshot_begin_recording();
+    return false;
+}
+
+void arena_snapshot_close()
+{
+    arena_snapshot_state *state = snapshot_state_ptr;
+    if (!state)
+    {
+        return;
+    }
+
+    if (state->mapped)
+    {
+        platform_unmap_file(state->mapped, state->mapped_size);
+        if (state->stale)
+        {
+            DINFO("Resource snapshot %s is stale, deleting it. The next launch will record a new one.",
+                  state->file_path);
+            file_delete(state->file_path);
+        }
+    }
+    if (state->recording)
+    {
+        if (state->dirty)
+        {
+            arena_snapshot_write();
+        }
+        arena_free_arena(state->recording);
+    }
+    snapshot_state_ptr = nullptr;
+}
+
+bool arena_snapshot_is_loaded()
+{
+    return snapshot_state_ptr && snapshot_state_ptr->mapped;
+}
+
+bool arena_snapshot_write()
+{
+    arena_snapshot_state *state = snapshot_state_ptr;
+    if (!state || !state->recording)
+    {
+        return false;
+    }
+
+    u64 used = static_cast<u8 *>(state->recording->free_ptr) - static_cast<u8 *>(state->recording->start_ptr);
+    state->header->total_size = used;
+
+    std::fstream file;
+    if (!file_open(state->file_path, &file, true, true))
+    {
+        DERROR("Couldnt open %s to write the resource snapshot.", state->file_path);
+        return false;
+    }
+    file_write(&file, static_cast<const char *>(state->recording->start_ptr), used);
+    file_close(&file);
+
+    state->dirty = false;
+    DDEBUG("Wrote resource snapshot %s: %d entries, %lld bytes.", state->file_path, state->header->entry_count, used);
+    return true;
+}
+
+arena_snapshot_source arena_snapshot_source_of(const char *file_path)
+{
+    arena_snapshot_source source;
+    platform_get_file_stamp(file_path, &source.size, &source.modified_time);
+    return source;
+}
+
+bool arena_snapshot_is_recording()
+{
+    return snapshot_state_ptr && snapshot_state_ptr->recording;
+}
+
+const void *arena_snapshot_find(arena_snapshot_entry_type type, const char *key, arena_snapshot_source source,
+                                u32 out_params[4], u64 *out_size)
+{
+    DASSERT(key);
+    arena_snapshot_state *state = snapshot_state_ptr;
+    if (!state || !state->mapped)
+    {
+        return nullptr;
+    }
+
+    // INFO: linear scan, there are a few hundred entries at most and every hit saves a full image decode.
+    const arena_snapshot_entry *entries = state->mapped_entries;
+    for (u32 i = 0; i < state->mapped_header->entry_count; i++)
+    {
+        if (entries[i].type != type || !string_compare(entries[i].key, key))
+        {
+            continue;
+        }
+        if (entries[i].source.size != source.size || entries[i].source.modified_time != source.modified_time)
+        {
+            break;
+        }
+        if (out_params)
+        {
+            for (u32 j = 0; j < 4; j++)
+            {
+                out_params[j] = entries[i].params[j];
+            }
+        }
+        if (out_size)
+        {
+            *out_size = entries[i].size;
+        }
+        return state->mapped + entries[i].offset;
+    }
+
+    state->stale = true;
+    return nullptr;
+}
+
+void arena_snapshot_add(arena_snapshot_entry_type type, const char *key, arena_snapshot_source source,
+                        const u32 params[4], const void *data, u64 size)
+{
+    DASSERT(key);
+    DASSERT(data);
+    arena_snapshot_state *state = snapshot_state_ptr;
+    if (!state || !state->recording)
+    {
+        return;
+    }
+    if (state->header->entry_count >= ARENA_SNAPSHOT_MAX_ENTRIES)
+    {
+        DWARN("Resource snapshot is full (%d entries), %s will not be in it.", ARENA_SNAPSHOT_MAX_ENTRIES, key);
+        return;
+    }
+    if (string_length(key) >= ARENA_SNAPSHOT_KEY_LENGTH)
+    {
+        DWARN("Resource snapshot key %s is too long, skipping it.", key);
+        return;
+    }
+
+    // pad so the blob starts on ARENA_SNAPSHOT_BLOB_ALIGNMENT, the arena only guarantees its default alignment.
+    u8       *block      = static_cast<u8 *>(arena_allocate_block(state->recording, size + ARENA_SNAPSHOT_BLOB_ALIGNMENT));
+    uintptr_t block_addr = reinterpret_cast<uintptr_t>(block);
+    u8       *dest       = reinterpret_cast<u8 *>((block_addr + ARENA_SNAPSHOT_BLOB_ALIGNMENT - 1) &
+                                        ~(static_cast<uintptr_t>(ARENA_SNAPSHOT_BLOB_ALIGNMENT) - 1));
+    dcopy_memory(dest, data, size);
+
+    arena_snapshot_entry *entry = &state->entries[state->header->entry_count++];
+    u32                   key_length = string_copy(entry->key, key, 0);
+    entry->key[key_length]           = '\0';
+    entry->type        = type;
+    entry->source      = source;
+    entry->offset      = dest - static_cast<u8 *>(state->recording->start_ptr);
+    entry->size        = size;
+    for (u32 i = 0; i < 4; i++)
+    {
+        entry->params[i] = params ? params[i] : 0;
+    }
+    state->dirty = true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "defines.hpp"
+#include "memory/arenas.hpp"
+
+#define ARENA_SNAPSHOT_MAGIC 0x50414E53414E5241ull // "ARNASNAP"
+#define ARENA_SNAPSHOT_VERSION 2
+#define ARENA_SNAPSHOT_MAX_ENTRIES 512
+#define ARENA_SNAPSHOT_KEY_LENGTH 256
+#define ARENA_SNAPSHOT_BLOB_ALIGNMENT 16
+
+// INFO: the snapshot is the decoded cpu side of the resources written out as one arena image: texture pixels, the
+// geometry configs of an obj and the material configs of an mtl. Everything inside it is addressed by offsets from the
+// start of the arena, so the file can be mapped anywhere and used as is without parsing or fixing up pointers. GPU
+// handles are not in here, those cant survive a restart anyway, the resource systems refill their tables from the
+// snapshot data instead of decoding the source files again. The blob layout of an entry belongs to the system that
+// records it. The small .conf files (shaders, the default material, textures) are still read every time.
+//
+// File layout: | header | entries[ARENA_SNAPSHOT_MAX_ENTRIES] | blobs... |
+enum arena_snapshot_entry_type : u32
+{
+    SNAPSHOT_ENTRY_UNKNOWN        = 0,
+    SNAPSHOT_ENTRY_TEXTURE_PIXELS = 1,
+    SNAPSHOT_ENTRY_GEOMETRY       = 2,
+    SNAPSHOT_ENTRY_MATERIALS      = 3,
+};
+
+// the file an entry was made from. Both have to match, an edited asset of the same size still has a new write time.
+struct arena_snapshot_source
+{
+    u64 size          = 0;
+    u64 modified_time = 0;
+};
+
+struct arena_snapshot_header
+{
+    u64 magic;
+    u32 version;
+    u32 entry_count;
+    u64 total_size;
+    u64 entries_offset;
+};
+
+struct arena_snapshot_entry
+{
+    char                      key[ARENA_SNAPSHOT_KEY_LENGTH];
+    arena_snapshot_entry_type type;
+    // type specific, for textures it is width, height, channels.
+    u32                       params[4];
+    // the source file when the entry was recorded. A mismatch means the asset changed and the entry is stale.
+    arena_snapshot_source     source;
+    u64                       offset;
+    u64                       size;
+};
+
+// Maps the snapshot at file_path if there is a valid one, otherwise starts recording a new one. Returns true if a
+// snapshot was loaded.
+bool arena_snapshot_open(const char *file_path);
+// Writes the recording out if anything was added, deletes the file if it turned out to be stale and unmaps it.
+void arena_snapshot_close();
+bool arena_snapshot_is_loaded();
+
+// writes everything recorded so far, can be called more than once.
+bool arena_snapshot_write();
+
+// zeroes if the file doesnt exist.
+arena_snapshot_source arena_snapshot_source_of(const char *file_path);
+
+// returns a pointer into the mapped file, nullptr if the snapshot doesnt have the entry or it is stale. A miss on a
+// loaded snapshot marks it stale so that the next launch records a fresh one.
+const void *arena_snapshot_find(arena_snapshot_entry_type type, const char *key, arena_snapshot_source source,
+                                u32 out_params[4], u64 *out_size);
+// copies data into the recording arena. Does nothing if we are not recording.
+void        arena_snapshot_add(arena_snapshot_entry_type type, const char *key, arena_snapshot_source source,
+                               const u32 params[4], const void *data, u64 size);
+// true if arena_snapshot_add would keep the entry, lets the caller skip putting the blob together.
+bool        arena_snapshot_is_recording();
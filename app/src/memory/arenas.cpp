@@ -1,11 +1,22 @@
 #include "arenas.hpp"
 #include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
 #include "core/logger.hpp"
 #include "defines.hpp"
 #include "math/dmath_types.hpp"
 #include "platform/platform.hpp"
 
-#define ARENA_DEFAULT_ALIGNMENT 8
+#include <new>
+#include <string.h>
+
+// 16 so the aligned math types (vec4, mat4) and anything holding them are fine in arena memory.
+#define ARENA_DEFAULT_ALIGNMENT 16
+
+// reserved size of one arena per size class, and how much of the pool (in 1/16ths) goes to small and medium arenas.
+// Large arenas get the rest.
+static const u64 arena_class_sizes[ARENA_SIZE_CLASS_COUNT]          = {MB(64), MB(512), GB(4)};
+static const u32 arena_class_pool_sixteenths[ARENA_SIZE_CLASS_COUNT] = {1, 5, 10};
 
 struct arena_system_state
 {
@@ -16,44 +27,204 @@ struct arena_system_state
 
 static arena_system_state *arena_sys_ptr = nullptr;
 
-// I am using the first page as the arena system state. Kind of seems wasteful but its only 4096 bytes.
-bool arena_allocate_arena_pool(u64 size, u32 num_arenas)
+// commits pages until at least required_size bytes from the start of the arena are backed. Returns false if the
+// arena's reserved range is not big enough.
+static bool arena_commit_up_to(arena *in_arena, u64 required_size)
 {
-    void *start_ptr = platform_virtual_reserve(size, true);
+    if (required_size <= in_arena->committed)
+    {
+        return true;
+    }
+    if (required_size > in_arena->total_size)
+    {
+        return false;
+    }
+
+    arena_pool *pool          = &arena_sys_ptr->pool;
+    u64         chunk_size    = pool->commit_chunk_size;
+    u64         new_committed = (required_size + chunk_size - 1) & ~(chunk_size - 1);
+    if (new_committed > in_arena->total_size)
+    {
+        new_committed = in_arena->total_size;
+    }
+
+    void *commit_ptr = static_cast<u8 *>(in_arena->start_ptr) + in_arena->committed;
+    if (pool->huge_page_mode != ARENA_HUGE_PAGES_OFF)
+    {
+        bool explicit_pages = pool->huge_page_mode == ARENA_HUGE_PAGES_EXPLICIT;
+        if (!platform_virtual_commit_huge(commit_ptr, new_committed - in_arena->committed, explicit_pages))
+        {
+            pool->huge_page_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        u64 page_size = arena_sys_ptr->info.page_size;
+        u32 num_pages = static_cast<u32>((new_committed - in_arena->committed) / page_size);
+        platform_virtual_commit(commit_ptr, num_pages);
+    }
+
+    in_arena->committed = new_committed;
+    return true;
+}
+
+// gives back every page after keep_size. keep_size has to be chunk aligned.
+static void arena_decommit_after(arena *in_arena, u64 keep_size)
+{
+    if (in_arena->committed <= keep_size)
+    {
+        return;
+    }
+    void *decommit_ptr = static_cast<u8 *>(in_arena->start_ptr) + keep_size;
+    platform_virtual_free(decommit_ptr, in_arena->committed - keep_size, true);
+    in_arena->committed = keep_size;
+}
+
+static thread_local arena *thread_arena = nullptr;
+
+static u64 arena_pack_free_list_head(u32 tag, u32 index)
+{
+    return (static_cast<u64>(tag) << 32) | index;
+}
+
+static void arena_push_free_list(arena_pool *pool, arena_size_class_region *region, u32 index)
+{
+    u64 head = region->free_list_head.load(std::memory_order_relaxed);
+    u64 new_head;
+    do
+    {
+        pool->arenas[index].next_free.store(static_cast<u32>(head), std::memory_order_relaxed);
+        new_head = arena_pack_free_list_head(static_cast<u32>(head >> 32) + 1, index);
+    } while (!region->free_list_head.compare_exchange_weak(head, new_head, std::memory_order_release,
+                                                           std::memory_order_relaxed));
+}
+
+static u32 arena_pop_free_list(arena_pool *pool, arena_size_class_region *region)
+{
+    u64 head = region->free_list_head.load(std::memory_order_acquire);
+    u64 new_head;
+    u32 index;
+    do
+    {
+        index = static_cast<u32>(head);
+        if (index == INVALID_ID)
+        {
+            return INVALID_ID;
+        }
+        // if another thread pops this arena first the tag changes and the exchange fails, so reading a stale
+        // next_free here is harmless.
+        u32 next = pool->arenas[index].next_free.load(std::memory_order_relaxed);
+        new_head = arena_pack_free_list_head(static_cast<u32>(head >> 32) + 1, next);
+    } while (!region->free_list_head.compare_exchange_weak(head, new_head, std::memory_order_acquire,
+                                                           std::memory_order_acquire));
+    return index;
+}
+
+// The start of the pool holds the system state and the arena array, the size class regions follow it:
+//      | system state + arenas[] | small arenas ... | medium arenas ... | large arenas ... |
+bool arena_allocate_arena_pool(u64 size, arena_huge_page_mode huge_pages)
+{
+    u32           page_size = 4096;
+    platform_info info      = platform_get_info();
+    // check if our assumption was correct. I think I can avoid this by finding a better way but oh well.
+    DASSERT(info.page_size == page_size);
+    DASSERT(ARENA_COMMIT_CHUNK_SIZE % page_size == 0);
+
+    // with huge pages the arenas have to start on a huge page boundary and commit whole huge pages, otherwise the
+    // kernel cant back them with 2 MiB pages.
+    u64 commit_chunk_size = ARENA_COMMIT_CHUNK_SIZE;
+    if (huge_pages != ARENA_HUGE_PAGES_OFF && commit_chunk_size < ARENA_HUGE_PAGE_SIZE)
+    {
+        commit_chunk_size = ARENA_HUGE_PAGE_SIZE;
+    }
+
+    // small and medium get their share of the pool, large gets whatever is left. The header is tiny compared to the
+    // regions, so an upper bound on the arena count (ignoring it) is good enough to size it.
+    u32 class_counts[ARENA_SIZE_CLASS_COUNT];
+    u32 max_arenas = 0;
+    for (u32 i = 0; i < ARENA_SIZE_CLASS_COUNT; i++)
+    {
+        class_counts[i]  = static_cast<u32>(((size / 16) * arena_class_pool_sixteenths[i]) / arena_class_sizes[i]);
+        max_arenas      += class_counts[i];
+    }
+    u64 header_size = sizeof(arena_system_state) + ARENA_DEFAULT_ALIGNMENT + sizeof(arena) * max_arenas;
+    header_size     = (header_size + page_size - 1) & ~static_cast<u64>(page_size - 1);
 
-    u32 page_size = 4096;
-    arena_sys_ptr = reinterpret_cast<arena_system_state *>(platform_virtual_commit(start_ptr, 1));
+    void *start_ptr = platform_virtual_reserve(size, true);
+    arena_sys_ptr   = reinterpret_cast<arena_system_state *>(
+        platform_virtual_commit(start_ptr, static_cast<u32>(header_size / page_size)));
     DASSERT(arena_sys_ptr);
+    new (arena_sys_ptr) arena_system_state();
 
-    arena_sys_ptr->info              = platform_get_info();
+    arena_sys_ptr->info              = info;
     arena_sys_ptr->total_global_size = size;
 
-    // check if our assumption was correct. I think I can avoid this by finding a better way but oh well.
-    DASSERT(arena_sys_ptr->info.page_size == page_size);
+    arena_pool *pool        = &arena_sys_ptr->pool;
+    pool->huge_page_mode    = huge_pages;
+    pool->commit_chunk_size = commit_chunk_size;
+
+    uintptr_t regions_start = (reinterpret_cast<uintptr_t>(start_ptr) + header_size + commit_chunk_size - 1) &
+                              ~static_cast<uintptr_t>(commit_chunk_size - 1);
+    u8       *arena_start_ptr = reinterpret_cast<u8 *>(regions_start);
+    u64       regions_size    = size - (regions_start - reinterpret_cast<uintptr_t>(start_ptr));
+    pool->pool_size           = regions_size;
 
-    arena_pool *pool       = &arena_sys_ptr->pool;
-    // for now allocate only one page
-    pool->pool_size        = size - page_size;
-    pool->num_arenas       = num_arenas;
-    pool->arena_size_bytes = pool->pool_size / num_arenas;
-    pool->arena_size_pages = floor(pool->arena_size_bytes / arena_sys_ptr->info.page_size);
+    // see if the os actually has huge pages for us before every commit has to find out the hard way.
+    if (huge_pages == ARENA_HUGE_PAGES_EXPLICIT)
+    {
+        bool explicit_ok = platform_virtual_commit_huge(arena_start_ptr, ARENA_HUGE_PAGE_SIZE, true);
+        platform_virtual_free(arena_start_ptr, ARENA_HUGE_PAGE_SIZE, true);
+        if (!explicit_ok)
+        {
+            DWARN("Explicit huge pages are not available (vm.nr_hugepages is probably 0). Falling back to "
+                  "transparent huge pages.");
+            pool->huge_page_mode = ARENA_HUGE_PAGES_TRANSPARENT;
+        }
+    }
+
+    u64 remaining = regions_size;
+    for (u32 i = 0; i < ARENA_SIZE_CLASS_COUNT - 1; i++)
+    {
+        remaining -= class_counts[i] * arena_class_sizes[i];
+    }
+    class_counts[ARENA_SIZE_LARGE] = static_cast<u32>(remaining / arena_class_sizes[ARENA_SIZE_LARGE]);
 
-    u32 sys_size = sizeof(arena_system_state);
+    u32   sys_size  = sizeof(arena_system_state);
     void *array_ptr = reinterpret_cast<u8 *>(start_ptr) + sys_size;
     pool->arenas    = reinterpret_cast<arena *>(DALIGN_UP(array_ptr, ARENA_DEFAULT_ALIGNMENT));
 
-    u8 *arena_start_ptr = static_cast<u8 *>(start_ptr) + page_size;
-    u64 arena_size      = size / num_arenas;
-
-    for (u32 i = 0; i < num_arenas; i++)
+    u32 arena_index = 0;
+    for (u32 c = 0; c < ARENA_SIZE_CLASS_COUNT; c++)
     {
-        pool->arenas[i].start_ptr  = reinterpret_cast<arena *>(arena_start_ptr);
-        pool->arenas[i].total_size = INVALID_ID_64;
-        pool->arenas[i].allocated  = INVALID_ID_64;
-        pool->arenas[i].free_ptr   = nullptr;
+        arena_size_class_region *region = &pool->classes[c];
+        region->arena_size_bytes        = arena_class_sizes[c];
+        region->first_arena             = arena_index;
+        region->num_arenas              = class_counts[c];
+
+        for (u32 i = 0; i < class_counts[c]; i++)
+        {
+            arena *a = &pool->arenas[arena_index++];
+            new (a) arena();
+            a->start_ptr  = arena_start_ptr;
+            a->total_size = INVALID_ID_64;
+            a->allocated  = INVALID_ID_64;
+            a->free_ptr   = nullptr;
+            a->committed  = 0;
+            a->size_class = static_cast<arena_size_class>(c);
+
+            arena_start_ptr += region->arena_size_bytes;
+        }
 
-        arena_start_ptr += arena_size;
+        // push in reverse so that arena_get_arena hands them out in address order, same as before.
+        for (u32 i = region->num_arenas; i > 0; i--)
+        {
+            arena_push_free_list(pool, region, region->first_arena + i - 1);
+        }
     }
+    pool->num_arenas = arena_index;
+    DASSERT_MSG(pool->num_arenas, "Arena pool is too small for even one arena.");
+    DASSERT(reinterpret_cast<uintptr_t>(&pool->arenas[pool->num_arenas]) <=
+            reinterpret_cast<uintptr_t>(start_ptr) + header_size);
 
     return true;
 }
@@ -69,32 +240,36 @@ bool arena_free_arena_pool()
     return true;
 }
 
-arena *arena_get_arena()
+arena_huge_page_mode arena_get_huge_page_mode()
+{
+    DASSERT(arena_sys_ptr);
+    return arena_sys_ptr->pool.huge_page_mode;
+}
+
+arena *arena_get_arena(arena_size_class size_class)
 {
     DASSERT_MSG(arena_sys_ptr,
                 "Arena systems hasent been initialized!!!. Initialize it first before calling this function");
+    DASSERT(size_class < ARENA_SIZE_CLASS_COUNT);
 
-    u32    num_arenas       = arena_sys_ptr->pool.num_arenas;
-    u32    arena_size_pages = arena_sys_ptr->pool.arena_size_pages;
-    arena *arenas_arr       = arena_sys_ptr->pool.arenas;
-
-    arena *out_arena = nullptr;
-
-    for (u32 i = 0; i < num_arenas; i++)
+    arena_pool *pool  = &arena_sys_ptr->pool;
+    u32         index = INVALID_ID;
+    for (u32 c = size_class; c < ARENA_SIZE_CLASS_COUNT && index == INVALID_ID; c++)
     {
-        if (arenas_arr[i].total_size == INVALID_ID_64)
-        {
-            void *start_ptr = arenas_arr[i].start_ptr;
-            start_ptr       = reinterpret_cast<arena *>(platform_virtual_commit(start_ptr, arena_size_pages));
+        index = arena_pop_free_list(pool, &pool->classes[c]);
+    }
+    DASSERT_MSG(index != INVALID_ID, "There are no more free arenas.");
 
-            out_arena = &arenas_arr[i];
+    arena *out_arena          = &pool->arenas[index];
+    out_arena->free_ptr       = out_arena->start_ptr;
+    out_arena->allocated      = 0;
+    out_arena->committed      = 0;
+    out_arena->total_size     = pool->classes[out_arena->size_class].arena_size_bytes;
+    out_arena->peak_allocated = 0;
+    out_arena->slab_backed    = false;
 
-            out_arena->free_ptr   = out_arena->start_ptr;
-            out_arena->total_size = arena_sys_ptr->pool.arena_size_bytes;
-            break;
-        }
-    }
-    DASSERT_MSG(out_arena, "There are no more free arenas.");
+    // only the first chunk is committed up front, the rest is committed as the arena grows.
+    arena_commit_up_to(out_arena, pool->commit_chunk_size);
     return out_arena;
 }
 
@@ -102,59 +277,220 @@ void *arena_allocate_block(arena *in_arena, u64 mem_size)
 {
     DASSERT(in_arena);
 
-    uintptr_t return_ptr = DALIGN_UP(in_arena->free_ptr, ARENA_DEFAULT_ALIGNMENT);
-    u64       new_size   = in_arena->allocated + mem_size;
+    uintptr_t return_ptr       = DALIGN_UP(in_arena->free_ptr, ARENA_DEFAULT_ALIGNMENT);
+    uintptr_t next_free_ptr    = reinterpret_cast<uintptr_t>(in_arena->free_ptr) + mem_size;
+    uintptr_t aligned_free_ptr = DALIGN_UP(next_free_ptr, ARENA_DEFAULT_ALIGNMENT);
+    u64       used_size        = aligned_free_ptr - reinterpret_cast<uintptr_t>(in_arena->start_ptr);
 
-    if (new_size > in_arena->total_size)
+    if (used_size > in_arena->committed && !arena_commit_up_to(in_arena, used_size))
     {
-        DFATAL("Arena doesnot have enough remaining space to accomade allocation of size %lld. Arena has already "
-               "allocated %lld",
-               mem_size, in_arena->allocated);
+        DFATAL("Arena ran out of reserved address space for an allocation of size %lld. Arena has already "
+               "allocated %lld and reserves %lld",
+               mem_size, in_arena->allocated, in_arena->total_size);
         return nullptr;
     }
 
-    uintptr_t next_free_ptr    = reinterpret_cast<uintptr_t>(in_arena->free_ptr) + mem_size;
-    uintptr_t aligned_free_ptr = DALIGN_UP(next_free_ptr, ARENA_DEFAULT_ALIGNMENT);
-
     in_arena->free_ptr   = reinterpret_cast<void *>(aligned_free_ptr);
     in_arena->allocated += mem_size;
+    if (in_arena->allocated > in_arena->peak_allocated)
+    {
+        in_arena->peak_allocated = in_arena->allocated;
+    }
 
     return reinterpret_cast<void *>(return_ptr);
 }
 
-void arena_reset_arena(arena *in_arena)
+arena_marker arena_get_marker(arena *in_arena)
 {
     DASSERT(in_arena);
-    in_arena->free_ptr = in_arena->start_ptr;
-    dzero_memory(in_arena->start_ptr, in_arena->total_size);
-    in_arena->allocated = 0;
+    arena_marker marker;
+    marker.owner     = in_arena;
+    marker.free_ptr  = in_arena->free_ptr;
+    marker.allocated = in_arena->allocated;
+    return marker;
 }
 
-void arena_free_arena(arena *in_arena)
+void arena_pop_to_marker(arena_marker marker)
 {
+    arena *in_arena = marker.owner;
+    DASSERT(in_arena);
+    DASSERT_MSG(reinterpret_cast<uintptr_t>(marker.free_ptr) <= reinterpret_cast<uintptr_t>(in_arena->free_ptr),
+                "Marker is ahead of the arena. Markers have to be popped in the reverse order they were taken.");
 
-    u32    num_arenas       = arena_sys_ptr->pool.num_arenas;
-    u32    arena_size_pages = arena_sys_ptr->pool.arena_size_pages;
-    u32    arena_size_bytes = arena_sys_ptr->pool.arena_size_bytes;
-    arena *arenas_arr       = arena_sys_ptr->pool.arenas;
+    in_arena->free_ptr  = marker.free_ptr;
+    in_arena->allocated = marker.allocated;
+}
 
-    arena *out_arena = nullptr;
+arena_scope::arena_scope(arena *in_arena)
+{
+    owner  = in_arena;
+    marker = arena_get_marker(in_arena);
+}
+
+arena_scope::~arena_scope()
+{
+    arena_pop_to_marker(marker);
+}
 
-    bool found = false;
-    for (u32 i = 0; i < num_arenas; i++)
+void arena_reset_arena(arena *in_arena, bool zero_memory)
+{
+    DASSERT(in_arena);
+    u64 used       = static_cast<u8 *>(in_arena->free_ptr) - static_cast<u8 *>(in_arena->start_ptr);
+    u64 clear_size = used;
+
+    if (used > ARENA_DISCARD_THRESHOLD)
     {
-        arena *ptr = &arenas_arr[i];
-        if (ptr == in_arena && arenas_arr[i].total_size != INVALID_ID_64)
+        // only the pages up to free_ptr have been touched since the last reset, everything after that is not resident.
+        arena_pool *pool = &arena_sys_ptr->pool;
+        if (pool->huge_page_mode == ARENA_HUGE_PAGES_EXPLICIT)
+        {
+            // MADV_DONTNEED on hugetlb mappings needs a recent kernel, decommitting works everywhere. The arena commits
+            // them again on demand.
+            arena_decommit_after(in_arena, ARENA_DISCARD_THRESHOLD);
+        }
+        else
         {
-            platform_virtual_free(in_arena->start_ptr, arena_size_bytes, true);
-            in_arena->start_ptr  = nullptr;
-            in_arena->free_ptr   = nullptr;
-            in_arena->total_size = INVALID_ID_64;
-            in_arena->allocated  = INVALID_ID_64;
-            found                = true;
-            break;
+            u64 granularity = pool->huge_page_mode == ARENA_HUGE_PAGES_OFF ? arena_sys_ptr->info.page_size
+                                                                           : pool->commit_chunk_size;
+            u64 discard_end = (used + granularity - 1) & ~(granularity - 1);
+            platform_virtual_discard(static_cast<u8 *>(in_arena->start_ptr) + ARENA_DISCARD_THRESHOLD,
+                                     discard_end - ARENA_DISCARD_THRESHOLD);
         }
+        // the discarded pages come back zeroed.
+        clear_size = ARENA_DISCARD_THRESHOLD;
     }
+
+#if defined(DEBUG) && ARENA_POISON_ON_RESET
+    dset_memory_value(in_arena->start_ptr, ARENA_POISON_VALUE, clear_size);
+#else
+    if (zero_memory)
+    {
+        dzero_memory(in_arena->start_ptr, clear_size);
+    }
+#endif
+
+    in_arena->free_ptr  = in_arena->start_ptr;
+    in_arena->allocated = 0;
+}
+
+void arena_free_arena(arena *in_arena)
+{
+    DASSERT(in_arena);
+    arena_pool *pool = &arena_sys_ptr->pool;
+
+    uintptr_t first = reinterpret_cast<uintptr_t>(&pool->arenas[0]);
+    uintptr_t last  = reinterpret_cast<uintptr_t>(&pool->arenas[pool->num_arenas]);
+    uintptr_t ptr   = reinterpret_cast<uintptr_t>(in_arena);
+
+    bool found = ptr >= first && ptr < last && (ptr - first) % sizeof(arena) == 0 &&
+                 in_arena->total_size != INVALID_ID_64;
     DASSERT_MSG(found, "Passed arena ptr doesnot match the arenas array inside the arena pool.");
+
+    // decommit the pages but keep the address range reserved so that the arena can be handed out again.
+    arena_decommit_after(in_arena, 0);
+    in_arena->free_ptr    = nullptr;
+    in_arena->total_size  = INVALID_ID_64;
+    in_arena->allocated   = INVALID_ID_64;
+    in_arena->slab_backed = false;
+
+    if (thread_arena == in_arena)
+    {
+        thread_arena = nullptr;
+    }
+
+    u32 index = static_cast<u32>((ptr - first) / sizeof(arena));
+    arena_push_free_list(pool, &pool->classes[in_arena->size_class], index);
     return;
 }
+
+arena *arena_thread_acquire_arena()
+{
+    if (thread_arena)
+    {
+        return thread_arena;
+    }
+    thread_arena = arena_get_arena(ARENA_SIZE_MEDIUM);
+    return thread_arena;
+}
+
+void arena_thread_release_arena()
+{
+    if (!thread_arena)
+    {
+        DWARN("arena_thread_release_arena called on a thread that doesnt own an arena.");
+        return;
+    }
+    arena_free_arena(thread_arena);
+    thread_arena = nullptr;
+}
+
+arena *arena_get_thread_arena()
+{
+    return thread_arena;
+}
+
+void arena_set_thread_arena(arena *in_arena)
+{
+    thread_arena = in_arena;
+}
+
+void get_arena_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer)
+{
+    DASSERT(arena_sys_ptr);
+    arena_pool *pool = &arena_sys_ptr->pool;
+
+    // header + one line per class + one line per arena in use. Arenas can be taken by other threads in between the
+    // two calls, leave room for a few more. If even that isnt enough the report is cut off at the end of the buffer.
+    u32 in_use = 0;
+    for (u32 i = 0; i < pool->num_arenas; i++)
+    {
+        in_use += pool->arenas[i].total_size != INVALID_ID_64;
+    }
+    *buffer_usg_mem_requirements = 128 + ARENA_SIZE_CLASS_COUNT * 80 + (in_use + 4) * 112;
+    if (!out_buffer)
+    {
+        return;
+    }
+
+    const u64 mib    = 1024 * 1024;
+    const u64 size   = *buffer_usg_mem_requirements;
+    u64       offset = string_append_format(out_buffer, size, 0, "Arena memory use (reserved/committed/used/peak):\n");
+
+    const char *mode_names[] = {"off", "transparent", "explicit"};
+    offset = string_append_format(out_buffer, size, offset, "  huge pages: %s, %u fallbacks to normal pages\n",
+                                  mode_names[pool->huge_page_mode],
+                                  pool->huge_page_fallbacks.load(std::memory_order_relaxed));
+
+    const char *class_names[] = {"small", "medium", "large"};
+    for (u32 c = 0; c < ARENA_SIZE_CLASS_COUNT; c++)
+    {
+        const arena_size_class_region *region      = &pool->classes[c];
+        u32                            class_inuse = 0;
+        for (u32 i = 0; i < region->num_arenas; i++)
+        {
+            class_inuse += pool->arenas[region->first_arena + i].total_size != INVALID_ID_64;
+        }
+        offset = string_append_format(out_buffer, size, offset, "  %-6s: %4u x %8.2f MiB, %u in use\n",
+                                      class_names[c], region->num_arenas,
+                                      static_cast<f32>(region->arena_size_bytes) / static_cast<f32>(mib), class_inuse);
+    }
+
+    u64 total_committed = 0;
+    for (u32 i = 0; i < pool->num_arenas; i++)
+    {
+        arena *a = &pool->arenas[i];
+        if (a->total_size == INVALID_ID_64)
+        {
+            continue;
+        }
+        total_committed += a->committed;
+        offset = string_append_format(out_buffer, size, offset,
+                                      "  arena %3u: %8.2f MiB / %8.2f MiB / %8.2f MiB / %8.2f MiB\n", i,
+                                      static_cast<f32>(a->total_size) / static_cast<f32>(mib),
+                                      static_cast<f32>(a->committed) / static_cast<f32>(mib),
+                                      static_cast<f32>(a->allocated) / static_cast<f32>(mib),
+                                      static_cast<f32>(a->peak_allocated) / static_cast<f32>(mib));
+    }
+    string_append_format(out_buffer, size, offset, "  total committed: %.2f MiB\n",
+                         static_cast<f32>(total_committed) / static_cast<f32>(mib));
+}
@@ -1,39 +1,154 @@
 #pragma once
 
 #include "defines.hpp"
+
+#include <atomic>
+
+// arenas commit memory in chunks of this size. Has to be a multiple of the page size.
+#define ARENA_COMMIT_CHUNK_SIZE MB(1)
+// on reset the pages above this are given back to the os (madvise DONTNEED), below it they stay resident because the
+// arena is probably going to use them again right away.
+#define ARENA_DISCARD_THRESHOLD MB(16)
+// debug only: reset fills the used part with ARENA_POISON_VALUE instead of zeroing it, so use-after-reset and code
+// that relies on zeroed arena memory shows up. Off by default because the hashtables do rely on it.
+#define ARENA_POISON_ON_RESET 0
+#define ARENA_POISON_VALUE 0xCD
+// with huge pages the arenas are aligned to and commit in multiples of this.
+#define ARENA_HUGE_PAGE_SIZE MB(2)
 // size of the pool  --> has to be multiple of 2
-// num of arenas for the pool  --> has to be a multiple of 2
 
+// INFO: the pool is split into regions, one per size class, and every region into arenas of that class' size. Small
+// scratch arenas dont have to pay for a resource arena sized slice anymore. How much of the pool each class gets is
+// in arenas.cpp, the number of arenas only depends on the size of the pool.
+enum arena_size_class : u32
+{
+    ARENA_SIZE_SMALL,  // 64 MiB reserved:  frame arenas
+    ARENA_SIZE_MEDIUM, // 512 MiB reserved: scratch and per thread arenas (a whole obj parse), slabs
+    ARENA_SIZE_LARGE,  // 4 GiB reserved:   the long lived system/resource arenas
+    ARENA_SIZE_CLASS_COUNT,
+};
+
+// INFO: an arena is owned by exactly one thread at a time. Acquiring and releasing arenas from the pool is
+// thread-safe, allocating from the same arena on two threads is not.
 struct arena
 {
+    // total_size is the reserved address range, only the first committed bytes of it are backed by memory. The
+    // committed range grows in commit chunk steps (see arena_pool::commit_chunk_size) as free_ptr advances.
     u64   total_size = INVALID_ID_64;
     u64   allocated  = INVALID_ID_64;
+    u64   committed  = 0;
     void *start_ptr  = nullptr;
     void *free_ptr   = nullptr;
+
+    // high water mark of allocated since the arena was handed out, survives resets.
+    u64 peak_allocated = 0;
+
+    // small dallocate()'s against this arena go to the memory system's slab allocator so that dfree() can reuse them.
+    // Set it with memory_system_enable_slab, leave it off for frame/scratch arenas.
+    bool slab_backed = false;
+
+    arena_size_class size_class = ARENA_SIZE_LARGE;
+
+    // index of the next free arena in its class' free list, INVALID_ID if this is the last one.
+    std::atomic<u32> next_free{INVALID_ID};
+};
+
+// INFO: 2 MiB pages for the pool so that big mesh/texture working sets dont thrash the TLB.
+//  TRANSPARENT: normal pages + madvise(MADV_HUGEPAGE), the kernel backs the aligned ranges with huge pages when it can.
+//  EXPLICIT: MAP_HUGETLB, needs pages reserved by the os (vm.nr_hugepages). If there are none the pool falls back to
+//            TRANSPARENT.
+enum arena_huge_page_mode : u32
+{
+    ARENA_HUGE_PAGES_OFF,
+    ARENA_HUGE_PAGES_TRANSPARENT,
+    ARENA_HUGE_PAGES_EXPLICIT,
+};
+
+struct arena_size_class_region
+{
+    u64 arena_size_bytes = INVALID_ID_64;
+    u32 first_arena      = INVALID_ID;
+    u32 num_arenas       = 0;
+
+    // lock-free stack of free arenas. The low 32 bits are the index of the top arena, the high 32 bits are a tag that
+    // is bumped on every push/pop so that a stale compare_exchange cannot succeed (ABA).
+    std::atomic<u64> free_list_head{INVALID_ID_64};
 };
 
 struct arena_pool
 {
-    u64         pool_size        = INVALID_ID_64; // 8
-    u32         arena_size_bytes = INVALID_ID;    // 4
-    u32         arena_size_pages = INVALID_ID;    // 4
-    // if they are not free that means we have to commit them.
-    u32 num_arenas               = INVALID_ID; // 4
-
-    // this will hold the starting ptr's for the arenas at total_pool_size / num_arenas internval
-    // if pool_size is m, where m must be a multiple of the page size, and num_arenas is n, where n is a multiple of 2.
-    // then each arena will have m/n size;
+    u64 pool_size  = INVALID_ID_64;
+    // all classes together.
+    u32 num_arenas = INVALID_ID;
+
+    arena_huge_page_mode huge_page_mode    = ARENA_HUGE_PAGES_OFF;
+    // ARENA_COMMIT_CHUNK_SIZE, or ARENA_HUGE_PAGE_SIZE if that is bigger and huge pages are on.
+    u64                  commit_chunk_size = ARENA_COMMIT_CHUNK_SIZE;
+    // explicit huge page commits that didnt get huge pages (the os ran out) and were backed by normal pages instead.
+    std::atomic<u32>     huge_page_fallbacks{0};
+
+    arena_size_class_region classes[ARENA_SIZE_CLASS_COUNT];
+
+    // every arena of every class, ordered by class and then by address. Lives in the pages right after the system
+    // state at the start of the pool.
     arena *arenas;
 };
 
 // INFO: I will only call this once at the start of the application. So there will
 //  be only one pool.
-bool arena_allocate_arena_pool(u64 size, u32 num_arenas);
+bool arena_allocate_arena_pool(u64 size, arena_huge_page_mode huge_pages = ARENA_HUGE_PAGES_OFF);
 bool arena_free_arena_pool();
+// the mode the pool actually runs in, EXPLICIT turns into TRANSPARENT if the os has no huge pages.
+arena_huge_page_mode arena_get_huge_page_mode();
 
-arena *arena_get_arena();
+// thread-safe, can be called from any thread. If every arena of the class is taken you get one of the next bigger
+// class, it only asserts when those are gone too.
+arena *arena_get_arena(arena_size_class size_class = ARENA_SIZE_LARGE);
 void   arena_free_arena(arena *in_arena);
 
+// Per thread "current" arena. Loader/job threads acquire one arena for themselves and allocate from it without
+// touching the pool again. The main thread doesnt have one unless it asks for it. These are ARENA_SIZE_MEDIUM.
+arena *arena_thread_acquire_arena();
+void   arena_thread_release_arena();
+arena *arena_get_thread_arena();
+void   arena_set_thread_arena(arena *in_arena);
+
 void *arena_allocate_block(arena *in_arena, u64 mem_size);
 
-void arena_reset_arena(arena *in_arena);
+// A marker remembers how far an arena has been bumped. Popping back to it frees everything allocated after it in O(1).
+// Nothing is cleared, the next allocations there get whatever was left behind. Construct or zero what goes in there,
+// only a fresh arena or a zero_memory reset hands out zeroes.
+struct arena_marker
+{
+    arena *owner     = nullptr;
+    void  *free_ptr  = nullptr;
+    u64    allocated = 0;
+};
+
+arena_marker arena_get_marker(arena *in_arena);
+void         arena_pop_to_marker(arena_marker marker);
+
+// RAII version of the markers. Everything allocated from the arena while the scope is alive is thrown away when it
+// goes out of scope.
+//      {
+//          arena_scope scratch(scratch_arena_get());
+//          void *temp = dallocate(scratch.owner, size, MEM_TAG_UNKNOWN);
+//      }
+struct arena_scope
+{
+    arena       *owner;
+    arena_marker marker;
+
+    arena_scope(arena *in_arena);
+    ~arena_scope();
+
+    arena_scope(const arena_scope &)            = delete;
+    arena_scope &operator=(const arena_scope &) = delete;
+};
+
+// Resets the arena. Only the used part is cleared so this is O(used), not O(arena size). Pass zero_memory = false if
+// nothing relies on getting zeroed memory out of the arena afterwards (frame arenas).
+void arena_reset_arena(arena *in_arena, bool zero_memory = true);
+
+// same as get_memory_usg_str but reports reserved vs committed vs allocated bytes for every arena that is in use.
+void get_arena_usg_str(u64 *buffer_usg_mem_requirements, char *out_buffer);
@@ -0,0 +1,97 @@
+#include "frame_arena.hpp"
+#include "core/dasserts.hpp"
+#include "core/logger.hpp"
+
+struct frame_arena_state
+{
+    arena *frame_arenas[FRAME_ARENA_MAX_FRAMES];
+    u32    frames_in_flight;
+    u32    current_frame;
+    u64    frame_number;
+};
+
+static frame_arena_state frame_arena_state_data;
+static frame_arena_state *frame_arena_state_ptr = nullptr;
+
+static thread_local arena *thread_scratch_arena = nullptr;
+
+bool frame_arena_initialize(u32 frames_in_flight)
+{
+    if (frames_in_flight == 0 || frames_in_flight > FRAME_ARENA_MAX_FRAMES)
+    {
+        DERROR("frame_arena_initialize: frames_in_flight has to be between 1 and %d. Got %d", FRAME_ARENA_MAX_FRAMES,
+               frames_in_flight);
+        return false;
+    }
+
+    frame_arena_state_ptr                   = &frame_arena_state_data;
+    frame_arena_state_ptr->frames_in_flight = frames_in_flight;
+    frame_arena_state_ptr->current_frame    = 0;
+    frame_arena_state_ptr->frame_number     = 0;
+
+    for (u32 i = 0; i < frames_in_flight; i++)
+    {
+        frame_arena_state_ptr->frame_arenas[i] = arena_get_arena(ARENA_SIZE_SMALL);
+    }
+    return true;
+}
+
+void frame_arena_shutdown()
+{
+    if (!frame_arena_state_ptr)
+    {
+        return;
+    }
+    for (u32 i = 0; i < frame_arena_state_ptr->frames_in_flight; i++)
+    {
+        arena_free_arena(frame_arena_state_ptr->frame_arenas[i]);
+        frame_arena_state_ptr->frame_arenas[i] = nullptr;
+    }
+    // the main thread's scratch arena, loader threads have to release their own.
+    if (thread_scratch_arena)
+    {
+        scratch_arena_release();
+    }
+    frame_arena_state_ptr = nullptr;
+}
+
+void frame_arena_begin_frame()
+{
+    DASSERT(frame_arena_state_ptr);
+
+    frame_arena_state_ptr->frame_number++;
+    frame_arena_state_ptr->current_frame =
+        static_cast<u32>(frame_arena_state_ptr->frame_number % frame_arena_state_ptr->frames_in_flight);
+
+    // INFO: this arena was last used frames_in_flight frames ago, the renderer has waited on that frame's fence by
+    // now so nothing is reading from it anymore.
+    // INFO: nothing in the frame arena expects zeroed memory, the text buffers are written before they are read.
+    arena_reset_arena(frame_arena_state_ptr->frame_arenas[frame_arena_state_ptr->current_frame], false);
+}
+
+arena *frame_arena_get_current()
+{
+    DASSERT(frame_arena_state_ptr);
+    return frame_arena_state_ptr->frame_arenas[frame_arena_state_ptr->current_frame];
+}
+
+arena *scratch_arena_get()
+{
+    if (!thread_scratch_arena)
+    {
+        // medium, the cubemap loader puts all six faces in here.
+        thread_scratch_arena = arena_get_arena(ARENA_SIZE_MEDIUM);
+    }
+    return thread_scratch_arena;
+}
+
+void scratch_arena_release()
+{
+    if (!thread_scratch_arena)
+    {
+        DWARN("scratch_arena_release called on a thread that doesnt have a scratch arena.");
+        return;
+    }
+    arena_free_arena(thread_scratch_arena);
+    thread_scratch_arena = nullptr;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "defines.hpp"
+#include "memory/arenas.hpp"
+
+// upper bound for frames_in_flight, the renderer uses MAX_FRAMES_IN_FLIGHT which is 3 right now.
+#define FRAME_ARENA_MAX_FRAMES 4
+
+// INFO: one arena per frame in flight. Anything that only has to live until the frame is done goes in here and is
+// thrown away in bulk when the ring comes back around to that frame. There is no need to free anything.
+bool frame_arena_initialize(u32 frames_in_flight);
+void frame_arena_shutdown();
+
+// call this once at the start of every frame. It moves to the next arena in the ring and resets it.
+void   frame_arena_begin_frame();
+arena *frame_arena_get_current();
+
+// Per thread scratch arena for temporary data that doesnt outlive a function (import paths etc). Always use it through
+// an arena_scope so that it is popped back when you are done with it.
+arena *scratch_arena_get();
+void   scratch_arena_release();
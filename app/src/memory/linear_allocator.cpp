@@ -62,7 +62,10 @@ void linear_allocator_free_all(linear_allocator *allocator)
 
     if (allocator->memory)
     {
-        dzero_memory(allocator->memory, allocator->total_size);
-        allocator->total_allocated = 0;
+        // only the used part has to be cleared, the rest was never handed out.
+        dzero_memory(allocator->memory, allocator->total_allocated);
+        allocator->total_allocated      = 0;
+        allocator->num_allocations      = 0;
+        allocator->current_free_mem_ptr = allocator->memory;
     }
 }
@@ -0,0 +1,173 @@
+#include "slab_allocator.hpp"
+#include "core/dasserts.hpp"
+#include "core/dmemory.hpp"
+#include "core/dstring.hpp"
+#include "core/logger.hpp"
+
+static u32 slab_size_class_block_size(u32 class_index)
+{
+    if (class_index < 4)
+    {
+        return (class_index + 1) * 16;
+    }
+    u32 power = 7 + (class_index - 4) / 2;
+    u32 size  = 1u << power;
+    // even classes are the 3/4 step between two powers of two
+    return ((class_index - 4) % 2 == 0) ? (size / 4) * 3 : size;
+}
+
+u32 slab_allocator_size_class(u64 size)
+{
+    if (size <= 64)
+    {
+        return size == 0 ? 0 : static_cast<u32>((size - 1) >> 4);
+    }
+    // smallest power of two that fits the size
+    u32 power = 64 - __builtin_clzll(size - 1);
+    u64 three_quarters = (1ull << (power - 2)) * 3;
+    return 4 + (power - 7) * 2 + (size <= three_quarters ? 0 : 1);
+}
+
+bool slab_allocator_create(arena *backing_arena, slab_allocator *out_allocator)
+{
+    DASSERT(backing_arena);
+    DASSERT(out_allocator);
+
+    DASSERT_MSG(backing_arena->allocated == 0, "The slab allocator needs a fresh arena.");
+
+    out_allocator->backing_arena = backing_arena;
+    out_allocator->max_spans     = backing_arena->total_size / SLAB_SPAN_SIZE;
+    out_allocator->num_spans     = 0;
+
+    // the span table sits at the front of the arena and eats the first span or so, whatever. Rounded to 16 so that the
+    // spans after it stay 16 byte aligned.
+    u64 table_size              = (out_allocator->max_spans + 15) & ~15ull;
+    out_allocator->span_classes = static_cast<u8 *>(arena_allocate_block(backing_arena, table_size));
+    out_allocator->max_spans   -= (table_size + SLAB_SPAN_SIZE - 1) / SLAB_SPAN_SIZE;
+    out_allocator->spans_start  = static_cast<u8 *>(backing_arena->free_ptr);
+
+    for (u32 i = 0; i < SLAB_NUM_SIZE_CLASSES; i++)
+    {
+        slab_size_class *size_class  = &out_allocator->classes[i];
+        size_class->block_size       = slab_size_class_block_size(i);
+        size_class->free_list        = nullptr;
+        size_class->span_cursor      = nullptr;
+        size_class->span_end         = nullptr;
+        size_class->live_blocks      = 0;
+        size_class->peak_live_blocks = 0;
+        size_class->num_spans        = 0;
+    }
+    DASSERT(slab_size_class_block_size(SLAB_NUM_SIZE_CLASSES - 1) == SLAB_MAX_BLOCK_SIZE);
+    return true;
+}
+
+void slab_allocator_destroy(slab_allocator *allocator)
+{
+    DASSERT(allocator);
+    // the memory belongs to the backing arena, the owner of the arena gives it back.
+    allocator->backing_arena = nullptr;
+    allocator->span_classes  = nullptr;
+    allocator->spans_start   = nullptr;
+    allocator->num_spans     = 0;
+}
+
+void *slab_allocator_allocate(slab_allocator *allocator, u64 size)
+{
+    if (size > SLAB_MAX_BLOCK_SIZE)
+    {
+        return nullptr;
+    }
+
+    u32              class_index = slab_allocator_size_class(size);
+    slab_size_class *size_class  = &allocator->classes[class_index];
+    void            *block       = nullptr;
+
+    if (size_class->free_list)
+    {
+        block                 = size_class->free_list;
+        size_class->free_list = *static_cast<void **>(block);
+        // INFO: callers expect zeroed memory like they get from the arena (hashtables rely on it).
+        dzero_memory(block, size_class->block_size);
+    }
+    else
+    {
+        if (size_class->span_cursor + size_class->block_size > size_class->span_end)
+        {
+            if (allocator->num_spans >= allocator->max_spans)
+            {
+                DFATAL("Slab allocator ran out of spans.");
+                return nullptr;
+            }
+            u8 *span = static_cast<u8 *>(arena_allocate_block(allocator->backing_arena, SLAB_SPAN_SIZE));
+            DASSERT(span == allocator->spans_start + allocator->num_spans * SLAB_SPAN_SIZE);
+
+            allocator->span_classes[allocator->num_spans++] = static_cast<u8>(class_index);
+            size_class->span_cursor                         = span;
+            size_class->span_end                            = span + SLAB_SPAN_SIZE;
+            size_class->num_spans++;
+        }
+        block                    = size_class->span_cursor;
+        size_class->span_cursor += size_class->block_size;
+    }
+
+    size_class->live_blocks++;
+    if (size_class->live_blocks > size_class->peak_live_blocks)
+    {
+        size_class->peak_live_blocks = size_class->live_blocks;
+    }
+    return block;
+}
+
+bool slab_allocator_owns(slab_allocator *allocator, void *block)
+{
+    uintptr_t ptr   = reinterpret_cast<uintptr_t>(block);
+    uintptr_t start = reinterpret_cast<uintptr_t>(allocator->spans_start);
+    return ptr >= start && ptr < start + allocator->num_spans * SLAB_SPAN_SIZE;
+}
+
+void slab_allocator_free(slab_allocator *allocator, void *block)
+{
+    DASSERT(slab_allocator_owns(allocator, block));
+
+    // the span table tells us the class, so the size the caller passes to dfree doesnt matter.
+    u64              span_index  = (static_cast<u8 *>(block) - allocator->spans_start) / SLAB_SPAN_SIZE;
+    slab_size_class *size_class  = &allocator->classes[allocator->span_classes[span_index]];
+    DASSERT_MSG((static_cast<u8 *>(block) - allocator->spans_start) % SLAB_SPAN_SIZE % size_class->block_size == 0,
+                "dfree() called with a pointer into the middle of a block.");
+    *static_cast<void **>(block) = size_class->free_list;
+    size_class->free_list        = block;
+
+    DASSERT(size_class->live_blocks);
+    size_class->live_blocks--;
+}
+
+void get_slab_usg_str(slab_allocator *allocator, u64 *buffer_usg_mem_requirements, char *out_buffer)
+{
+    *buffer_usg_mem_requirements = 128 + SLAB_NUM_SIZE_CLASSES * 96;
+    if (!out_buffer)
+    {
+        return;
+    }
+
+    u64 size   = *buffer_usg_mem_requirements;
+    u64 offset = string_append_format(out_buffer, size, 0, "Slab memory use (class: live/peak blocks, spans):\n");
+
+    u64 total_live = 0;
+    for (u32 i = 0; i < SLAB_NUM_SIZE_CLASSES; i++)
+    {
+        slab_size_class *size_class = &allocator->classes[i];
+        if (size_class->num_spans == 0)
+        {
+            continue;
+        }
+        total_live += size_class->live_blocks * size_class->block_size;
+        offset      = string_append_format(out_buffer, size, offset, "  %6u: %8llu / %8llu, %llu\n",
+                                           size_class->block_size,
+                                           static_cast<unsigned long long>(size_class->live_blocks),
+                                           static_cast<unsigned long long>(size_class->peak_live_blocks),
+                                           static_cast<unsigned long long>(size_class->num_spans));
+    }
+    string_append_format(out_buffer, size, offset, "  live %.2f KiB in %.2f KiB of spans\n",
+                         static_cast<f32>(total_live) / 1024.0f,
+                         static_cast<f32>(allocator->num_spans * SLAB_SPAN_SIZE) / 1024.0f);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "defines.hpp"
+#include "memory/arenas.hpp"
+
+// INFO: size class allocator. Blocks of the same class are carved out of fixed size spans, freed blocks go on a per
+// class free list and get reused by the next allocation of that class. Both allocate and free are O(1).
+//
+// classes are 16, 32, 48, 64 and then two per power of two (96, 128, 192, 256 ... 48K, 64K).
+#define SLAB_NUM_SIZE_CLASSES 24
+#define SLAB_SPAN_SIZE KI(64)
+#define SLAB_MAX_BLOCK_SIZE SLAB_SPAN_SIZE
+
+struct slab_size_class
+{
+    u32   block_size;
+    // freed blocks, the next pointer is stored in the block itself.
+    void *free_list;
+    // bump pointer into the newest span, blocks that have never been handed out.
+    u8   *span_cursor;
+    u8   *span_end;
+
+    u64 live_blocks;
+    u64 peak_live_blocks;
+    u64 num_spans;
+};
+
+struct slab_allocator
+{
+    // the slab owns the whole arena, nothing else should allocate from it.
+    arena *backing_arena;
+    u8    *spans_start;
+    // class index of every span that has been carved out of the arena so far.
+    u8    *span_classes;
+    u64    max_spans;
+    u64    num_spans;
+
+    slab_size_class classes[SLAB_NUM_SIZE_CLASSES];
+};
+
+bool slab_allocator_create(arena *backing_arena, slab_allocator *out_allocator);
+void slab_allocator_destroy(slab_allocator *allocator);
+
+// returns nullptr if the size is bigger than SLAB_MAX_BLOCK_SIZE. The returned block is zeroed, same as fresh arena
+// memory.
+void *slab_allocator_allocate(slab_allocator *allocator, u64 size);
+void  slab_allocator_free(slab_allocator *allocator, void *block);
+
+// true if the block was handed out by this slab.
+bool slab_allocator_owns(slab_allocator *allocator, void *block);
+u32  slab_allocator_size_class(u64 size);
+
+void get_slab_usg_str(slab_allocator *allocator, u64 *buffer_usg_mem_requirements, char *out_buffer);
@@ -26,6 +26,18 @@ void *platform_virtual_reserve(u64 size, bool aligned);
 void  platform_virtual_unreserve(void *ptr, u64 size);
 void  platform_virtual_free(void *block, u64 size, bool aligned);
 void *platform_virtual_commit(void *ptr, u32 num_pages);
+// Commits with 2 MiB pages, ptr and size have to be 2 MiB aligned. explicit_pages tries MAP_HUGETLB first, otherwise
+// (or if the os has no huge pages reserved) it commits normal pages and asks for transparent huge pages. Returns false
+// if explicit pages were asked for and couldnt be used.
+bool  platform_virtual_commit_huge(void *ptr, u64 size, bool explicit_pages);
+// gives the physical pages back to the os but keeps the range committed, they read back as zero next time.
+void  platform_virtual_discard(void *ptr, u64 size);
+
+// read only mapping of a whole file. Returns nullptr if the file doesnt exist or is empty.
+const void *platform_map_file(const char *file_path, u64 *out_size);
+void        platform_unmap_file(const void *ptr, u64 size);
+// size and last write time of a file, false if it doesnt exist. The time is in platform units, only compare it.
+bool        platform_get_file_stamp(const char *file_path, u64 *out_size, u64 *out_modified_time);
 
 void *platform_zero_memory(void *block, u64 size);
 void *platform_copy_memory(void *dest, const void *source, u64 size);
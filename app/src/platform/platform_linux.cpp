@@ -10,10 +10,12 @@
 #ifdef DPLATFORM_LINUX
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -1195,12 +1197,56 @@ keys translate_keycode(xkb_keysym_t xkb_sym)
 
 #endif
 
+#if !defined(DPLATFORM_LINUX_X11) && !defined(DPLATFORM_LINUX_WAYLAND)
+
+// Headless linux platform. No window and no input, used by the tools that only need memory, timing and console
+// output (e.g the benchmarks).
+typedef struct platform_state
+{
+    u32 width;
+    u32 height;
+
+    platform_info info;
+} platform_state;
+
+static platform_state *platform_state_ptr;
+
+bool platform_system_startup(arena *arena, application_config *app_config)
+{
+    DASSERT(arena);
+    platform_state_ptr = static_cast<platform_state *>(dallocate(arena, sizeof(platform_state), MEM_TAG_APPLICATION));
+
+    DINFO("Initializing headless linux platform...");
+    platform_state_ptr->width  = 1270;
+    platform_state_ptr->height = 800;
+    platform_state_ptr->info   = platform_get_info();
+    return true;
+}
+
+bool platform_pump_messages()
+{
+    return true;
+}
+
+void platform_system_shutdown()
+{
+    platform_state_ptr = 0;
+}
+
+void platform_get_window_dimensions(u32 *width, u32 *height)
+{
+    *width  = platform_state_ptr ? platform_state_ptr->width : 1270;
+    *height = platform_state_ptr ? platform_state_ptr->height : 800;
+}
+
+#endif
+
 void *platform_virtual_reserve(u64 size, bool aligned)
 {
     DASSERT(size != INVALID_ID_64);
     platform_info info = platform_get_info();
 
-    void *ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void *ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
     if (ptr == MAP_FAILED)
     {
         s32         error_code = errno;
@@ -1224,18 +1270,117 @@ void platform_virtual_unreserve(void *ptr, u64 size)
         DFATAL("Linux Virtual unreserve failed. %s", error);
     }
 }
+// INFO: this only decommits the pages, the address range stays reserved (same as MEM_DECOMMIT on windows). Use
+// platform_virtual_unreserve to give the range back.
 void platform_virtual_free(void *block, u64 size, bool aligned)
 {
     platform_info info = platform_get_info();
     DASSERT(reinterpret_cast<uintptr_t>(block) % info.page_size == 0);
-    s32 result = munmap(block, size);
-    if (result == -1)
+    void *result = mmap(block, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+    if (result == MAP_FAILED)
     {
         s32         error_code = errno;
         const char *error      = strerror(error_code);
         DFATAL("Linux Virtual free failed. %s", error);
     }
 }
+void platform_virtual_discard(void *ptr, u64 size)
+{
+    platform_info info = platform_get_info();
+    DASSERT(reinterpret_cast<uintptr_t>(ptr) % info.page_size == 0);
+    // anonymous private mapping, so DONTNEED hands the pages back and the next touch gets fresh zero pages.
+    s32 result = madvise(ptr, size, MADV_DONTNEED);
+    if (result == -1)
+    {
+        s32         error_code = errno;
+        const char *error      = strerror(error_code);
+        DERROR("Linux Virtual discard failed. %s", error);
+    }
+}
+const void *platform_map_file(const char *file_path, u64 *out_size)
+{
+    DASSERT(file_path);
+    DASSERT(out_size);
+    *out_size = 0;
+
+    s32 fd = open(file_path, O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    // the mapping keeps its own reference to the file, so the fd can go right away.
+    void *ptr = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        s32         error_code = errno;
+        const char *error      = strerror(error_code);
+        DERROR("Linux map file %s failed. %s", file_path, error);
+        return nullptr;
+    }
+    *out_size = file_stat.st_size;
+    return ptr;
+}
+void platform_unmap_file(const void *ptr, u64 size)
+{
+    DASSERT(ptr);
+    s32 result = munmap(const_cast<void *>(ptr), size);
+    if (result == -1)
+    {
+        s32         error_code = errno;
+        const char *error      = strerror(error_code);
+        DERROR("Linux unmap file failed. %s", error);
+    }
+}
+bool platform_get_file_stamp(const char *file_path, u64 *out_size, u64 *out_modified_time)
+{
+    DASSERT(file_path);
+    DASSERT(out_size && out_modified_time);
+    struct stat file_stat;
+    if (stat(file_path, &file_stat) == -1)
+    {
+        *out_size          = 0;
+        *out_modified_time = 0;
+        return false;
+    }
+    *out_size          = file_stat.st_size;
+    *out_modified_time = static_cast<u64>(file_stat.st_mtim.tv_sec) * 1000000000ull + file_stat.st_mtim.tv_nsec;
+    return true;
+}
+bool platform_virtual_commit_huge(void *ptr, u64 size, bool explicit_pages)
+{
+#ifdef MAP_HUGETLB
+    if (explicit_pages)
+    {
+        // without MAP_NORESERVE the huge pages are reserved right here, so this fails now instead of SIGBUS'ing later.
+        void *result = mmap(ptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB,
+                            -1, 0);
+        if (result != MAP_FAILED)
+        {
+            return true;
+        }
+    }
+#endif
+    void *result = mmap(ptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (result == MAP_FAILED)
+    {
+        s32         error_code = errno;
+        const char *error      = strerror(error_code);
+        DFATAL("Linux Virtual commit (huge) failed. %s", error);
+        return false;
+    }
+#ifdef MADV_HUGEPAGE
+    // only a hint, fails if THP is compiled out or set to never. Not worth a log line per commit.
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    return !explicit_pages;
+}
 void *platform_virtual_commit(void *ptr, u32 num_pages)
 {
     void         *return_ptr = nullptr;
@@ -231,6 +231,91 @@ void platform_virtual_free(void *block,u64 size, bool aligned)
         DFATAL("Virtual free failed. Windows error_code: %d", GetLastError());
     }
 }
+// MEM_RESET doesnt give zeroed pages back, so decommit and commit again.
+void platform_virtual_discard(void *ptr, u64 size)
+{
+    bool result = VirtualFree(ptr, size, MEM_DECOMMIT);
+    if(!result)
+    {
+        DERROR("Virtual discard failed. Windows error_code: %d", GetLastError());
+        return;
+    }
+    void *return_ptr = VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE);
+    if(!return_ptr)
+    {
+        DFATAL("Virtual discard recommit failed. Windows error_code: %d", GetLastError());
+    }
+}
+const void *platform_map_file(const char *file_path, u64 *out_size)
+{
+    DASSERT(file_path);
+    DASSERT(out_size);
+    *out_size = 0;
+
+    HANDLE file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        DERROR("Map file %s failed. Windows error_code: %d", file_path, GetLastError());
+        return nullptr;
+    }
+    // the view keeps the mapping alive.
+    void *ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!ptr)
+    {
+        DERROR("Map view of file %s failed. Windows error_code: %d", file_path, GetLastError());
+        return nullptr;
+    }
+    *out_size = file_size.QuadPart;
+    return ptr;
+}
+void platform_unmap_file(const void *ptr, u64 size)
+{
+    DASSERT(ptr);
+    if (!UnmapViewOfFile(ptr))
+    {
+        DERROR("Unmap file failed. Windows error_code: %d", GetLastError());
+    }
+}
+bool platform_get_file_stamp(const char *file_path, u64 *out_size, u64 *out_modified_time)
+{
+    DASSERT(file_path);
+    DASSERT(out_size && out_modified_time);
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(file_path, GetFileExInfoStandard, &data))
+    {
+        *out_size          = 0;
+        *out_modified_time = 0;
+        return false;
+    }
+    *out_size          = (static_cast<u64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    *out_modified_time = (static_cast<u64>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                         data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+// INFO: large pages on windows need SeLockMemoryPrivilege and have to be reserved and committed in one go with
+// MEM_LARGE_PAGES, which doesnt work with commit-on-demand arenas. So this is a normal commit for now.
+bool platform_virtual_commit_huge(void *ptr, u64 size, bool explicit_pages)
+{
+    void *return_ptr = VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE);
+    if (!return_ptr)
+    {
+        DFATAL("Virtual alloc (huge) failed. Windows error_code: %d", GetLastError());
+    }
+    return !explicit_pages;
+}
 // this will commit page size
 void *platform_virtual_commit(void *ptr, u32 num_pages)
 {
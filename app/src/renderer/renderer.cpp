@@ -1,5 +1,10 @@
 #include "core/dmemory.hpp"
 #include "core/logger.hpp"
+#include "main.hpp"
+#include "math/dbvh.hpp"
+#include "math/dfrustum.hpp"
+#include "math/dmath.hpp"
+#include "memory/frame_arena.hpp"
 #include "platform/platform.hpp"
 #include "renderer.hpp"
 #include "vulkan/vulkan_backend.hpp"
@@ -12,8 +17,33 @@ struct renderer_system_state
 
     u64   vulkan_backend_memory_requirements;
     void *vulkan_backend_state;
+
+    renderer_cull_stats cull_stats;
+
+    // INFO: the world boxes of the 3D geometry of the last frame drawn, worked out once a frame for the cull. The scene
+    // bvh over them is only brought up to date when something asks for it: the cull every frame once there are enough
+    // objects for it to beat the flat pass, otherwise only picking and nearest queries. It is built again when the
+    // geometry list changes and refit when the boxes moved since the last time.
+    //
+    // The boxes and the tree share one block out of the resource arena, big enough for scene_capacity objects. A
+    // bigger scene gets a block twice the size. dfree only gets small blocks back, a big one stays in the arena, but
+    // with the doubling all of those together are smaller than the block in use.
+    arena     *resource_arena;
+    void      *scene_memory;
+    u32        scene_capacity;
+    bvh        scene_bvh;
+    bool       scene_bvh_needs_build;
+    bool       scene_bvh_needs_refit;
+    bounds_3D *scene_bounds;
+    geometry **scene_geometries;
+    u32        scene_count;
+    mat4       view_projection;
 };
 
+// the bvh bench has the flat frustum_cull pass ahead at sponza size (a few hundred objects) and the bvh ahead at 64k,
+// somewhere in between is where it starts paying for itself.
+#define RENDERER_BVH_CULL_MIN_OBJECTS 4096
+
 static renderer_system_state *renderer_system_state_ptr;
 
 bool renderer_system_startup(arena *system_arena, arena *resource_arena, struct application_config *app_config)
@@ -34,6 +64,9 @@ bool renderer_system_startup(arena *system_arena, arena *resource_arena, struct
         DFATAL("Vukan backend initialization failed.");
         return false;
     }
+    renderer_system_state_ptr->resource_arena = resource_arena;
+    renderer_system_state_ptr->scene_memory   = nullptr;
+    renderer_system_state_ptr->scene_capacity = 0;
 
     return true;
 }
@@ -49,15 +82,176 @@ void renderer_system_shutdown()
     }
 }
 
+// the boxes first, then the tree over them.
+static u64 renderer_scene_memory_requirements(u32 capacity)
+{
+    return sizeof(bounds_3D) * capacity + bvh_memory_requirements(capacity);
+}
+
+// world boxes of the 3D geometry in data, data is the callers list and not the culled one.
+static void renderer_update_scene_bounds(const render_data *data)
+{
+    renderer_system_state *state = renderer_system_state_ptr;
+    u32                    count = data->test_geometry_3D ? data->geometry_count_3D : 0;
+    count                        = count == INVALID_ID ? 0 : count;
+
+    if (data->test_geometry_3D != state->scene_geometries || count != state->scene_count)
+    {
+        if (count > state->scene_capacity)
+        {
+            u32 capacity = count > state->scene_capacity * 2 ? count : state->scene_capacity * 2;
+            dfree(state->scene_memory, renderer_scene_memory_requirements(state->scene_capacity), MEM_TAG_RENDERER);
+            state->scene_memory =
+                DALLOCATE(state->resource_arena, renderer_scene_memory_requirements(capacity), MEM_TAG_RENDERER);
+            state->scene_capacity = capacity;
+        }
+        state->scene_geometries      = data->test_geometry_3D;
+        state->scene_count           = count;
+        state->scene_bounds          = static_cast<bounds_3D *>(state->scene_memory);
+        state->scene_bvh_needs_build = true;
+    }
+    for (u32 i = 0; i < count; i++)
+    {
+        geometry *geo          = data->test_geometry_3D[i];
+        state->scene_bounds[i] = bounds_3D_transform(&geo->bounds, geo->ubo.model);
+    }
+
+    state->scene_bvh_needs_refit = true;
+    // row vectors, the view goes first.
+    state->view_projection = mat4_mul(data->scene_ubo.view, data->scene_ubo.projection);
+}
+
+// the scene bvh over the current world boxes.
+static bvh *renderer_get_scene_bvh()
+{
+    renderer_system_state *state = renderer_system_state_ptr;
+    if (state->scene_bvh_needs_build)
+    {
+        bvh_build_in_place(state->scene_bounds + state->scene_capacity, state->scene_bounds, state->scene_count,
+                           &state->scene_bvh);
+    }
+    else if (state->scene_bvh_needs_refit)
+    {
+        bvh_refit(&state->scene_bvh, state->scene_bounds);
+    }
+    state->scene_bvh_needs_build = false;
+    state->scene_bvh_needs_refit = false;
+    return &state->scene_bvh;
+}
+
+// swaps the 3D geometry list of data for the visible part of it. The list lives in the frame arena.
+static void renderer_cull_geometries(render_data *data)
+{
+    renderer_cull_stats *stats = &renderer_system_state_ptr->cull_stats;
+    u32                  count = data->geometry_count_3D;
+    if (!data->test_geometry_3D || !count || count == INVALID_ID)
+    {
+        *stats = {};
+        return;
+    }
+
+    arena  *frame_arena   = frame_arena_get_current();
+    frustum view_frustum  = frustum_from_matrix(renderer_system_state_ptr->view_projection);
+    u32    *visible       = static_cast<u32 *>(DALLOCATE(frame_arena, sizeof(u32) * count, MEM_TAG_RENDERER));
+    u32     visible_count = 0;
+    if (count >= RENDERER_BVH_CULL_MIN_OBJECTS)
+    {
+        visible_count = bvh_query_frustum(renderer_get_scene_bvh(), &view_frustum, visible);
+    }
+    else
+    {
+        frustum_cull_list list;
+        frustum_cull_list_create(frame_arena, count, &list);
+        // the world boxes are the ones worked out for the frame, the list comes straight from the callers list.
+        for (u32 i = 0; i < count; i++)
+        {
+            frustum_cull_list_push_world(&list, &renderer_system_state_ptr->scene_bounds[i]);
+        }
+        visible_count = frustum_cull(&view_frustum, &list, visible);
+    }
+    geometry **visible_geos =
+        static_cast<geometry **>(DALLOCATE(frame_arena, sizeof(geometry *) * count, MEM_TAG_RENDERER));
+    for (u32 i = 0; i < visible_count; i++)
+    {
+        visible_geos[i] = data->test_geometry_3D[visible[i]];
+    }
+
+    data->test_geometry_3D  = visible_geos;
+    data->geometry_count_3D = visible_count;
+
+    stats->tested  = count;
+    stats->visible = visible_count;
+    stats->culled  = count - visible_count;
+}
+
 void renderer_draw_frame(render_data *data)
 {
-    bool result = vulkan_draw_frame(data);
+    // the callers list stays as it is, the backend gets a copy with the culled one.
+    render_data frame_data = *data;
+    renderer_update_scene_bounds(data);
+    renderer_cull_geometries(&frame_data);
+
+    bool result = vulkan_draw_frame(&frame_data);
     if (!result)
     {
         DERROR("Smth wrong with drawing frame");
         return;
     }
 }
+renderer_cull_stats renderer_get_cull_stats()
+{
+    return renderer_system_state_ptr ? renderer_system_state_ptr->cull_stats : renderer_cull_stats{};
+}
+
+geometry *renderer_pick_geometry(s32 x, s32 y, f32 *out_distance)
+{
+    renderer_system_state *state = renderer_system_state_ptr;
+    u32                    width = 0, height = 0;
+    platform_get_window_dimensions(&width, &height);
+    if (!state || !state->scene_count || !width || !height)
+    {
+        return nullptr;
+    }
+
+    // the pixel center to ndc, the projection flips y already so y goes down in both. The ray runs from the near
+    // plane to the far plane.
+    f32  ndc_x      = 2.0f * (x + 0.5f) / width - 1.0f;
+    f32  ndc_y      = 2.0f * (y + 0.5f) / height - 1.0f;
+    mat4 inverse    = mat4_inverse(state->view_projection);
+    vec4 near_point = mat4_mul_vec4(inverse, vec4(ndc_x, ndc_y, -1, 1));
+    vec4 far_point  = mat4_mul_vec4(inverse, vec4(ndc_x, ndc_y, 1, 1));
+    vec3 origin     = vec3(near_point.x, near_point.y, near_point.z) * (1.0f / near_point.w);
+    vec3 target     = vec3(far_point.x, far_point.y, far_point.z) * (1.0f / far_point.w);
+    vec3 direction  = target - origin;
+
+    // distances come back in lengths of direction, 1 is the far plane.
+    bvh_hit hit;
+    if (!bvh_raycast(renderer_get_scene_bvh(), origin, direction, 1.0f, &hit))
+    {
+        return nullptr;
+    }
+    if (out_distance)
+    {
+        *out_distance = hit.distance * direction.magnitude();
+    }
+    return state->scene_geometries[hit.item];
+}
+
+geometry *renderer_nearest_geometry(vec3 point, f32 *out_distance)
+{
+    renderer_system_state *state = renderer_system_state_ptr;
+    bvh_hit                hit;
+    if (!state || !bvh_nearest(renderer_get_scene_bvh(), point, &hit))
+    {
+        return nullptr;
+    }
+    if (out_distance)
+    {
+        *out_distance = hit.distance;
+    }
+    return state->scene_geometries[hit.item];
+}
+
 bool renderer_resize()
 {
     if (renderer_system_state_ptr && renderer_system_state_ptr->vulkan_backend_state)
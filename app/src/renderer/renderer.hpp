@@ -8,8 +8,25 @@ bool renderer_system_startup(arena* system_arena, arena* resource_arena, struct
 void renderer_system_shutdown();
 bool renderer_resize();
 
+// the 3D geometry in data is frustum culled before it goes to the backend, only what can end up on screen is drawn.
 void renderer_draw_frame(struct render_data *data);
 
+struct renderer_cull_stats
+{
+    u32 tested;
+    u32 visible;
+    u32 culled;
+};
+// counts of the last frame that was drawn.
+renderer_cull_stats renderer_get_cull_stats();
+
+// the 3D geometry whose world box is the first one under the window pixel x, y, or nullptr. Goes by the boxes in the
+// scene bvh of the last frame drawn, there are no triangles on the cpu side to test. Boxes the camera is in are
+// skipped, so the floor and walls around it dont swallow every click. out_distance is in world units, can be nullptr.
+geometry *renderer_pick_geometry(s32 x, s32 y, f32 *out_distance);
+// the 3D geometry whose world box is closest to point, 0 distance for boxes point is in.
+geometry *renderer_nearest_geometry(vec3 point, f32 *out_distance);
+
 bool renderer_update_global_data(shader* shader, u32 offset, u32 size, void* data);
 bool renderer_update_globals(shader* shader, darray<u32>& sizes);
 
@@ -27,7 +27,7 @@ bool font_system_initialize(arena *system_arena, arena* resource_arena)
     DASSERT(system_arena);
     DASSERT(resource_arena);
 
-    font_sys_state_ptr = static_cast<font_system_state *>(dallocate(system_arena, sizeof(font_system_state), MEM_TAG_APPLICATION));
+    font_sys_state_ptr = static_cast<font_system_state *>(DALLOCATE(system_arena, sizeof(font_system_state), MEM_TAG_APPLICATION));
     font_sys_state_ptr->arena = resource_arena;
 
     dstring system_font = "SystemFont.UbuntuMono";
@@ -73,13 +73,13 @@ bool font_system_load_font(dstring *font_base_name, font_data* data)
         bool result = file_open_and_read(file_full_path.c_str(), &font_buffer_size, nullptr, false);
         DASSERT(result == true);
 
-        u8 *font_buffer = static_cast<u8 *>(dallocate(arena, font_buffer_size, MEM_TAG_UNKNOWN));
+        u8 *font_buffer = static_cast<u8 *>(DALLOCATE(arena, font_buffer_size, MEM_TAG_UNKNOWN));
         result =
             file_open_and_read(file_full_path.c_str(), &font_buffer_size, reinterpret_cast<char *>(font_buffer), false);
         DASSERT(result == true);
 
         u32 font_atlas_size   = atlas_width * atlas_height;
-        u8 *font_atlas_buffer = static_cast<u8 *>(dallocate(arena, font_atlas_size, MEM_TAG_UNKNOWN));
+        u8 *font_atlas_buffer = static_cast<u8 *>(DALLOCATE(arena, font_atlas_size, MEM_TAG_UNKNOWN));
 
         bool use_sdf = false;
 
@@ -206,7 +206,7 @@ bool font_system_load_font(dstring *font_base_name, font_data* data)
     dstring base_name_plus_suffix;
     string_copy_format(base_name_plus_suffix.string, "%s%s", 0, font_base_name->c_str(), ".png");
 
-    texture_system_create_texture(&base_name_plus_suffix, IMG_FORMAT_UNORM);
+    texture_system_create_texture(base_name_plus_suffix, IMG_FORMAT_UNORM);
 
     font_atlas.albedo_map = base_name_plus_suffix;
 
@@ -214,7 +214,7 @@ bool font_system_load_font(dstring *font_base_name, font_data* data)
 
     if (!data->glyphs)
     {
-        data->glyphs = static_cast<font_glyph_data *>(dallocate(arena, sizeof(font_glyph_data) * 96, MEM_TAG_DARRAY));
+        data->glyphs = static_cast<font_glyph_data *>(DALLOCATE(arena, sizeof(font_glyph_data) * 96, MEM_TAG_DARRAY));
         data->glyph_table_length = 96;
 
         font_glyph_data *glyphs_table = data->glyphs; // ASCII 32..126
@@ -271,7 +271,7 @@ bool _parse_glyph_atlas_file(dstring *file_full_path, font_glyph_data **data, u3
     file_open_and_read(file_full_path->c_str(), &buff_size, 0, 1);
     arena *arena = font_sys_state_ptr->arena;
 
-    char *buffer = static_cast<char *>(dallocate(arena, buff_size + 1, MEM_TAG_GEOMETRY));
+    char *buffer = static_cast<char *>(DALLOCATE(arena, buff_size + 1, MEM_TAG_GEOMETRY));
     bool  result = file_open_and_read(file_full_path->c_str(), &buff_size, buffer, 1);
     DASSERT(result);
 
@@ -331,7 +331,7 @@ bool _parse_glyph_atlas_file(dstring *file_full_path, font_glyph_data **data, u3
         else if (string_compare(identifier.c_str(), "font_glyph_data_count"))
         {
             dcopy_memory(&size, ptr, sizeof(u32));
-            (*data)  = static_cast<font_glyph_data *>(dallocate(arena, size * sizeof(font_glyph_data), MEM_TAG_DARRAY));
+            (*data)  = static_cast<font_glyph_data *>(DALLOCATE(arena, size * sizeof(font_glyph_data), MEM_TAG_DARRAY));
             *length  = size;
             ptr     += sizeof(u32) + 1;
             size     = 0;
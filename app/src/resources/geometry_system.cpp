@@ -1,6 +1,7 @@
 #include "defines.hpp"
 
 #include "containers/dhashtable.hpp"
+#include "containers/dslot_map.hpp"
 
 #include "core/dclock.hpp"
 #include "core/dfile_system.hpp"
@@ -11,23 +12,32 @@
 #include "geometry_system.hpp"
 
 #include "math/dmath.hpp"
+#include "math/dvertex_batch.hpp"
 
+#include "memory/arena_snapshot.hpp"
 #include "memory/arenas.hpp"
+#include "memory/frame_arena.hpp"
 #include "platform/platform.hpp"
 #include "renderer/vulkan/vulkan_backend.hpp"
 #include "resources/font_system.hpp"
 #include "resources/material_system.hpp"
+#include "resources/obj_parser.hpp"
 #include "resources/resource_types.hpp"
 
 #include <cstring>
+#include <new>
 #include <stdio.h>
 
+// the text vertices/indices are rebuilt every frame in the frame arena, this caps how many glyph quads fit.
+#define MAX_TEXT_QUADS_PER_FRAME 4096
+
 struct geometry_system_state
 {
-    darray<dstring>      loaded_geometry;
-    dhashtable<geometry> hashtable;
-    u64                  default_geo_id;
-    arena               *arena;
+    // geometry ids are handles into the slot map, only named geometry is in the hashtable.
+    dslot_map<geometry>      geometries;
+    dhashtable<dslot_handle> hashtable;
+    u64                      default_geo_id;
+    arena                   *arena;
 
     // HACK:
 
@@ -42,13 +52,21 @@ struct geometry_system_state
 static geometry_system_state *geo_sys_state_ptr;
 bool                          geometry_system_create_default_geometry();
 
+// name -> handle -> geometry, nullptr if there is no geometry by that name.
+static geometry *geometry_system_lookup(string_id id)
+{
+    dslot_handle *handle = geo_sys_state_ptr->hashtable.try_find(id);
+    return handle ? geo_sys_state_ptr->geometries.get(*handle) : nullptr;
+}
+
 // this will allocate and write size back, assumes the caller will call free once the data is processed
 static void geometry_system_parse_obj(arena *arena, const char *obj_file_full_path, u32 *num_of_objects,
                                       geometry_config **geo_configs);
 static bool destroy_geometry_config(geometry_config *config);
 static bool geometry_system_write_configs_to_file(dstring *file_full_path, u32 geometry_config_count,
                                                   geometry_config *configs);
-static bool geometry_system_parse_bin_file(dstring *file_name, u32 *geometry_config_count, geometry_config **configs);
+static bool geometry_system_parse_bin_file(arena *arena, dstring *file_name, u32 *geometry_config_count,
+                                           geometry_config **configs);
 static void calculate_tangents(geometry_config *config);
 
 bool geometry_system_initialize(arena *system_arena, arena *resource_arena)
@@ -56,22 +74,21 @@ bool geometry_system_initialize(arena *system_arena, arena *resource_arena)
     DASSERT(system_arena);
     DASSERT(resource_arena);
     geo_sys_state_ptr = static_cast<geometry_system_state *>(
-        dallocate(system_arena, sizeof(geometry_system_state), MEM_TAG_APPLICATION));
+        DALLOCATE(system_arena, sizeof(geometry_system_state), MEM_TAG_APPLICATION));
 
     geo_sys_state_ptr->hashtable.c_init(system_arena, MAX_GEOMETRIES_LOADED);
     geo_sys_state_ptr->hashtable.is_non_resizable = true;
-    geo_sys_state_ptr->loaded_geometry.reserve(system_arena);
+    geo_sys_state_ptr->geometries.init(MAX_GEOMETRIES_LOADED);
     geo_sys_state_ptr->arena = resource_arena;
 
     {
         geo_sys_state_ptr->vertex_offset_ind = 0;
         geo_sys_state_ptr->index_offset_ind  = 0;
         geo_sys_state_ptr->font_id           = INVALID_ID_64;
-        geo_sys_state_ptr->font_geometry_config.vertices =
-            dallocate(resource_arena, sizeof(vertex_2D) * MB(1), MEM_TAG_GEOMETRY);
-        geo_sys_state_ptr->font_geometry_config.indices =
-            static_cast<u32 *>(dallocate(resource_arena, sizeof(u32) * MB(1), MEM_TAG_GEOMETRY));
-        geo_sys_state_ptr->system_font = font_system_get_system_font();
+        // INFO: allocated from the frame arena on the first text of every frame.
+        geo_sys_state_ptr->font_geometry_config.vertices = nullptr;
+        geo_sys_state_ptr->font_geometry_config.indices  = nullptr;
+        geo_sys_state_ptr->system_font                   = font_system_get_system_font();
     }
 
     geometry_system_create_default_geometry();
@@ -80,22 +97,20 @@ bool geometry_system_initialize(arena *system_arena, arena *resource_arena)
 
 bool geometry_system_shutdowm()
 {
-    u32       loaded_geometry_count = geo_sys_state_ptr->loaded_geometry.size();
-    geometry *geo                   = nullptr;
-    bool      result                = false;
+    u32  loaded_geometry_count = geo_sys_state_ptr->geometries.size();
+    bool result                = false;
     for (u32 i = 0; i < loaded_geometry_count; i++)
     {
-        const char *geo_name = geo_sys_state_ptr->loaded_geometry[i].c_str();
-        geo                  = geo_sys_state_ptr->hashtable.find(geo_name);
+        geometry *geo = geo_sys_state_ptr->geometries.at(i);
 
         result = vulkan_destroy_geometry(geo);
         if (!result)
         {
-            DERROR("Failed to destroy %s geometry", geo_name);
+            DERROR("Failed to destroy %s geometry", geo->name.c_str());
         }
     }
 
-    geo_sys_state_ptr->loaded_geometry.~darray();
+    geo_sys_state_ptr->geometries.destroy();
     geo_sys_state_ptr = 0;
     return true;
 }
@@ -110,8 +125,6 @@ bool geometry_system_update_geometry(geometry_config *config, u64 id)
 
     bool result = vulkan_create_geometry(UI_RENDERPASS, geo, tris_count, sizeof(vertex_2D),
                                          static_cast<void *>(config->vertices), indices_count, config->indices);
-    geo_sys_state_ptr->hashtable.update(id, *geo);
-
     return result;
 }
 
@@ -126,6 +139,13 @@ u64 geometry_system_create_geometry(geometry_config *config, bool use_name)
     if (config->type == GEO_TYPE_3D)
     {
         calculate_tangents(config);
+        if (!config->has_bounds)
+        {
+            config->bounds = vertex_batch_bounds_3D(static_cast<vertex_3D *>(config->vertices), config->vertex_count);
+            config->has_bounds = true;
+        }
+        geo.bounds = config->bounds;
+
         result = vulkan_create_geometry(WORLD_RENDERPASS, &geo, tris_count, sizeof(vertex_3D), config->vertices,
                                         indices_count, config->indices);
     }
@@ -139,25 +159,21 @@ u64 geometry_system_create_geometry(geometry_config *config, bool use_name)
     geo.material        = config->material;
     // default model
     geo.ubo.model       = mat4();
-    // we are setting this id to INVALID_ID_64 because the hashtable will genereate an ID for us.
 
     if (!result)
     {
         DERROR("Couldnt create geometry %s.", config->name.c_str());
         return false;
     }
-    // the hashtable will create a unique id for us
+    // the id is the slot map handle, named geometry can also be found by its interned string id.
+    geo.id = geo_sys_state_ptr->geometries.insert(geo);
+
+    geo_sys_state_ptr->geometries.get(geo.id)->id = geo.id;
     if (use_name)
     {
-        geo_sys_state_ptr->hashtable.insert(config->name.c_str(), geo);
-    }
-    else
-    {
-        geo.id = geo_sys_state_ptr->hashtable.insert(INVALID_ID_64, geo);
+        geo_sys_state_ptr->hashtable.insert(string_id_intern(config->name.c_str()), geo.id);
     }
 
-    geo_sys_state_ptr->loaded_geometry.push_back(geo.name);
-
     return geo.id;
 }
 
@@ -181,9 +197,9 @@ geometry_config geometry_system_generate_quad_config(f32 width, f32 height, f32
     config.vertex_count = 4;
     config.type         = GEO_TYPE_2D;
     config.vertices =
-        static_cast<vertex_3D *>(dallocate(arena, sizeof(vertex_2D) * config.vertex_count, MEM_TAG_GEOMETRY));
+        static_cast<vertex_3D *>(DALLOCATE(arena, sizeof(vertex_2D) * config.vertex_count, MEM_TAG_GEOMETRY));
     config.index_count = 6;
-    config.indices     = static_cast<u32 *>(dallocate(arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
+    config.indices     = static_cast<u32 *>(DALLOCATE(arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
 
     vertex_2D *vertices = reinterpret_cast<vertex_2D *>(config.vertices);
 
@@ -251,9 +267,9 @@ geometry_config geometry_system_generate_plane_config(f32 width, f32 height, u32
 
     config.vertex_count = x_segment_count * y_segment_count * 4;
     config.vertices =
-        static_cast<vertex_3D *>(dallocate(arena, sizeof(vertex_3D) * config.vertex_count, MEM_TAG_GEOMETRY));
+        static_cast<vertex_3D *>(DALLOCATE(arena, sizeof(vertex_3D) * config.vertex_count, MEM_TAG_GEOMETRY));
     config.index_count = x_segment_count * y_segment_count * 6;
-    config.indices     = static_cast<u32 *>(dallocate(arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
+    config.indices     = static_cast<u32 *>(DALLOCATE(arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
 
     // TODO: This generates extra vertices, but we can always deduplicate them later.
     f32 seg_width   = width / x_segment_count;
@@ -323,15 +339,13 @@ geometry_config geometry_system_generate_plane_config(f32 width, f32 height, u32
         }
     }
 
-    string_ncopy(config.name.string, name, GEOMETRY_NAME_MAX_LENGTH);
-    config.name.str_len = strlen(name);
-    dstring mat_name    = material_name;
-    config.material     = material_system_get_from_name(&mat_name);
-    config.type         = GEO_TYPE_3D;
+    config.name     = name;
+    config.material = material_system_get_from_name(material_name);
+    config.type     = GEO_TYPE_3D;
     return config;
 }
 
-geometry_config *geometry_system_generate_config(dstring obj_file_name)
+geometry_config *geometry_system_generate_config(dstring_view obj_file_name)
 {
     dstring file_full_path;
     dstring bin_file_full_path;
@@ -339,7 +353,8 @@ geometry_config *geometry_system_generate_config(dstring obj_file_name)
     const char *prefix = "../assets/meshes/";
     const char *suffix = ".bin";
 
-    string_copy_format(file_full_path.string, "%s%s", 0, prefix, obj_file_name.c_str());
+    string_copy_format(file_full_path.string, "%s%.*s", 0, prefix, static_cast<s32>(obj_file_name.length),
+                       obj_file_name.data);
     string_copy_format(bin_file_full_path.string, "%s%s", 0, file_full_path.c_str(), suffix);
 
     geometry_config *config      = nullptr;
@@ -351,7 +366,7 @@ geometry_config *geometry_system_generate_config(dstring obj_file_name)
 
     if (result)
     {
-        result = geometry_system_parse_bin_file(&bin_file_full_path, &num_objects, &config);
+        result = geometry_system_parse_bin_file(geo_sys_state_ptr->arena, &bin_file_full_path, &num_objects, &config);
         DASSERT(result);
     }
     else
@@ -384,10 +399,10 @@ geometry_config geometry_system_generate_cube_config()
     config.name         = DEFAULT_GEOMETRY_HANDLE;
     config.vertex_count = 4 * 6; // 4 verts per side, 6 sides
     config.vertices     = static_cast<vertex_3D *>(
-        dallocate(geo_sys_state_ptr->arena, sizeof(vertex_3D) * config.vertex_count, MEM_TAG_GEOMETRY));
+        DALLOCATE(geo_sys_state_ptr->arena, sizeof(vertex_3D) * config.vertex_count, MEM_TAG_GEOMETRY));
     config.index_count = 6 * 6; // 6 indices per side, 6 sides
     config.indices =
-        static_cast<u32 *>(dallocate(geo_sys_state_ptr->arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
+        static_cast<u32 *>(DALLOCATE(geo_sys_state_ptr->arena, sizeof(u32) * config.index_count, MEM_TAG_GEOMETRY));
     config.type = GEO_TYPE_3D;
 
     f32 half_width  = width * 0.5f;
@@ -518,7 +533,8 @@ bool geometry_system_create_default_geometry()
 
     if (result)
     {
-        result = geometry_system_parse_bin_file(&bin_file, &num_of_objects, &default_geo_configs);
+        result = geometry_system_parse_bin_file(geo_sys_state_ptr->arena, &bin_file, &num_of_objects,
+                                                &default_geo_configs);
         DASSERT(result);
     }
     else
@@ -550,7 +566,7 @@ bool geometry_system_create_default_geometry()
 
 geometry *geometry_system_get_geometry(u64 id)
 {
-    geometry *geo = geo_sys_state_ptr->hashtable.find(id);
+    geometry *geo = geo_sys_state_ptr->geometries.get(id);
 
     if (!geo)
     {
@@ -562,15 +578,14 @@ geometry *geometry_system_get_geometry(u64 id)
     return geo;
 }
 
-geometry *geometry_system_get_geometry_by_name(dstring geometry_name)
+geometry *geometry_system_get_geometry_by_name(dstring_view geometry_name)
 {
-    const char *name = geometry_name.c_str();
-    geometry   *geo  = geo_sys_state_ptr->hashtable.find(name);
+    geometry *geo = geometry_system_lookup(string_id_hash(geometry_name.data, geometry_name.length));
     if (!geo)
     {
-        DWARN("Geometry %s not loaded yet.Load it first by calling geometry_system_create_geometry. Returning "
+        DWARN("Geometry %.*s not loaded yet.Load it first by calling geometry_system_create_geometry. Returning "
               "default_geometry",
-              name);
+              static_cast<s32>(geometry_name.length), geometry_name.data);
         return geometry_system_get_default_geometry();
     }
     geo->reference_count++;
@@ -581,7 +596,7 @@ geometry *geometry_system_get_default_geometry()
 {
 
     u64       default_id = geo_sys_state_ptr->default_geo_id;
-    geometry *geo        = geo_sys_state_ptr->hashtable.find(default_id);
+    geometry *geo        = geo_sys_state_ptr->geometries.get(default_id);
     if (!geo)
     {
         DERROR("Default geometry is not loaded yet. How is this possible?? Make sure that you have initialzed the "
@@ -594,7 +609,7 @@ geometry *geometry_system_get_default_geometry()
 
 geometry *geometry_system_get_default_plane()
 {
-    geometry *geo = geo_sys_state_ptr->hashtable.find(DEFAULT_PLANE_HANDLE);
+    geometry *geo = geometry_system_lookup(DEFAULT_PLANE_ID);
     if (!geo)
     {
         DERROR(
@@ -632,21 +647,20 @@ void geometry_system_copy_config(geometry_config *dst_config, const geometry_con
     }
     arena *arena = geo_sys_state_ptr->arena;
 
-    dcopy_memory(dst_config->name.string, src_config->name.string, src_config->name.str_len);
-    dst_config->name.str_len = src_config->name.str_len;
+    dst_config->name = src_config->name;
 
     dst_config->vertex_count = src_config->vertex_count;
     dst_config->vertices =
-        static_cast<vertex_3D *>(dallocate(arena, sizeof(vertex_3D) * src_config->vertex_count, MEM_TAG_GEOMETRY));
+        static_cast<vertex_3D *>(DALLOCATE(arena, sizeof(vertex_3D) * src_config->vertex_count, MEM_TAG_GEOMETRY));
     dcopy_memory(dst_config->vertices, src_config->vertices, src_config->vertex_count * sizeof(vertex_3D));
 
     dst_config->index_count = src_config->index_count;
-    dst_config->indices = static_cast<u32 *>(dallocate(arena, sizeof(u32) * src_config->index_count, MEM_TAG_GEOMETRY));
+    dst_config->indices = static_cast<u32 *>(DALLOCATE(arena, sizeof(u32) * src_config->index_count, MEM_TAG_GEOMETRY));
     dcopy_memory(dst_config->indices, src_config->indices, src_config->index_count * sizeof(u32));
 
     if (src_config->material)
     {
-        dst_config->material = material_system_get_from_name(&src_config->material->name);
+        dst_config->material = material_system_get_from_name(src_config->material->name);
     }
 
     return;
@@ -671,444 +685,141 @@ void get_random_string(char *out_string)
 
     return;
 }
-//
-// this will allocate and write size back, assumes the caller will call free once the data is processed
-
+// the parsing is in obj_parser.cpp, the engine names every object and looks its usemtl line up in the material system.
 void geometry_system_parse_obj(arena *arena, const char *obj_file_full_path, u32 *num_of_objects,
                                geometry_config **geo_configs)
 {
-    DTRACE("parsing file %s.", obj_file_full_path);
-    dclock telemetry;
-    clock_start(&telemetry);
+    obj_parse_file(arena, obj_file_full_path, material_system_get_from_name, num_of_objects, geo_configs);
 
-    u64 buffer_mem_requirements = -1;
-    file_open_and_read(obj_file_full_path, &buffer_mem_requirements, 0, 0);
-    if (buffer_mem_requirements == INVALID_ID_64)
+    char random_name[MAX_KEY_LENGTH] = {};
+    for (u32 i = 0; i < *num_of_objects; i++)
     {
-        DERROR("Failed to get size requirements for %s", obj_file_full_path);
-        return;
+        get_random_string(random_name);
+        (*geo_configs)[i].name = random_name;
     }
-    DASSERT(buffer_mem_requirements != INVALID_ID_64);
-
-    char *buffer = static_cast<char *>(dallocate(arena, buffer_mem_requirements + 1, MEM_TAG_GEOMETRY));
-    char *start  = buffer;
+}
 
-    file_open_and_read(obj_file_full_path, &buffer_mem_requirements, buffer, 0);
+// INFO: the geometry configs of an obj in the resource snapshot. The blob is an array of these followed by the vertex and
+// index data, the offsets are from the start of the blob. The configs are recorded as parsed, before the scale hack.
+struct geometry_snapshot_record
+{
+    char      name[GEOMETRY_NAME_MAX_LENGTH];
+    char      material_name[MATERIAL_NAME_MAX_LENGTH];
+    u32       type;
+    u32       vertex_count;
+    u32       index_count;
+    u32       has_bounds;
+    bounds_3D bounds;
+    u64       vertices_offset;
+    u64       indices_offset;
+};
 
-    // TODO: cleaup this piece of shit code
-    u32 objects        = string_num_of_substring_occurence(buffer, "o ");
-    u32 usemtl_objects = string_num_of_substring_occurence(buffer, "usemtl");
+static u64 geometry_snapshot_align(u64 offset)
+{
+    return (offset + ARENA_SNAPSHOT_BLOB_ALIGNMENT - 1) & ~static_cast<u64>(ARENA_SNAPSHOT_BLOB_ALIGNMENT - 1);
+}
 
-    bool usemtl_name = true;
-    if (usemtl_objects < objects)
+static void geometry_system_record_snapshot(const char *key, arena_snapshot_source source,
+                                            const geometry_config *configs, u32 count)
+{
+    if (!arena_snapshot_is_recording())
     {
-        usemtl_name = false;
+        return;
     }
-    objects = DMAX(objects, usemtl_objects);
 
-    *num_of_objects = objects;
-
-    *geo_configs =
-        static_cast<geometry_config *>(dallocate(arena, sizeof(geometry_config) * objects, MEM_TAG_GEOMETRY));
-
-    clock_update(&telemetry);
-    f64 names_proccesing_start_time = telemetry.time_elapsed;
+    u64 size = geometry_snapshot_align(sizeof(geometry_snapshot_record) * count);
+    for (u32 i = 0; i < count; i++)
     {
-        char *object_name_ptr      = buffer;
-        char *next_object_name_ptr = nullptr;
-        char *object_usemtl_name   = nullptr;
-
-        auto extract_name = [](char *dest, const char *src) -> u32 {
-            u32 j = 0;
-            while (*src != '\n' && *src != '\r')
-            {
-                if (*src == ' ')
-                {
-                    src++;
-                    continue;
-                }
-                dest[j++] = *src;
-                src++;
-            }
-            return j;
-        };
-        u32 j = 0;
-        for (u32 i = 0; i < objects; i++)
-        {
-            object_name_ptr = strstr(object_name_ptr, "o ");
-            if (object_name_ptr == nullptr)
-            {
-                break;
-            }
-            object_name_ptr        += 2;
-            (*geo_configs)[i].type  = GEO_TYPE_3D;
-
-            next_object_name_ptr = strstr(object_name_ptr, "o ");
-            if (next_object_name_ptr == nullptr)
-            {
-                next_object_name_ptr = buffer + buffer_mem_requirements;
-            }
-
-            if (usemtl_name)
-            {
-                object_usemtl_name = object_name_ptr;
-                while ((object_usemtl_name = strstr(object_usemtl_name, "usemtl")) && object_usemtl_name != nullptr &&
-                       object_usemtl_name < next_object_name_ptr)
-                {
-                    dstring material_name  = {};
-                    object_usemtl_name    += 6;
-                    u32 size               = extract_name(material_name.string, object_usemtl_name);
-                    get_random_string((*geo_configs)[j].name.string);
-                    (*geo_configs)[j].name.str_len  = MAX_KEY_LENGTH - 1;
-                    (*geo_configs)[j++].material    = material_system_get_from_name(&material_name);
-                    object_usemtl_name             += size;
-                }
-            }
-            else
-            {
-                get_random_string((*geo_configs)[j++].name.string);
-                //(*geo_configs)[i].material = material_system_get_default_material();
-            }
-        }
+        size += geometry_snapshot_align(sizeof(vertex_3D) * configs[i].vertex_count);
+        size += geometry_snapshot_align(sizeof(u32) * configs[i].index_count);
     }
 
-    clock_update(&telemetry);
-    f64 names_proccesing_end_time = telemetry.time_elapsed - names_proccesing_start_time;
-    DTRACE("names proccesing took %fs.\n", names_proccesing_end_time);
-
-    char *vert_ptr            = buffer;
-    char  vert_substring[3]   = "v ";
-    u32   vert_substring_size = 2;
-
-    char *vert_            = buffer;
-    u32   vertex_count_obj = string_num_of_substring_occurence(vert_, vert_substring) + 1;
+    arena_scope               scratch(scratch_arena_get());
+    u8                       *blob    = static_cast<u8 *>(DALLOCATE(scratch.owner, size, MEM_TAG_GEOMETRY));
+    geometry_snapshot_record *records = reinterpret_cast<geometry_snapshot_record *>(blob);
+    dzero_memory(blob, size);
 
-    vert_ptr  = const_cast<char *>(string_first_string_occurence(vert_ptr, vert_substring));
-    vert_ptr += vert_substring_size;
-
-    vec3 *vert_coords = static_cast<vec3 *>(dallocate(arena, sizeof(vec3) * vertex_count_obj, MEM_TAG_GEOMETRY));
-
-    u32 vert_processed = 0;
-    clock_update(&telemetry);
-    f64 vert_proccesing_start_time = telemetry.time_elapsed;
-
-    for (u32 i = 0; i < vertex_count_obj && vert_ptr != nullptr; i++)
+    u64 offset = geometry_snapshot_align(sizeof(geometry_snapshot_record) * count);
+    for (u32 i = 0; i < count; i++)
     {
-        char *a;
-        vert_coords[i].x = strtof(vert_ptr, &a);
-        char *b;
-        vert_coords[i].y = strtof(a, &b);
-        vert_coords[i].z = strtof(b, NULL);
-
-        vert_ptr = strstr(vert_ptr, "v ");
-
-        // if (vert_processed % 1000 == 0)
-        //{
-        //     DTRACE("Verts Processed: %d Remaining: %d", vert_processed,
-        //     vertex_count_obj - vert_processed);
-        // }
-        vert_processed++;
-        if (vert_ptr != nullptr)
-        {
-            vert_ptr += vert_substring_size;
-        }
-    }
-    clock_update(&telemetry);
-    f64 vert_proccesing_end_time = telemetry.time_elapsed;
-    f64 total_vert_time          = vert_proccesing_end_time - vert_proccesing_start_time;
-    DTRACE("%d Vertices processed in %fs.\n", vert_processed, total_vert_time);
-
-    char vert_normal[3]             = "vn";
-    u32  vert_normal_substring_size = 2;
-
-    char *norm_ptr         = buffer;
-    u32   normal_count_obj = string_num_of_substring_occurence(norm_ptr, "vn");
-
-    vec3 *normals = static_cast<vec3 *>(dallocate(arena, sizeof(vec3) * normal_count_obj, MEM_TAG_GEOMETRY));
-
-    norm_ptr  = const_cast<char *>(string_first_string_occurence(norm_ptr, vert_normal));
-    norm_ptr += vert_normal_substring_size;
+        const geometry_config    *config = &configs[i];
+        geometry_snapshot_record *record = &records[i];
 
-    u32 normal_processed = 0;
-    clock_update(&telemetry);
-    f64 norm_proccesing_start_time = telemetry.time_elapsed;
-    for (u32 i = 0; i < normal_count_obj; i++)
-    {
-        char *a;
-        normals[i].x = strtof(norm_ptr, &a);
-        char *b;
-        normals[i].y = strtof(a, &b);
-        normals[i].z = strtof(b, NULL);
-
-        norm_ptr = strstr(norm_ptr, "vn");
-        // if (normal_processed % 1000 == 0)
-        //{
-        //     DTRACE("normals Processed: %d Remaining: %d", normal_processed,
-        //     normal_count_obj - normal_processed);
-        // }
-        normal_processed++;
-        if (norm_ptr == nullptr)
+        const dstr *material_name = config->material ? &config->material->name : nullptr;
+        if (config->name.size() >= GEOMETRY_NAME_MAX_LENGTH ||
+            (material_name && material_name->size() >= MATERIAL_NAME_MAX_LENGTH))
         {
-            break;
+            DWARN("A geometry name in %s is too long for the resource snapshot, it will be parsed every time.", key);
+            return;
         }
-        norm_ptr += vert_normal_substring_size;
-    }
-    clock_update(&telemetry);
-    f64 norm_proccesing_end_time = telemetry.time_elapsed;
-    f64 total_norm_time          = norm_proccesing_end_time - norm_proccesing_start_time;
-
-    DTRACE("%d normals processed in %fs.\n", normal_processed, total_norm_time);
-
-    char vert_texture[3]             = "vt";
-    u32  vert_texture_substring_size = 2;
-
-    char *tex_ptr           = buffer;
-    u32   texture_count_obj = string_num_of_substring_occurence(tex_ptr, "vt");
-
-    vec2 *textures = static_cast<vec2 *>(dallocate(arena, sizeof(vec2) * texture_count_obj, MEM_TAG_GEOMETRY));
-
-    tex_ptr  = const_cast<char *>(string_first_string_occurence(tex_ptr, vert_texture));
-    tex_ptr += vert_texture_substring_size;
-
-    u32 texture_processed = 0;
-    clock_update(&telemetry);
-    f64 textrue_proccesing_start_time = telemetry.time_elapsed;
-    for (u32 i = 0; i < texture_count_obj; i++)
-    {
-        char *a;
-        textures[i].x = strtof(tex_ptr, &a);
-        textures[i].y = strtof(a, NULL);
-
-        tex_ptr = strstr(tex_ptr, "vt");
-        // if (texture_processed % 1000 == 0)
-        //{
-        //     DTRACE("textures Processed: %d Remaining: %d", texture_processed,
-        //     texture_count_obj - texture_processed);
-        // }
-        texture_processed++;
-        if (tex_ptr == nullptr)
+        dcopy_memory(record->name, config->name.c_str(), config->name.size());
+        if (material_name)
         {
-            break;
+            dcopy_memory(record->material_name, material_name->c_str(), material_name->size());
         }
-        tex_ptr += vert_texture_substring_size;
-    }
-
-    clock_update(&telemetry);
-    f64 textrue_proccesing_end_time = telemetry.time_elapsed;
-    f64 total_texture_time          = textrue_proccesing_end_time - textrue_proccesing_start_time;
-    DTRACE("%d Texture_coords processed in %fs.\n", texture_processed, total_texture_time);
-
-    // INFO: Experimental get all the offsets
-    u32 offsets_count = string_num_of_substring_occurence(buffer, "f ");
-    // one f represents 3 vertices 3 nromals 3 texture coords which define a
-    // triangle. So we need to have enough space for have number of 'f ' * 9
-    // indicies.Furthermore, Each object will have its max offset and min offset for vertices, textures, and normals
-    // and number of vertices for that object stored in the first 7 index of its
-    // array (i.e) 0 , 1 and 2 .. 6 . From 7 till vertices count onwards are the actual
-    // global offsets for the object.
-    u32  offsets_size = (offsets_count * 9) + (7 * objects);
-    u32 *offsets      = static_cast<u32 *>(dallocate(arena, sizeof(u32) * (offsets_size), MEM_TAG_GEOMETRY));
-
-    char *object_ptr  = const_cast<char *>(string_first_string_occurence(buffer, "o "));
-    object_ptr       += 2;
-
-    const char *usemtl_substring      = "usemtl";
-    u32         usemtl_substring_size = 6;
-
-    const char *obj_substring      = "o ";
-    u32         obj_substring_size = 3;
-
-    const char *use_string      = nullptr;
-    u32         use_string_size = INVALID_ID;
-    if (usemtl_name)
-    {
-        object_ptr       = const_cast<char *>(string_first_string_occurence(buffer, usemtl_substring));
-        object_ptr      += 6;
-        use_string       = usemtl_substring;
-        use_string_size  = usemtl_substring_size;
-    }
-    else
-    {
-        object_ptr       = const_cast<char *>(string_first_string_occurence(buffer, obj_substring));
-        object_ptr      += obj_substring_size;
-        use_string       = obj_substring;
-        use_string_size  = obj_substring_size;
+        record->type         = config->type;
+        record->vertex_count = config->vertex_count;
+        record->index_count  = config->index_count;
+        record->has_bounds   = config->has_bounds;
+        record->bounds       = config->bounds;
+
+        record->vertices_offset = offset;
+        dcopy_memory(blob + offset, config->vertices, sizeof(vertex_3D) * config->vertex_count);
+        offset                 += geometry_snapshot_align(sizeof(vertex_3D) * config->vertex_count);
+        record->indices_offset  = offset;
+        dcopy_memory(blob + offset, config->indices, sizeof(u32) * config->index_count);
+        offset += geometry_snapshot_align(sizeof(u32) * config->index_count);
     }
+    DASSERT(offset == size);
 
-    char *indices_ptr = object_ptr;
+    u32 params[4] = {count, 0, 0, 0};
+    arena_snapshot_add(SNAPSHOT_ENTRY_GEOMETRY, key, source, params, blob, size);
+}
 
-    object_ptr = const_cast<char *>(string_first_string_occurence(object_ptr, use_string));
-    if (object_ptr == nullptr)
-    {
-        object_ptr = buffer + buffer_mem_requirements;
-    }
-    else
+// NOTE: the vertices and indices are copied into the arena, the scale hack and the tangents write into them and the
+// snapshot is mapped read only. The materials have to be loaded already.
+static bool geometry_system_load_snapshot(arena *arena, const char *key, arena_snapshot_source source,
+                                          u32 *geometry_config_count, geometry_config **configs)
+{
+    u32       params[4];
+    u64       size = 0;
+    const u8 *blob = static_cast<const u8 *>(arena_snapshot_find(SNAPSHOT_ENTRY_GEOMETRY, key, source, params, &size));
+    if (!blob)
     {
-        object_ptr += use_string_size;
+        return false;
     }
 
-    // move the pointer to the next object's offsets
-    u32   object_indices_offset = 0;
-    char *found                 = indices_ptr;
-    u32  *offset_ptr_start      = offsets;
-    u32  *offset_ptr_walk       = &offset_ptr_start[7];
-
-    u32 max_vert_for_obj      = 0;
-    u32 min_vert_for_obj      = INVALID_ID;
-    u32 max_texture_for_obj   = 0;
-    u32 min_texture_for_obj   = INVALID_ID;
-    u32 max_normal_for_obj    = 0;
-    u32 min_normal_for_obj    = INVALID_ID;
-    u32 offsets_count_for_obj = 0;
-
-    u32 object_processed  = 0;
-    u32 offsets_processed = 0;
+    u32                             count   = params[0];
+    const geometry_snapshot_record *records = reinterpret_cast<const geometry_snapshot_record *>(blob);
 
-    clock_update(&telemetry);
-    f64  offsets_proccesing_start_time = telemetry.time_elapsed;
-    bool process_final_line            = false;
-
-    while (process_final_line || indices_ptr != NULL || found != NULL)
+    *configs = static_cast<geometry_config *>(DALLOCATE(arena, sizeof(geometry_config) * count, MEM_TAG_GEOMETRY));
+    for (u32 i = 0; i < count; i++)
     {
-        found = strstr(found, "f ");
-        if (found == NULL || found > object_ptr)
-        {
-
-            offset_ptr_start[0] = min_vert_for_obj;
-            offset_ptr_start[1] = max_vert_for_obj;
-            offset_ptr_start[2] = min_texture_for_obj;
-            offset_ptr_start[3] = max_texture_for_obj;
-            offset_ptr_start[4] = min_normal_for_obj;
-            offset_ptr_start[5] = max_normal_for_obj;
-            offset_ptr_start[6] = offsets_count_for_obj;
-
-            offsets_processed += offsets_count_for_obj;
-
-            offset_ptr_start = offset_ptr_walk;
-            offset_ptr_walk  = &offset_ptr_start[7];
-
-            max_vert_for_obj      = 0;
-            min_vert_for_obj      = INVALID_ID;
-            max_texture_for_obj   = 0;
-            min_texture_for_obj   = INVALID_ID;
-            max_normal_for_obj    = 0;
-            min_normal_for_obj    = INVALID_ID;
-            offsets_count_for_obj = 0;
-
-            object_ptr = const_cast<char *>(string_first_string_occurence(object_ptr, use_string));
-            if (object_ptr == nullptr)
-            {
-                object_ptr = buffer + buffer_mem_requirements;
-            }
-            else
-            {
-                object_ptr += use_string_size;
-            }
-            object_processed++;
-            if (found == NULL)
-            {
-                break;
-            }
-        }
-        char *f = found;
-
-        u32   j    = 0;
-        u32   k    = 0;
-        char *ptr2 = f + 2;
-        char *a;
-
-        while (k < 9 && *ptr2 != '\n')
-        {
-            offset_ptr_walk[k++] = strtol(ptr2, &a, 10);
-
-            ptr2  = a;
-            *ptr2 = ' ';
-            a     = NULL;
-        }
-
-        for (u32 j = 0; j < 9; j += 3)
-        {
-            max_vert_for_obj    = DMAX(max_vert_for_obj, offset_ptr_walk[j]);
-            min_vert_for_obj    = DMIN(min_vert_for_obj, offset_ptr_walk[j]);
-            max_texture_for_obj = DMAX(max_texture_for_obj, offset_ptr_walk[j + 1]);
-            min_texture_for_obj = DMIN(min_texture_for_obj, offset_ptr_walk[j + 1]);
-            max_normal_for_obj  = DMAX(max_normal_for_obj, offset_ptr_walk[j + 2]);
-            min_normal_for_obj  = DMIN(min_normal_for_obj, offset_ptr_walk[j + 2]);
-        }
-
-        offsets_count_for_obj += 9;
-        offset_ptr_walk       += 9;
-
-        if (found != NULL)
+        const geometry_snapshot_record *record = &records[i];
+        geometry_config                *config = new (&(*configs)[i]) geometry_config();
+
+        config->name         = dstring_view(record->name, string_length(record->name));
+        config->type         = static_cast<geometry_type>(record->type);
+        config->vertex_count = record->vertex_count;
+        config->index_count  = record->index_count;
+        config->has_bounds   = record->has_bounds;
+        config->bounds       = record->bounds;
+        if (record->material_name[0])
         {
-            found += 2;
+            config->material =
+                material_system_get_from_name(dstring_view(record->material_name, string_length(record->material_name)));
         }
-        else
-        {
-            process_final_line = true;
-        }
-    }
 
-    clock_update(&telemetry);
-    f64 offsets_proccesing_end_time = telemetry.time_elapsed;
-    f64 total_offsets_time          = offsets_proccesing_end_time - offsets_proccesing_start_time;
-    DTRACE("%d offsets processed in %fs for %d objects .\n", offsets_processed, total_offsets_time, object_processed);
-
-    clock_update(&telemetry);
-    f64 object_proccesing_start_time = telemetry.time_elapsed;
-
-    u32 size_till_now = 0;
-    for (u32 object = 0; object < objects; object++)
-    {
-        u32 *offset_ptr_walk = &offsets[size_till_now + 7];
-        u32  count           = offsets[(size_till_now) + 6];
-        u32  vert_min        = offsets[size_till_now + 0];
-        u32  vert_max        = offsets[size_till_now + 1];
-        u32  tex_min         = offsets[size_till_now + 2];
-        u32  norm_min        = offsets[size_till_now + 4];
-
-        size_till_now            += (count + 7);
-        u32 vertex_count_per_obj  = vert_max - vert_min + 1;
-
-        (*geo_configs)[object].vertices =
-            static_cast<vertex_3D *>(dallocate(arena, sizeof(vertex_3D) * (count / 3), MEM_TAG_GEOMETRY));
-        (*geo_configs)[object].vertex_count = count / 3;
-        (*geo_configs)[object].indices =
-            static_cast<u32 *>(dallocate(arena, sizeof(u32) * (count / 3), MEM_TAG_GEOMETRY));
-        (*geo_configs)[object].index_count = count / 3;
-
-        vertex_3D *vertices = static_cast<vertex_3D *>((*geo_configs)[object].vertices);
-
-        u32 index_ind = 0;
-        for (u32 j = 0; j <= count - 3; j += 3)
-        {
-            u32 vert_ind = offset_ptr_walk[j] - 1;
-            u32 tex_ind  = offset_ptr_walk[j + 1] - 1;
-            u32 norm_ind = offset_ptr_walk[j + 2] - 1;
-
-            vertices[index_ind].position              = vert_coords[vert_ind];
-            vertices[index_ind].tex_coord             = textures[tex_ind];
-            vertices[index_ind].normal                = normals[norm_ind];
-            (*geo_configs)[object].indices[index_ind] = index_ind;
-            index_ind++;
-        }
-        DASSERT(index_ind == (*geo_configs)[object].index_count);
+        u64 vertices_size = sizeof(vertex_3D) * record->vertex_count;
+        u64 indices_size  = sizeof(u32) * record->index_count;
+        config->vertices  = DALLOCATE(arena, vertices_size, MEM_TAG_GEOMETRY);
+        config->indices   = static_cast<u32 *>(DALLOCATE(arena, indices_size, MEM_TAG_GEOMETRY));
+        dcopy_memory(config->vertices, blob + record->vertices_offset, vertices_size);
+        dcopy_memory(config->indices, blob + record->indices_offset, indices_size);
     }
-
-    clock_update(&telemetry);
-    f64 object_proccesing_end_time = telemetry.time_elapsed;
-    f64 total_object_time          = object_proccesing_end_time - object_proccesing_start_time;
-    DTRACE("objects proccesing took %f", total_object_time);
-
-    dfree(textures, sizeof(vec3) * texture_count_obj, MEM_TAG_UNKNOWN);
-    dfree(normals, sizeof(vec3) * normal_count_obj, MEM_TAG_UNKNOWN);
-    dfree(vert_coords, sizeof(vec3) * vertex_count_obj, MEM_TAG_UNKNOWN);
-    dfree(buffer, buffer_mem_requirements, MEM_TAG_GEOMETRY);
-
-    clock_update(&telemetry);
-    f64 elapsed = telemetry.time_elapsed;
-
-    DTRACE("Parse obj function took %fs : wtf so slow", elapsed);
+    *geometry_config_count = count;
+    DTRACE("%u geometry configs of %s came out of the resource snapshot.", count, key);
+    return true;
 }
 
 void geometry_system_get_geometries_from_file(const char *obj_file_name, const char *mtl_file_name, geometry ***geos,
@@ -1136,22 +847,29 @@ void geometry_system_get_geometries_from_file(const char *obj_file_name, const c
 
     bool result = file_exists(&bin_file_full_path);
 
-    arena *temp_arena = nullptr;
+    // the parsed configs are uploaded to the gpu below and not needed after that.
+    arena_scope scratch(scratch_arena_get());
 
-    if (result)
-    {
-        geometry_system_parse_bin_file(&bin_file_full_path, &objects, &geo_configs);
-    }
-    else
+    // the snapshot entry is keyed on the obj, the .bin is only a cache of it.
+    arena_snapshot_source source = arena_snapshot_source_of(obj_file_full_path);
+
+    if (!geometry_system_load_snapshot(scratch.owner, obj_file_full_path, source, &objects, &geo_configs))
     {
-        temp_arena = arena_get_arena();
-        geometry_system_parse_obj(temp_arena, obj_file_full_path, &objects, &geo_configs);
-        geometry_system_write_configs_to_file(&bin_file_full_path, objects, geo_configs);
+        if (result)
+        {
+            geometry_system_parse_bin_file(scratch.owner, &bin_file_full_path, &objects, &geo_configs);
+        }
+        else
+        {
+            geometry_system_parse_obj(scratch.owner, obj_file_full_path, &objects, &geo_configs);
+            geometry_system_write_configs_to_file(&bin_file_full_path, objects, geo_configs);
+        }
+        geometry_system_record_snapshot(obj_file_full_path, source, geo_configs, objects);
     }
 
     DASSERT(objects != INVALID_ID);
     arena *arena = geo_sys_state_ptr->arena;
-    *geos        = static_cast<geometry **>(dallocate(arena, sizeof(geometry *) * objects, MEM_TAG_GEOMETRY));
+    *geos        = static_cast<geometry **>(DALLOCATE(arena, sizeof(geometry *) * objects, MEM_TAG_GEOMETRY));
 
     // HACK:
     vec3 scale = {0.5, 0.5, 0.5};
@@ -1162,14 +880,11 @@ void geometry_system_get_geometries_from_file(const char *obj_file_name, const c
         scale_geometries(&geo_configs[i], scale);
         u64 id     = geometry_system_create_geometry(&geo_configs[i], false);
         (*geos)[i] = geometry_system_get_geometry(id);
+        // the configs are in the scratch arena but their names may not be.
+        destroy_geometry_config(&geo_configs[i]);
     }
     *geometry_count = objects;
-
-    if (temp_arena)
-    {
-        arena_free_arena(temp_arena);
-        temp_arena = nullptr;
-    }
+    memory_system_timeline_sample("geometry_import");
 
     return;
 }
@@ -1182,7 +897,7 @@ bool destroy_geometry_config(geometry_config *config)
     config->indices      = nullptr;
     config->vertex_count = INVALID_ID;
     config->index_count  = INVALID_ID;
-    dzero_memory(config->name.string, GEOMETRY_NAME_MAX_LENGTH);
+    config->name.clear();
     return true;
 }
 
@@ -1227,7 +942,7 @@ bool geometry_system_write_configs_to_file(dstring *file_full_path, u32 geometry
         {
             DERROR("Unknown geometry type: %d", configs[i].type);
         }
-        size = configs[i].name.str_len;
+        size = static_cast<u32>(configs[i].name.size());
         if (size)
         {
             file_write(&f, "name:", string_length("name:"));
@@ -1239,7 +954,7 @@ bool geometry_system_write_configs_to_file(dstring *file_full_path, u32 geometry
         // NOTE: thi&s is the material name and not the material itself.
         if (configs[i].material)
         {
-            size = configs[i].material->name.str_len;
+            size = static_cast<u32>(configs[i].material->name.size());
             file_write(&f, "material:", string_length("material:"));
             file_write(&f, reinterpret_cast<const char *>(&size), sizeof(u32));
             file_write(&f, configs[i].material->name.c_str(), size);
@@ -1255,6 +970,20 @@ bool geometry_system_write_configs_to_file(dstring *file_full_path, u32 geometry
                    configs[i].vertex_count * sizeof(vertex_3D));
         file_write(&f, reinterpret_cast<const char *>(&new_line), 1);
 
+        // NOTE: has to come before the indices, those flush the config when it is parsed back.
+        if (configs[i].type == GEO_TYPE_3D)
+        {
+            if (!configs[i].has_bounds)
+            {
+                configs[i].bounds =
+                    vertex_batch_bounds_3D(static_cast<vertex_3D *>(configs[i].vertices), configs[i].vertex_count);
+                configs[i].has_bounds = true;
+            }
+            file_write(&f, "bounds:", string_length("bounds:"));
+            file_write(&f, reinterpret_cast<const char *>(&configs[i].bounds), sizeof(bounds_3D));
+            file_write(&f, reinterpret_cast<const char *>(&new_line), 1);
+        }
+
         file_write(&f, "index_count:", string_length("index_count:"));
         file_write(&f, reinterpret_cast<const char *>(&configs[i].index_count), sizeof(u32));
         file_write(&f, reinterpret_cast<const char *>(&new_line), 1);
@@ -1267,16 +996,17 @@ bool geometry_system_write_configs_to_file(dstring *file_full_path, u32 geometry
     return true;
 }
 // NOTE: count and configs should be nullptr because the function will allocate it dynamically based on the bin file
-// header
-bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_config_count, geometry_config **configs)
+// header. The configs point into the file buffer so both live in the passed arena.
+bool geometry_system_parse_bin_file(arena *arena, dstring *file_full_path, u32 *geometry_config_count,
+                                    geometry_config **configs)
 {
     DASSERT(file_full_path);
+    DASSERT(arena);
 
     u64 buff_size = INVALID_ID_64;
     file_open_and_read(file_full_path->c_str(), &buff_size, 0, 1);
-    arena *arena = geo_sys_state_ptr->arena;
 
-    char *buffer = static_cast<char *>(dallocate(arena, buff_size + 1, MEM_TAG_GEOMETRY));
+    char *buffer = static_cast<char *>(DALLOCATE(arena, buff_size + 1, MEM_TAG_GEOMETRY));
     bool  result = file_open_and_read(file_full_path->c_str(), &buff_size, buffer, 1);
     DASSERT(result);
 
@@ -1331,7 +1061,12 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             dcopy_memory(&config_count, ptr, sizeof(u32));
             *geometry_config_count = config_count;
             (*configs)             = static_cast<geometry_config *>(
-                dallocate(arena, sizeof(geometry_config) * config_count, MEM_TAG_GEOMETRY));
+                DALLOCATE(arena, sizeof(geometry_config) * config_count, MEM_TAG_GEOMETRY));
+            // scratch memory like in parse_obj, and caches written before bounds existed dont have them.
+            for (u32 i = 0; i < config_count; i++)
+            {
+                new (&(*configs)[i]) geometry_config();
+            }
             ptr += sizeof(u32) + 1;
         }
         else if (string_compare(identifier.c_str(), "geo_type"))
@@ -1362,9 +1097,8 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             u32 name_len;
             dcopy_memory(&name_len, ptr, sizeof(u32));
             ptr           += sizeof(u32);
-            dstring &name  = (*configs)[index].name;
-            string_ncopy(name.string, ptr, name_len);
-            ptr += name_len + 1;
+            (*configs)[index].name  = dstring_view(ptr, name_len);
+            ptr                    += name_len + 1;
         }
         else if (string_compare(identifier.c_str(), "material"))
         {
@@ -1372,12 +1106,8 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             dcopy_memory(&name_len, ptr, sizeof(u32));
             ptr += sizeof(u32);
 
-            dstring mat_name;
-            string_ncopy(mat_name.string, ptr, name_len);
-            mat_name.str_len  = name_len;
-            ptr              += name_len + 1;
-
-            (*configs)[index].material = material_system_get_from_name(&mat_name);
+            (*configs)[index].material  = material_system_get_from_name(dstring_view(ptr, name_len));
+            ptr                        += name_len + 1;
         }
         else if (string_compare(identifier.c_str(), "vertex_count"))
         {
@@ -1387,7 +1117,7 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             (*configs)[index].vertex_count = vertex_count;
 
             u32 size                    = sizeof(vertex_3D) * vertex_count;
-            (*configs)[index].vertices  = static_cast<vertex_3D *>(dallocate(arena, size, MEM_TAG_GEOMETRY));
+            (*configs)[index].vertices  = static_cast<vertex_3D *>(DALLOCATE(arena, size, MEM_TAG_GEOMETRY));
             ptr                        += sizeof(u32) + 1;
         }
         else if (string_compare(identifier.c_str(), "vertices"))
@@ -1397,6 +1127,13 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             dcopy_memory(dst, ptr, size);
             ptr += size + 1;
         }
+        else if (string_compare(identifier.c_str(), "bounds"))
+        {
+            // caches written before the bounds were added dont have this, those get them at creation.
+            dcopy_memory(&(*configs)[index].bounds, ptr, sizeof(bounds_3D));
+            (*configs)[index].has_bounds  = true;
+            ptr                          += sizeof(bounds_3D) + 1;
+        }
         else if (string_compare(identifier.c_str(), "index_count"))
         {
             u32 index_count;
@@ -1405,7 +1142,7 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
             (*configs)[index].index_count = index_count;
 
             u32 size                   = sizeof(u32) * index_count;
-            (*configs)[index].indices  = static_cast<u32 *>(dallocate(arena, size, MEM_TAG_GEOMETRY));
+            (*configs)[index].indices  = static_cast<u32 *>(DALLOCATE(arena, size, MEM_TAG_GEOMETRY));
             ptr                       += sizeof(u32) + 1;
         }
         else if (string_compare(identifier.c_str(), "indices"))
@@ -1429,44 +1166,8 @@ bool geometry_system_parse_bin_file(dstring *file_full_path, u32 *geometry_confi
 static void calculate_tangents(geometry_config *config)
 {
     DASSERT(config);
-
-    u32 index_count = config->index_count;
-    DASSERT(index_count);
-    vertex_3D *vertices = static_cast<vertex_3D *>(config->vertices);
-    for (u32 i = 0; i < index_count; i += 3)
-    {
-        u32 i0 = config->indices[i + 0];
-        u32 i1 = config->indices[i + 1];
-        u32 i2 = config->indices[i + 2];
-
-        vec3 edge1 = vertices[i1].position - vertices[i0].position;
-        vec3 edge2 = vertices[i2].position - vertices[i0].position;
-
-        f32 deltaU1 = vertices[i1].tex_coord.x - vertices[i0].tex_coord.x;
-        f32 deltaV1 = vertices[i1].tex_coord.y - vertices[i0].tex_coord.y;
-
-        f32 deltaU2 = vertices[i2].tex_coord.x - vertices[i0].tex_coord.x;
-        f32 deltaV2 = vertices[i2].tex_coord.y - vertices[i0].tex_coord.y;
-
-        f32 dividend = (deltaU1 * deltaV2 - deltaU2 * deltaV1);
-        f32 fc       = 1.0f / dividend;
-
-        vec3 tangent =
-            (vec3){(fc * (deltaV2 * edge1.x - deltaV1 * edge2.x)), (fc * (deltaV2 * edge1.y - deltaV1 * edge2.y)),
-                   (fc * (deltaV2 * edge1.z - deltaV1 * edge2.z))};
-
-        tangent = vec3_normalized(tangent);
-
-        f32 sx = deltaU1, sy = deltaU2;
-        f32 tx = deltaV1, ty = deltaV2;
-        f32 handedness = ((tx * sy - ty * sx) < 0.0f) ? -1.0f : 1.0f;
-
-        vec4 t4 = {tangent.x, tangent.y, tangent.z, handedness};
-
-        vertices[i0].tangent = t4;
-        vertices[i1].tangent = t4;
-        vertices[i2].tangent = t4;
-    }
+    DASSERT(config->index_count);
+    vertex_batch_calculate_tangents(static_cast<vertex_3D *>(config->vertices), config->indices, config->index_count);
 }
 
 bool geometry_system_generate_text_geometry(dstring *text, vec2 position, vec4 color)
@@ -1499,6 +1200,18 @@ bool geometry_system_generate_text_geometry(dstring *text, vec2 position, vec4 c
     q2.color = color;
     q3.color = color;
 
+    if (!geo_sys_state_ptr->font_geometry_config.vertices)
+    {
+        arena *frame_arena = frame_arena_get_current();
+        geo_sys_state_ptr->font_geometry_config.vertices =
+            DALLOCATE(frame_arena, sizeof(vertex_2D) * 4 * MAX_TEXT_QUADS_PER_FRAME, MEM_TAG_GEOMETRY);
+        geo_sys_state_ptr->font_geometry_config.indices = static_cast<u32 *>(
+            DALLOCATE(frame_arena, sizeof(u32) * 6 * MAX_TEXT_QUADS_PER_FRAME, MEM_TAG_GEOMETRY));
+    }
+    // +1 for the background quad
+    DASSERT_MSG(geo_sys_state_ptr->vertex_offset_ind / 4 + text->str_len + 1 <= MAX_TEXT_QUADS_PER_FRAME,
+                "Too much text for one frame. Bump MAX_TEXT_QUADS_PER_FRAME.");
+
     vertex_2D *vertices = static_cast<vertex_2D *>(geo_sys_state_ptr->font_geometry_config.vertices);
     u32       *indices  = geo_sys_state_ptr->font_geometry_config.indices;
 
@@ -1649,6 +1362,9 @@ u64 geometry_system_flush_text_geometries()
     geo_sys_state_ptr->vertex_offset_ind                 = 0;
     geo_sys_state_ptr->font_geometry_config.vertex_count = 0;
     geo_sys_state_ptr->font_geometry_config.index_count  = 0;
+    // the buffers belong to the frame arena, next frame gets new ones.
+    geo_sys_state_ptr->font_geometry_config.vertices     = nullptr;
+    geo_sys_state_ptr->font_geometry_config.indices      = nullptr;
 
     return id;
 }
@@ -8,7 +8,7 @@ bool geometry_system_shutdowm();
 // call this first
 u64 geometry_system_create_geometry(geometry_config *config, bool use_name);
 
-geometry_config* geometry_system_generate_config(dstring obj_file_name);
+geometry_config* geometry_system_generate_config(dstring_view obj_file_name);
 
 geometry *geometry_system_get_geometry(u64 id);
 
@@ -1,12 +1,16 @@
 #include "defines.hpp"
 
-#include "containers/darray.hpp"
 #include "containers/dhashtable.hpp"
+#include "containers/dslot_map.hpp"
 #include "core/dfile_system.hpp"
 #include "core/dmemory.hpp"
+#include "core/dnumber.hpp"
 #include "core/dstring.hpp"
+#include "core/dtext_scan.hpp"
 #include "core/logger.hpp"
 #include "material_system.hpp"
+#include "memory/arena_snapshot.hpp"
+#include "memory/frame_arena.hpp"
 #include "shader_system.hpp"
 
 #include "renderer/vulkan/vulkan_backend.hpp"
@@ -14,16 +18,35 @@
 
 #include "resource_types.hpp"
 
+#include <new>
+
 
 struct material_system_state
 {
-    darray<dstring>      loaded_materials;
-    dhashtable<material> hashtable;
-    arena               *arena;
+    // the materials themselves, the hashtable only maps names to handles.
+    dslot_map<material>      materials;
+    dhashtable<dslot_handle> hashtable;
+    arena                   *arena;
 };
 
 static material_system_state *mat_sys_state_ptr;
 
+// name -> handle -> material, nullptr if it isnt loaded.
+static material *material_system_lookup(string_id id)
+{
+    dslot_handle *handle = mat_sys_state_ptr->hashtable.try_find(id);
+    return handle ? mat_sys_state_ptr->materials.get(*handle) : nullptr;
+}
+
+static void material_system_store(material *mat)
+{
+    mat->handle = mat_sys_state_ptr->materials.insert(*mat);
+
+    // the stored copy should know its own handle too.
+    mat_sys_state_ptr->materials.get(mat->handle)->handle = mat->handle;
+    mat_sys_state_ptr->hashtable.insert(mat->name_id, mat->handle);
+}
+
 bool        material_system_create_default_material();
 static bool material_system_parse_configuration_file(dstring *conf_file_name, material_config *out_config);
 
@@ -33,9 +56,9 @@ bool material_system_initialize(arena *system_arena, arena* resource_arena)
     DASSERT(system_arena);
     DASSERT(resource_arena);
 
-    mat_sys_state_ptr = static_cast<material_system_state *>(dallocate(system_arena, sizeof(material_system_state), MEM_TAG_APPLICATION));
+    mat_sys_state_ptr = static_cast<material_system_state *>(DALLOCATE(system_arena, sizeof(material_system_state), MEM_TAG_APPLICATION));
 
-    mat_sys_state_ptr->loaded_materials.reserve(system_arena);
+    mat_sys_state_ptr->materials.init(MAX_MATERIALS_LOADED);
     mat_sys_state_ptr->hashtable.c_init(system_arena, MAX_MATERIALS_LOADED);
     mat_sys_state_ptr->arena = resource_arena;
 
@@ -45,8 +68,7 @@ bool material_system_initialize(arena *system_arena, arena* resource_arena)
 }
 bool material_system_shutdown()
 {
-    u64 loaded_materials_count = MAX_MATERIALS_LOADED;
-
+    mat_sys_state_ptr->materials.destroy();
     mat_sys_state_ptr = nullptr;
     return true;
 }
@@ -57,27 +79,26 @@ material *material_system_get_from_config_file(dstring *file_base_name)
 
     material_system_parse_configuration_file(file_base_name, &base);
 
-    material *out_mat = nullptr;
-    out_mat           = mat_sys_state_ptr->hashtable.find(base.mat_name.c_str());
+    string_id id      = string_id_hash(base.mat_name.c_str());
+    material *out_mat = material_system_lookup(id);
 
     if (out_mat == nullptr)
     {
         DTRACE("Material:%s not loaded yet. Loading it...", file_base_name->c_str());
         material_system_create_material(&base, shader_system_get_default_material_shader_id());
+        out_mat = material_system_lookup(id);
     }
-
-    out_mat = mat_sys_state_ptr->hashtable.find(base.mat_name.c_str());
     return out_mat;
 };
 
 material *material_system_acquire_from_config(material_config *config)
 {
 
-    material *out_mat = mat_sys_state_ptr->hashtable.find(config->mat_name.c_str());
+    material *out_mat = material_system_lookup(string_id_hash(config->mat_name.c_str()));
     if (out_mat == nullptr)
     {
         DERROR("No Material by the name of %s. Maybe you havenet loaded it yet. Returning default Material",
-               config->mat_name);
+               config->mat_name.c_str());
         out_mat = material_system_get_default_material();
     }
     return out_mat;
@@ -88,7 +109,8 @@ bool material_system_create_material(material_config *config, u64 shader_id)
 
     material mat{};
     mat.name            = config->mat_name;
-    mat.id              = mat_sys_state_ptr->hashtable.size();
+    mat.name_id         = string_id_intern(config->mat_name.c_str());
+    mat.id              = static_cast<u32>(mat_sys_state_ptr->materials.size());
     mat.reference_count = 0;
     mat.map.diffuse     = texture_system_get_texture(config->albedo_map.c_str());
     mat.map.normal      = texture_system_get_texture(config->normal_map.c_str());
@@ -97,10 +119,9 @@ bool material_system_create_material(material_config *config, u64 shader_id)
 
     bool result = vulkan_create_material(&mat, shader_id);
 
-    mat_sys_state_ptr->hashtable.insert(config->mat_name.c_str(), mat);
-    mat_sys_state_ptr->loaded_materials.push_back(config->mat_name);
+    material_system_store(&mat);
 
-    DTRACE("Material %s created", config->mat_name);
+    DTRACE("Material %s created", config->mat_name.c_str());
 
     return true;
 }
@@ -110,90 +131,182 @@ bool material_system_create_default_material()
     {
         material default_mat{};
         default_mat.name            = DEFAULT_MATERIAL_HANDLE;
+        default_mat.name_id         = string_id_intern(DEFAULT_MATERIAL_HANDLE);
         default_mat.id              = 0;
         default_mat.reference_count = 0;
-        default_mat.map.diffuse     = texture_system_get_texture(DEFAULT_ALBEDO_TEXTURE_HANDLE);
-        default_mat.map.normal      = texture_system_get_texture(DEFAULT_NORMAL_TEXTURE_HANDLE);
-        default_mat.map.specular    = texture_system_get_texture(DEFAULT_ALBEDO_TEXTURE_HANDLE);
+        default_mat.map.diffuse     = texture_system_get_texture_by_id(DEFAULT_ALBEDO_TEXTURE_ID);
+        default_mat.map.normal      = texture_system_get_texture_by_id(DEFAULT_NORMAL_TEXTURE_ID);
+        default_mat.map.specular    = texture_system_get_texture_by_id(DEFAULT_ALBEDO_TEXTURE_ID);
         default_mat.diffuse_color   = {1.0f, 1.0f, 1.0f, 1.0f};
 
         bool result = vulkan_create_material(&default_mat, shader_system_get_default_material_shader_id());
         DASSERT(result);
 
-        mat_sys_state_ptr->hashtable.insert(DEFAULT_MATERIAL_HANDLE, default_mat);
-        mat_sys_state_ptr->loaded_materials.push_back(DEFAULT_MATERIAL_HANDLE);
+        material_system_store(&default_mat);
     }
     {
         material default_light_mat{};
         default_light_mat.name            = DEFAULT_LIGHT_MATERIAL_HANDLE;
+        default_light_mat.name_id         = string_id_intern(DEFAULT_LIGHT_MATERIAL_HANDLE);
         default_light_mat.id              = 0;
         default_light_mat.reference_count = 0;
-        default_light_mat.map.diffuse     = texture_system_get_texture(DEFAULT_ALBEDO_TEXTURE_HANDLE);
-        default_light_mat.map.normal      = texture_system_get_texture(DEFAULT_NORMAL_TEXTURE_HANDLE);
-        default_light_mat.map.specular    = texture_system_get_texture(DEFAULT_ALBEDO_TEXTURE_HANDLE);
+        default_light_mat.map.diffuse     = texture_system_get_texture_by_id(DEFAULT_ALBEDO_TEXTURE_ID);
+        default_light_mat.map.normal      = texture_system_get_texture_by_id(DEFAULT_NORMAL_TEXTURE_ID);
+        default_light_mat.map.specular    = texture_system_get_texture_by_id(DEFAULT_ALBEDO_TEXTURE_ID);
 
         default_light_mat.diffuse_color = {1.0f, 1.0f, 1.0f, 1.0f};
 
         bool result = vulkan_create_material(&default_light_mat, shader_system_get_default_material_shader_id());
         DASSERT(result);
 
-        mat_sys_state_ptr->hashtable.insert(DEFAULT_LIGHT_MATERIAL_HANDLE, default_light_mat);
-        mat_sys_state_ptr->loaded_materials.push_back(DEFAULT_LIGHT_MATERIAL_HANDLE);
+        material_system_store(&default_light_mat);
     }
     // HACK:
     // create skybox
     {
         material skybox{};
         skybox.name            = DEFAULT_CUBEMAP_TEXTURE_HANDLE;
+        skybox.name_id         = string_id_intern(DEFAULT_CUBEMAP_TEXTURE_HANDLE);
         skybox.id              = 0;
         skybox.reference_count = 0;
-        skybox.map.diffuse     = texture_system_get_texture(DEFAULT_CUBEMAP_TEXTURE_HANDLE);
+        skybox.map.diffuse     = texture_system_get_texture_by_id(DEFAULT_CUBEMAP_TEXTURE_ID);
         skybox.map.normal      = nullptr;
         skybox.map.specular    = nullptr;
 
         bool result = vulkan_create_cubemap(&skybox);
         DASSERT(result);
 
-        mat_sys_state_ptr->hashtable.insert(DEFAULT_CUBEMAP_TEXTURE_HANDLE, skybox);
-        mat_sys_state_ptr->loaded_materials.push_back(DEFAULT_CUBEMAP_TEXTURE_HANDLE);
+        material_system_store(&skybox);
     }
     return true;
 }
 
 material *material_system_get_default_material()
 {
-    material *default_mat = mat_sys_state_ptr->hashtable.find(DEFAULT_MATERIAL_HANDLE);
+    material *default_mat = material_system_lookup(DEFAULT_MATERIAL_ID);
     default_mat->reference_count++;
     return default_mat;
 }
 
-bool material_system_release_materials(dstring *mat_name)
+// the other records dont move, only the geometries using this material are left pointing at an empty slot.
+bool material_system_release_materials(dstring_view material_name)
 {
-    const char *material_name = mat_name->c_str();
-
-    bool found = mat_sys_state_ptr->hashtable.erase(material_name);
+    string_id     id     = string_id_hash(material_name.data, material_name.length);
+    dslot_handle *handle = mat_sys_state_ptr->hashtable.try_find(id);
+    bool          found  = handle && mat_sys_state_ptr->materials.erase(*handle);
+    if (handle)
+    {
+        mat_sys_state_ptr->hashtable.erase(id);
+    }
 
     if (!found)
     {
-        DERROR("Couldn't find and release material %s. Have you made sure that you have loaded it correctly?",
-               material_name);
+        DERROR("Couldn't find and release material %.*s. Have you made sure that you have loaded it correctly?",
+               static_cast<s32>(material_name.length), material_name.data);
         return false;
     }
     return true;
 }
-material *material_system_get_from_name(dstring *material_name)
+
+material *material_system_get_from_name(dstring_view material_name)
 {
+    return material_system_get_from_string_id(string_id_hash(material_name.data, material_name.length));
+}
 
-    material *out_mat = mat_sys_state_ptr->hashtable.find(material_name->c_str());
+material *material_system_get_from_string_id(string_id id)
+{
+    material *out_mat = material_system_lookup(id);
     if (out_mat == nullptr)
     {
+        const char *material_name = string_id_get_string(id);
         DERROR("No Material by the name of %s. Maybe you havenet loaded it yet. Returning default Material",
-               material_name->c_str());
+               material_name ? material_name : "<not interned>");
         out_mat = material_system_get_default_material();
     }
     return out_mat;
 }
 
+// INFO: the material configs of an mtl file in the resource snapshot are an array of these. The names are fixed size so
+// the records are used straight out of the mapped file.
+struct material_snapshot_record
+{
+    char mat_name[MATERIAL_NAME_MAX_LENGTH];
+    char albedo_map[MATERIAL_NAME_MAX_LENGTH];
+    char alpha_map[MATERIAL_NAME_MAX_LENGTH];
+    char normal_map[MATERIAL_NAME_MAX_LENGTH];
+    char specular_map[MATERIAL_NAME_MAX_LENGTH];
+    vec4 diffuse_color;
+};
+
+// dest is zeroed, false if the name doesnt fit.
+static bool material_snapshot_copy_name(char *dest, const dstr &name)
+{
+    if (name.size() >= MATERIAL_NAME_MAX_LENGTH)
+    {
+        return false;
+    }
+    dcopy_memory(dest, name.c_str(), name.size());
+    return true;
+}
+
+static void material_system_record_snapshot(const char *full_path, arena_snapshot_source source,
+                                            const material_config *configs, s32 count)
+{
+    if (!arena_snapshot_is_recording())
+    {
+        return;
+    }
+    arena_scope               scratch(scratch_arena_get());
+    u64                       size    = sizeof(material_snapshot_record) * count;
+    material_snapshot_record *records = static_cast<material_snapshot_record *>(
+        DALLOCATE(scratch.owner, size, MEM_TAG_RENDERER));
+    dzero_memory(records, size);
+    for (s32 i = 0; i < count; i++)
+    {
+        material_snapshot_record *record = &records[i];
+        const material_config    *config = &configs[i];
+        bool fits = material_snapshot_copy_name(record->mat_name, config->mat_name) &&
+                    material_snapshot_copy_name(record->albedo_map, config->albedo_map) &&
+                    material_snapshot_copy_name(record->alpha_map, config->alpha_map) &&
+                    material_snapshot_copy_name(record->normal_map, config->normal_map) &&
+                    material_snapshot_copy_name(record->specular_map, config->specular_map);
+        if (!fits)
+        {
+            DWARN("A material name in %s is too long for the resource snapshot, it will be parsed every time.",
+                  full_path);
+            return;
+        }
+        record->diffuse_color = config->diffuse_color;
+    }
+    arena_snapshot_add(SNAPSHOT_ENTRY_MATERIALS, full_path, source, nullptr, records, size);
+}
+
+// the materials of the mtl file out of the resource snapshot, false if it doesnt have them.
+static bool material_system_load_snapshot(const char *full_path, arena_snapshot_source source)
+{
+    u64                             size    = 0;
+    const material_snapshot_record *records = static_cast<const material_snapshot_record *>(
+        arena_snapshot_find(SNAPSHOT_ENTRY_MATERIALS, full_path, source, nullptr, &size));
+    if (!records)
+    {
+        return false;
+    }
+    u64 count = size / sizeof(material_snapshot_record);
+    for (u64 i = 0; i < count; i++)
+    {
+        material_config config;
+        config.mat_name      = records[i].mat_name;
+        config.albedo_map    = records[i].albedo_map;
+        config.alpha_map     = records[i].alpha_map;
+        config.normal_map    = records[i].normal_map;
+        config.specular_map  = records[i].specular_map;
+        config.diffuse_color = records[i].diffuse_color;
+        material_system_create_material(&config, shader_system_get_default_material_shader_id());
+    }
+    DTRACE("%llu materials of %s came out of the resource snapshot.", count, full_path);
+    return true;
+}
+
 bool material_system_parse_mtl_file(dstring *mtl_file_name)
 {
     DASSERT(mtl_file_name);
@@ -204,127 +317,89 @@ bool material_system_parse_mtl_file(dstring *mtl_file_name)
     dstring full_file_path;
     string_copy_format(full_file_path.string, "%s%s", 0, prefix, mtl_file_name->c_str());
 
+    arena_snapshot_source source = arena_snapshot_source_of(full_file_path.c_str());
+    if (material_system_load_snapshot(full_file_path.c_str(), source))
+    {
+        return true;
+    }
+
     arena *arena = mat_sys_state_ptr->arena;
 
     char *file                         = nullptr;
     u64   file_buffer_mem_requirements = INVALID_ID_64;
 
     file_open_and_read(full_file_path.c_str(), &file_buffer_mem_requirements, 0, 0);
-    file = static_cast<char *>(dallocate(arena, file_buffer_mem_requirements + 1, MEM_TAG_RENDERER));
-    file_open_and_read(full_file_path.c_str(), &file_buffer_mem_requirements, file, 0);
-
     DASSERT(file_buffer_mem_requirements != INVALID_ID_64);
+    file = static_cast<char *>(DALLOCATE(arena, file_buffer_mem_requirements + 1, MEM_TAG_RENDERER));
+    file_open_and_read(full_file_path.c_str(), &file_buffer_mem_requirements, file, 0);
+    file[file_buffer_mem_requirements] = '\0';
 
-    u32 real_size = string_length(file);
-
-    const char *eof = file + file_buffer_mem_requirements;
-
-    s32 num_materials = string_num_of_substring_occurence(file, "newmtl");
+    s32 num_materials = static_cast<s32>(text_count_keyword(file, file_buffer_mem_requirements, "newmtl"));
     if (num_materials <= 0)
     {
-        DERROR("No newmtl defined in %s file", mtl_file_name);
+        DERROR("No newmtl defined in %s file", mtl_file_name->c_str());
         return false;
     }
     configs =
-        static_cast<material_config *>(dallocate(arena, sizeof(material_config) * (num_materials), MEM_TAG_RENDERER));
+        static_cast<material_config *>(DALLOCATE(arena, sizeof(material_config) * (num_materials), MEM_TAG_RENDERER));
+    // constructed like the destructor below expects, zeroes would also lose the white diffuse_color default.
+    for (s32 i = 0; i < num_materials; i++)
+    {
+        new (&configs[i]) material_config();
+    }
 
-    auto go_to_next_line = [](const char *ptr) -> const char * {
-        while (*ptr != '\n' && *ptr != '\r')
+    // the textures are looked up by file name, drop the directories in front of it.
+    auto file_name = [](dstring_view path) -> dstring_view {
+        u64 start = path.length;
+        while (start && path[start - 1] != '/')
         {
-            ptr++;
+            start--;
         }
-        return ptr + 1;
+        return path.substr(start, path.length - start);
     };
-    auto extract_identifier = [](const char *line, dstring &dst) {
-        u32 index = 0;
-        u32 j     = 0;
-
-        while (line[index] != ' ' && line[index] != '\0' && line[index] != '\n' && line[index] != '\r')
-        {
-            dst[j++] = line[index++];
-        }
-        dst[j++]    = '\0';
-        dst.str_len = j;
-    };
-
-    const char *ptr = file;
-    dstring     identifier;
 
     s32 index = -1;
 
-    while (ptr < eof && ptr != nullptr)
+    text_line_reader lines(file, file_buffer_mem_requirements);
+    dstring_view     line;
+    while (lines.next(&line))
     {
-        if (*ptr == '#' || *ptr == '\n' || *ptr == '\r')
-        {
-            ptr = go_to_next_line(ptr);
-            continue;
-        }
-        extract_identifier(ptr, identifier);
+        // comments and empty lines come out as an empty or "#..." identifier and match nothing.
+        dstring_view identifier = text_next_token(&line);
 
-        if (string_compare(identifier.c_str(), "newmtl"))
+        if (identifier == "newmtl")
         {
             index++;
-            ptr += identifier.str_len;
-            extract_identifier(ptr, configs[index].mat_name);
+            configs[index].mat_name = text_next_token(&line);
         }
-        else if (string_compare(identifier.c_str(), "map_Kd"))
+        else if (index < 0)
         {
-            ptr += identifier.str_len;
-            dstring full_path;
-            extract_identifier(ptr, full_path);
-            u32 size = full_path.str_len - 1;
-
-            u32     i = 0;
-            dstring stack;
-            while (size--)
-            {
-                if (full_path[size] == '/')
-                {
-                    break;
-                }
-                stack[i++] = full_path[size];
-            }
-            stack.str_len = i;
-
-            u32 j = 0;
-            for (; i > 0; i--)
-            {
-                configs[index].albedo_map[j++] = stack[i - 1];
-            }
-            configs[index].albedo_map.str_len = j;
+            continue;
         }
-        else if (string_compare(identifier.c_str(), "map_d"))
+        else if (identifier == "Kd")
         {
-            ptr += identifier.str_len;
-            dstring full_path;
-            extract_identifier(ptr, full_path);
-            u32 size = full_path.str_len - 1;
-
-            u32     i = 0;
-            dstring stack;
-            while (size--)
-            {
-                if (full_path[size] == '/')
-                {
-                    break;
-                }
-                stack[i++] = full_path[size];
-            }
-            stack.str_len = i;
-
-            u32 j = 0;
-            for (; i > 0; i--)
+            f32 color[3] = {};
+            if (number_parse_f32s(&line, color, 3) == 3)
             {
-                configs[index].alpha_map[j++] = stack[i - 1];
+                configs[index].diffuse_color = {color[0], color[1], color[2], 1.0f};
             }
-            configs[index].alpha_map.str_len = j;
         }
-        ptr = go_to_next_line(ptr);
+        else if (identifier == "map_Kd")
+        {
+            configs[index].albedo_map = file_name(text_next_token(&line));
+        }
+        else if (identifier == "map_d")
+        {
+            configs[index].alpha_map = file_name(text_next_token(&line));
+        }
     }
 
+    material_system_record_snapshot(full_file_path.c_str(), source, configs, num_materials);
     for (s32 i = 0; i < num_materials; i++)
     {
         material_system_create_material(&configs[i], shader_system_get_default_material_shader_id());
+        // gives the names that didnt fit inline back, the configs array itself stays in the arena.
+        configs[i].~material_config();
     }
 
     return true;
@@ -339,8 +414,10 @@ static bool material_system_parse_configuration_file(dstring *conf_file_name, ma
     const char *prefix = "../assets/materials/";
     string_copy_format(conf_full_path.string, "%s%s", 0, prefix, conf_file_name->c_str());
 
-    std::fstream file;
-    bool         result = file_open(conf_full_path, &file, false, false);
+    // the file buffer is only needed while parsing.
+    arena_scope scratch(scratch_arena_get());
+    file_lines  file;
+    bool        result = file_read_lines(scratch.owner, conf_full_path.c_str(), &file);
     DASSERT(result);
 
     auto go_to_colon = [](const char *line) -> const char * {
@@ -374,7 +451,7 @@ static bool material_system_parse_configuration_file(dstring *conf_file_name, ma
     };
 
     dstring line;
-    while (file_get_line(file, &line))
+    while (file_next_line(&file, &line))
     {
         // INFO: if comment skip line
         if (line[0] == '#' || line[0] == '\0' || line[0] == '\n' || line[0] == '\r')
@@ -388,9 +465,11 @@ static bool material_system_parse_configuration_file(dstring *conf_file_name, ma
         DASSERT(str);
         dstring string = str;
 
+        dstring value;
         if (string_compare(identifier.c_str(), "name"))
         {
-            extract_identifier(str, out_config->mat_name);
+            extract_identifier(str, value);
+            out_config->mat_name = value;
         }
         else if (string_compare(identifier.c_str(), "diffuse_color"))
         {
@@ -398,15 +477,18 @@ static bool material_system_parse_configuration_file(dstring *conf_file_name, ma
         }
         else if (string_compare(identifier.c_str(), "albedo_map"))
         {
-            extract_identifier(str, out_config->albedo_map);
+            extract_identifier(str, value);
+            out_config->albedo_map = value;
         }
         else if (string_compare(identifier.c_str(), "normal_map"))
         {
-            extract_identifier(str, out_config->normal_map);
+            extract_identifier(str, value);
+            out_config->normal_map = value;
         }
         else if (string_compare(identifier.c_str(), "specular_map"))
         {
-            extract_identifier(str, out_config->specular_map);
+            extract_identifier(str, value);
+            out_config->specular_map = value;
         }
         else
         {
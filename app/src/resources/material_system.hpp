@@ -8,9 +8,10 @@ bool material_system_shutdown();
 
 material *material_system_get_default_material();
 material *material_system_get_from_config_file(dstring *file_base_name);
-material *material_system_get_from_id(u32 id);
 bool      material_system_parse_mtl_file(dstring *mtl_file_name);
-material *material_system_get_from_name(dstring *material_name);
+material *material_system_get_from_name(dstring_view material_name);
+// no string hashing or compares, use this on hot paths.
+material *material_system_get_from_string_id(string_id id);
 
 // for which shader do you want the material to be applied to
 bool material_system_create_material(material_config* config, u64 shader_id);
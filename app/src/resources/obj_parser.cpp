@@ -0,0 +1,228 @@
+#include "obj_parser.hpp"
+
+#include "containers/darray.hpp"
+#include "core/dclock.hpp"
+#include "core/dfile_system.hpp"
+#include "core/dmemory.hpp"
+#include "core/dnumber.hpp"
+#include "core/dtext_scan.hpp"
+#include "core/logger.hpp"
+
+#include <new>
+
+// one corner of a face as 0 based indices into the position/tex_coord/normal lists, INVALID_ID for an attribute the
+// face didnt have.
+struct obj_corner
+{
+    u32 position;
+    u32 tex_coord;
+    u32 normal;
+};
+
+// an "o" or "usemtl" line, the object it starts runs until the next one.
+struct obj_object_start
+{
+    u64          first_corner;
+    dstring_view material_name;
+};
+
+// "7" or "-1" (counted back from the end of what has been read so far) -> 0 based, INVALID_ID if it is missing or out
+// of range.
+static u32 obj_resolve_index(dstring_view token, u64 count)
+{
+    s64 value = 0;
+    if (!number_parse_s64(token, &value) || value == 0)
+    {
+        return INVALID_ID;
+    }
+    s64 index = value < 0 ? static_cast<s64>(count) + value : value - 1;
+    return index >= 0 && index < static_cast<s64>(count) ? static_cast<u32>(index) : INVALID_ID;
+}
+
+// "v", "v/vt", "v//vn" or "v/vt/vn".
+static obj_corner obj_parse_corner(dstring_view token, u64 position_count, u64 tex_coord_count, u64 normal_count)
+{
+    dstring_view parts[3];
+    for (u32 i = 0; i < 3; i++)
+    {
+        s64 slash = token.find('/');
+        u64 end   = slash < 0 ? token.length : static_cast<u64>(slash);
+        parts[i]  = token.substr(0, end);
+        token     = token.substr(slash < 0 ? token.length : end + 1, token.length);
+    }
+    obj_corner corner;
+    corner.position  = obj_resolve_index(parts[0], position_count);
+    corner.tex_coord = obj_resolve_index(parts[1], tex_coord_count);
+    corner.normal    = obj_resolve_index(parts[2], normal_count);
+    return corner;
+}
+
+// INFO: one pass over the lines. Positions, normals, texture coords and the triangulated face corners go into growing
+// lists and the "o"/"usemtl" lines are remembered by where they are in the corner list. If there are at least as many
+// usemtl lines as o lines the objects are split per material, otherwise per o line. Faces before the first split and
+// files without any become an object of their own, objects without faces are dropped.
+void obj_parse_file(arena *arena, const char *obj_file_full_path, obj_material_lookup material_lookup,
+                    u32 *num_of_objects, geometry_config **geo_configs)
+{
+    DTRACE("parsing file %s.", obj_file_full_path);
+    dclock telemetry;
+    clock_start(&telemetry);
+
+    *num_of_objects = 0;
+    *geo_configs    = nullptr;
+
+    u64 buffer_mem_requirements = -1;
+    file_open_and_read(obj_file_full_path, &buffer_mem_requirements, 0, 0);
+    if (buffer_mem_requirements == INVALID_ID_64)
+    {
+        DERROR("Failed to get size requirements for %s", obj_file_full_path);
+        return;
+    }
+
+    char *buffer = static_cast<char *>(DALLOCATE(arena, buffer_mem_requirements + 1, MEM_TAG_GEOMETRY));
+    file_open_and_read(obj_file_full_path, &buffer_mem_requirements, buffer, 0);
+    buffer[buffer_mem_requirements] = '\0';
+
+    darray<vec3>             positions;
+    darray<vec3>             normals;
+    darray<vec2>             tex_coords;
+    darray<obj_corner>       corners;
+    darray<obj_object_start> o_starts;
+    darray<obj_object_start> usemtl_starts;
+    positions.c_init(arena);
+    normals.c_init(arena);
+    tex_coords.c_init(arena);
+    corners.c_init(arena);
+    o_starts.c_init(arena);
+    usemtl_starts.c_init(arena);
+
+    text_line_reader lines(buffer, buffer_mem_requirements);
+    dstring_view     line;
+    while (lines.next(&line))
+    {
+        dstring_view keyword = text_next_token(&line);
+        // whatever is missing from a v/vn/vt line stays 0.
+        f32 values[3] = {};
+        if (keyword == "v")
+        {
+            number_parse_f32s(&line, values, 3);
+            positions.push_back(vec3(values[0], values[1], values[2]));
+        }
+        else if (keyword == "vn")
+        {
+            number_parse_f32s(&line, values, 3);
+            normals.push_back(vec3(values[0], values[1], values[2]));
+        }
+        else if (keyword == "vt")
+        {
+            number_parse_f32s(&line, values, 2);
+            tex_coords.push_back(vec2(values[0], values[1]));
+        }
+        else if (keyword == "f")
+        {
+            // polygons are split into a fan of triangles around the first corner.
+            obj_corner   first    = {};
+            obj_corner   previous = {};
+            u32          count    = 0;
+            dstring_view token;
+            while ((token = text_next_token(&line)).length)
+            {
+                obj_corner corner =
+                    obj_parse_corner(token, positions.size(), tex_coords.size(), normals.size());
+                if (count >= 2)
+                {
+                    corners.push_back(first);
+                    corners.push_back(previous);
+                    corners.push_back(corner);
+                }
+                first    = count == 0 ? corner : first;
+                previous = corner;
+                count++;
+            }
+        }
+        else if (keyword == "o")
+        {
+            o_starts.push_back({corners.size(), dstring_view()});
+        }
+        else if (keyword == "usemtl")
+        {
+            usemtl_starts.push_back({corners.size(), line.trim()});
+        }
+    }
+
+    clock_update(&telemetry);
+    DTRACE("%llu positions, %llu normals, %llu texture coords and %llu triangles read in %fs.",
+           static_cast<unsigned long long>(positions.size()), static_cast<unsigned long long>(normals.size()),
+           static_cast<unsigned long long>(tex_coords.size()), static_cast<unsigned long long>(corners.size() / 3),
+           telemetry.time_elapsed);
+
+    bool                      usemtl_name = usemtl_starts.size() >= o_starts.size();
+    darray<obj_object_start> &starts      = usemtl_name ? usemtl_starts : o_starts;
+
+    // the object boundaries in the corner list, the faces before the first start are an object too.
+    u64 split_count = starts.size() + 1;
+    u64 objects     = 0;
+    for (u64 i = 0; i < split_count; i++)
+    {
+        u64 first = i == 0 ? 0 : starts[i - 1].first_corner;
+        u64 last  = i < starts.size() ? starts[i].first_corner : corners.size();
+        objects  += last > first;
+    }
+
+    *geo_configs =
+        static_cast<geometry_config *>(DALLOCATE(arena, sizeof(geometry_config) * objects, MEM_TAG_GEOMETRY));
+    *num_of_objects = static_cast<u32>(objects);
+    // NOTE: this is scratch memory, whatever was popped off it before is still in there. Only some of the fields get
+    // set below (no material before the first usemtl, no bounds), so every config starts from its defaults.
+    for (u64 i = 0; i < objects; i++)
+    {
+        new (&(*geo_configs)[i]) geometry_config();
+    }
+
+    u32 object = 0;
+    for (u64 i = 0; i < split_count; i++)
+    {
+        u64 first = i == 0 ? 0 : starts[i - 1].first_corner;
+        u64 last  = i < starts.size() ? starts[i].first_corner : corners.size();
+        if (last == first)
+        {
+            continue;
+        }
+        geometry_config *config = &(*geo_configs)[object++];
+        u32              count  = static_cast<u32>(last - first);
+
+        config->type = GEO_TYPE_3D;
+        if (material_lookup && usemtl_name && i > 0)
+        {
+            config->material = material_lookup(starts[i - 1].material_name);
+        }
+
+        config->vertices     = static_cast<vertex_3D *>(DALLOCATE(arena, sizeof(vertex_3D) * count, MEM_TAG_GEOMETRY));
+        config->vertex_count = count;
+        config->indices      = static_cast<u32 *>(DALLOCATE(arena, sizeof(u32) * count, MEM_TAG_GEOMETRY));
+        config->index_count  = count;
+
+        vertex_3D *vertices = static_cast<vertex_3D *>(config->vertices);
+        for (u32 j = 0; j < count; j++)
+        {
+            const obj_corner &corner = corners[first + j];
+
+            vertices[j]           = {};
+            vertices[j].position  = corner.position != INVALID_ID ? positions[corner.position] : vec3();
+            vertices[j].tex_coord = corner.tex_coord != INVALID_ID ? tex_coords[corner.tex_coord] : vec2();
+            vertices[j].normal    = corner.normal != INVALID_ID ? normals[corner.normal] : vec3();
+            config->indices[j]    = j;
+        }
+    }
+
+    dfree(usemtl_starts.data, usemtl_starts.capacity, MEM_TAG_DARRAY);
+    dfree(o_starts.data, o_starts.capacity, MEM_TAG_DARRAY);
+    dfree(corners.data, corners.capacity, MEM_TAG_DARRAY);
+    dfree(tex_coords.data, tex_coords.capacity, MEM_TAG_DARRAY);
+    dfree(normals.data, normals.capacity, MEM_TAG_DARRAY);
+    dfree(positions.data, positions.capacity, MEM_TAG_DARRAY);
+    dfree(buffer, buffer_mem_requirements + 1, MEM_TAG_GEOMETRY);
+
+    clock_update(&telemetry);
+    DTRACE("Parse obj function took %fs for %u objects.", telemetry.time_elapsed, *num_of_objects);
+}
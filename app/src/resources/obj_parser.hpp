@@ -0,0 +1,15 @@
+#pragma once
+
+#include "defines.hpp"
+#include "resources/resource_types.hpp"
+
+// INFO: the obj text format -> one geometry_config per object. It only needs the memory system, so the benches can read
+// the same meshes the engine does. Naming the objects is left to the caller.
+
+// what the usemtl line an object came from turns into, e.g. material_system_get_from_name.
+typedef material *(*obj_material_lookup)(dstring_view material_name);
+
+// vertices, indices and the config array come out of arena. material_lookup can be nullptr, then no config gets a
+// material. *num_of_objects is 0 if the file cant be read.
+void obj_parse_file(arena *arena, const char *obj_file_full_path, obj_material_lookup material_lookup,
+                    u32 *num_of_objects, geometry_config **geo_configs);
@@ -2,6 +2,8 @@
 
 #include "containers/darray.hpp"
 #include "core/dstring.hpp"
+#include "containers/dslot_map.hpp"
+#include "core/dstring_id.hpp"
 #include "defines.hpp"
 #include "main.hpp"
 
@@ -46,7 +48,7 @@ enum attribute_types
 
 struct shader_uniform_config
 {
-    dstring         name;
+    dstr            name;
     shader_stage    stage       = STAGE_UNKNOWN;
     shader_scope    scope       = SHADER_SCOPE_UNKNOWN;
     u32             set         = INVALID_ID;
@@ -58,7 +60,7 @@ struct shader_uniform_config
 // attributes can only be set for the vertex stage.
 struct shader_attribute_config
 {
-    dstring         name;
+    dstr            name;
     u32             location;
     attribute_types type;
 };
@@ -110,8 +112,8 @@ struct shader_config
     bool has_per_frame;
     bool has_per_group;
     // NOTE: we will have a push constant regardless of this flag so idk.
-    bool    has_per_object;
-    dstring name;
+    bool has_per_object;
+    dstr name;
 
     darray<shader_stage>            stages;
     darray<u32>                     per_frame_uniform_offsets;
@@ -119,8 +121,8 @@ struct shader_config
     darray<shader_uniform_config>   uniforms;
     darray<shader_attribute_config> attributes;
 
-    dstring vert_spv_full_path;
-    dstring frag_spv_full_path;
+    dstr vert_spv_full_path;
+    dstr frag_spv_full_path;
 
     shader_pipeline_configuration pipeline_configuration;
     renderpass_types              renderpass_types;
@@ -153,6 +155,10 @@ struct shader
 #define DEFAULT_ALBEDO_TEXTURE_HANDLE "DEFAULT_ALBDEO_TEXTURE"
 #define DEFAULT_NORMAL_TEXTURE_HANDLE "DEFAULT_NORMAL_TEXTURE"
 #define DEFAULT_CUBEMAP_TEXTURE_HANDLE "DEFAULT_CUBEMAP_TEXTURE"
+// the ids the systems store the default resources under, known at compile time.
+#define DEFAULT_ALBEDO_TEXTURE_ID DSID(DEFAULT_ALBEDO_TEXTURE_HANDLE)
+#define DEFAULT_NORMAL_TEXTURE_ID DSID(DEFAULT_NORMAL_TEXTURE_HANDLE)
+#define DEFAULT_CUBEMAP_TEXTURE_ID DSID(DEFAULT_CUBEMAP_TEXTURE_HANDLE)
 
 #define MAX_TEXTURES_LOADED 1024
 #define TEXTURE_NAME_MAX_LENGTH 512
@@ -167,7 +173,9 @@ enum image_format
 struct texture
 {
 
-    dstring      name;
+    dstr         name;
+    string_id    name_id      = INVALID_STRING_ID;
+    dslot_handle handle       = INVALID_SLOT_HANDLE;
     u32          id           = INVALID_ID;
     u32          width        = INVALID_ID;
     u32          height       = INVALID_ID;
@@ -183,6 +191,9 @@ struct texture
 #define DEFAULT_FONT_ATLAS_TEXTURE_HANDLE "DEFAULT_FONT_ATLAS_TEXTURE"
 // INFO: maybe name it differenlty
 #define DEFAULT_LIGHT_MATERIAL_HANDLE "default_light_material"
+#define DEFAULT_MATERIAL_ID DSID(DEFAULT_MATERIAL_HANDLE)
+#define DEFAULT_FONT_ATLAS_TEXTURE_ID DSID(DEFAULT_FONT_ATLAS_TEXTURE_HANDLE)
+#define DEFAULT_LIGHT_MATERIAL_ID DSID(DEFAULT_LIGHT_MATERIAL_HANDLE)
 #define MAX_MATERIALS_LOADED 1024
 #define MATERIAL_NAME_MAX_LENGTH 256
 
@@ -220,20 +231,22 @@ struct texture_map
 
 struct material_config
 {
-    dstring mat_name;
-    dstring albedo_map;
-    dstring alpha_map;
-    dstring normal_map;
-    dstring specular_map;
-    vec4    diffuse_color = {1.0f, 1.0f, 1.0f, 1.0f};
+    dstr mat_name;
+    dstr albedo_map;
+    dstr alpha_map;
+    dstr normal_map;
+    dstr specular_map;
+    vec4 diffuse_color = {1.0f, 1.0f, 1.0f, 1.0f};
     // TODO: add normal maps, heightmap etc..
 };
 
 struct material
 {
 
-    dstring name;
-    u32     id                  = INVALID_ID;
+    dstr         name;
+    string_id    name_id        = INVALID_STRING_ID;
+    dslot_handle handle         = INVALID_SLOT_HANDLE;
+    u32          id             = INVALID_ID;
     // WARN: should never change this
     u32 internal_id             = INVALID_ID;
     //
@@ -244,6 +257,8 @@ struct material
 
 #define DEFAULT_GEOMETRY_HANDLE "DEFAULT_GEOMETRY"
 #define DEFAULT_PLANE_HANDLE "DEFAULT_PLANE_HANDLE"
+#define DEFAULT_GEOMETRY_ID DSID(DEFAULT_GEOMETRY_HANDLE)
+#define DEFAULT_PLANE_ID DSID(DEFAULT_PLANE_HANDLE)
 #define MAX_GEOMETRIES_LOADED 1024
 #define GEOMETRY_NAME_MAX_LENGTH 256
 
@@ -256,21 +271,26 @@ enum geometry_type
 
 struct geometry_config
 {
-    dstring       name;
+    dstr          name;
     geometry_type type;
     material     *material     = nullptr;
     u32           vertex_count = INVALID_ID;
     void         *vertices     = nullptr;
     u32           index_count  = INVALID_ID;
     u32          *indices      = nullptr;
+    // 3D only. Filled in by the .bin cache, or from the vertices when the geometry is created.
+    bounds_3D     bounds;
+    bool          has_bounds = false;
 };
 
 struct geometry
 {
     u64                          id              = INVALID_ID_64;
     u32                          reference_count = INVALID_ID;
-    dstring                      name;
+    dstr                         name;
     material                    *material              = nullptr;
     void                        *vulkan_geometry_state = nullptr;
     object_uniform_buffer_object ubo;
+    // object space, ubo.model moves it into the world.
+    bounds_3D                    bounds;
 };
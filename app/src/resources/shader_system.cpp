@@ -6,6 +6,7 @@
 #include "core/dstring.hpp"
 #include "defines.hpp"
 #include "math/dmath_types.hpp"
+#include "memory/frame_arena.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/vulkan/vulkan_backend.hpp"
 #include "resources/resource_types.hpp"
@@ -38,7 +39,7 @@ bool shader_system_startup(arena *system_arena, arena *resource_arena)
     DASSERT(resource_arena);
 
     shader_sys_state_ptr =
-        static_cast<shader_system_state *>(dallocate(system_arena, sizeof(shader_system_state), MEM_TAG_APPLICATION));
+        static_cast<shader_system_state *>(DALLOCATE(system_arena, sizeof(shader_system_state), MEM_TAG_APPLICATION));
     shader_sys_state_ptr->arena = resource_arena;
 
     shader_sys_state_ptr->shaders.c_init(system_arena, MAX_SHADER_COUNT);
@@ -60,7 +61,7 @@ bool shader_system_shutdown()
     return true;
 }
 
-static u64 _create_shader(shader_config *config, shader *out_shader, shader_type type)
+static u64 _create_shader(const char *name, shader_config *config, shader *out_shader, shader_type type)
 {
     if (!config || !out_shader)
     {
@@ -71,8 +72,9 @@ static u64 _create_shader(shader_config *config, shader *out_shader, shader_type
     bool result = vulkan_initialize_shader(config, out_shader);
     DASSERT(result);
 
+    // keyed by the interned config name so the ids are the same from run to run.
     out_shader->type = type;
-    u64 id           = shader_sys_state_ptr->shaders.insert(INVALID_ID_64, *out_shader);
+    u64 id           = shader_sys_state_ptr->shaders.insert(string_id_intern(name), *out_shader);
     DASSERT(id != INVALID_ID_64);
 
     u64 config_id = shader_sys_state_ptr->shader_configs.insert(id, *config);
@@ -155,8 +157,10 @@ static void shader_parse_configuration_file(dstring conf_file_name, shader_confi
 
     arena *arena = shader_sys_state_ptr->arena;
 
-    std::fstream file;
-    bool         result = file_open(full_file_path, &file, false, false);
+    // the file buffer is only needed while parsing.
+    arena_scope scratch(scratch_arena_get());
+    file_lines  file;
+    bool        result = file_read_lines(scratch.owner, full_file_path.c_str(), &file);
     DASSERT(result);
 
     // NOTE:  this is literraly an adhoc aproach. So future me learn to write a proper parser :)
@@ -248,7 +252,7 @@ static void shader_parse_configuration_file(dstring conf_file_name, shader_confi
 
     dstring line;
     u32     num_stages = 0;
-    while (file_get_line(file, &line))
+    while (file_next_line(&file, &line))
     {
         // INFO: if comment skip line
         if (line[0] == '#' || line[0] == '\0')
@@ -410,7 +414,8 @@ bool shader_system_create_default_shaders(u64 *material_shader_id, u64 *skybox_s
     shader_parse_configuration_file(conf_file, &material_shader_conf);
 
     shader material_shader{};
-    *material_shader_id = _create_shader(&material_shader_conf, &material_shader, SHADER_TYPE_MATERIAL);
+    *material_shader_id =
+        _create_shader(conf_file.c_str(), &material_shader_conf, &material_shader, SHADER_TYPE_MATERIAL);
     shader_sys_state_ptr->default_material_shader_id = *material_shader_id;
 
     shader_config skybox_shader_conf{};
@@ -424,7 +429,7 @@ bool shader_system_create_default_shaders(u64 *material_shader_id, u64 *skybox_s
     shader_parse_configuration_file(conf_file, &skybox_shader_conf);
 
     shader skybox_shader{};
-    *skybox_shader_id = _create_shader(&skybox_shader_conf, &skybox_shader, SHADER_TYPE_SKYBOX);
+    *skybox_shader_id = _create_shader(conf_file.c_str(), &skybox_shader_conf, &skybox_shader, SHADER_TYPE_SKYBOX);
     shader_sys_state_ptr->default_skybox_shader_id = *skybox_shader_id;
 
     shader_config grid_shader_conf{};
@@ -444,7 +449,7 @@ bool shader_system_create_default_shaders(u64 *material_shader_id, u64 *skybox_s
     shader_parse_configuration_file(conf_file, &grid_shader_conf);
 
     shader grid_shader{};
-    *grid_shader_id                              = _create_shader(&grid_shader_conf, &grid_shader, SHADER_TYPE_GRID);
+    *grid_shader_id = _create_shader(conf_file.c_str(), &grid_shader_conf, &grid_shader, SHADER_TYPE_GRID);
     shader_sys_state_ptr->default_grid_shader_id = *grid_shader_id;
 
     shader_config ui_shader_conf{};
@@ -464,7 +469,7 @@ bool shader_system_create_default_shaders(u64 *material_shader_id, u64 *skybox_s
     shader_parse_configuration_file(conf_file, &ui_shader_conf);
 
     shader ui_shader{};
-    *ui_shader_id                              = _create_shader(&ui_shader_conf, &ui_shader, SHADER_TYPE_UI);
+    *ui_shader_id = _create_shader(conf_file.c_str(), &ui_shader_conf, &ui_shader, SHADER_TYPE_UI);
     shader_sys_state_ptr->default_ui_shader_id = *ui_shader_id;
 
     return true;
@@ -574,7 +579,7 @@ static void shader_system_add_uniform(shader_config *out_config, dstring *name,
         }
     }
 
-    conf.name        = name;
+    conf.name        = *name;
     conf.stage       = stage;
     conf.scope       = scope;
     conf.set         = set;
@@ -1,8 +1,11 @@
 #include "containers/dhashtable.hpp"
+#include "containers/dslot_map.hpp"
 #include "core/dfile_system.hpp"
 #include "core/dmemory.hpp"
 #include "defines.hpp"
+#include "memory/arena_snapshot.hpp"
 #include "memory/arenas.hpp"
+#include "memory/frame_arena.hpp"
 #include "renderer/vulkan/vulkan_backend.hpp"
 #include "resources/resource_types.hpp"
 #include "texture_system.hpp"
@@ -15,9 +18,10 @@
 
 struct texture_system_state
 {
-    darray<dstring>     loaded_textures;
-    dhashtable<texture> hashtable;
-    arena              *arena;
+    // the textures themselves, the hashtable only maps names to handles.
+    dslot_map<texture>       textures;
+    dhashtable<dslot_handle> hashtable;
+    arena                   *arena;
 
     u32              glyphs_size;
     font_glyph_data *glyphs;
@@ -26,7 +30,14 @@ struct texture_system_state
 static texture_system_state *tex_sys_state_ptr;
 bool                         texture_system_create_default_textures();
 
-static bool texture_system_release_textures(dstring *texture_name);
+static bool texture_system_release_textures(dstring_view texture_name);
+
+// name -> handle -> texture, nullptr if it isnt loaded.
+static texture *texture_system_lookup(string_id id)
+{
+    dslot_handle *handle = tex_sys_state_ptr->hashtable.try_find(id);
+    return handle ? tex_sys_state_ptr->textures.get(*handle) : nullptr;
+}
 // static bool texture_system_create_font_atlas();
 
 bool texture_system_initialize(arena *system_arena, arena* resource_arena)
@@ -34,11 +45,11 @@ bool texture_system_initialize(arena *system_arena, arena* resource_arena)
     DINFO("Initializing texture system...");
     DASSERT(system_arena);
     DASSERT(resource_arena);
-    tex_sys_state_ptr = static_cast<texture_system_state *>(dallocate(system_arena, sizeof(texture_system_state), MEM_TAG_APPLICATION));
+    tex_sys_state_ptr = static_cast<texture_system_state *>(DALLOCATE(system_arena, sizeof(texture_system_state), MEM_TAG_APPLICATION));
     DASSERT(tex_sys_state_ptr);
 
     tex_sys_state_ptr->hashtable.c_init(system_arena, MAX_TEXTURES_LOADED);
-    tex_sys_state_ptr->loaded_textures.c_init(system_arena);
+    tex_sys_state_ptr->textures.init(MAX_TEXTURES_LOADED);
     tex_sys_state_ptr->arena = resource_arena;
 
     stbi_set_flip_vertically_on_load(true);
@@ -50,14 +61,13 @@ bool texture_system_initialize(arena *system_arena, arena* resource_arena)
 
 bool texture_system_shutdown()
 {
-    u64 loaded_textures_count = tex_sys_state_ptr->loaded_textures.size();
+    u64 loaded_textures_count = tex_sys_state_ptr->textures.size();
     for (u64 i = 0; i < loaded_textures_count; i++)
     {
-        dstring *tex_name = &tex_sys_state_ptr->loaded_textures[i];
-        texture_system_release_textures(tex_name);
+        texture_system_release_textures(tex_sys_state_ptr->textures.at(i)->name);
     }
 
-    tex_sys_state_ptr->loaded_textures.~darray();
+    tex_sys_state_ptr->textures.destroy();
     tex_sys_state_ptr = nullptr;
     return true;
 }
@@ -73,22 +83,26 @@ bool create_texture(texture *texture, u8 *pixels)
 
     const char *conf_file_base_name = texture->name.c_str();
 
-    tex_sys_state_ptr->hashtable.insert(conf_file_base_name, *texture);
-    tex_sys_state_ptr->loaded_textures.push_back(texture->name);
+    texture->name_id = string_id_intern(conf_file_base_name);
+    texture->handle  = tex_sys_state_ptr->textures.insert(*texture);
+
+    // the stored copy should know its own handle too.
+    tex_sys_state_ptr->textures.get(texture->handle)->handle = texture->handle;
+    tex_sys_state_ptr->hashtable.insert(texture->name_id, texture->handle);
     DDEBUG("Texture %s loaded in hastable.", conf_file_base_name);
 
     return true;
 }
 
-bool texture_system_create_texture(dstring *texture_name, u32 tex_width, u32 tex_height, u32 tex_num_channels,
+bool texture_system_create_texture(dstring_view texture_name, u32 tex_width, u32 tex_height, u32 tex_num_channels,
                                    image_format format, u8 *pixels)
 {
-    DASSERT(texture_name);
+    DASSERT(texture_name.length);
     DASSERT(pixels);
     DASSERT(format != IMG_FORMAT_UNKNOWN);
 
     texture texture{};
-    texture.name         = *texture_name;
+    texture.name         = texture_name;
     texture.format       = format;
     texture.width        = tex_width;
     texture.height       = tex_height;
@@ -116,26 +130,67 @@ bool texture_system_write_texture(dstring *file_full_path, u32 tex_width, u32 te
     return true;
 }
 
-bool texture_system_create_texture(dstring *file_base_name, image_format format)
+// Decoded rgba pixels for the file. Comes out of the resource snapshot if it has them, otherwise stbi decodes the file
+// and the result is recorded into the snapshot. *out_owned tells the caller if it has to stbi_image_free the pixels,
+// snapshot pixels point into the mapped file.
+static u8 *texture_system_load_pixels(const char *full_path, bool flip, s32 *out_width, s32 *out_height,
+                                      s32 *out_channels, bool *out_owned)
 {
-    DASSERT(file_base_name);
+    char key[TEXTURE_NAME_MAX_LENGTH + 8] = {0};
+    string_copy_format(key, "%s|%d", 0, full_path, flip ? 1 : 0);
+
+    arena_snapshot_source source = arena_snapshot_source_of(full_path);
+
+    u32       params[4] = {0};
+    const u8 *cached    = static_cast<const u8 *>(
+        arena_snapshot_find(SNAPSHOT_ENTRY_TEXTURE_PIXELS, key, source, params, nullptr));
+    if (cached)
+    {
+        *out_width    = params[0];
+        *out_height   = params[1];
+        *out_channels = params[2];
+        *out_owned    = false;
+        return const_cast<u8 *>(cached);
+    }
+
+    stbi_set_flip_vertically_on_load(flip);
+    stbi_uc *pixels = stbi_load(full_path, out_width, out_height, out_channels, STBI_rgb_alpha);
+    stbi_set_flip_vertically_on_load(true);
+    if (!pixels)
+    {
+        return nullptr;
+    }
+    *out_owned = true;
+
+    params[0] = *out_width;
+    params[1] = *out_height;
+    params[2] = *out_channels;
+    arena_snapshot_add(SNAPSHOT_ENTRY_TEXTURE_PIXELS, key, source, params, pixels,
+                       static_cast<u64>(*out_width) * *out_height * 4);
+    return pixels;
+}
+
+bool texture_system_create_texture(dstring_view file_base_name, image_format format)
+{
+    DASSERT(file_base_name.length);
     DASSERT(format != IMG_FORMAT_UNKNOWN);
 
     texture texture{};
-    texture.name = *file_base_name;
+    texture.name = file_base_name;
 
     char full_path_name[TEXTURE_NAME_MAX_LENGTH] = {0};
 
     const char *prefix = "../assets/textures/";
 
-    string_copy_format(static_cast<char *>(full_path_name), "%s%s", 0, prefix, file_base_name->c_str());
+    string_copy_format(static_cast<char *>(full_path_name), "%s%s", 0, prefix, texture.name.c_str());
 
     s32 tex_width    = -1;
     s32 tex_height   = -1;
     s32 tex_channels = -1;
 
-    stbi_uc *pixels =
-        stbi_load(static_cast<const char *>(full_path_name), &tex_width, &tex_height, &tex_channels, STBI_rgb_alpha);
+    bool owned  = false;
+    u8  *pixels = texture_system_load_pixels(static_cast<const char *>(full_path_name), true, &tex_width, &tex_height,
+                                             &tex_channels, &owned);
 
     if (!pixels)
     {
@@ -152,7 +207,10 @@ bool texture_system_create_texture(dstring *file_base_name, image_format format)
     texture.num_channels = tex_channels;
     texture.format       = format;
     bool result          = create_texture(&texture, pixels);
-    stbi_image_free(pixels);
+    if (owned)
+    {
+        stbi_image_free(pixels);
+    }
 
     return result;
 }
@@ -176,7 +234,7 @@ bool texture_system_create_default_textures()
         u32 texture_size =
             default_albedo_texture.width * default_albedo_texture.height * default_albedo_texture.num_channels;
 
-        u8 *pixels = static_cast<u8 *>(dallocate(arena, texture_size, MEM_TAG_UNKNOWN));
+        u8 *pixels = static_cast<u8 *>(DALLOCATE(arena, texture_size, MEM_TAG_UNKNOWN));
 
         for (u32 y = 0; y < tex_height; y++)
         {
@@ -210,7 +268,7 @@ bool texture_system_create_default_textures()
         u32 texture_size =
             default_normal_texture.width * default_normal_texture.height * default_normal_texture.num_channels;
 
-        u8 *pixels = static_cast<u8 *>(dallocate(arena, texture_size, MEM_TAG_UNKNOWN));
+        u8 *pixels = static_cast<u8 *>(DALLOCATE(arena, texture_size, MEM_TAG_UNKNOWN));
 
         for (u32 y = 0; y < tex_height; y++)
         {
@@ -238,29 +296,56 @@ texture *texture_system_get_texture(const char *texture_name)
     if (texture_name == nullptr)
     {
         DWARN("Texuture name is nullptr retrunring default albedo texture");
-        return texture_system_get_texture(DEFAULT_ALBEDO_TEXTURE_HANDLE);
+        return texture_system_get_texture_by_id(DEFAULT_ALBEDO_TEXTURE_ID);
     }
-    texture *texture = tex_sys_state_ptr->hashtable.find(texture_name);
+    string_id id      = string_id_hash(texture_name);
+    texture  *texture = texture_system_lookup(id);
     // TODO: increment the value for texture references
     if (texture == nullptr)
     {
         DTRACE("Texture: %s not loaded in yet, loading it...", texture_name);
-        dstring name = texture_name;
-        texture_system_create_texture(&name, IMG_FORMAT_SRGB);
-        texture = tex_sys_state_ptr->hashtable.find(texture_name);
+        texture_system_create_texture(texture_name, IMG_FORMAT_SRGB);
+        texture = texture_system_lookup(id);
     }
 
     return texture;
 }
 
-bool texture_system_release_textures(dstring *tex_name)
+texture *texture_system_get_texture_by_id(string_id id)
 {
-    const char *texture_name = tex_name->c_str();
-    texture    *texture      = tex_sys_state_ptr->hashtable.find(texture_name);
-    bool        result       = vulkan_destroy_texture(texture);
+    texture *texture = texture_system_lookup(id);
+    if (texture)
+    {
+        return texture;
+    }
+    // not loaded yet, if we know its name we can still load it.
+    const char *texture_name = string_id_get_string(id);
+    if (texture_name)
+    {
+        return texture_system_get_texture(texture_name);
+    }
+    DWARN("No texture with id %llu, returning the default albedo texture.", id);
+    return texture_system_lookup(DEFAULT_ALBEDO_TEXTURE_ID);
+}
+
+texture *texture_system_get_texture_by_handle(dslot_handle handle)
+{
+    texture *texture = tex_sys_state_ptr->textures.get(handle);
+    if (!texture)
+    {
+        DWARN("Stale or invalid texture handle %llu, returning the default albedo texture.", handle);
+        return texture_system_lookup(DEFAULT_ALBEDO_TEXTURE_ID);
+    }
+    return texture;
+}
+
+bool texture_system_release_textures(dstring_view texture_name)
+{
+    texture *texture = texture_system_lookup(string_id_hash(texture_name.data, texture_name.length));
+    bool     result  = texture && vulkan_destroy_texture(texture);
     if (!result)
     {
-        DERROR("Couldn't release texture %s", texture_name);
+        DERROR("Couldn't release texture %.*s", static_cast<s32>(texture_name.length), texture_name.data);
         return false;
     }
 
@@ -276,8 +361,14 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 
     dstring cubemap_faces[6];
 
-    std::fstream f;
-    file_open(full_file_path, &f, false, false);
+    // the conf file text, popped when the cubemap is done.
+    arena_scope conf_scratch(scratch_arena_get());
+    file_lines  f;
+    if (!file_read_lines(conf_scratch.owner, full_file_path.c_str(), &f))
+    {
+        DERROR("Couldnt open cubemap configuration %s.", full_file_path.c_str());
+        return false;
+    }
 
     dstring line;
     dstring identifier;
@@ -311,7 +402,7 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
         dst.str_len = j;
     };
 
-    while (file_get_line(f, &line))
+    while (file_next_line(&f, &line))
     {
         if (line[0] == '#' || line[0] == '\0' || line[0] == '\n' || line[0] == '\r')
         {
@@ -354,12 +445,12 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
         line.clear();
     }
 
-    stbi_uc *cubemap_pixels[6] = {nullptr};
+    u8      *cubemap_pixels[6] = {nullptr};
+    bool     cubemap_owned[6]  = {false};
     s32      prev_width        = INVALID_ID_S32;
     s32      prev_height       = INVALID_ID_S32;
     s32      prev_channel      = INVALID_ID_S32;
 
-    stbi_set_flip_vertically_on_load(false);
     for (s32 i = 0; i < 6; i++)
     {
         full_file_path.clear();
@@ -369,7 +460,8 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
         s32 channel = INVALID_ID_S32;
 
         string_copy_format(full_file_path.string, "%s%s", 0, prefix.c_str(), cubemap_faces[i].c_str());
-        cubemap_pixels[i] = stbi_load(full_file_path.c_str(), &width, &height, &channel, STBI_rgb_alpha);
+        cubemap_pixels[i] = texture_system_load_pixels(full_file_path.c_str(), false, &width, &height, &channel,
+                                                       &cubemap_owned[i]);
         if (!cubemap_pixels[i])
         {
             DERROR("Cubemap Texture creation failed. Error opening file %s: %s", full_file_path.c_str(),
@@ -387,7 +479,6 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
         prev_height  = height;
         prev_channel = channel;
     }
-    stbi_set_flip_vertically_on_load(true);
 
     texture cubemap_texture;
     // HACK:
@@ -398,8 +489,9 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
     cubemap_texture.texure_size  = prev_width * prev_height * 4 * 6;
     cubemap_texture.format       = IMG_FORMAT_SRGB;
 
-    arena *temp_arena = arena_get_arena();
-    u8    *pixels     = static_cast<u8 *>(dallocate(temp_arena, cubemap_texture.texure_size, MEM_TAG_RENDERER));
+    // create_texture copies the pixels into a staging buffer, so they only have to live until the end of this function.
+    arena_scope scratch(scratch_arena_get());
+    u8         *pixels = static_cast<u8 *>(DALLOCATE(scratch.owner, cubemap_texture.texure_size, MEM_TAG_RENDERER));
 
     u32 tex_real_size = prev_width * prev_height * 4;
     u32 layer_size    = cubemap_texture.texure_size / 6;
@@ -414,7 +506,10 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 
     for (s32 i = 0; i < 6; i++)
     {
-        stbi_image_free(cubemap_pixels[i]);
+        if (cubemap_owned[i])
+        {
+            stbi_image_free(cubemap_pixels[i]);
+        }
     }
 
     return true;
@@ -449,7 +544,7 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 //         bool result = file_open_and_read(file_full_path.c_str(), &font_buffer_size, nullptr, false);
 //         DASSERT(result);
 //
-//         u8 *font_buffer = static_cast<u8 *>(dallocate(arena, font_buffer_size, MEM_TAG_UNKNOWN));
+//         u8 *font_buffer = static_cast<u8 *>(DALLOCATE(arena, font_buffer_size, MEM_TAG_UNKNOWN));
 //         result =
 //             file_open_and_read(file_full_path.c_str(), &font_buffer_size, reinterpret_cast<char *>(font_buffer),
 //             false);
@@ -459,7 +554,7 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 //         u32 atlas_height = 512;
 //
 //         u32 font_atlas_size   = atlas_width * atlas_height;
-//         u8 *font_atlas_buffer = static_cast<u8 *>(dallocate(arena, font_atlas_size, MEM_TAG_UNKNOWN));
+//         u8 *font_atlas_buffer = static_cast<u8 *>(DALLOCATE(arena, font_atlas_size, MEM_TAG_UNKNOWN));
 //
 //         stbtt_fontinfo font;
 //         if (!stbtt_InitFont(&font, font_buffer, stbtt_GetFontOffsetForIndex(font_buffer, 0)))
@@ -628,7 +723,7 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 //         bool result = file_open_and_read(file_full_path.c_str(), &font_buffer_size, nullptr, false);
 //         DASSERT(result);
 //
-//         char *font_buffer = static_cast<char *>(dallocate(arena, font_buffer_size, MEM_TAG_UNKNOWN));
+//         char *font_buffer = static_cast<char *>(DALLOCATE(arena, font_buffer_size, MEM_TAG_UNKNOWN));
 //         result            = file_open_and_read(file_full_path.c_str(), &font_buffer_size, font_buffer, false);
 //         DASSERT(result);
 //
@@ -636,7 +731,7 @@ bool texture_system_load_cubemap(dstring *conf_file_base_name)
 //         u32 atlas_height = 512;
 //
 //         u32 font_atlas_size   = atlas_width * atlas_height;
-//         u8 *font_atlas_buffer = static_cast<u8 *>(dallocate(arena, font_atlas_size, MEM_TAG_UNKNOWN));
+//         u8 *font_atlas_buffer = static_cast<u8 *>(DALLOCATE(arena, font_atlas_size, MEM_TAG_UNKNOWN));
 //
 //         stbtt_pack_context packContext;
 //         if (!stbtt_PackBegin(&packContext, font_atlas_buffer, atlas_width, atlas_height, 0, 1, NULL))